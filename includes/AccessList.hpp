@@ -0,0 +1,104 @@
+/**
+ * @file AccessList.hpp
+ * @brief Client address access rules (`allow`, `deny`, `allow_list`,
+ *        `deny_list`)
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-17
+ * @version 1.0
+ *
+ * Rules are checked in order and the first one matching the client decides,
+ * as in nginx; a client no rule matches is allowed. A rule is `all` or an
+ * IPv4/IPv6 CIDR, a `*_list` file adds all its prefixes as one rule.
+ *
+ * The prefixes are kept in two path-compressed binary tries (Patricia
+ * trees), one per address family. Every prefix remembers the first rule it
+ * belongs to, so a lookup is one walk from the root to the longest matching
+ * prefix taking the smallest rule number on the way, whatever the number of
+ * prefixes (a 500k prefix blocklist costs at most 32 steps for IPv4).
+ *
+ * Server rules are checked right after accept(): a client every server of
+ * the listening socket denies is closed before anything is read. Locations
+ * without rules of their own use the rules of their server, checked in the
+ * access phase once the virtual host is known.
+ */
+
+// List file format, one prefix per line (`#` starts a comment):
+//
+//   192.0.2.0/24
+//   198.51.100.7
+//   2001:db8::/32;
+
+#ifndef _ACCESS_LIST_HPP
+#define _ACCESS_LIST_HPP
+
+#include <sys/socket.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using uint128_t = unsigned __int128;
+
+/// @brief Address of the peer of a connection
+struct ClientAddress {
+  int family = AF_UNSPEC;  // AF_INET, AF_INET6, AF_UNSPEC (unix sockets)
+  uint32_t v4 = 0;         // host byte order
+  uint128_t v6 = 0;
+
+  static ClientAddress fromSockaddr(const sockaddr_storage& address);
+  static bool parse(const std::string& text, ClientAddress& address);
+  std::string toString(void) const;
+};
+
+class AccessList {
+ public:
+  AccessList() = default;
+  ~AccessList() = default;
+  AccessList(const AccessList& other) = default;
+  AccessList& operator=(const AccessList& other) = default;
+
+  void addRule(bool allow, const std::string& prefix);
+  void load(bool allow, const std::string& path);
+
+  bool isAllowed(const ClientAddress& client) const;
+  size_t size(void) const;
+
+ private:
+  static constexpr uint32_t NO_RULE = UINT32_MAX;
+
+  template <typename Key>
+  class PrefixTree {
+   public:
+    PrefixTree();
+    void insert(Key key, uint8_t length, uint32_t rule);
+    uint32_t find(Key key) const;
+    size_t size(void) const;
+
+   private:
+    struct Node {
+      Key key;
+      uint32_t child[2];  // 0 = none (node 0 is the root)
+      uint32_t rule;      // NO_RULE for a branching node without a prefix
+      uint8_t length;
+    };
+    std::vector<Node> _nodes;
+    size_t _prefixes;
+
+    static constexpr uint8_t BITS = sizeof(Key) * 8;
+    static Key mask(uint8_t length);
+    static int bit(Key key, uint8_t index);
+    static uint8_t commonLength(Key a, Key b, uint8_t limit);
+  };
+
+  PrefixTree<uint32_t> _v4;
+  PrefixTree<uint128_t> _v6;
+  std::vector<bool> _deny;         // action of each rule
+  uint32_t _all_rule = NO_RULE;    // first `all` (unix socket clients)
+
+ private:
+  uint32_t nextRule(bool allow);
+  void addPrefix(const std::string& prefix, uint32_t rule);
+};
+
+#endif  // _ACCESS_LIST_HPP
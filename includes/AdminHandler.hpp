@@ -0,0 +1,60 @@
+/**
+ * @file AdminHandler.hpp
+ * @brief Serves runtime reports of the webserver on admin locations
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-02
+ * @version 1.0
+ *
+ * A location with `admin_endpoint on;` exposes read-only plain text reports.
+ * The report is selected by the part of the URI after the location path:
+ * - <location>/              list of available reports
+ * - <location>/vhosts        per virtual host quota usage
+ * - <location>/memory        memory held by client connections and buffers
+ * - <location>/connections   client connections, filtered by the query
+ *                            (`peer`, `vhost`, `state`, `idle`)
+ * - <location>/profile       `?seconds=N` starts a CPU profile, then the
+ *                            folded stacks
+ * - <location>/heap          allocation sites (HEAP_PROFILE=1 builds)
+ *
+ * @note Protect admin locations, they expose internal server state.
+ */
+
+#ifndef _ADMIN_HANDLER_HPP
+#define _ADMIN_HANDLER_HPP
+
+#include <string>
+
+#include "Config.hpp"
+#include "HttpRequest.hpp"
+#include "HttpResponse.hpp"
+
+/// @brief Allocation sites listed by <location>/heap
+#define ADMIN_HEAP_SITES 100
+
+class Webserv;
+
+class AdminHandler {
+ public:
+  AdminHandler() = delete;
+  AdminHandler& operator=(const AdminHandler& other) = delete;
+  AdminHandler(const AdminHandler& other) = delete;
+  explicit AdminHandler(const Webserv& webserv);
+  ~AdminHandler() = default;
+
+  HttpResponse handle(const HttpRequest& request,
+                      const ConfigParser::LocationConfig& location);
+
+ private:
+  const Webserv& _webserv;
+
+ private:
+  HttpResponse serveIndex(void);
+  HttpResponse serveVhosts(void);
+  HttpResponse serveMemory(void);
+  HttpResponse serveConnections(const HttpRequest& request);
+  HttpResponse serveProfile(const HttpRequest& request,
+                            const ConfigParser::LocationConfig& location);
+  HttpResponse serveHeap(void);
+};
+
+#endif  // _ADMIN_HANDLER_HPP
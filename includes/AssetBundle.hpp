@@ -0,0 +1,125 @@
+/**
+ * @file AssetBundle.hpp
+ * @brief Read-only site packed into one file (`bundle` directive)
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-13
+ * @version 1.0
+ *
+ * `make bundle` builds the `webserv-bundle` tool, which packs a document
+ * root into one file: every file's content, its MIME type, a strong ETag
+ * (SHA-256 prefix) and a gzip variant when that is smaller. The server maps
+ * the bundle at config load and answers GETs of a location with
+ * `bundle <file>;` straight from it: one hash probe per request, no stat(),
+ * open() or path canonicalization. Paths not in the bundle fall back to the
+ * location's root as usual. Deploying a new site is one file copy.
+ *
+ * Small bodies are copied from the mapping into the response, larger ones
+ * are sent from the bundle file with sendfile() (page cache, no copy). The
+ * client socket is non-blocking, so a large asset to a client that stops
+ * reading waits for EPOLLOUT like any other response.
+ */
+
+// File layout (host byte order, the bundle is built where it is served):
+//
+//   Header          magic, counts and offsets of the tables below
+//   contents        file contents and gzip variants back to back
+//   Record[count]   one per asset, sorted by path
+//   slots[n]        open addressing table (n power of two, load <= 1/2):
+//                   record index + 1 at hashPath(path) & (n - 1) or after
+//   strings         path, content type and ETag of every record
+
+#ifndef _ASSET_BUNDLE_HPP
+#define _ASSET_BUNDLE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "BodySource.hpp"
+
+#define BUNDLE_MAGIC "WSBUNDL1"
+/// @brief Bodies up to this size are copied, larger go out with sendfile()
+#define BUNDLE_INLINE_MAX 16384
+
+class AssetBundle {
+ public:
+  /// @brief Asset found by find(), views point into the mapped bundle
+  struct Asset {
+    std::string_view path;
+    std::string_view content_type;
+    std::string_view etag;  // without quotes
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    uint64_t gzip_offset = 0;
+    uint64_t gzip_length = 0;  // 0 = no gzip variant
+  };
+
+  /// @brief Compresses input to gzip, returns false to store no variant
+  using Compressor = bool (*)(std::string_view input, std::string& output);
+
+  /// @brief Response body of one asset sent with sendfile()
+  class Body : public BodySource {
+   public:
+    Body(std::shared_ptr<const AssetBundle> bundle, uint64_t offset,
+         uint64_t length);
+    uint64_t size(void) const override;
+    bool next(std::string& buffer, FileRange& range) override;
+
+   private:
+    std::shared_ptr<const AssetBundle> _bundle;
+    uint64_t _offset;
+    uint64_t _length;
+    bool _sent = false;
+  };
+
+  AssetBundle() = delete;
+  explicit AssetBundle(const std::string& path);
+  ~AssetBundle();
+  AssetBundle& operator=(const AssetBundle& other) = delete;
+  AssetBundle(const AssetBundle& other) = delete;
+
+  bool find(std::string_view path, Asset& asset) const;
+  std::string_view data(uint64_t offset, uint64_t length) const;
+  int getFd(void) const;
+  size_t size(void) const;
+
+  static bool build(const std::string& root, const std::string& output,
+                    Compressor gzip, size_t& assets, std::string& error_msg);
+
+ private:
+  struct Header {
+    char magic[8];
+    uint32_t count;
+    uint32_t slot_count;
+    uint64_t records_offset;
+    uint64_t slots_offset;
+    uint64_t strings_offset;
+    uint64_t file_size;
+  };
+
+  struct Record {
+    uint64_t hash;
+    uint64_t offset;
+    uint64_t length;
+    uint64_t gzip_offset;
+    uint64_t gzip_length;
+    uint32_t strings;  // offset in strings
+    uint16_t path_length;
+    uint8_t type_length;
+    uint8_t etag_length;
+  };
+
+  int _fd = -1;
+  const char* _map = nullptr;
+  size_t _map_size = 0;
+  Header _header{};
+  const Record* _records = nullptr;
+  const uint32_t* _slots = nullptr;
+  const char* _strings = nullptr;
+
+ private:
+  void validate(const std::string& path) const;
+};
+
+#endif  // _ASSET_BUNDLE_HPP
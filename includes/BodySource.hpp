@@ -0,0 +1,51 @@
+/**
+ * @file BodySource.hpp
+ * @brief Response body produced while it is being sent
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-12
+ * @version 1.0
+ *
+ * A response with a body source has no body string: the connection sends
+ * the head from its write buffer, then asks the source for the next piece
+ * each time everything before it has been sent. A piece is either a few
+ * generated bytes (appended to the connection's write buffer) or a range of
+ * an open file, which is sent with sendfile() and never copied to userspace.
+ * Memory stays bounded by one piece no matter how large the body is.
+ */
+
+#ifndef _BODY_SOURCE_HPP
+#define _BODY_SOURCE_HPP
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <string>
+
+class BodySource {
+ public:
+  /// @brief Part of an open file, the fd stays owned by the source
+  struct FileRange {
+    int fd = -1;
+    off_t offset = 0;
+    size_t length = 0;
+  };
+
+  virtual ~BodySource() = default;
+
+  /// @brief Content-Length of the whole body, known before sending starts
+  virtual uint64_t size(void) const = 0;
+
+  /**
+   * @brief Produces the next piece of the body
+   *
+   * If the file of a range turns out shorter than promised, the connection
+   * sends zeros for the rest so the body still matches size().
+   *
+   * @param buffer [out] Generated bytes are appended here
+   * @param range [out] File range to send after the buffer, length 0 if none
+   * @return false once the body is complete (nothing was produced)
+   */
+  virtual bool next(std::string& buffer, FileRange& range) = 0;
+};
+
+#endif  // _BODY_SOURCE_HPP
@@ -0,0 +1,99 @@
+/**
+ * @file BufferChain.hpp
+ * @brief Receive buffer made of pooled fixed-size blocks
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-08
+ * @version 1.0
+ *
+ * `recv()` writes straight into the free tail of the last block and the
+ * parser consumes from the head of the first one. Consumed blocks go back
+ * to a process-wide pool instead of the remaining bytes being moved to the
+ * front of a growing string, so a large body costs one copy (socket ->
+ * block) plus the copy into the request body.
+ *
+ * Data may span block boundaries: find() searches across them and peek()
+ * returns a contiguous view, copying into a scratch string only when the
+ * requested bytes really are split between blocks.
+ *
+ * Blocks come in a few sizes, chosen per chain with setBlockSize() for the
+ * blocks it adds next: the connection reads request heads into small
+ * blocks (`client_header_buffer_size`), larger heads into
+ * `large_client_header_buffers` blocks and bodies into BUFFER_BLOCK_SIZE
+ * blocks. Every size has its own free list in the pool.
+ */
+
+#ifndef _BUFFER_CHAIN_HPP
+#define _BUFFER_CHAIN_HPP
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// @brief Size of the pooled blocks request bodies are read into
+#define BUFFER_BLOCK_SIZE 16384
+/// @brief Free blocks kept by the pool per block size, the rest is freed
+#define BUFFER_POOL_MAX_FREE 256
+
+class BufferPool {
+ public:
+  static char* acquire(size_t size = BUFFER_BLOCK_SIZE);
+  static void release(char* block, size_t size = BUFFER_BLOCK_SIZE);
+  static size_t allocatedBlocks(void);
+  static size_t allocatedBytes(void);
+  static size_t freeBlocks(void);
+
+ private:
+  struct SizeClass {
+    size_t size;
+    std::vector<char*> free;
+  };
+  static std::vector<SizeClass> _classes;  // one per block size in use
+  static size_t _allocated;
+  static size_t _allocated_bytes;
+
+ private:
+  static SizeClass& getSizeClass(size_t size);
+};
+
+class BufferChain {
+ public:
+  BufferChain();
+  ~BufferChain();
+  BufferChain& operator=(const BufferChain& other) = delete;
+  BufferChain(const BufferChain& other) = delete;
+
+  void setBlockSize(size_t size);
+  char* prepare(size_t& available);
+  void commit(size_t bytes);
+  void append(std::string_view data);
+
+  size_t find(std::string_view needle, size_t from = 0) const;
+  std::string_view peek(size_t bytes);
+  void consume(size_t bytes);
+  void moveTo(std::string& out, size_t bytes);
+  void clear(void);
+
+  size_t size(void) const;
+  bool empty(void) const;
+  size_t blockCount(void) const;
+  size_t capacity(void) const;
+
+ private:
+  struct Block {
+    char* data;
+    size_t size;
+  };
+  std::deque<Block> _blocks;
+  size_t _block_size;  // of the blocks prepare() adds
+  size_t _head;  // read offset in the first block
+  size_t _tail;  // write offset in the last block
+  size_t _size;
+  std::string _scratch;  // peek() of bytes split between blocks
+
+ private:
+  bool matchesAt(size_t block, size_t offset, std::string_view needle) const;
+};
+
+#endif  // _BUFFER_CHAIN_HPP
@@ -0,0 +1,72 @@
+/**
+ * @file CachePolicy.hpp
+ * @brief Caching headers of static responses (`expires`, `add_header`)
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-15
+ * @version 1.0
+ *
+ * Built while a location is parsed: every directive re-renders the header
+ * lines it affects, so a response only gets a precomputed block of bytes
+ * appended (plus the `Expires` date of `expires <time>`, which moves with
+ * the clock). Paths matching `immutable_pattern` are fingerprinted (their
+ * content never changes under that name) and get
+ * `Cache-Control: public, max-age=31536000, immutable` instead.
+ *
+ *   expires 30d | -1 | epoch | max | off
+ *   add_header Cache-Control "public, no-transform"
+ *   immutable_pattern on | <regex>
+ */
+
+#ifndef _CACHE_POLICY_HPP
+#define _CACHE_POLICY_HPP
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "RegexDfa.hpp"
+
+class HttpResponse;
+
+/// @brief `immutable_pattern on`: name.<8+ hex digits>.ext or name-<...>.ext
+#define CACHE_FINGERPRINT_PATTERN "[.-][0-9a-fA-F]{8,}\\.[0-9A-Za-z]+$"
+/// @brief max-age of fingerprinted paths (one year)
+#define CACHE_IMMUTABLE_MAX_AGE 31536000
+/// @brief `expires max` as nginx sends it (ten years, far-future date)
+#define CACHE_MAX_AGE 315360000
+#define CACHE_MAX_EXPIRES "Thu, 31 Dec 2037 23:55:55 GMT"
+#define CACHE_EPOCH_EXPIRES "Thu, 01 Jan 1970 00:00:01 GMT"
+
+class CachePolicy {
+ public:
+  CachePolicy() = default;
+  CachePolicy& operator=(const CachePolicy& other) = default;
+  CachePolicy(const CachePolicy& other) = default;
+  ~CachePolicy() = default;
+
+  void setExpires(const std::string& value);
+  void addHeader(const std::string& name, const std::string& value);
+  void setImmutablePattern(const std::string& pattern);
+
+  void apply(std::string_view path, HttpResponse& response) const;
+  std::string_view headerBlock(bool immutable) const;
+
+  static long parseDuration(const std::string& value);
+
+ private:
+  enum class Expires { OFF, TIME, EPOCH, MAX };
+
+  Expires _expires = Expires::OFF;
+  long _expires_seconds = 0;
+  std::vector<std::pair<std::string, std::string>> _headers;  // add_header
+  bool _has_immutable_pattern = false;
+  RegexDfa _immutable_pattern;
+  std::string _block;            // "Name: value\r\n" lines
+  std::string _immutable_block;  // same for fingerprinted paths
+
+ private:
+  void render(void);
+};
+
+#endif  // _CACHE_POLICY_HPP
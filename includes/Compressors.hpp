@@ -0,0 +1,35 @@
+/**
+ * @file Compressors.hpp
+ * @brief Content codings of the offline tools (webserv-bundle, -precompress)
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-14
+ * @version 1.0
+ *
+ * The server itself never compresses, so only the tools link compression
+ * libraries. The Makefile defines HAVE_ZLIB, HAVE_BROTLI and HAVE_ZSTD for
+ * the tools when it finds the headers; a coding without its library is not
+ * declared. All of them compress at the best level: the output is made once
+ * and sent many times.
+ */
+
+#ifndef _COMPRESSORS_HPP
+#define _COMPRESSORS_HPP
+
+#include <string>
+#include <string_view>
+
+namespace Compressors {
+
+#ifdef HAVE_ZLIB
+bool gzip(std::string_view input, std::string& output);
+#endif
+#ifdef HAVE_BROTLI
+bool brotli(std::string_view input, std::string& output);
+#endif
+#ifdef HAVE_ZSTD
+bool zstd(std::string_view input, std::string& output);
+#endif
+
+}  // namespace Compressors
+
+#endif  // _COMPRESSORS_HPP
@@ -3,8 +3,18 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 #include <iostream>
 
+struct VhostUsage;
+namespace MimeTypes { class MimeTable; }
+class RedirectMap;
+class LocationMatcher;
+class AssetBundle;
+class CachePolicy;
+class AccessList;
+class RequestPipeline;
+
 namespace ConfigParser {
 
     enum class TokenType {
@@ -25,17 +35,57 @@ namespace ConfigParser {
 
     struct ServerConfig;
 
+    // `location [modifier] path`, as in nginx
+    enum class LocationModifier {
+        PREFIX,             // none: longest prefix
+        EXACT,              // =
+        PREFERRED_PREFIX,   // ^~ : prefix, regex locations are not checked
+        REGEX,              // ~
+        REGEX_CASELESS      // ~*
+    };
+
+    // `upload_durability`: what is synced before an upload is reported done
+    enum class UploadDurability {
+        NONE,               // page cache only (default)
+        FDATASYNC,          // file data (and size)
+        FSYNC               // file data and metadata, then the directory
+    };
+
     struct LocationConfig {
         std::string path;
+        LocationModifier modifier           = LocationModifier::PREFIX;
         std::string root;
         std::string index;
         bool        autoindex               = false;
         size_t      client_max_body_size    = 1048576; // Default 1MB
         std::string redirect_url;
+        int         redirect_code           = 301;
         std::vector<std::string>            allowed_methods;
         std::vector<std::string>            cgi_ext;
         std::vector<std::string>            cgi_path;
         std::map<int, std::string>          error_pages;
+        bool        admin_endpoint          = false;
+        size_t      limit_rate              = 0; // bytes per second, 0 = off
+        size_t      limit_rate_after        = 0;
+        bool        limit_rate_kernel       = false;
+        bool        upload_by_digest        = false; // upload_store digest
+        bool        upload_resumable        = false;
+        bool        upload_splice           = false; // raw bodies: splice()
+        UploadDurability upload_durability  = UploadDurability::NONE;
+        // `types {}` of the location or its server (nullptr = built-in)
+        std::shared_ptr<const MimeTypes::MimeTable> mime_types;
+        // `bundle` file GETs are served from (nullptr = files under root)
+        std::shared_ptr<const AssetBundle> bundle;
+        // `gzip_static` etc.: send <file>.gz/.br/.zst the client accepts
+        bool        gzip_static             = false;
+        bool        brotli_static           = false;
+        bool        zstd_static             = false;
+        // `expires`, `add_header`, `immutable_pattern` of static files
+        std::shared_ptr<const CachePolicy> cache_policy;
+        // `allow`/`deny` rules (nullptr = none), the server's if it has none
+        std::shared_ptr<const AccessList> access;
+        // phase handlers of the location, composed after the server block
+        std::shared_ptr<const RequestPipeline> pipeline;
 
         LocationConfig(const ServerConfig& parent);
     };
@@ -43,14 +93,40 @@ namespace ConfigParser {
     struct ServerConfig {
         std::string host                    = "0.0.0.0";
         int         port                    = 80;
+        // `listen unix:<path>` sockets; listen_tcp is false if the server
+        // only has these (without any `listen` it is port 80 as before)
+        std::vector<std::string>            unix_paths;
+        bool        listen_tcp              = false;
         std::vector<std::string>            server_names;
         std::string root;
         std::string index;
         size_t      client_max_body_size    = 1048576; // Default 1MB
+        // request heads are read into a small block, larger heads into up
+        // to large_header_buffers blocks (431 beyond, one line per block)
+        size_t      client_header_buffer_size = 1024;
+        size_t      large_header_buffers      = 4;
+        size_t      large_header_buffer_size  = 8192;
         std::map<int, std::string>          error_pages;
         std::vector<std::string>            cgi_ext;
         std::vector<std::string>            cgi_path;
         std::vector<LocationConfig>         locations;
+        size_t      limit_rate              = 0; // bytes per second, 0 = off
+        size_t      limit_rate_after        = 0;
+        bool        limit_rate_kernel       = false;
+        std::shared_ptr<const MimeTypes::MimeTable> mime_types;
+        // `redirect_map` entries, checked before location lookup
+        std::shared_ptr<const RedirectMap> redirects;
+        // `allow`/`deny` rules, checked when a client connects
+        std::shared_ptr<const AccessList> access;
+        // lookup tables over `locations`, built after the server block
+        std::shared_ptr<const LocationMatcher> location_matcher;
+        // per-vhost quotas (0 = unlimited)
+        size_t      max_connections         = 0;
+        size_t      max_cgi_processes       = 0;
+        size_t      max_body_memory         = 0;
+        size_t      max_bandwidth           = 0; // bytes per second
+        // live counters, owned by Webserv (nullptr = quotas not enforced)
+        VhostUsage* usage                   = nullptr;
     };
 
     struct Config {
@@ -66,6 +142,7 @@ namespace ConfigParser {
         namespace Tokenizer {
             std::vector<Token> tokenize(const std::string& content);
             void classifyTokens(std::vector<Token>& tokens);
+            void expandIncludes(std::vector<Token>& tokens, const std::string& base_dir, size_t depth = 0);
         }
 
         namespace Parser {
@@ -73,6 +150,7 @@ namespace ConfigParser {
             
             void parseServerBlock(Config& config, const std::vector<Token>& tokens, size_t& pos);
             void parseLocationBlock(ServerConfig& server, const std::vector<Token>& tokens, size_t& pos);
+            void parseTypesBlock(std::shared_ptr<const MimeTypes::MimeTable>& types, const std::vector<Token>& tokens, size_t& pos);
 
             void parseServerDirective(ServerConfig& server, const std::vector<Token>& tokens, size_t& pos);
             void parseLocationDirective(LocationConfig& location, const std::vector<Token>& tokens, size_t& pos);
@@ -9,18 +9,32 @@
 #ifndef _CONNECTION_HPP
 #define _CONNECTION_HPP
 
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
 #include <chrono>
+#include <cstdint>
+#include <memory>
 #include <sstream>
 #include <string>
 
+#include "BodySource.hpp"
 #include "HttpRequest.hpp"
 #include "HttpRequestParser.hpp"
 #include "HttpResponse.hpp"
 #include "Logger.hpp"
+#include "VhostQuota.hpp"
 #include "Webserver.hpp"
 
+/// @brief Paced responses are sent in slices of 1/20 of limit_rate (50 ms)
+#define CONNECTION_LIMIT_RATE_SLICES 20
+/// @brief Write buffer capacity kept between responses, larger is freed
+#define CONNECTION_KEEP_CAPACITY 16384
+/// @brief Keep-alive connections idle this long release all their buffers
+#define CONNECTION_IDLE_RELEASE_SEC 5
+
 class HttpMethodHandler;
 class HttpRequest;
 class HttpResponse;
@@ -28,33 +42,103 @@ class Webserv;
 
 class Connection {
  public:
+  /// @brief What the connection is doing (admin `connections` report)
+  struct Snapshot {
+    ClientAddress peer;
+    std::string vhost;  // server label, empty before the first request
+    HttpParsingState state;
+    size_t bytes_in;   // received and not handled yet (headers, body)
+    size_t bytes_out;  // response bytes not sent yet
+    size_t memory;
+    std::chrono::milliseconds idle;
+    std::string request_line;  // empty between requests
+  };
+
   Connection() = delete;
   ~Connection();
   Connection& operator=(const Connection& other) = delete;
   Connection(const Connection& other) = delete;
   Connection(int client_socket_fd, int server_socket_fd, Webserv& webserv,
-             HttpMethodHandler& method_handler);
+             HttpMethodHandler& method_handler,
+             const ClientAddress& client = ClientAddress());
 
-  void processRequest(std::string&& data);
+  void processRequest(void);
+  BufferChain& getReceiveBuffer(void);
+  bool isSplicingBody(void) const;
+  bool receiveSplicedBody(void);
+  void handleWritable(void);
   void updateLastActiveTime(void);
   bool isTimedOut(std::chrono::seconds timeout) const;
   bool keepAlive() const;
+  bool hasPendingWrite(void) const;
+  bool isWritePaused(void) const;
+  std::chrono::steady_clock::time_point getResumeTime(void) const;
+  uint32_t getEpollEvents(void) const;
+  void setEpollEvents(uint32_t events);
+  bool isIdle(void) const;
+  void releaseIdleMemory(void);
+  size_t getMemoryUsage(void) const;
+  Snapshot getSnapshot(std::chrono::steady_clock::time_point now) const;
 
  private:
   int _client_fd;
   int _server_fd;
+  // request head block sizes, of the listening socket's default server
+  size_t _header_buffer_size;
+  size_t _large_header_buffer_size;
   Webserv& _webserv;
   HttpMethodHandler& _method_handler;
   HttpRequest _request;
   std::string _write_buffer;
+  size_t _write_offset;
+  // streamed body: the range is sent once _write_buffer is drained
+  std::shared_ptr<BodySource> _body_source;
+  BodySource::FileRange _file_range;
+  size_t _sent_bytes;  // of the current response
+  uint32_t _epoll_events;
   bool _keep_alive;
   std::chrono::steady_clock::time_point _last_active;
+  // virtual host this connection is accounted to (quotas)
+  const ConfigParser::ServerConfig* _vhost;
+  size_t _body_memory;
+  bool _splice_checked;  // findSpliceDirectory() asked for this request
+  // response pacing (limit_rate)
+  size_t _limit_rate;
+  size_t _limit_rate_after;
+  bool _kernel_pacing;
+  bool _kernel_pacing_active;
+  double _rate_tokens;
+  std::chrono::steady_clock::time_point _rate_refill;
+  std::chrono::steady_clock::time_point _resume_at;
+  bool _is_paused;
 
  private:
+  bool checkVhostQuotas(const ConfigParser::ServerConfig& server);
+  bool bindVhost(const ConfigParser::ServerConfig& server);
+  bool startSplicedBody(const ConfigParser::ServerConfig& server);
+  void releaseVhost(void);
+  size_t getBufferedBodySize(void) const;
   void buildParserErrorResponse(void);
   void buildMethodHandlerErrorResponse(HttpResponse& response);
   void sendResponse(void);
+  void flushWriteBuffer(void);
+  bool pullBodySource(void);
+  size_t takeSendBudget(size_t wanted);
+  void refundSendBudget(size_t unused);
+  void setPacingRate(size_t rate);
+  void finishTransmission(void);
   void cleanup(void);
 };
 
+/// @brief Which connections the admin `connections` report lists
+struct ConnectionFilter {
+  std::shared_ptr<const AccessList> peer;  // addresses, nullptr = all
+  std::string vhost;                       // server label, empty = all
+  std::string state;                       // getStateName(), empty = all
+  std::chrono::milliseconds min_idle{0};
+
+  bool matches(const Connection::Snapshot& snapshot) const;
+  static const char* getStateName(HttpParsingState state);
+};
+
 #endif  // _CONNECTION_HPP
@@ -0,0 +1,108 @@
+/**
+ * @file DirectoryArchive.hpp
+ * @brief Directory tree streamed as tar or zip (`?archive=` of autoindex)
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-12
+ * @version 1.0
+ *
+ * The tree is walked once when the archive is created: the list of entries
+ * (names, sizes, modes) is all that is kept, so the exact Content-Length is
+ * known up front and no temporary file is written. Archive headers are then
+ * generated entry by entry while the connection sends them, file contents
+ * are never held in memory.
+ *
+ * - tar (POSIX ustar, pax records for names and sizes ustar can't hold):
+ *   file contents are handed to the connection as file ranges (sendfile);
+ * - zip (stored, no compression): every entry needs a CRC-32, so file data
+ *   is read in ARCHIVE_READ_CHUNK pieces, checksummed and sent from the
+ *   buffer; the CRC follows the data in a data descriptor and again in the
+ *   central directory. No zip64, the limits below are checked at creation.
+ *
+ * Hidden entries (names starting with a dot, e.g. unfinished uploads),
+ * symlinks and special files are left out, like in the HTML listing.
+ * A file that shrinks while it is sent is padded with zeros, one that grows
+ * is cut at the size seen by the walk, so the archive stays well-formed.
+ */
+
+#ifndef _DIRECTORY_ARCHIVE_HPP
+#define _DIRECTORY_ARCHIVE_HPP
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "BodySource.hpp"
+
+/// @brief Generated bytes are produced in pieces of about this size
+#define ARCHIVE_READ_CHUNK 65536
+/// @brief Largest number of entries (zip without zip64)
+#define ARCHIVE_MAX_ENTRIES 65535
+/// @brief Largest zip archive (32-bit sizes and offsets)
+#define ARCHIVE_ZIP_MAX_SIZE 0xFFFFFFFFULL
+
+class DirectoryArchive : public BodySource {
+ public:
+  enum class Format { TAR, ZIP };
+
+  DirectoryArchive() = delete;
+  DirectoryArchive(const std::string& directory, const std::string& root_name,
+                   Format format);
+  ~DirectoryArchive() override;
+  DirectoryArchive& operator=(const DirectoryArchive& other) = delete;
+  DirectoryArchive(const DirectoryArchive& other) = delete;
+
+  uint64_t size(void) const override;
+  bool next(std::string& buffer, FileRange& range) override;
+  size_t entryCount(void) const;
+
+  static bool parseFormat(std::string_view name, Format& format);
+  static std::string_view contentType(Format format);
+  static std::string_view extension(Format format);
+  static uint32_t crc32(uint32_t crc, const void* data, size_t length);
+
+ private:
+  struct Entry {
+    std::string path;  // on disk
+    std::string name;  // in the archive, directories end with '/'
+    uint64_t size = 0;
+    mode_t mode = 0;
+    time_t mtime = 0;
+    bool directory = false;
+    uint32_t crc = 0;         // zip, known once the data is sent
+    uint64_t offset = 0;      // zip, offset of the local header
+  };
+
+  enum class Phase { HEADER, DATA, ENTRY_END, CENTRAL, END, DONE };
+
+  Format _format;
+  std::vector<Entry> _entries;
+  uint64_t _size = 0;
+  // streaming position
+  Phase _phase = Phase::HEADER;
+  size_t _index = 0;
+  int _fd = -1;
+  uint64_t _data_sent = 0;
+  uint64_t _produced = 0;
+  uint64_t _central_size = 0;
+
+ private:
+  void scan(const std::string& directory, const std::string& root_name);
+  void addEntry(const std::string& path, const std::string& name,
+                const struct stat& info);
+  void openEntry(Entry& entry);
+  void closeEntry(void);
+  void appendData(std::string& buffer, Entry& entry);
+  void append(std::string& buffer, std::string_view bytes);
+
+  std::string tarHeader(const Entry& entry) const;
+  std::string zipLocalHeader(const Entry& entry) const;
+  std::string zipDataDescriptor(const Entry& entry) const;
+  std::string zipCentralHeader(const Entry& entry) const;
+  std::string zipEndRecord(void) const;
+};
+
+#endif  // _DIRECTORY_ARCHIVE_HPP
@@ -25,17 +25,23 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <chrono>
 
+#include "AssetBundle.hpp"
 #include "HttpRequest.hpp"
 #include "HttpResponse.hpp"
 #include "Logger.hpp"
 #include "Config.hpp"
 #include "CgiHandler.hpp"
+#include "RedirectMap.hpp"
+#include "RequestPipeline.hpp"
+#include "VhostQuota.hpp"
 
 class HttpRequest;
 class HttpResponse;
+class AdminHandler;
 
 /**
  * @namespace HttpMethodHandler
@@ -46,9 +52,14 @@ class HttpResponse;
  * - Handle HTTP POST requests (file uploads)
  * - Manage HTTP DELETE requests (file deletion)
  * - Serve static files with appropriate MIME types
+ * - Serve packed sites from asset bundles (`bundle`)
  * - Generate directory listings when auto-index is enabled
+ * - Stream directories as tar/zip archives (`?archive=`, auto-index only)
  * - CGI
  *
+ * The checks and handlers run as phases composed per location, see
+ * RequestPipeline.hpp.
+ *
  * @see Common helper functions in srcs/HttpUtils.cpp
  */
 class HttpMethodHandler {
@@ -60,29 +71,84 @@ class HttpMethodHandler {
 
   HttpResponse processMethod(const HttpRequest& request,
                              const ConfigParser::ServerConfig& config);
+  void setAdminHandler(AdminHandler* admin_handler);
+  bool findSpliceDirectory(const HttpRequest& request,
+                           const ConfigParser::ServerConfig& config,
+                           std::string& directory);
 
  protected:
   // main functions
-  HttpResponse handleGetMethod(const std::string& path, const std::string& uri,
+  HttpResponse handleGetMethod(const std::string& path,
+                               const HttpRequest& request,
                                const ConfigParser::LocationConfig& location);
   HttpResponse handlePostMethod(const std::string& path,
-                                const HttpRequest& request);
+                                const HttpRequest& request,
+                                const ConfigParser::LocationConfig& location);
   HttpResponse handleDeleteMethod(const std::string& path);
+  HttpResponse handleResumableUpload(
+      const std::string& path, const HttpRequest& request,
+      const ConfigParser::LocationConfig& location);
+
+ private:
+  AdminHandler* _admin_handler = nullptr;
+
+ private:
+  friend class RequestPipeline;
+
+  // request phases
+  static PhaseResult redirectPhase(RequestContext& context);
+  static PhaseResult clientAccessPhase(RequestContext& context);
+  static PhaseResult bodySizePhase(RequestContext& context);
+  static PhaseResult allowedMethodPhase(RequestContext& context);
+  static PhaseResult adminPhase(RequestContext& context);
+  static PhaseResult bundlePhase(RequestContext& context);
+  static PhaseResult filePathPhase(RequestContext& context);
+  static PhaseResult cgiPhase(RequestContext& context);
+  static PhaseResult resumableUploadPhase(RequestContext& context);
+  static PhaseResult methodPhase(RequestContext& context);
+  static PhaseResult rateLimitPhase(RequestContext& context);
 
  private:
   // helper functions
-  HttpResponse serveStaticFile(const std::string& path);
+  HttpResponse redirectTo(const std::string& url, int code);
+  bool findServerRedirect(const HttpRequest& request,
+                          const ConfigParser::ServerConfig& config,
+                          std::string& url, int& code);
+  static std::shared_ptr<const RequestPipeline> getPipeline(
+      const ConfigParser::LocationConfig& location);
+  HttpResponse serveStaticFile(const std::string& path,
+                               const HttpRequest& request,
+                               const ConfigParser::LocationConfig& location);
+  bool findPrecompressed(const std::string& path, const HttpRequest& request,
+                         const ConfigParser::LocationConfig& location,
+                         std::string& variant, std::string_view& coding);
   HttpResponse serveDirectoryContent(const std::string& path,
                                      const std::string& uri);
+  bool findBundleAsset(const ConfigParser::LocationConfig& location,
+                       const std::string& uri, AssetBundle::Asset& asset);
+  HttpResponse serveBundleAsset(const HttpRequest& request,
+                                const ConfigParser::LocationConfig& location,
+                                const AssetBundle::Asset& asset);
+  HttpResponse serveDirectoryArchive(const std::string& path,
+                                     const std::string& uri,
+                                     std::string_view format_name);
   bool saveUploadedFile(const std::string& upload_dir,
                         const std::string& file_name,
-                        const std::string& content, std::string& error_msg);
+                        std::string_view content,
+                        ConfigParser::UploadDurability durability,
+                        std::string& error_msg);
   bool isAllowedFileType(const std::string& extension);
+  bool parseUnsigned(const std::string& value, uint64_t& result);
   std::string generateFileName(const std::string& extension);
 
-  HttpResponse handleMultipartFileUpload(const HttpRequest& request,
-                                         const std::string& path,
-                                         const std::string& content_type);
+  HttpResponse storeUploadByDigest(
+      const HttpRequest& request, const std::string& path,
+      const std::string& extension,
+      const ConfigParser::LocationConfig& location);
+  HttpResponse handleMultipartFileUpload(
+      const HttpRequest& request, const std::string& path,
+      const std::string& content_type,
+      const ConfigParser::LocationConfig& location);
   std::string getMultipartBoundary(const std::string& content_type);
   std::string getMultipartFileName(const std::string& body, size_t start,
                                    size_t end);
@@ -18,12 +18,18 @@
 #define _HTTP_REQUEST_HPP
 
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <string_view>
 
+#include "AccessList.hpp"
+#include "BufferChain.hpp"
 #include "HttpUtils.hpp"
+#include "SplicedBody.hpp"
 
 // Common methods https://datatracker.ietf.org/doc/html/rfc7231#section-4
 // Registry: https://www.iana.org/assignments/http-methods/http-methods.xhtml
@@ -32,6 +38,7 @@ enum class HttpMethod {
   HEAD,
   POST,
   PUT,
+  PATCH,
   DELETE,
   CONNECT,
   OPTIONS,
@@ -58,6 +65,8 @@ class HttpRequest {
 
   void setMethod(const std::string& method);
   void setRequestTarget(const std::string& request_target);
+  void setNormalizedTarget(std::string&& path, size_t query_offset,
+                           uint64_t path_hash);
   void setHttpVersion(const std::string& http_version);
   void insertHeader(const std::string& field_name, std::string& value);
   void setBody(const std::string& body);
@@ -67,44 +76,62 @@ class HttpRequest {
   void setParsingState(HttpParsingState state);
   void setChunkedStatus(bool is_chanked);
   void setExpectedChunkLength(size_t expected_length);
-  void appendBuffer(std::string&& data);
+  void appendBuffer(std::string_view data);
   void commitParsedBytes(size_t bytes);
   void appendBody(std::string&& data);
+  void moveToBody(size_t bytes);
+  void setClientAddress(const ClientAddress& client);
+  void setHeaderLimits(size_t line_max, size_t total_max);
+  void setSplicedBody(std::shared_ptr<SplicedBody> body);
 
   const std::string& getMethod(void) const;
   const HttpMethod& getMethodCode(void) const;
   const std::string& getRequestTarget(void) const;
+  const std::string& getPath(void) const;
+  std::string_view getQuery(void) const;
+  bool hasQuery(void) const;
+  uint64_t getPathHash(void) const;
   const std::string& getHttpVersion(void) const;
   const std::string& getHeader(const std::string& field_name) const;
   const std::string& getBody(void) const;
   size_t getBodyLength(void) const;
-  std::string_view getUnparsedBuffer(void) const;
+  BufferChain& getUnparsedBuffer(void);
+  const BufferChain& getUnparsedBuffer(void) const;
   HttpParsingState getParsingState(void) const;
   bool getChunkedStatus(void) const;
   size_t getExpectedChunkLength(void) const;
   HttpUtils::HttpStatusCode getStatusCode(void) const;
   const std::string& getErrorMessage(void) const;
   std::string getRequestLine(void) const;
+  const ClientAddress& getClientAddress(void) const;
+  size_t getHeaderLineLimit(void) const;
+  size_t getHeaderTotalLimit(void) const;
+  SplicedBody* getSplicedBody(void) const;
 
   bool hasHeader(const std::string& field_name) const;
   bool isErrorStatusCode(void) const;
 
-  void eraseParsedBuffer(size_t bytes = 0);
   void reset(void);
+  void releaseMemory(void);
+  size_t getMemoryUsage(void) const;
 
  private:
-  std::string _buffer;
-  size_t _parsed_buffer_offset;
+  BufferChain _buffer;  // received, not yet parsed bytes
   // Request Line https://datatracker.ietf.org/doc/html/rfc7230#autoid-17
   HttpMethod _method_code;
   std::string _method_raw;
   std::string _request_target;
   std::string _http_version;
+  // Normalized target, filled by the parser from _request_target
+  std::string _path;        // percent-decoded, without dot segments
+  size_t _query_offset;     // index of '?' in _request_target or npos
+  uint64_t _path_hash;      // HttpUtils::hashPath(_path)
   // Header Fields https://datatracker.ietf.org/doc/html/rfc7230#autoid-19
   std::map<std::string, std::string> _headers;
   // Message Body https://datatracker.ietf.org/doc/html/rfc7230#autoid-26
   std::string _body;
   size_t _body_length;
+  std::shared_ptr<SplicedBody> _spliced_body;  // body in a file instead
   // Parsing managment
   HttpParsingState _state;
   bool _is_chanked;
@@ -112,9 +139,15 @@ class HttpRequest {
   bool _is_error;
   HttpUtils::HttpStatusCode _status_code;
   std::string _err_message;
+  // peer of the connection, kept by reset() for the next request
+  ClientAddress _client;
+  // line and header section limits, kept by reset() for the next request
+  size_t _header_line_max;
+  size_t _header_total_max;
 
  protected:
-  static constexpr size_t PARSED_OFFSET_THRESHOLD = 4096;
+  // reset() keeps body capacity up to this, larger bodies are freed
+  static constexpr size_t KEEP_BODY_CAPACITY = 16384;
 };
 
 #endif  // _HTTP_REQUEST_HPP
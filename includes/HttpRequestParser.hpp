@@ -66,6 +66,7 @@ namespace HttpRequestParser {
 enum class Status { WAIT_FOR_DATA, CONTINUE, DONE, ERROR };
 
 Status parseRequest(std::string&& data, HttpRequest& request);
+Status parseRequest(HttpRequest& request);
 
 Status parseRequestLine(HttpRequest& request);
 Status parseRequestHeaders(HttpRequest& request);
@@ -76,6 +77,7 @@ Status parseRequestChunkedBodyData(HttpRequest& request);
 Status parseRequestChunkedBodyTrailer(HttpRequest& request);
 
 bool validateRequestTarget(const std::string& terget, HttpRequest& request);
+bool normalizeRequestTarget(const std::string& target, HttpRequest& request);
 bool validateHttpVersion(const std::string& version, HttpRequest& request);
 bool validateHeaderField(const std::string& field);
 bool validateAndTrimHeaderValue(std::string& value);
@@ -23,9 +23,12 @@
 #include <ctime>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <string_view>
 
+#include "BodySource.hpp"
 #include "HttpRequest.hpp"
 #include "HttpUtils.hpp"
 
@@ -37,14 +40,22 @@ class HttpResponse {
   ~HttpResponse();
   HttpResponse& operator=(const HttpResponse& other);
   HttpResponse(const HttpResponse& other);
+  HttpResponse& operator=(HttpResponse&& other) noexcept = default;
+  HttpResponse(HttpResponse&& other) noexcept = default;
 
   void setStatusCode(const HttpUtils::HttpStatusCode& code);
   void setBody(const std::string& body,
-               const std::string& content_type = "text/plain");
-  void setContentType(const std::string& content_type);
+               std::string_view content_type = "text/plain");
+  void setContentType(std::string_view content_type);
+  void setBodySource(std::shared_ptr<BodySource> source,
+                     std::string_view content_type);
   void setConnectionHeader(const std::string& request_connection,
                            const std::string& request_http_version);
   void insertHeader(const std::string& field_name, const std::string& value);
+  void appendRawHeaders(std::string_view header_lines);
+
+  void setRateLimit(size_t limit_rate, size_t limit_rate_after,
+                    bool kernel_pacing);
 
   void setErrorPageBody(const ConfigParser::ServerConfig& server_config);
   void setErrorResponse(const HttpUtils::HttpStatusCode& code,
@@ -54,18 +65,30 @@ class HttpResponse {
   bool isKeepAliveConnection(void) const;
 
   const std::string& getBody(void) const;
+  std::shared_ptr<BodySource> getBodySource(void) const;
   HttpUtils::HttpStatusCode getStatusCode(void) const;
   std::string getStatusLine(void) const;
+  size_t getLimitRate(void) const;
+  size_t getLimitRateAfter(void) const;
+  bool isKernelPacing(void) const;
 
   std::string convertToString(void);
 
  private:
   HttpUtils::HttpStatusCode _status_code;
   std::map<std::string, std::string> _headers;
+  // "Name: value\r\n" lines rendered at config load (CachePolicy)
+  std::string _raw_headers;
   std::string _body;
   std::string _content_type;
+  // body produced while sending (streamed archives), replaces _body
+  std::shared_ptr<BodySource> _body_source;
   bool _is_error_response;
   bool _is_keep_alive_connection;
+  // transmission hints for the connection (bytes per second, 0 = off)
+  size_t _limit_rate;
+  size_t _limit_rate_after;
+  bool _kernel_pacing;
 
  private:
   std::string whatReasonPhrase(const HttpUtils::HttpStatusCode& code) const;
@@ -15,12 +15,15 @@
 #define _HTTP_UTILS_HPP
 
 #include <algorithm>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 #include "Config.hpp"
+#include "MimeTypes.hpp"
 
 #define CRLF_LENGTH 2
 
@@ -55,6 +58,7 @@ enum class HttpStatusCode {
   NOT_MODIFIED = 304,
   USE_PROXY = 305,
   TEMPORARY_REDIRECT = 307,
+  PERMANENT_REDIRECT = 308,
   // Client Error 4xx
   BAD_REQUEST = 400,
   UNAUTHORIZED = 401,
@@ -75,13 +79,15 @@ enum class HttpStatusCode {
   // https://developer.mozilla.org/en-US/docs/Web/HTTP/Reference/Status/418
   I_AM_TEAPOD = 418,
   TOO_MANY_REQUESTS = 429,
+  REQUEST_HEADER_FIELDS_TOO_LARGE = 431,
   // Server Error 5xx
   INTERNAL_SERVER_ERROR = 500,
   NOT_IMPLEMENTED = 501,
   BAD_GATEWAY = 502,
   SERVICE_UNAVAILABLE = 503,
   GATEWAY_TIMEOUT = 504,
-  HTTP_VERSION_NOT_SUPPORTED = 505
+  HTTP_VERSION_NOT_SUPPORTED = 505,
+  INSUFFICIENT_STORAGE = 507
 };
 
 /**
@@ -95,10 +101,14 @@ enum class HttpStatusCode {
 std::string toLowerCase(const std::string& str);
 
 const ConfigParser::LocationConfig* getLocation(
-    const std::string& request_uri, const ConfigParser::ServerConfig& config);
+    std::string_view path, const ConfigParser::ServerConfig& config);
 
 const std::string getFilePath(const ConfigParser::LocationConfig& location,
-                              const std::string& request_uri);
+                              std::string_view path);
+
+uint64_t hashPath(std::string_view path);
+
+size_t heapCapacity(const std::string& str);
 
 int getFileContent(const std::string& path, std::string& body);
 
@@ -108,9 +118,20 @@ bool isFilePathSecure(const std::string& path, const std::string& root,
 bool isMethodAllowed(const ConfigParser::LocationConfig& location,
                      const std::string& method);
 
-const std::string getMIME(const std::string& path);
+std::string_view getMIME(std::string_view path,
+                         const MimeTypes::MimeTable* types = nullptr);
 
 const std::string getExtension(const std::string& content_type);
+
+std::string_view getQueryParameter(std::string_view query,
+                                   std::string_view name);
+
+bool isCompressibleType(std::string_view content_type);
+
+bool acceptsEncoding(std::string_view accept_encoding,
+                     std::string_view coding);
+
+bool matchesEntityTag(std::string_view if_none_match, std::string_view etag);
 }  // namespace HttpUtils
 
 #endif  // _HTTP_UTILS_HPP
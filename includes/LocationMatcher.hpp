@@ -0,0 +1,53 @@
+/**
+ * @file LocationMatcher.hpp
+ * @brief Location lookup with nginx modifiers (`=`, `^~`, `~`, `~*`)
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-07
+ * @version 1.0
+ *
+ * Built once per server block after parsing. Lookup order is the one of
+ * nginx: an exact (`=`) location is found with one hash probe; otherwise
+ * the longest prefix location is remembered and used right away if it has
+ * `^~`; otherwise the regex locations are tried (all of them compiled into
+ * one DFA, the first one in config order wins) and the remembered prefix
+ * location is the fallback.
+ */
+
+#ifndef _LOCATION_MATCHER_HPP
+#define _LOCATION_MATCHER_HPP
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Config.hpp"
+#include "RegexDfa.hpp"
+
+class LocationMatcher {
+ public:
+  explicit LocationMatcher(
+      const std::vector<ConfigParser::LocationConfig>& locations);
+  ~LocationMatcher() = default;
+  LocationMatcher& operator=(const LocationMatcher& other) = delete;
+  LocationMatcher(const LocationMatcher& other) = delete;
+
+  int find(std::string_view path) const;
+  size_t regexStateCount(void) const;
+
+ private:
+  struct Prefix {
+    std::string path;
+    size_t index;
+    bool preferred;  // `^~`: skip the regex locations
+  };
+
+  // exact keys are views into _exact_paths (reserved, never reallocated)
+  std::vector<std::string> _exact_paths;
+  std::unordered_map<std::string_view, size_t> _exact;
+  std::vector<Prefix> _prefixes;  // longest first
+  RegexDfa _regex;
+  std::vector<size_t> _regex_locations;  // pattern index -> location index
+};
+
+#endif  // _LOCATION_MATCHER_HPP
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <fstream>
 #include <mutex> // Required for thread safety
@@ -25,6 +26,8 @@ public:
 
     static void init(const std::string& log_file_path);
     static void shutdown();
+    static void disable();
+    static bool isEnabled();
     static void log(const std::string& message, LogLevel level);
     
     // Convenience methods
@@ -35,4 +38,5 @@ public:
 private:
     static std::ofstream    _log_file;
     static std::mutex       _log_mutex; // Mutex for thread safety
+    static std::atomic<bool> _enabled;  // false: messages go nowhere
 };
\ No newline at end of file
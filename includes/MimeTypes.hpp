@@ -0,0 +1,230 @@
+/**
+ * @file MimeTypes.hpp
+ * @brief Perfect hash tables mapping file extensions to MIME types
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-05
+ * @version 1.0
+ *
+ * Both the built-in table and tables compiled from `types {}` blocks use
+ * the same "hash and displace" layout: the extension picks a bucket, the
+ * bucket stores the seed that sends every one of its extensions to a
+ * distinct slot. A lookup is two hashes and one case-insensitive compare,
+ * it never allocates.
+ *
+ * The built-in table is compiled by the compiler (see MimeTypes.cpp), the
+ * configured ones when the config file is loaded.
+ */
+
+#ifndef _MIME_TYPES_HPP
+#define _MIME_TYPES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/// @brief Give up on a bucket after this many seeds (table is grown then)
+#define MIME_TYPES_MAX_DISPLACEMENT 65536
+
+namespace MimeTypes {
+
+constexpr std::string_view DEFAULT_TYPE = "application/octet-stream";
+
+struct Entry {
+  std::string_view extension;
+  std::string_view type;
+};
+
+constexpr char toLower(char c) {
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+constexpr bool equalsIgnoreCase(std::string_view lhs, std::string_view rhs) {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < lhs.size(); i++) {
+    if (toLower(lhs[i]) != toLower(rhs[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Case-insensitive FNV-1a with a seed and a final mix
+ * @note The final mix spreads all input bits into the low bits used as
+ *       slot index
+ */
+constexpr uint32_t hash(std::string_view key, uint32_t seed) {
+  uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+  for (char c : key) {
+    h ^= static_cast<unsigned char>(toLower(c));
+    h *= 16777619u;
+  }
+  h ^= h >> 15;
+  h *= 0x2c1b3c6du;
+  h ^= h >> 12;
+  return h;
+}
+
+/// @brief Amount of slots for count entries (power of two, load <= 0.5)
+constexpr size_t slotCount(size_t count) {
+  size_t slots = 8;
+  while (slots < count * 2) {
+    slots *= 2;
+  }
+  return slots;
+}
+
+/// @brief Amount of buckets for count entries (two per bucket on average)
+constexpr size_t bucketCount(size_t count) {
+  return (count < 2) ? 1 : (count + 1) / 2;
+}
+
+constexpr size_t bucketOf(std::string_view extension, size_t buckets) {
+  return hash(extension, 0) % buckets;
+}
+
+/**
+ * @brief Finds a seed that puts every extension of the bucket in a free slot
+ * @return false if no seed up to MIME_TYPES_MAX_DISPLACEMENT fits
+ */
+constexpr bool placeBucket(const Entry* entries, size_t count, size_t bucket,
+                           uint32_t* displacement, size_t buckets,
+                           uint32_t* slots, size_t slot_count) {
+  for (uint32_t seed = 1; seed < MIME_TYPES_MAX_DISPLACEMENT; seed++) {
+    size_t failed = count;
+    for (size_t i = 0; i < count; i++) {
+      if (bucketOf(entries[i].extension, buckets) != bucket) {
+        continue;
+      }
+      uint32_t& slot =
+          slots[hash(entries[i].extension, seed) & (slot_count - 1)];
+      if (slot != 0) {
+        failed = i;
+        break;
+      }
+      slot = static_cast<uint32_t>(i + 1);
+    }
+    if (failed == count) {
+      displacement[bucket] = seed;
+      return true;
+    }
+    // take back the slots claimed with this seed
+    for (size_t i = 0; i < failed; i++) {
+      if (bucketOf(entries[i].extension, buckets) == bucket) {
+        slots[hash(entries[i].extension, seed) & (slot_count - 1)] = 0;
+      }
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Builds perfect hash of entries, largest buckets are placed first
+ *
+ * While building, displacement holds bucket sizes (marked with the high
+ * bit), a placed bucket gets its seed instead.
+ *
+ * @param entries Extensions and types, extensions must be unique
+ * @param count Amount of entries
+ * @param displacement [out] Seed per bucket (0 = empty bucket)
+ * @param buckets Amount of buckets, see bucketCount()
+ * @param slots [out] Entry index + 1 per slot (0 = empty slot)
+ * @param slot_count Amount of slots, power of two, see slotCount()
+ * @return true on success
+ */
+constexpr bool buildPerfectHash(const Entry* entries, size_t count,
+                                uint32_t* displacement, size_t buckets,
+                                uint32_t* slots, size_t slot_count) {
+  constexpr uint32_t unplaced = 0x80000000u;
+  for (size_t i = 0; i < slot_count; i++) {
+    slots[i] = 0;
+  }
+  for (size_t b = 0; b < buckets; b++) {
+    displacement[b] = unplaced;
+  }
+  uint32_t largest = 0;
+  for (size_t i = 0; i < count; i++) {
+    uint32_t& size = displacement[bucketOf(entries[i].extension, buckets)];
+    size += 1;
+    largest = (size - unplaced > largest) ? size - unplaced : largest;
+  }
+
+  for (uint32_t size = largest; size > 0; size--) {
+    for (size_t b = 0; b < buckets; b++) {
+      if (displacement[b] == (unplaced | size) &&
+          !placeBucket(entries, count, b, displacement, buckets, slots,
+                       slot_count)) {
+        return false;
+      }
+    }
+  }
+  for (size_t b = 0; b < buckets; b++) {
+    if (displacement[b] == unplaced) {
+      displacement[b] = 0;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Looks up extension in a table built by buildPerfectHash()
+ * @return MIME type or empty view if the extension is unknown
+ */
+constexpr std::string_view lookup(const Entry* entries,
+                                  const uint32_t* displacement, size_t buckets,
+                                  const uint32_t* slots, size_t slot_count,
+                                  std::string_view extension) {
+  if (buckets == 0 || extension.empty()) {
+    return std::string_view();
+  }
+  uint32_t seed = displacement[bucketOf(extension, buckets)];
+  if (seed == 0) {
+    return std::string_view();
+  }
+  uint32_t index = slots[hash(extension, seed) & (slot_count - 1)];
+  if (index == 0 ||
+      !equalsIgnoreCase(entries[index - 1].extension, extension)) {
+    return std::string_view();
+  }
+  return entries[index - 1].type;
+}
+
+std::string_view findBuiltin(std::string_view extension);
+
+/**
+ * @brief MIME types of a `types {}` block, compiled when config is loaded
+ *
+ * Filled with add(), then compile() builds the lookup structure. The table
+ * is not copyable because entries point into its own storage, configs
+ * share it through std::shared_ptr<const MimeTable>.
+ */
+class MimeTable {
+ public:
+  MimeTable() = default;
+  ~MimeTable() = default;
+  MimeTable& operator=(const MimeTable& other) = delete;
+  MimeTable(const MimeTable& other) = delete;
+
+  void add(const std::string& type, const std::string& extension);
+  void merge(const MimeTable& other);
+  void compile(void);
+  std::string_view find(std::string_view extension) const;
+  size_t size(void) const;
+
+ private:
+  std::vector<std::string> _extensions;
+  std::vector<std::string> _types;
+  std::unordered_map<std::string, size_t> _index;  // lowercase extension
+  std::vector<Entry> _entries;
+  std::vector<uint32_t> _displacement;
+  std::vector<uint32_t> _slots;
+};
+
+}  // namespace MimeTypes
+
+#endif  // _MIME_TYPES_HPP
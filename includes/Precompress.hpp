@@ -0,0 +1,57 @@
+/**
+ * @file Precompress.hpp
+ * @brief Compressed variants of static files (`webserv-precompress`)
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-14
+ * @version 1.0
+ *
+ * `make precompress` builds the `webserv-precompress` tool, which walks a
+ * document root with a pool of threads and writes `<file>.gz` (and `.br`,
+ * `.zst` if built with brotli/zstd) next to every file of a compressible
+ * type. Locations with `gzip_static on;` (`brotli_static`, `zstd_static`)
+ * then send the variant the client accepts instead of compressing anything
+ * per request.
+ *
+ * A variant gets the modification time of its source: it is up to date
+ * while the times match, so re-running the tool only compresses what
+ * changed. A variant that is not smaller than its source is not kept.
+ */
+
+#ifndef _PRECOMPRESS_HPP
+#define _PRECOMPRESS_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// @brief Files smaller than this are not worth a variant
+#define PRECOMPRESS_MIN_SIZE 256
+
+namespace Precompress {
+
+/// @brief Compresses input, returns false on failure
+using Compressor = bool (*)(std::string_view input, std::string& output);
+
+struct Encoding {
+  std::string_view suffix;  // ".gz"
+  Compressor compress;
+};
+
+struct Stats {
+  size_t files = 0;         // compressible files found
+  size_t written = 0;       // variants (re)written
+  size_t up_to_date = 0;    // variants kept as they are
+  size_t not_smaller = 0;   // variants not kept
+  size_t failed = 0;
+  uint64_t bytes_in = 0;    // of the sources of written variants
+  uint64_t bytes_out = 0;   // of written variants
+};
+
+Stats run(const std::string& root, const std::vector<Encoding>& encodings,
+          size_t threads);
+bool isVariant(std::string_view path, const std::vector<Encoding>& encodings);
+
+}  // namespace Precompress
+
+#endif  // _PRECOMPRESS_HPP
@@ -0,0 +1,58 @@
+/**
+ * @file Profiler.hpp
+ * @brief On-demand CPU sampling and heap allocation sampling
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-17
+ * @version 1.0
+ *
+ * CPU profile: start() arms ITIMER_PROF, every PROFILER_HZ-th of a second of
+ * CPU time the SIGPROF handler walks the frame pointers of the interrupted
+ * code into a buffer allocated up front. The handler disarms the timer
+ * itself once the profile time is over, so the event loop never waits for
+ * a profile; foldedStacks() symbolizes the samples when they are asked for,
+ * as folded stacks ("outer;inner count" per line) for flamegraph.pl.
+ *
+ * Heap profile: a server built with `make HEAP_PROFILE=1` links a sampling
+ * operator new (heap_hook.cpp) that calls sampleAllocation(). About one
+ * allocation per PROFILER_HEAP_INTERVAL bytes is recorded with its call
+ * stack in a fixed table of sites, so the hook never allocates itself.
+ *
+ * Idle cost: no timer, no signal and no buffer while no CPU profile runs;
+ * one subtraction per allocation with the heap hook.
+ *
+ * @note Stacks are only as good as the frame pointers: the server is built
+ * with -fno-omit-frame-pointer and linked with -rdynamic (symbol names),
+ * library frames without frame pointers end or skip parts of a stack.
+ */
+
+#ifndef _PROFILER_HPP
+#define _PROFILER_HPP
+
+#include <cstddef>
+#include <string>
+
+/// @brief CPU samples per second of CPU time (off the 100 Hz beat)
+#define PROFILER_HZ 99
+#define PROFILER_MAX_SECONDS 60
+#define PROFILER_MAX_FRAMES 64
+/// @brief Average allocated bytes between two heap samples
+#define PROFILER_HEAP_INTERVAL (512 * 1024)
+#define PROFILER_HEAP_SITES 1024
+#define PROFILER_HEAP_FRAMES 16
+
+namespace Profiler {
+
+bool start(unsigned seconds, std::string& error_msg);
+bool isRunning(void);
+unsigned getRemainingSeconds(void);
+bool hasProfile(void);
+std::string foldedStacks(void);
+
+void installHeapHook(void);
+bool isHeapHookInstalled(void);
+void sampleAllocation(size_t size);
+std::string heapReport(size_t top);
+
+}  // namespace Profiler
+
+#endif  // _PROFILER_HPP
@@ -0,0 +1,68 @@
+/**
+ * @file RedirectMap.hpp
+ * @brief Bulk redirects loaded from `redirect_map` files
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-06
+ * @version 1.0
+ *
+ * Exact paths are kept in a hash table, prefix rules in a trie of path
+ * segments, so a lookup costs one hash probe plus one step per segment no
+ * matter how many redirects are configured. Exact entries win over prefix
+ * rules, the longest prefix wins among prefix rules.
+ */
+
+// Map file format, one redirect per line (`#` starts a comment):
+//
+//   /old-page.html     /new-page.html;
+//   /blog/2019/post    https://blog.example.com/post 302;
+//   /legacy/*          /archive/*;
+//
+// A path ending with "/*" is a prefix rule, a `*` in its target is replaced
+// with the rest of the request path.
+
+#ifndef _REDIRECT_MAP_HPP
+#define _REDIRECT_MAP_HPP
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class RedirectMap {
+ public:
+  struct Target {
+    std::string url;
+    int code;
+  };
+
+  RedirectMap() = default;
+  ~RedirectMap() = default;
+  RedirectMap& operator=(const RedirectMap& other) = delete;
+  RedirectMap(const RedirectMap& other) = delete;
+
+  void load(const std::string& path, int default_code);
+  void addExact(const std::string& from, const std::string& to, int code);
+  void addPrefix(const std::string& prefix, const std::string& to, int code);
+  bool resolve(std::string_view path, std::string& url, int& code) const;
+  size_t size(void) const;
+
+  static bool isRedirectCode(int code);
+
+ private:
+  struct Node {
+    std::unordered_map<std::string_view, size_t> children;
+    int rule = -1;  // index in _prefix_targets
+  };
+
+  // keys of both tables are views into _keys (deque keeps them in place)
+  std::deque<std::string> _keys;
+  std::unordered_map<std::string_view, Target> _exact;
+  std::vector<Node> _trie = std::vector<Node>(1);
+  std::vector<Target> _prefix_targets;
+
+ private:
+  std::string_view storeKey(std::string_view key);
+};
+
+#endif  // _REDIRECT_MAP_HPP
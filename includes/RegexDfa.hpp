@@ -0,0 +1,81 @@
+/**
+ * @file RegexDfa.hpp
+ * @brief Set of regular expressions compiled into one DFA
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-07
+ * @version 1.0
+ *
+ * Every pattern is parsed into a Thompson NFA, the NFAs of all patterns
+ * share one start state and are turned into a single DFA by subset
+ * construction when compile() is called. Matching walks the DFA once over
+ * the input (one table lookup per byte, no backtracking) and reports the
+ * lowest index of the patterns that matched, so "first pattern in config
+ * order wins" costs the same as testing a single pattern.
+ *
+ * Bytes that no pattern tells apart share one byte class, the transition
+ * table has one column per class instead of 256.
+ *
+ * Supported syntax (PCRE subset used by nginx configs): literals, `.`,
+ * `[...]` classes with ranges and negation, `\d \w \s \D \W \S`, escaped
+ * punctuation, `\t \n \r \xHH`, groups `(...)` and `(?:...)`, `|`, and the
+ * quantifiers `* + ? {n} {n,} {n,m}` (lazy forms match the same). `^` and
+ * `$` are supported at the start and the end of a pattern only.
+ * Backreferences, lookarounds and named groups are rejected.
+ */
+
+#ifndef _REGEX_DFA_HPP
+#define _REGEX_DFA_HPP
+
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// @brief Compilation fails if the DFA would get more states than this
+#define REGEX_DFA_MAX_STATES 10000
+/// @brief Largest bound allowed in `{n,m}`
+#define REGEX_MAX_REPEAT 100
+
+class RegexDfa {
+ public:
+  RegexDfa() = default;
+  ~RegexDfa() = default;
+  RegexDfa& operator=(const RegexDfa& other) = default;
+  RegexDfa(const RegexDfa& other) = default;
+
+  void addPattern(const std::string& pattern, bool caseless);
+  void compile(size_t max_states = REGEX_DFA_MAX_STATES);
+  int match(std::string_view input) const;
+  size_t patternCount(void) const;
+  size_t stateCount(void) const;
+
+ private:
+  struct NfaState {
+    int charset = -1;  // index in _charsets, -1 = only epsilon edges
+    int next = -1;     // target of the charset edge
+    std::vector<int> epsilon;
+    int accept = -1;  // pattern index if this state accepts
+  };
+
+  // NFA of all patterns added so far
+  std::vector<std::bitset<256>> _charsets;
+  std::vector<NfaState> _nfa;
+  std::vector<int> _pattern_starts;
+
+  // compiled DFA, state 0 is the dead state
+  uint8_t _classes[256] = {};
+  size_t _class_count = 0;
+  std::vector<int32_t> _transitions;
+  std::vector<int> _accept;
+  int32_t _start = 0;
+
+ private:
+  friend class RegexCompiler;
+  int newState(void);
+  void computeByteClasses(void);
+  void closure(std::vector<int>& states, std::vector<uint32_t>& marks,
+               uint32_t stamp) const;
+};
+
+#endif  // _REGEX_DFA_HPP
@@ -0,0 +1,81 @@
+/**
+ * @file RequestPipeline.hpp
+ * @brief Per-location chain of request phase handlers
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-17
+ * @version 1.0
+ *
+ * A request that matched a location runs through five phases:
+ *
+ * - rewrite: redirects of the location
+ * - access:  checks that can refuse the request (client address, body
+ *            size, methods)
+ * - content: the first handler that answers makes the response
+ * - filter:  changes to responses of the content phase (rate limits)
+ * - log:     runs for every response, once it is final
+ *
+ * The handlers of a location are composed once, when its server block is
+ * parsed, into one flat array of function pointers: a location only gets
+ * the handlers its directives need (no `allow_methods` - no method check,
+ * no `cgi_ext` - no CGI handler, `return` - nothing but the redirect).
+ */
+
+#ifndef _REQUEST_PIPELINE_HPP
+#define _REQUEST_PIPELINE_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Config.hpp"
+
+class HttpMethodHandler;
+class HttpRequest;
+class HttpResponse;
+
+/// @brief Number of values of Phase
+#define PIPELINE_PHASES 5
+
+enum class Phase : uint8_t { REWRITE, ACCESS, CONTENT, FILTER, LOG };
+
+enum class PhaseResult : uint8_t {
+  NEXT,  // go on with the next handler
+  DONE   // the response is made, leave the phase (rewrite/access: to log)
+};
+
+/// @brief State of one request in the pipeline
+struct RequestContext {
+  HttpMethodHandler& handler;
+  const HttpRequest& request;
+  const ConfigParser::ServerConfig& server;
+  const ConfigParser::LocationConfig& location;
+  HttpResponse& response;
+  std::string file_path;  // set in the content phase before file handlers
+};
+
+class RequestPipeline {
+ public:
+  using Handler = PhaseResult (*)(RequestContext& context);
+
+  RequestPipeline() = default;
+  RequestPipeline(const RequestPipeline& other) = default;
+  RequestPipeline& operator=(const RequestPipeline& other) = default;
+  ~RequestPipeline() = default;
+
+  static std::shared_ptr<const RequestPipeline> compose(
+      const ConfigParser::LocationConfig& location);
+
+  void add(Phase phase, Handler handler);
+  void run(RequestContext& context) const;
+  bool admits(RequestContext& context) const;
+  size_t count(Phase phase) const;
+
+ private:
+  std::vector<Handler> _handlers;  // grouped by phase, in phase order
+  // _handlers[_phase_start[p] .. _phase_start[p + 1]) belong to phase p
+  std::array<size_t, PIPELINE_PHASES + 1> _phase_start{};
+};
+
+#endif  // _REQUEST_PIPELINE_HPP
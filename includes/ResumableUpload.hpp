@@ -0,0 +1,80 @@
+/**
+ * @file ResumableUpload.hpp
+ * @brief Resumable uploads (tus 1.0 core protocol with creation)
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-11
+ * @version 1.0
+ *
+ * In a location with `upload_resumable on;` a client uploads a large file
+ * in pieces and continues after a dropped connection instead of starting
+ * over:
+ * - POST with `Upload-Length` creates the upload, the response's Location
+ *   is the upload URL (`<location>/<id>`);
+ * - PATCH with `Upload-Offset` appends the body at that offset;
+ * - HEAD returns the offset the server has, where the client resumes.
+ *
+ * Every upload is two hidden files in the upload directory: the data file
+ * `.resumable-<id>.part`, preallocated to the full length, and the sidecar
+ * `.resumable-<id>.info` with the length and the final file name. The data
+ * is preallocated with FALLOC_FL_KEEP_SIZE, so its size is still the number
+ * of bytes received: the offset survives restarts without any extra
+ * bookkeeping write. The last piece renames the data file to its final name
+ * (atomically, an existing file is never replaced).
+ *
+ * With `upload_durability` every acknowledged piece is synced before the
+ * 204, so the offset a client resumes from is on disk.
+ *
+ * Uploads without progress for RESUMABLE_UPLOAD_EXPIRE_SEC are removed by
+ * sweep(), which the event loop runs every RESUMABLE_SWEEP_INTERVAL_SEC.
+ *
+ * @see https://tus.io/protocols/resumable-upload
+ */
+
+#ifndef _RESUMABLE_UPLOAD_HPP
+#define _RESUMABLE_UPLOAD_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "Config.hpp"
+#include "HttpUtils.hpp"
+
+/// @brief Unfinished uploads are removed after a day without progress
+#define RESUMABLE_UPLOAD_EXPIRE_SEC 86400
+/// @brief How often the event loop looks for expired uploads
+#define RESUMABLE_SWEEP_INTERVAL_SEC 60
+/// @brief Value of the Tus-Resumable header
+#define RESUMABLE_PROTOCOL_VERSION "1.0.0"
+
+namespace ResumableUpload {
+
+/// @brief Progress of one upload
+struct State {
+  uint64_t offset = 0;
+  uint64_t length = 0;
+  std::string file_name;  // final name (the stored name once complete)
+  bool complete = false;
+};
+
+HttpUtils::HttpStatusCode create(const std::string& directory,
+                                 uint64_t length, const std::string& file_name,
+                                 ConfigParser::UploadDurability durability,
+                                 std::string& id, std::string& error_msg);
+HttpUtils::HttpStatusCode getState(const std::string& directory,
+                                   const std::string& id, State& state,
+                                   std::string& error_msg);
+HttpUtils::HttpStatusCode append(const std::string& directory,
+                                 const std::string& id, uint64_t offset,
+                                 std::string_view data,
+                                 ConfigParser::UploadDurability durability,
+                                 State& state, std::string& error_msg);
+size_t sweep(const std::string& directory, std::chrono::seconds max_age);
+
+bool isValidId(std::string_view id);
+std::string getMetadataFileName(const std::string& metadata);
+
+}  // namespace ResumableUpload
+
+#endif  // _RESUMABLE_UPLOAD_HPP
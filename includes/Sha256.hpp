@@ -0,0 +1,55 @@
+/**
+ * @file Sha256.hpp
+ * @brief Incremental SHA-256 with a SHA-NI code path
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-10
+ * @version 1.0
+ *
+ * Data is hashed as it arrives (update() may be called with pieces of any
+ * size), so an upload is hashed in the same pass that writes it to disk.
+ * On x86 CPUs with the SHA extensions the block function runs on the
+ * dedicated instructions (several GB/s), elsewhere on the portable FIPS
+ * 180-4 code. Both paths produce the same digest.
+ */
+
+#ifndef _SHA256_HPP
+#define _SHA256_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+class Sha256 {
+ public:
+  static constexpr size_t DIGEST_SIZE = 32;
+  static constexpr size_t BLOCK_SIZE = 64;
+  using Digest = std::array<uint8_t, DIGEST_SIZE>;
+
+  explicit Sha256(bool use_hardware = true);
+  ~Sha256() = default;
+  Sha256& operator=(const Sha256& other) = default;
+  Sha256(const Sha256& other) = default;
+
+  void update(std::string_view data);
+  Digest finish(void);
+  std::string finishHex(void);
+  bool usesHardware(void) const;
+
+  static bool hasHardwareSupport(void);
+  static std::string toHex(const Digest& digest);
+  static std::string hashHex(std::string_view data);
+
+ private:
+  uint32_t _state[8];
+  uint8_t _block[BLOCK_SIZE];
+  size_t _block_size = 0;
+  uint64_t _length = 0;
+  bool _hardware;
+
+ private:
+  void compress(const uint8_t* data, size_t blocks);
+};
+
+#endif  // _SHA256_HPP
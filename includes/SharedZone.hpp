@@ -0,0 +1,93 @@
+/**
+ * @file SharedZone.hpp
+ * @brief Named shared memory zones with a slab allocator
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-17
+ * @version 1.0
+ *
+ * A zone is a memfd mapped MAP_SHARED, so processes forked after it was
+ * created (workers) see the same memory: counters and tables kept in a
+ * zone are global, and the memory they take doesn't grow with the number
+ * of processes. The memfd shows up as `memfd:webserv:<name>` in
+ * /proc/<pid>/maps.
+ *
+ * Inside the zone everything is addressed by offsets, never by pointers:
+ *
+ * - pages of SHARED_ZONE_PAGE_SIZE bytes, the first ones hold the zone
+ *   header, the page map and the hash table buckets
+ * - slab classes of 16 .. SHARED_ZONE_PAGE_SIZE / 2 bytes, each with its
+ *   own lock and free list, a page is cut into chunks of one class
+ * - larger blocks take a run of whole pages (first fit)
+ * - a hash table of named objects: lookup() finds or creates the object of
+ *   a key, so every process reaches the same counters by name
+ *
+ * Locks are spinlocks on lock-free atomics, which work across processes
+ * sharing the memory. Freed slab chunks stay in their class.
+ */
+
+#ifndef _SHARED_ZONE_HPP
+#define _SHARED_ZONE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+/// @brief Allocation unit of a zone
+#define SHARED_ZONE_PAGE_SIZE 4096
+/// @brief Smallest slab chunk
+#define SHARED_ZONE_MIN_CHUNK 16
+/// @brief Number of slab classes (16 .. 2048 bytes)
+#define SHARED_ZONE_SLAB_CLASSES 8
+/// @brief Buckets of the named object table
+#define SHARED_ZONE_BUCKETS 256
+
+class SharedZone {
+ public:
+  /// @brief Spinlock usable in shared memory (zero-initialized = unlocked)
+  class Lock {
+   public:
+    void lock(void);
+    void unlock(void);
+    bool try_lock(void);
+
+   private:
+    std::atomic<uint32_t> _state{0};
+  };
+  using LockGuard = std::lock_guard<Lock>;
+
+  SharedZone(const std::string& name, size_t size);
+  ~SharedZone();
+  SharedZone& operator=(const SharedZone& other) = delete;
+  SharedZone(const SharedZone& other) = delete;
+
+  void* allocate(size_t size);
+  void deallocate(void* block);
+  void* lookup(std::string_view key, size_t size);
+
+  const std::string& getName(void) const;
+  size_t getPageCount(void) const;
+  size_t getUsedPages(void) const;
+
+ private:
+  struct Header;
+  struct Entry;
+
+  std::string _name;
+  int _fd;
+  char* _base;
+  size_t _size;
+
+ private:
+  Header& header(void) const;
+  uint32_t* pageMap(void) const;
+  uint32_t allocatePages(uint32_t count);
+  void freePages(uint32_t first);
+  uint32_t allocateChunk(size_t slab_class);
+  void* at(uint32_t offset) const;
+  uint32_t offsetOf(const void* block) const;
+};
+
+#endif  // _SHARED_ZONE_HPP
@@ -0,0 +1,45 @@
+/**
+ * @file SocketActivation.hpp
+ * @brief Listening sockets opened by a supervisor (socket activation)
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-16
+ * @version 1.0
+ *
+ * A supervisor (systemd, systemd-socket-activate, a container runtime)
+ * can own the listening sockets and pass them to webserv, which then skips
+ * socket()/bind()/listen() for them:
+ *
+ * - systemd convention: the sockets are fds 3 .. 3 + $LISTEN_FDS - 1 and
+ *   $LISTEN_PID is the pid of webserv
+ * - `./webserv --inherit-fd <fd> [config]`, once per socket
+ *
+ * Every socket is matched to the `listen` directives by its address: the
+ * port of a TCP socket (whatever address it is bound to) or the path of a
+ * unix socket. Connections arriving while webserv starts wait in the
+ * socket's queue, and a restart never closes the socket.
+ */
+
+#ifndef _SOCKET_ACTIVATION_HPP
+#define _SOCKET_ACTIVATION_HPP
+
+#include <string>
+#include <vector>
+
+/// @brief First fd passed by the systemd convention (SD_LISTEN_FDS_START)
+#define LISTEN_FDS_START 3
+
+namespace SocketActivation {
+
+/// @brief Address of an inherited listening socket
+struct Listener {
+  int fd = -1;
+  int port = -1;          // TCP port, -1 for a unix socket
+  std::string unix_path;  // path of a unix socket
+};
+
+std::vector<int> takeEnvironmentFds(void);
+bool describe(int fd, Listener& listener, std::string& error_msg);
+
+}  // namespace SocketActivation
+
+#endif  // _SOCKET_ACTIVATION_HPP
@@ -0,0 +1,65 @@
+/**
+ * @file SplicedBody.hpp
+ * @brief Raw upload body moved from the socket to a file by the kernel
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-17
+ * @version 1.0
+ *
+ * In a location with `upload_splice on;` the body of a raw POST (Content-
+ * Length, not multipart) is not buffered: once the head is parsed, the
+ * bytes that came with it are written to a temporary file in the upload
+ * directory and the rest goes socket -> pipe -> file with splice(). The
+ * body pages move between kernel buffers and are never copied to
+ * userspace. handlePostMethod() then moves the file to its name.
+ *
+ * The temporary file is reserved, written behind and published like any
+ * other upload (see UploadStore.hpp); a body that is never published (the
+ * client went away, a later phase refused the request) is removed.
+ */
+
+#ifndef _SPLICED_BODY_HPP
+#define _SPLICED_BODY_HPP
+
+#include <sys/types.h>
+
+#include <string>
+#include <string_view>
+
+#include "Config.hpp"
+
+/// @brief Pipe capacity asked for (fcntl F_SETPIPE_SZ, best effort)
+#define SPLICED_BODY_PIPE_SIZE (1 << 20)
+
+class SplicedBody {
+ public:
+  SplicedBody();
+  ~SplicedBody();
+  SplicedBody& operator=(const SplicedBody& other) = delete;
+  SplicedBody(const SplicedBody& other) = delete;
+
+  bool open(const std::string& directory, size_t length,
+            std::string& error_msg);
+  bool write(std::string_view data, std::string& error_msg);
+  ssize_t receive(int socket_fd, std::string& error_msg);
+  bool publish(const std::string& path,
+               ConfigParser::UploadDurability durability,
+               std::string& error_msg);
+
+  bool isComplete(void) const;
+  size_t getLength(void) const;
+  size_t getReceived(void) const;
+
+ private:
+  int _file_fd;
+  int _pipe[2];  // read end, write end
+  std::string _temp_path;
+  size_t _length;
+  size_t _received;        // bytes in the file
+  size_t _written_behind;  // bytes handed to UploadStore::writeBehind()
+
+ private:
+  void advance(size_t bytes);
+  void closeFiles(void);
+};
+
+#endif  // _SPLICED_BODY_HPP
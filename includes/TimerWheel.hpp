@@ -0,0 +1,59 @@
+/**
+ * @file TimerWheel.hpp
+ * @brief Hashed timing wheel for connection timers of the event loop
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-04
+ * @version 1.0
+ *
+ * Timers are stored in one of TIMER_WHEEL_SLOTS buckets selected by their
+ * expiration tick (TIMER_WHEEL_TICK_MS resolution), so scheduling is O(1)
+ * and every loop iteration only looks at the buckets of the ticks that
+ * passed since the previous call.
+ *
+ * Timers are identified by file descriptor and can't be cancelled: the owner
+ * is expected to check on expiration that the timer is still relevant
+ * (connection still exists and still waits for that moment).
+ */
+
+#ifndef _TIMER_WHEEL_HPP
+#define _TIMER_WHEEL_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+/// @brief Resolution of the timer wheel in milliseconds
+#define TIMER_WHEEL_TICK_MS 10
+/// @brief Amount of buckets (one full turn is 5.12 seconds)
+#define TIMER_WHEEL_SLOTS 512
+
+class TimerWheel {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  TimerWheel();
+  ~TimerWheel() = default;
+  TimerWheel& operator=(const TimerWheel& other) = delete;
+  TimerWheel(const TimerWheel& other) = delete;
+
+  void schedule(int fd, Clock::time_point when);
+  void collectExpired(Clock::time_point now, std::vector<int>& expired);
+  size_t size(void) const;
+
+ private:
+  struct Timer {
+    int fd;
+    Clock::time_point when;
+  };
+
+  std::vector<std::vector<Timer>> _slots;
+  Clock::time_point _origin;
+  uint64_t _current_tick;
+  size_t _size;
+
+ private:
+  uint64_t toTick(Clock::time_point time) const;
+};
+
+#endif  // _TIMER_WHEEL_HPP
@@ -0,0 +1,81 @@
+/**
+ * @file UploadStore.hpp
+ * @brief Writing uploaded files to disk, by name or by content digest
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-10
+ * @version 1.0
+ *
+ * Every upload is written to a temporary file in the upload directory and
+ * moved to its name only when complete, so a reader never sees a partial
+ * file and an existing file is never overwritten (the move fails instead,
+ * no window between an existence check and the write).
+ *
+ * Write path:
+ * - the full size is reserved with fallocate() (the length is known), so
+ *   the file isn't fragmented and a full disk fails before writing;
+ * - data goes out in UPLOAD_WRITE_CHUNK pwrite()s;
+ * - for large files writeback of every chunk is started at once and the
+ *   previous chunk is waited for and dropped from the page cache
+ *   (sync_file_range + POSIX_FADV_DONTNEED). Dirty pages stay bounded to
+ *   two chunks instead of piling up into a writeback storm that stalls
+ *   reads of the same disk;
+ * - `upload_durability` decides what is synced before the move: nothing,
+ *   fdatasync(), or fsync() plus fsync() of the directory after the move.
+ *
+ * Bodies spliced from the socket (SplicedBody.hpp) go through the same
+ * steps: temporary file, reserved size, write-behind, publishFile().
+ *
+ * Locations with `upload_store digest;` keep uploads content-addressed:
+ * the body is hashed (SHA-256) in the same pass that writes the temporary
+ * file, which is then hard linked to `<digest>.<ext>`. If that name
+ * exists, the same content is already stored: link() fails with EEXIST
+ * and the temporary file is dropped, so re-uploading an artifact costs no
+ * disk space and the client still gets its digest back.
+ */
+
+#ifndef _UPLOAD_STORE_HPP
+#define _UPLOAD_STORE_HPP
+
+#include <string>
+#include <string_view>
+
+#include "Config.hpp"
+
+/// @brief Uploads are written (and hashed) in pieces of this size
+#define UPLOAD_WRITE_CHUNK (1 << 20)
+/// @brief Files from this size on are written with bounded dirty pages
+#define UPLOAD_WRITE_BEHIND_MIN (4 * UPLOAD_WRITE_CHUNK)
+
+namespace UploadStore {
+
+using Durability = ConfigParser::UploadDurability;
+
+/// @brief Result of storeByDigest()
+struct StoredObject {
+  std::string digest;     // hex SHA-256 of the content
+  std::string file_name;  // digest plus extension, relative to the directory
+  bool created = false;   // false if the same content was stored before
+};
+
+bool writeNewFile(const std::string& path, std::string_view content,
+                  std::string& error_msg,
+                  Durability durability = Durability::NONE);
+bool storeByDigest(const std::string& directory, const std::string& extension,
+                   std::string_view content, StoredObject& object,
+                   std::string& error_msg,
+                   Durability durability = Durability::NONE);
+bool publishFile(const std::string& temp_path, const std::string& path,
+                 std::string& error_msg,
+                 Durability durability = Durability::NONE);
+int createTempFile(const std::string& directory, std::string& path,
+                   std::string& error_msg);
+bool reserveSpace(int fd, size_t size, std::string& error_msg);
+void writeBehind(int fd, size_t offset, size_t length);
+bool syncFile(int fd, Durability durability, std::string& error_msg);
+bool syncDirectory(const std::string& directory, Durability durability,
+                   std::string& error_msg);
+std::string joinPath(const std::string& directory, const std::string& name);
+
+}  // namespace UploadStore
+
+#endif  // _UPLOAD_STORE_HPP
@@ -0,0 +1,72 @@
+/**
+ * @file VhostQuota.hpp
+ * @brief Per virtual host resource quotas and live usage counters
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-02
+ * @version 1.0
+ *
+ * Every server block may limit the resources its requests consume, so one
+ * busy virtual host can't starve the others sharing the same process:
+ * - max_connections:   client connections bound to the vhost
+ * - max_cgi_processes: CGI scripts running at the same time
+ * - max_body_memory:   request body bytes buffered in memory
+ * - max_bandwidth:     response bytes per second (token bucket)
+ *
+ * The counters live in VhostUsage objects Webserv keeps in the shared zone
+ * `vhost_usage`, so the quotas stay global for processes forked later.
+ * Each ServerConfig points to its own counters, so the checks on the request
+ * path are a couple of integer operations under the counters' lock without
+ * any lookup. A ServerConfig without usage pointer (e.g. in unit tests) is
+ * never limited.
+ */
+
+#ifndef _VHOST_QUOTA_HPP
+#define _VHOST_QUOTA_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <string>
+
+#include "Config.hpp"
+#include "SharedZone.hpp"
+
+/// @brief Live resource counters of one virtual host (server block)
+struct VhostUsage {
+  SharedZone::Lock lock;
+  size_t connections = 0;
+  size_t cgi_processes = 0;
+  size_t body_memory = 0;
+  size_t bytes_sent = 0;
+  size_t requests = 0;
+  size_t rejected = 0;
+  double bandwidth_tokens = 0;
+  std::chrono::steady_clock::time_point bandwidth_refill =
+      std::chrono::steady_clock::now();
+};
+
+namespace VhostQuota {
+
+bool acquireConnection(const ConfigParser::ServerConfig& server);
+void releaseConnection(const ConfigParser::ServerConfig& server);
+
+bool acquireCgiProcess(const ConfigParser::ServerConfig& server);
+void releaseCgiProcess(const ConfigParser::ServerConfig& server);
+
+bool chargeBodyMemory(const ConfigParser::ServerConfig& server,
+                      size_t& charged, size_t total);
+void releaseBodyMemory(const ConfigParser::ServerConfig& server,
+                       size_t& charged);
+
+bool hasBandwidth(const ConfigParser::ServerConfig& server);
+void consumeBandwidth(const ConfigParser::ServerConfig& server, size_t bytes);
+
+void countRequest(const ConfigParser::ServerConfig& server);
+void countRejected(const ConfigParser::ServerConfig& server);
+
+std::string getServerLabel(const ConfigParser::ServerConfig& server);
+std::string report(const ConfigParser::Config& config);
+
+}  // namespace VhostQuota
+
+#endif  // _VHOST_QUOTA_HPP
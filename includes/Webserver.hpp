@@ -4,6 +4,8 @@
 #include <netinet/in.h>
 #include <sys/epoll.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include <unistd.h>
 
 #include <algorithm>
@@ -13,16 +15,23 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "AccessList.hpp"
+#include "AdminHandler.hpp"
 #include "Connection.hpp"
 #include "HttpMethodHandler.hpp"
 #include "Logger.hpp"
 #include "Config.hpp"
+#include "SharedZone.hpp"
+#include "TimerWheel.hpp"
+#include "VhostQuota.hpp"
 
 extern volatile std::sig_atomic_t shutdown_requested;
 
 class Connection;
+struct ConnectionFilter;
 
 /// @brief Maximum number of pending connections in listen queue
 #define WEBSERV_MAX_PENDING_CONNECTIONS 20
@@ -39,13 +48,14 @@ class Connection;
 
 #define DEFAULT_LOG_PATH "logs/webserv.log"
 
-/// @brief If wait time is zero, it is non-blocking
-int constexpr NONBLOCKING = 0;
+/// @brief Longest epoll_wait when no timer is pending (timeouts checks)
+int constexpr IDLE_WAIT_MS = 1000;
 
 class Webserv {
  public:
   Webserv() = delete;
-  Webserv(const std::string &config_path);
+  Webserv(const std::string &config_path,
+          const std::vector<int> &inherited_fds = {});
   ~Webserv();
   Webserv &operator=(const Webserv &other) = delete;
   Webserv(const Webserv &other) = delete;
@@ -54,32 +64,56 @@ class Webserv {
   void run(void);
 
   int getPortByServerSocket(int server_socket_fd);
+  int getServerSocketByPort(int port) const;
+  std::string getListenerName(int server_socket_fd) const;
   const ConfigParser::ServerConfig &getServerConfigs(int server_socket_fd,
                                                      const std::string &host);
+  const ConfigParser::Config &getConfig(void) const;
+  std::string reportMemory(void) const;
+  std::string reportConnections(const ConnectionFilter &filter) const;
 
  private:
   ConfigParser::Config _config;
+  // quota counters of the server blocks, shared with forked processes
+  std::unique_ptr<SharedZone> _usage_zone;
   std::unordered_map<int, int> _port_to_servfd;
+  // `listen unix:<path>` sockets, same vhost lookup as ports
+  std::unordered_map<std::string, int> _unix_path_to_servfd;
+  // sockets opened by a supervisor: not bound, listened or unlinked by us
+  std::unordered_set<int> _inherited_fds;
   std::unordered_map<int, std::vector<ConfigParser::ServerConfig *>>
       _servfd_to_config;
   int _epoll_fd;
   std::unordered_map<int, std::unique_ptr<Connection>> _connections;
-  char _buffer[WEBSERV_BUFFER_SIZE];
   HttpMethodHandler _method_handler;
+  AdminHandler _admin_handler;
+  TimerWheel _timers;
+  // first sweep right after start removes uploads expired while stopped
+  std::chrono::steady_clock::time_point _next_upload_sweep;
 
  private:
   // helper functions
+  void adoptInheritedSockets(const std::vector<int> &inherited_fds);
   void openServerSockets(void);
   void bindServerSockets(void);
   void listenServerSockets(void);
   void createEpoll(void);
   void addServerSocketsToEpoll(void);
+  std::vector<int> getServerSockets(void) const;
   void addConnection(int server_socket_fd);
+  bool isClientAllowed(int server_socket_fd,
+                       const ClientAddress &client) const;
   void handleConnection(int client_socket_fd);
+  void handleWritableConnection(int client_socket_fd);
+  void updateConnectionEvents(int client_socket_fd);
+  void resumePausedConnections(void);
+  int getEpollWaitTime(void) const;
   void cleanupTimeOutConnections(void);
+  void sweepResumableUploads(void);
   void handleKeepAliveConnection(int client_socket_fd);
   void setServerSocketOptions(int server_socket_fd);
   void setClientSocketOptions(int client_socket_fd);
+  void attachVhostUsage(void);
 };
 
 #endif  // _WEBSERV_HPP
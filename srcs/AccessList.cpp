@@ -0,0 +1,332 @@
+/**
+ * @file AccessList.cpp
+ * @brief Client address access rules (`allow`, `deny`, `allow_list`,
+ *        `deny_list`)
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-17
+ * @version 1.0
+ */
+
+#include "AccessList.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+// ClientAddress
+
+/**
+ * @brief Takes the address accept() returned
+ * @param address Peer address, IPv4-mapped IPv6 addresses become IPv4
+ * @return Address, family AF_UNSPEC for unix sockets
+ */
+ClientAddress ClientAddress::fromSockaddr(const sockaddr_storage& address) {
+  ClientAddress client;
+  if (address.ss_family == AF_INET) {
+    const sockaddr_in* ipv4 = reinterpret_cast<const sockaddr_in*>(&address);
+    client.family = AF_INET;
+    client.v4 = ntohl(ipv4->sin_addr.s_addr);
+  } else if (address.ss_family == AF_INET6) {
+    const in6_addr& ipv6 =
+        reinterpret_cast<const sockaddr_in6*>(&address)->sin6_addr;
+    if (IN6_IS_ADDR_V4MAPPED(&ipv6)) {
+      client.family = AF_INET;
+      for (int i = 12; i < 16; i++) {
+        client.v4 = (client.v4 << 8) | ipv6.s6_addr[i];
+      }
+    } else {
+      client.family = AF_INET6;
+      for (int i = 0; i < 16; i++) {
+        client.v6 = (client.v6 << 8) | ipv6.s6_addr[i];
+      }
+    }
+  }
+  return client;
+}
+
+/**
+ * @brief Parses an IPv4 or IPv6 address
+ * @param text Address without prefix length
+ * @param address [out] Parsed address
+ * @return false if text is neither
+ */
+bool ClientAddress::parse(const std::string& text, ClientAddress& address) {
+  in_addr ipv4;
+  in6_addr ipv6;
+  address = ClientAddress();
+  if (inet_pton(AF_INET, text.c_str(), &ipv4) == 1) {
+    address.family = AF_INET;
+    address.v4 = ntohl(ipv4.s_addr);
+    return true;
+  }
+  if (inet_pton(AF_INET6, text.c_str(), &ipv6) == 1) {
+    address.family = AF_INET6;
+    for (int i = 0; i < 16; i++) {
+      address.v6 = (address.v6 << 8) | ipv6.s6_addr[i];
+    }
+    return true;
+  }
+  return false;
+}
+
+/// @brief Printable address, "unix" for unix socket clients
+std::string ClientAddress::toString(void) const {
+  char text[INET6_ADDRSTRLEN] = "unix";
+  if (family == AF_INET) {
+    in_addr ipv4;
+    ipv4.s_addr = htonl(v4);
+    inet_ntop(AF_INET, &ipv4, text, sizeof(text));
+  } else if (family == AF_INET6) {
+    in6_addr ipv6;
+    for (int i = 0; i < 16; i++) {
+      ipv6.s6_addr[i] = static_cast<uint8_t>(v6 >> (8 * (15 - i)));
+    }
+    inet_ntop(AF_INET6, &ipv6, text, sizeof(text));
+  }
+  return text;
+}
+
+// AccessList
+
+/**
+ * @brief Adds an `allow` or `deny` rule
+ * @param allow true for `allow`, false for `deny`
+ * @param prefix `all`, an address or a CIDR ("10.0.0.0/8", "2001:db8::/32")
+ * @throws std::invalid_argument if prefix is none of these
+ */
+void AccessList::addRule(bool allow, const std::string& prefix) {
+  uint32_t rule = nextRule(allow);
+  if (prefix == "all") {
+    _v4.insert(0, 0, rule);
+    _v6.insert(0, 0, rule);
+    _all_rule = std::min(_all_rule, rule);
+    return;
+  }
+  addPrefix(prefix, rule);
+}
+
+/**
+ * @brief Adds an `allow_list` or `deny_list` file as one rule
+ * @param allow true for `allow_list`, false for `deny_list`
+ * @param path List file (see the format in AccessList.hpp)
+ * @throws std::runtime_error if the file can't be read or has an invalid line
+ */
+void AccessList::load(bool allow, const std::string& path) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open access list: " + path);
+  }
+
+  uint32_t rule = nextRule(allow);
+  std::string line;
+  size_t line_number = 0;
+  while (std::getline(file, line)) {
+    line_number++;
+    line = line.substr(0, line.find('#'));
+    size_t semicolon = line.find_last_not_of(" \t\r");
+    if (semicolon != std::string::npos && line[semicolon] == ';') {
+      line.erase(semicolon);
+    }
+
+    std::istringstream fields(line);
+    std::string prefix;
+    std::string extra;
+    if (!(fields >> prefix)) {
+      continue;  // empty line or comment
+    }
+    try {
+      if (fields >> extra) {
+        throw std::invalid_argument("expected one prefix per line");
+      }
+      addPrefix(prefix, rule);
+    } catch (const std::invalid_argument& e) {
+      throw std::runtime_error(path + ":" + std::to_string(line_number) +
+                               ": " + e.what());
+    }
+  }
+}
+
+/**
+ * @brief Checks a client against the rules, the first matching rule decides
+ * @param client Peer address (unix socket clients only match `all`)
+ * @return true if the client is allowed or no rule matches it
+ */
+bool AccessList::isAllowed(const ClientAddress& client) const {
+  uint32_t rule = _all_rule;
+  if (client.family == AF_INET) {
+    rule = _v4.find(client.v4);
+  } else if (client.family == AF_INET6) {
+    rule = _v6.find(client.v6);
+  }
+  return rule == NO_RULE || !_deny[rule];
+}
+
+/// @brief Number of prefixes (an `all` rule counts once per family)
+size_t AccessList::size(void) const { return _v4.size() + _v6.size(); }
+
+// private
+
+uint32_t AccessList::nextRule(bool allow) {
+  _deny.push_back(!allow);
+  return static_cast<uint32_t>(_deny.size() - 1);
+}
+
+/**
+ * @brief Parses a CIDR and adds it to the tree of its family
+ * @throws std::invalid_argument on an invalid address or prefix length
+ */
+void AccessList::addPrefix(const std::string& prefix, uint32_t rule) {
+  size_t slash = prefix.find('/');
+  ClientAddress address;
+  if (!ClientAddress::parse(prefix.substr(0, slash), address)) {
+    throw std::invalid_argument("invalid address '" + prefix + "'");
+  }
+  const unsigned bits = (address.family == AF_INET) ? 32 : 128;
+  unsigned length = bits;
+  if (slash != std::string::npos) {
+    std::string digits = prefix.substr(slash + 1);
+    if (digits.empty() || digits.size() > 3 ||
+        digits.find_first_not_of("0123456789") != std::string::npos ||
+        std::stoul(digits) > bits) {
+      throw std::invalid_argument("invalid prefix length '" + prefix + "'");
+    }
+    length = std::stoul(digits);
+  }
+  // bits past the prefix length are ignored, as in nginx
+  if (address.family == AF_INET) {
+    _v4.insert(address.v4, static_cast<uint8_t>(length), rule);
+  } else {
+    _v6.insert(address.v6, static_cast<uint8_t>(length), rule);
+  }
+}
+
+// PrefixTree
+
+static uint8_t leadingZeros(uint32_t value) {
+  return static_cast<uint8_t>(__builtin_clz(value));
+}
+
+static uint8_t leadingZeros(uint128_t value) {
+  uint64_t high = static_cast<uint64_t>(value >> 64);
+  if (high != 0) {
+    return static_cast<uint8_t>(__builtin_clzll(high));
+  }
+  return static_cast<uint8_t>(64 +
+                              __builtin_clzll(static_cast<uint64_t>(value)));
+}
+
+template <typename Key>
+AccessList::PrefixTree<Key>::PrefixTree() : _prefixes(0) {
+  _nodes.push_back({0, {0, 0}, NO_RULE, 0});
+}
+
+/**
+ * @brief Adds a prefix, a prefix added twice keeps its first rule
+ * @param key Address (bits past length are ignored)
+ * @param length Prefix length in bits
+ * @param rule Rule number
+ */
+template <typename Key>
+void AccessList::PrefixTree<Key>::insert(Key key, uint8_t length,
+                                         uint32_t rule) {
+  key &= mask(length);
+  uint32_t index = 0;
+  while (true) {
+    if (_nodes[index].length == length) {  // the node is this prefix
+      if (_nodes[index].rule == NO_RULE) {
+        _prefixes++;
+      }
+      _nodes[index].rule = std::min(_nodes[index].rule, rule);
+      return;
+    }
+    // the node's prefix is a proper prefix of key/length
+    const int side = bit(key, _nodes[index].length);
+    const uint32_t child = _nodes[index].child[side];
+    const uint32_t created = static_cast<uint32_t>(_nodes.size());
+    if (child == 0) {
+      _nodes.push_back({key, {0, 0}, rule, length});
+      _nodes[index].child[side] = created;
+      _prefixes++;
+      return;
+    }
+    const Node& next = _nodes[child];
+    uint8_t common =
+        commonLength(key, next.key, std::min(length, next.length));
+    if (common == next.length) {
+      index = child;
+      continue;
+    }
+    if (common == length) {
+      // the new prefix goes between the node and its child
+      Node node = {key, {0, 0}, rule, length};
+      node.child[bit(next.key, length)] = child;
+      _nodes.push_back(node);
+    } else {
+      // branching node where the prefixes part
+      Node branch = {static_cast<Key>(key & mask(common)), {0, 0}, NO_RULE,
+                     common};
+      branch.child[bit(next.key, common)] = child;
+      branch.child[bit(key, common)] = created + 1;
+      _nodes.push_back(branch);
+      _nodes.push_back({key, {0, 0}, rule, length});
+    }
+    _nodes[index].child[side] = created;
+    _prefixes++;
+    return;
+  }
+}
+
+/**
+ * @brief Finds the smallest rule among the prefixes containing key
+ * @return Rule number, NO_RULE if no prefix contains key
+ */
+template <typename Key>
+uint32_t AccessList::PrefixTree<Key>::find(Key key) const {
+  uint32_t rule = NO_RULE;
+  uint32_t index = 0;
+  do {
+    const Node& node = _nodes[index];
+    if (((key ^ node.key) & mask(node.length)) != 0) {
+      break;
+    }
+    rule = std::min(rule, node.rule);
+    if (node.length == BITS) {
+      break;
+    }
+    index = node.child[bit(key, node.length)];
+  } while (index != 0);
+  return rule;
+}
+
+template <typename Key>
+size_t AccessList::PrefixTree<Key>::size(void) const {
+  return _prefixes;
+}
+
+template <typename Key>
+Key AccessList::PrefixTree<Key>::mask(uint8_t length) {
+  return (length == 0) ? 0 : static_cast<Key>(~static_cast<Key>(0)
+                                               << (BITS - length));
+}
+
+template <typename Key>
+int AccessList::PrefixTree<Key>::bit(Key key, uint8_t index) {
+  return static_cast<int>((key >> (BITS - 1 - index)) & 1);
+}
+
+template <typename Key>
+uint8_t AccessList::PrefixTree<Key>::commonLength(Key a, Key b,
+                                                  uint8_t limit) {
+  Key difference = a ^ b;
+  if (difference == 0) {
+    return limit;
+  }
+  return std::min(leadingZeros(difference), limit);
+}
+
+template class AccessList::PrefixTree<uint32_t>;
+template class AccessList::PrefixTree<uint128_t>;
@@ -0,0 +1,197 @@
+/**
+ * @file AdminHandler.cpp
+ * @brief Serves runtime reports of the webserver on admin locations
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-02
+ * @version 1.0
+ */
+
+#include "AdminHandler.hpp"
+
+#include "Connection.hpp"
+#include "Profiler.hpp"
+#include "VhostQuota.hpp"
+#include "Webserver.hpp"
+
+AdminHandler::AdminHandler(const Webserv& webserv) : _webserv(webserv) {}
+
+/**
+ * @brief Routes admin request to the report it asks for
+ * @param request The HTTP request (only GET is accepted)
+ * @param location The admin location that matched the request
+ * @return HttpResponse with plain text report or error
+ */
+HttpResponse AdminHandler::handle(
+    const HttpRequest& request, const ConfigParser::LocationConfig& location) {
+  HttpResponse response;
+
+  if (request.getMethodCode() != HttpMethod::GET) {
+    response.setErrorResponse(
+        HttpUtils::HttpStatusCode::METHOD_NOT_ALLOWED,
+        "Admin endpoint is read-only: " + request.getMethod());
+    return response;
+  }
+
+  std::string report = request.getPath();
+  report = (report.length() > location.path.length())
+               ? report.substr(location.path.length())
+               : "";
+  if (!report.empty() && report[0] == '/') {
+    report.erase(0, 1);
+  }
+
+  if (report.empty()) {
+    return serveIndex();
+  }
+  if (report == "vhosts") {
+    return serveVhosts();
+  }
+  if (report == "memory") {
+    return serveMemory();
+  }
+  if (report == "connections") {
+    return serveConnections(request);
+  }
+  if (report == "profile") {
+    return serveProfile(request, location);
+  }
+  if (report == "heap") {
+    return serveHeap();
+  }
+
+  response.setErrorResponse(HttpUtils::HttpStatusCode::NOT_FOUND,
+                            "Unknown admin report: " + report);
+  return response;
+}
+
+HttpResponse AdminHandler::serveIndex(void) {
+  HttpResponse response;
+  response.setStatusCode(HttpUtils::HttpStatusCode::OK);
+  response.setBody("vhosts\nmemory\nconnections\nprofile\nheap\n");
+  return response;
+}
+
+HttpResponse AdminHandler::serveVhosts(void) {
+  HttpResponse response;
+  response.setStatusCode(HttpUtils::HttpStatusCode::OK);
+  response.setBody(VhostQuota::report(_webserv.getConfig()));
+  return response;
+}
+
+HttpResponse AdminHandler::serveMemory(void) {
+  HttpResponse response;
+  response.setStatusCode(HttpUtils::HttpStatusCode::OK);
+  response.setBody(_webserv.reportMemory());
+  return response;
+}
+
+/**
+ * @brief Connection table, narrowed by the query parameters
+ *
+ * `peer=<address|CIDR>`, `vhost=<name:port>`, `state=<parser state>` and
+ * `idle=<seconds>` (idle at least that long), e.g.
+ * `connections?state=headers&idle=10` lists slow header senders.
+ */
+HttpResponse AdminHandler::serveConnections(const HttpRequest& request) {
+  HttpResponse response;
+  std::string_view query = request.getQuery();
+  ConnectionFilter filter;
+  std::string_view peer = HttpUtils::getQueryParameter(query, "peer");
+  std::string_view idle = HttpUtils::getQueryParameter(query, "idle");
+  try {
+    if (!peer.empty()) {
+      auto addresses = std::make_shared<AccessList>();
+      addresses->addRule(true, std::string(peer));
+      addresses->addRule(false, "all");
+      filter.peer = addresses;
+    }
+    if (!idle.empty()) {
+      if (idle.size() > 9 ||
+          idle.find_first_not_of("0123456789") != std::string_view::npos) {
+        throw std::invalid_argument("invalid idle seconds");
+      }
+      filter.min_idle = std::chrono::seconds(std::stoul(std::string(idle)));
+    }
+  } catch (const std::invalid_argument& e) {
+    response.setErrorResponse(HttpUtils::HttpStatusCode::BAD_REQUEST,
+                              std::string("Connection filter: ") + e.what());
+    return response;
+  }
+  filter.vhost = HttpUtils::getQueryParameter(query, "vhost");
+  filter.state = HttpUtils::getQueryParameter(query, "state");
+
+  response.setStatusCode(HttpUtils::HttpStatusCode::OK);
+  response.setBody(_webserv.reportConnections(filter));
+  return response;
+}
+
+/**
+ * @brief CPU profile: `?seconds=N` starts one, without query the result
+ *
+ * The profile runs in the background (202 with Retry-After until it is
+ * over), requests keep being served meanwhile and are what gets sampled.
+ */
+HttpResponse AdminHandler::serveProfile(
+    const HttpRequest& request, const ConfigParser::LocationConfig& location) {
+  HttpResponse response;
+  std::string_view seconds =
+      HttpUtils::getQueryParameter(request.getQuery(), "seconds");
+  std::string result = location.path;
+  if (!result.empty() && result.back() == '/') {
+    result.pop_back();
+  }
+  result += "/profile";
+  if (!seconds.empty()) {
+    std::string error_msg;
+    unsigned value = 0;
+    if (seconds.find_first_not_of("0123456789") == std::string_view::npos &&
+        seconds.size() <= 3) {
+      value = static_cast<unsigned>(std::stoul(std::string(seconds)));
+    }
+    if (!Profiler::start(value, error_msg)) {
+      response.setErrorResponse(Profiler::isRunning()
+                                    ? HttpUtils::HttpStatusCode::CONFLICT
+                                    : HttpUtils::HttpStatusCode::BAD_REQUEST,
+                                "Profile not started: " + error_msg);
+      return response;
+    }
+    response.setStatusCode(HttpUtils::HttpStatusCode::ACCEPTED);
+    response.insertHeader("Retry-After", std::to_string(value));
+    response.setBody("Sampling " + std::to_string(value) + " s at " +
+                     std::to_string(PROFILER_HZ) + " Hz of CPU time, GET " +
+                     result + " for folded stacks\n");
+    return response;
+  }
+
+  if (Profiler::isRunning()) {
+    unsigned remaining = Profiler::getRemainingSeconds();
+    response.setStatusCode(HttpUtils::HttpStatusCode::ACCEPTED);
+    response.insertHeader("Retry-After", std::to_string(remaining));
+    response.setBody("Profile running, " + std::to_string(remaining) +
+                     " s left\n");
+    return response;
+  }
+  if (!Profiler::hasProfile()) {
+    response.setErrorResponse(HttpUtils::HttpStatusCode::NOT_FOUND,
+                              "No profile, start one with " + result +
+                                  "?seconds=N");
+    return response;
+  }
+  response.setStatusCode(HttpUtils::HttpStatusCode::OK);
+  response.setBody(Profiler::foldedStacks());
+  return response;
+}
+
+/// @brief Allocation sites, needs a server built with `make HEAP_PROFILE=1`
+HttpResponse AdminHandler::serveHeap(void) {
+  HttpResponse response;
+  if (!Profiler::isHeapHookInstalled()) {
+    response.setErrorResponse(
+        HttpUtils::HttpStatusCode::NOT_FOUND,
+        "Heap sampling is not built in (make re HEAP_PROFILE=1)");
+    return response;
+  }
+  response.setStatusCode(HttpUtils::HttpStatusCode::OK);
+  response.setBody(Profiler::heapReport(ADMIN_HEAP_SITES));
+  return response;
+}
@@ -0,0 +1,317 @@
+/**
+ * @file AssetBundle.cpp
+ * @brief Read-only site packed into one file (`bundle` directive)
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-13
+ * @version 1.0
+ */
+
+#include "AssetBundle.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "HttpUtils.hpp"
+#include "Sha256.hpp"
+
+/// @brief ETag is this many hex digits of the content's SHA-256
+#define BUNDLE_ETAG_DIGITS 32
+
+// Body
+
+AssetBundle::Body::Body(std::shared_ptr<const AssetBundle> bundle,
+                        uint64_t offset, uint64_t length)
+    : _bundle(std::move(bundle)), _offset(offset), _length(length) {}
+
+uint64_t AssetBundle::Body::size(void) const { return _length; }
+
+bool AssetBundle::Body::next(std::string& buffer, FileRange& range) {
+  (void)buffer;
+  if (_sent || _length == 0) {
+    return false;
+  }
+  range.fd = _bundle->getFd();
+  range.offset = static_cast<off_t>(_offset);
+  range.length = static_cast<size_t>(_length);
+  _sent = true;
+  return true;
+}
+
+// constructor and destructor
+
+/**
+ * @brief Maps the bundle file and checks its tables
+ * @param path Bundle built by `webserv-bundle`
+ * @throws std::runtime_error if the file can't be mapped or is not a valid
+ *         bundle
+ */
+AssetBundle::AssetBundle(const std::string& path) {
+  _fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  struct stat info;
+  if (_fd == -1 || fstat(_fd, &info) == -1) {
+    std::string reason = strerror(errno);
+    if (_fd != -1) {
+      close(_fd);
+    }
+    throw std::runtime_error("Failed to open bundle " + path + ": " + reason);
+  }
+  _map_size = static_cast<size_t>(info.st_size);
+  if (_map_size < sizeof(Header)) {
+    close(_fd);
+    throw std::runtime_error("Not a bundle: " + path);
+  }
+
+  void* map = mmap(nullptr, _map_size, PROT_READ, MAP_SHARED, _fd, 0);
+  if (map == MAP_FAILED) {
+    std::string reason = strerror(errno);
+    close(_fd);
+    throw std::runtime_error("Failed to map bundle " + path + ": " + reason);
+  }
+  _map = static_cast<const char*>(map);
+  std::memcpy(&_header, _map, sizeof(Header));
+
+  try {
+    validate(path);
+  } catch (...) {
+    munmap(const_cast<char*>(_map), _map_size);
+    close(_fd);
+    throw;
+  }
+  _records = reinterpret_cast<const Record*>(_map + _header.records_offset);
+  _slots = reinterpret_cast<const uint32_t*>(_map + _header.slots_offset);
+  _strings = _map + _header.strings_offset;
+}
+
+AssetBundle::~AssetBundle() {
+  munmap(const_cast<char*>(_map), _map_size);
+  close(_fd);
+}
+
+// public methods
+
+/**
+ * @brief Looks up asset by request path
+ * @param path Normalized request path, e.g. "/css/style.css"
+ * @param asset [out] Asset if found
+ * @return true if the bundle has the path
+ */
+bool AssetBundle::find(std::string_view path, Asset& asset) const {
+  uint64_t hash = HttpUtils::hashPath(path);
+  uint32_t mask = _header.slot_count - 1;
+  for (uint32_t slot = hash & mask; _slots[slot] != 0;
+       slot = (slot + 1) & mask) {
+    const Record& record = _records[_slots[slot] - 1];
+    if (record.hash != hash ||
+        std::string_view(_strings + record.strings, record.path_length) !=
+            path) {
+      continue;
+    }
+    const char* strings = _strings + record.strings;
+    asset.path = std::string_view(strings, record.path_length);
+    strings += record.path_length;
+    asset.content_type = std::string_view(strings, record.type_length);
+    strings += record.type_length;
+    asset.etag = std::string_view(strings, record.etag_length);
+    asset.offset = record.offset;
+    asset.length = record.length;
+    asset.gzip_offset = record.gzip_offset;
+    asset.gzip_length = record.gzip_length;
+    return true;
+  }
+  return false;
+}
+
+/// @brief Bytes of the bundle file (offset and length of an Asset)
+std::string_view AssetBundle::data(uint64_t offset, uint64_t length) const {
+  return std::string_view(_map + offset, length);
+}
+
+int AssetBundle::getFd(void) const { return _fd; }
+
+size_t AssetBundle::size(void) const { return _header.count; }
+
+/**
+ * @brief Packs a document root into a bundle file
+ *
+ * Hidden files and directories (names starting with a dot) and anything
+ * that is not a regular file are left out. The bundle is written next to
+ * output and renamed over it when complete.
+ *
+ * @param root Document root
+ * @param output Bundle file to create
+ * @param gzip Compressor of gzip variants, nullptr for none
+ * @param assets [out] Number of files packed
+ * @param error_msg [out] Error message on failure
+ * @return true on success
+ */
+bool AssetBundle::build(const std::string& root, const std::string& output,
+                        Compressor gzip, size_t& assets,
+                        std::string& error_msg) {
+  namespace fs = std::filesystem;
+
+  std::vector<std::pair<std::string, std::string>> files;  // path, on disk
+  try {
+    const fs::path base(root);
+    for (fs::recursive_directory_iterator it(base), end; it != end; ++it) {
+      if (it->path().filename().string()[0] == '.') {
+        it.disable_recursion_pending();
+        continue;
+      }
+      if (it->symlink_status().type() == fs::file_type::regular) {
+        files.emplace_back("/" + it->path().lexically_relative(base).string(),
+                           it->path().string());
+      }
+    }
+  } catch (const fs::filesystem_error& e) {
+    error_msg = e.what();
+    return false;
+  }
+  std::sort(files.begin(), files.end());
+
+  std::string temp = output + ".tmp";
+  std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    error_msg = "Failed to create " + temp;
+    return false;
+  }
+
+  Header header{};
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  uint64_t position = sizeof(header);
+  std::vector<Record> records;
+  std::string strings;
+  for (const auto& file : files) {
+    std::string content;
+    if (HttpUtils::getFileContent(file.second, content) == -1) {
+      error_msg = content + ": " + file.second;
+      std::remove(temp.c_str());
+      return false;
+    }
+    std::string_view type = HttpUtils::getMIME(file.first);
+    std::string etag =
+        Sha256::hashHex(content).substr(0, BUNDLE_ETAG_DIGITS);
+    if (file.first.size() > UINT16_MAX || type.size() > UINT8_MAX) {
+      error_msg = "Path too long: " + file.second;
+      std::remove(temp.c_str());
+      return false;
+    }
+
+    Record record{};
+    record.hash = HttpUtils::hashPath(file.first);
+    record.offset = position;
+    record.length = content.size();
+    out.write(content.data(), static_cast<std::streamsize>(content.size()));
+    position += content.size();
+
+    std::string compressed;
+    if (gzip != nullptr && HttpUtils::isCompressibleType(type) &&
+        gzip(content, compressed) && compressed.size() < content.size()) {
+      record.gzip_offset = position;
+      record.gzip_length = compressed.size();
+      out.write(compressed.data(),
+                static_cast<std::streamsize>(compressed.size()));
+      position += compressed.size();
+    }
+
+    record.strings = static_cast<uint32_t>(strings.size());
+    record.path_length = static_cast<uint16_t>(file.first.size());
+    record.type_length = static_cast<uint8_t>(type.size());
+    record.etag_length = static_cast<uint8_t>(etag.size());
+    strings.append(file.first).append(type).append(etag);
+    records.push_back(record);
+  }
+
+  // records are read in place, keep them aligned
+  std::string padding((8 - position % 8) % 8, '\0');
+  out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+  position += padding.size();
+
+  uint32_t slot_count = 2;
+  while (slot_count < 2 * records.size()) {
+    slot_count *= 2;
+  }
+  std::vector<uint32_t> slots(slot_count, 0);
+  for (size_t i = 0; i < records.size(); i++) {
+    uint32_t slot = records[i].hash & (slot_count - 1);
+    while (slots[slot] != 0) {
+      slot = (slot + 1) & (slot_count - 1);
+    }
+    slots[slot] = static_cast<uint32_t>(i + 1);
+  }
+
+  std::memcpy(header.magic, BUNDLE_MAGIC, sizeof(header.magic));
+  header.count = static_cast<uint32_t>(records.size());
+  header.slot_count = slot_count;
+  header.records_offset = position;
+  header.slots_offset = position + records.size() * sizeof(Record);
+  header.strings_offset = header.slots_offset + slot_count * sizeof(uint32_t);
+  header.file_size = header.strings_offset + strings.size();
+
+  out.write(reinterpret_cast<const char*>(records.data()),
+            static_cast<std::streamsize>(records.size() * sizeof(Record)));
+  out.write(reinterpret_cast<const char*>(slots.data()),
+            static_cast<std::streamsize>(slots.size() * sizeof(uint32_t)));
+  out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+  out.seekp(0);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.close();
+  if (!out || std::rename(temp.c_str(), output.c_str()) == -1) {
+    error_msg = "Failed to write " + output + ": " + strerror(errno);
+    std::remove(temp.c_str());
+    return false;
+  }
+  assets = records.size();
+  return true;
+}
+
+// private
+
+/**
+ * @brief Checks that every table and range of the bundle is inside the file
+ * @throws std::runtime_error if the bundle is damaged or of another format
+ */
+void AssetBundle::validate(const std::string& path) const {
+  const Header& h = _header;
+  if (std::memcmp(h.magic, BUNDLE_MAGIC, sizeof(h.magic)) != 0) {
+    throw std::runtime_error("Not a bundle: " + path);
+  }
+  bool valid =
+      h.file_size == _map_size && h.slot_count >= 2 &&
+      (h.slot_count & (h.slot_count - 1)) == 0 && h.count < h.slot_count &&
+      h.records_offset % 8 == 0 &&
+      h.slots_offset == h.records_offset + h.count * sizeof(Record) &&
+      h.strings_offset == h.slots_offset + h.slot_count * sizeof(uint32_t) &&
+      h.strings_offset <= _map_size;
+  const Record* records =
+      reinterpret_cast<const Record*>(_map + h.records_offset);
+  const uint32_t* slots =
+      reinterpret_cast<const uint32_t*>(_map + h.slots_offset);
+  uint64_t strings_size = _map_size - h.strings_offset;
+  for (uint32_t i = 0; valid && i < h.count; i++) {
+    const Record& r = records[i];
+    valid = r.offset <= h.records_offset &&
+            r.length <= h.records_offset - r.offset &&
+            r.gzip_offset <= h.records_offset &&
+            r.gzip_length <= h.records_offset - r.gzip_offset &&
+            static_cast<uint64_t>(r.strings) + r.path_length +
+                    r.type_length + r.etag_length <=
+                strings_size;
+  }
+  for (uint32_t i = 0; valid && i < h.slot_count; i++) {
+    valid = slots[i] <= h.count;
+  }
+  if (!valid) {
+    throw std::runtime_error("Damaged bundle: " + path);
+  }
+}
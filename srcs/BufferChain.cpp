@@ -0,0 +1,260 @@
+/**
+ * @file BufferChain.cpp
+ * @brief Receive buffer made of pooled fixed-size blocks
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-08
+ * @version 1.0
+ */
+
+#include "BufferChain.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+// BufferPool
+
+std::vector<BufferPool::SizeClass> BufferPool::_classes;
+size_t BufferPool::_allocated = 0;
+size_t BufferPool::_allocated_bytes = 0;
+
+/// @brief Takes a block from the pool (or the heap if the pool is empty)
+char* BufferPool::acquire(size_t size) {
+  SizeClass& blocks = getSizeClass(size);
+  if (blocks.free.empty()) {
+    _allocated++;
+    _allocated_bytes += size;
+    return new char[size];
+  }
+  char* block = blocks.free.back();
+  blocks.free.pop_back();
+  return block;
+}
+
+/// @brief Gives a block back, blocks over BUFFER_POOL_MAX_FREE are freed
+void BufferPool::release(char* block, size_t size) {
+  SizeClass& blocks = getSizeClass(size);
+  if (blocks.free.size() >= BUFFER_POOL_MAX_FREE) {
+    _allocated--;
+    _allocated_bytes -= size;
+    delete[] block;
+    return;
+  }
+  blocks.free.push_back(block);
+}
+
+/// @brief Blocks owned by the pool and the buffers together
+size_t BufferPool::allocatedBlocks(void) { return _allocated; }
+
+size_t BufferPool::allocatedBytes(void) { return _allocated_bytes; }
+
+size_t BufferPool::freeBlocks(void) {
+  size_t free = 0;
+  for (const SizeClass& blocks : _classes) {
+    free += blocks.free.size();
+  }
+  return free;
+}
+
+/// @brief Free list of a block size (a handful of sizes: a linear search)
+BufferPool::SizeClass& BufferPool::getSizeClass(size_t size) {
+  for (SizeClass& blocks : _classes) {
+    if (blocks.size == size) {
+      return blocks;
+    }
+  }
+  _classes.push_back({size, {}});
+  return _classes.back();
+}
+
+// BufferChain
+
+BufferChain::BufferChain()
+    : _blocks(), _block_size(BUFFER_BLOCK_SIZE), _head(0), _tail(0), _size(0) {}
+
+BufferChain::~BufferChain() { clear(); }
+
+/**
+ * @brief Sets the size of the blocks added from now on
+ * @param size Bytes, blocks already in the chain keep their size
+ */
+void BufferChain::setBlockSize(size_t size) { _block_size = size; }
+
+/**
+ * @brief Returns free space at the end of the chain, adds a block if needed
+ * @param available [out] Bytes that may be written at the returned pointer
+ * @return Pointer to write to, followed by commit() of the written amount
+ */
+char* BufferChain::prepare(size_t& available) {
+  if (_blocks.empty() || _tail == _blocks.back().size) {
+    _blocks.push_back({BufferPool::acquire(_block_size), _block_size});
+    _tail = 0;
+  }
+  available = _blocks.back().size - _tail;
+  return _blocks.back().data + _tail;
+}
+
+/// @brief Marks bytes written after prepare() as data
+void BufferChain::commit(size_t bytes) {
+  _tail += bytes;
+  _size += bytes;
+}
+
+/// @brief Copies data to the end of the chain
+void BufferChain::append(std::string_view data) {
+  while (!data.empty()) {
+    size_t available = 0;
+    char* tail = prepare(available);
+    size_t bytes = std::min(available, data.size());
+    std::memcpy(tail, data.data(), bytes);
+    commit(bytes);
+    data.remove_prefix(bytes);
+  }
+}
+
+/**
+ * @brief Searches needle in the unread data, across block boundaries
+ * @param needle Bytes to search for (non-empty)
+ * @param from Offset to start at, relative to the first unread byte
+ * @return Offset of the first match relative to the first unread byte or
+ *         std::string::npos
+ */
+size_t BufferChain::find(std::string_view needle, size_t from) const {
+  if (needle.empty() || from + needle.size() > _size) {
+    return std::string::npos;
+  }
+  size_t position = 0;  // offset of the current block's first unread byte
+  for (size_t i = 0; i < _blocks.size(); i++) {
+    size_t begin = (i == 0) ? _head : 0;
+    size_t end = (i + 1 == _blocks.size()) ? _tail : _blocks[i].size;
+    size_t length = end - begin;
+    if (position + length <= from) {
+      position += length;
+      continue;
+    }
+    size_t offset = begin + (from > position ? from - position : 0);
+    while (offset < end) {
+      const void* hit = std::memchr(_blocks[i].data + offset, needle[0],
+                                    end - offset);
+      if (hit == nullptr) {
+        break;
+      }
+      offset = static_cast<const char*>(hit) - _blocks[i].data;
+      size_t match = position + offset - begin;
+      if (match + needle.size() > _size) {
+        return std::string::npos;
+      }
+      if (matchesAt(i, offset, needle)) {
+        return match;
+      }
+      offset++;
+    }
+    position += length;
+  }
+  return std::string::npos;
+}
+
+/**
+ * @brief Returns the first bytes of the unread data as one contiguous view
+ * @param bytes Amount of bytes, at most size()
+ * @return View valid until the chain is changed
+ */
+std::string_view BufferChain::peek(size_t bytes) {
+  bytes = std::min(bytes, _size);
+  if (bytes == 0) {
+    return std::string_view();
+  }
+  size_t first =
+      ((_blocks.size() == 1) ? _tail : _blocks.front().size) - _head;
+  if (bytes <= first) {
+    return std::string_view(_blocks.front().data + _head, bytes);
+  }
+  _scratch.clear();
+  _scratch.reserve(bytes);
+  for (size_t i = 0; _scratch.size() < bytes; i++) {
+    size_t begin = (i == 0) ? _head : 0;
+    size_t end = (i + 1 == _blocks.size()) ? _tail : _blocks[i].size;
+    _scratch.append(_blocks[i].data + begin,
+                    std::min(end - begin, bytes - _scratch.size()));
+  }
+  return _scratch;
+}
+
+/// @brief Drops bytes from the front, emptied blocks return to the pool
+void BufferChain::consume(size_t bytes) {
+  bytes = std::min(bytes, _size);
+  _size -= bytes;
+  while (bytes > 0) {
+    size_t end = (_blocks.size() == 1) ? _tail : _blocks.front().size;
+    size_t step = std::min(bytes, end - _head);
+    _head += step;
+    bytes -= step;
+    if (_head == end && _blocks.size() > 1) {
+      BufferPool::release(_blocks.front().data, _blocks.front().size);
+      _blocks.pop_front();
+      _head = 0;
+    }
+  }
+  if (_size == 0) {
+    clear();
+  }
+}
+
+/// @brief Appends the first bytes to out and consumes them
+void BufferChain::moveTo(std::string& out, size_t bytes) {
+  bytes = std::min(bytes, _size);
+  size_t left = bytes;
+  for (size_t i = 0; left > 0; i++) {
+    size_t begin = (i == 0) ? _head : 0;
+    size_t end = (i + 1 == _blocks.size()) ? _tail : _blocks[i].size;
+    size_t step = std::min(end - begin, left);
+    out.append(_blocks[i].data + begin, step);
+    left -= step;
+  }
+  consume(bytes);
+}
+
+/// @brief Returns all blocks to the pool
+void BufferChain::clear(void) {
+  for (const Block& block : _blocks) {
+    BufferPool::release(block.data, block.size);
+  }
+  _blocks.clear();
+  _head = 0;
+  _tail = 0;
+  _size = 0;
+  std::string().swap(_scratch);
+}
+
+size_t BufferChain::size(void) const { return _size; }
+
+bool BufferChain::empty(void) const { return _size == 0; }
+
+size_t BufferChain::blockCount(void) const { return _blocks.size(); }
+
+/// @brief Bytes of the blocks the chain holds
+size_t BufferChain::capacity(void) const {
+  size_t bytes = 0;
+  for (const Block& block : _blocks) {
+    bytes += block.size;
+  }
+  return bytes;
+}
+
+/// @brief Compares needle with the data at (block, offset), across blocks
+bool BufferChain::matchesAt(size_t block, size_t offset,
+                            std::string_view needle) const {
+  for (char expected : needle) {
+    size_t end = (block + 1 == _blocks.size()) ? _tail : _blocks[block].size;
+    if (offset == end) {
+      block++;
+      offset = 0;
+      if (block == _blocks.size()) {
+        return false;
+      }
+    }
+    if (_blocks[block].data[offset++] != expected) {
+      return false;
+    }
+  }
+  return true;
+}
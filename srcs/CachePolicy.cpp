@@ -0,0 +1,203 @@
+/**
+ * @file CachePolicy.cpp
+ * @brief Caching headers of static responses (`expires`, `add_header`)
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-15
+ * @version 1.0
+ */
+
+#include "CachePolicy.hpp"
+
+#include <climits>
+#include <ctime>
+#include <stdexcept>
+
+#include "HttpRequestParser.hpp"
+#include "HttpResponse.hpp"
+#include "HttpUtils.hpp"
+
+/**
+ * @brief Sets the `expires` policy
+ * @param value Duration (see parseDuration(); negative means "no-cache"),
+ *        `epoch`, `max` or `off`
+ * @throws std::invalid_argument if value is none of these
+ */
+void CachePolicy::setExpires(const std::string& value) {
+  if (value == "off") {
+    _expires = Expires::OFF;
+  } else if (value == "epoch") {
+    _expires = Expires::EPOCH;
+  } else if (value == "max") {
+    _expires = Expires::MAX;
+  } else {
+    _expires_seconds = parseDuration(value);
+    _expires = Expires::TIME;
+  }
+  render();
+}
+
+/**
+ * @brief Adds a header line (`add_header`), repeated names are all sent
+ *
+ * A `Cache-Control` header takes the place of the one `expires` would send.
+ *
+ * @param name Header field name
+ * @param value Header field value
+ * @throws std::invalid_argument on an invalid name or value, or a header the
+ *         server sets itself
+ */
+void CachePolicy::addHeader(const std::string& name, const std::string& value) {
+  static const char* reserved[] = {"content-length", "content-type",
+                                   "transfer-encoding", "connection", "date",
+                                   "server"};
+  std::string trimmed = value;
+  if (!HttpRequestParser::validateHeaderField(name) ||
+      !HttpRequestParser::validateAndTrimHeaderValue(trimmed)) {
+    throw std::invalid_argument("invalid header '" + name + ": " + value +
+                                "'");
+  }
+  std::string lowercase_name = HttpUtils::toLowerCase(name);
+  for (const char* field : reserved) {
+    if (lowercase_name == field) {
+      throw std::invalid_argument(name + " is set by the server");
+    }
+  }
+  _headers.emplace_back(name, trimmed);
+  render();
+}
+
+/**
+ * @brief Sets the pattern of fingerprinted paths (`immutable_pattern`)
+ * @param pattern Regular expression (RegexDfa syntax) matched against the
+ *        request path, `on` for CACHE_FINGERPRINT_PATTERN, `off` for none
+ * @throws std::runtime_error if the pattern doesn't compile
+ */
+void CachePolicy::setImmutablePattern(const std::string& pattern) {
+  _immutable_pattern = RegexDfa();
+  _has_immutable_pattern = (pattern != "off");
+  if (_has_immutable_pattern) {
+    _immutable_pattern.addPattern(
+        pattern == "on" ? CACHE_FINGERPRINT_PATTERN : pattern, false);
+    _immutable_pattern.compile();
+  }
+  render();
+}
+
+/**
+ * @brief Adds the caching headers to a response
+ * @param path Request path (tested against `immutable_pattern`)
+ * @param response Successful response of a static file
+ */
+void CachePolicy::apply(std::string_view path, HttpResponse& response) const {
+  bool immutable =
+      _has_immutable_pattern && _immutable_pattern.match(path) >= 0;
+  response.appendRawHeaders(headerBlock(immutable));
+  if (immutable || _expires != Expires::TIME) {
+    return;
+  }
+  std::time_t expires = std::time(nullptr) + _expires_seconds;
+  std::tm gmt{};
+  gmtime_r(&expires, &gmt);
+  char date[64];
+  std::strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", &gmt);
+  response.insertHeader("Expires", date);
+}
+
+/// @brief Precomputed header lines of a (fingerprinted) path
+std::string_view CachePolicy::headerBlock(bool immutable) const {
+  return immutable ? _immutable_block : _block;
+}
+
+/**
+ * @brief Parses a duration of `expires`
+ * @param value Seconds or a sequence of numbers with units `s m h d w M y`
+ *        (e.g. "30d", "1h30m"), a leading '-' makes it negative
+ * @return Seconds
+ * @throws std::invalid_argument if value is malformed or over INT_MAX
+ */
+long CachePolicy::parseDuration(const std::string& value) {
+  bool negative = !value.empty() && value[0] == '-';
+  size_t i = negative ? 1 : 0;
+  if (i == value.size()) {
+    throw std::invalid_argument("invalid duration '" + value + "'");
+  }
+  long total = 0;
+  while (i < value.size()) {
+    long number = 0;
+    size_t digits = 0;
+    while (i < value.size() && value[i] >= '0' && value[i] <= '9') {
+      number = number * 10 + (value[i++] - '0');
+      digits++;
+      if (number > INT_MAX) {
+        throw std::invalid_argument("duration too long '" + value + "'");
+      }
+    }
+    long unit = 1;
+    if (i < value.size()) {
+      switch (value[i++]) {
+        case 's': unit = 1; break;
+        case 'm': unit = 60; break;
+        case 'h': unit = 3600; break;
+        case 'd': unit = 86400; break;
+        case 'w': unit = 7 * 86400; break;
+        case 'M': unit = 30 * 86400; break;
+        case 'y': unit = 365 * 86400; break;
+        default: digits = 0; break;
+      }
+    }
+    if (digits == 0) {
+      throw std::invalid_argument("invalid duration '" + value + "'");
+    }
+    total += number * unit;
+    if (total > INT_MAX) {
+      throw std::invalid_argument("duration too long '" + value + "'");
+    }
+  }
+  return negative ? -total : total;
+}
+
+// private
+
+/// @brief Renders the header blocks from the current settings
+void CachePolicy::render(void) {
+  _block.clear();
+  _immutable_block.clear();
+  bool has_cache_control = false;
+  for (const auto& header : _headers) {
+    std::string line = header.first + ": " + header.second + "\r\n";
+    _block += line;
+    if (HttpUtils::toLowerCase(header.first) == "cache-control") {
+      has_cache_control = true;
+    } else {
+      _immutable_block += line;
+    }
+  }
+  _immutable_block += "Cache-Control: public, max-age=" +
+                      std::to_string(CACHE_IMMUTABLE_MAX_AGE) +
+                      ", immutable\r\n";
+
+  switch (_expires) {
+    case Expires::OFF:
+      return;
+    case Expires::TIME:
+      break;
+    case Expires::EPOCH:
+      _block += "Expires: " CACHE_EPOCH_EXPIRES "\r\n";
+      break;
+    case Expires::MAX:
+      _block += "Expires: " CACHE_MAX_EXPIRES "\r\n";
+      break;
+  }
+  if (has_cache_control) {
+    return;
+  }
+  if (_expires == Expires::MAX) {
+    _block += "Cache-Control: max-age=" + std::to_string(CACHE_MAX_AGE) +
+              "\r\n";
+  } else if (_expires == Expires::EPOCH || _expires_seconds <= 0) {
+    _block += "Cache-Control: no-cache\r\n";
+  } else {
+    _block += "Cache-Control: max-age=" + std::to_string(_expires_seconds) +
+              "\r\n";
+  }
+}
@@ -387,20 +387,14 @@ std::unique_ptr<char*[], void(*)(char**)> CgiHandler::setupEnvironment(const Htt
     // Basic CGI environment variables
     env["GATEWAY_INTERFACE"] = "CGI/1.1";
     env["REQUEST_METHOD"] = request.getMethod();
-    env["SCRIPT_NAME"] = request.getRequestTarget();
+    env["SCRIPT_NAME"] = request.getPath();
     env["SCRIPT_FILENAME"] = script_path;
     env["SERVER_PROTOCOL"] = "HTTP/1.1";
     env["SERVER_SOFTWARE"] = "WebServ/1.0";
     env["REDIRECT_STATUS"] = "200";
     
     // Query string
-    std::string uri = request.getRequestTarget();
-    size_t query_pos = uri.find('?');
-    if (query_pos != std::string::npos) {
-        env["QUERY_STRING"] = uri.substr(query_pos + 1);
-    } else {
-        env["QUERY_STRING"] = "";
-    }
+    env["QUERY_STRING"] = std::string(request.getQuery());
     
     // Server info
     if (request.hasHeader("Host")) {
@@ -432,7 +426,9 @@ std::unique_ptr<char*[], void(*)(char**)> CgiHandler::setupEnvironment(const Htt
     }
     
     // Additional CGI variables
-    env["REMOTE_ADDR"] = "127.0.0.1";
+    const ClientAddress& client = request.getClientAddress();
+    env["REMOTE_ADDR"] =
+        (client.family == AF_UNSPEC) ? "127.0.0.1" : client.toString();
     env["PATH_INFO"] = "";
     
     return mapToEnvArray(env);
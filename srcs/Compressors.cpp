@@ -0,0 +1,72 @@
+/**
+ * @file Compressors.cpp
+ * @brief Content codings of the offline tools (webserv-bundle, -precompress)
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-14
+ * @version 1.0
+ */
+
+#include "Compressors.hpp"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_BROTLI
+#include <brotli/encode.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace Compressors {
+
+#ifdef HAVE_ZLIB
+bool gzip(std::string_view input, std::string& output) {
+  z_stream stream{};
+  if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    return false;
+  }
+  output.resize(deflateBound(&stream, input.size()));
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+  stream.avail_in = static_cast<uInt>(input.size());
+  stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+  stream.avail_out = static_cast<uInt>(output.size());
+  int status = deflate(&stream, Z_FINISH);
+  output.resize(stream.total_out);
+  deflateEnd(&stream);
+  return status == Z_STREAM_END;
+}
+#endif
+
+#ifdef HAVE_BROTLI
+bool brotli(std::string_view input, std::string& output) {
+  size_t size = BrotliEncoderMaxCompressedSize(input.size());
+  output.resize(size == 0 ? input.size() + 1024 : size);
+  size = output.size();
+  if (!BrotliEncoderCompress(
+          BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+          input.size(), reinterpret_cast<const uint8_t*>(input.data()), &size,
+          reinterpret_cast<uint8_t*>(&output[0]))) {
+    return false;
+  }
+  output.resize(size);
+  return true;
+}
+#endif
+
+#ifdef HAVE_ZSTD
+bool zstd(std::string_view input, std::string& output) {
+  output.resize(ZSTD_compressBound(input.size()));
+  size_t size = ZSTD_compress(&output[0], output.size(), input.data(),
+                              input.size(), ZSTD_maxCLevel());
+  if (ZSTD_isError(size)) {
+    return false;
+  }
+  output.resize(size);
+  return true;
+}
+#endif
+
+}  // namespace Compressors
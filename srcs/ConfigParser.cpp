@@ -1,5 +1,13 @@
 #include "Config.hpp"
+#include "AccessList.hpp"
+#include "AssetBundle.hpp"
+#include "CachePolicy.hpp"
+#include "LocationMatcher.hpp"
 #include "Logger.hpp"
+#include "MimeTypes.hpp"
+#include "RedirectMap.hpp"
+#include "RegexDfa.hpp"
+#include "RequestPipeline.hpp"
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -9,6 +17,7 @@
 #include <unordered_set>
 #include <set>
 #include <cctype>
+#include <sys/un.h>
 
 
 namespace ConfigParser {
@@ -23,7 +32,10 @@ LocationConfig::LocationConfig(const ServerConfig& parent) :
     client_max_body_size(parent.client_max_body_size),
     cgi_ext(parent.cgi_ext),
     cgi_path(parent.cgi_path),
-    error_pages(parent.error_pages)
+    error_pages(parent.error_pages),
+    limit_rate(parent.limit_rate),
+    limit_rate_after(parent.limit_rate_after),
+    limit_rate_kernel(parent.limit_rate_kernel)
 {}
 
 void throwError(const std::string& message) {
@@ -92,6 +104,7 @@ Config parse(const std::string& filePath) {
     const std::string content = buffer.str();
     auto tokens = detail::Tokenizer::tokenize(content);
     detail::Tokenizer::classifyTokens(tokens);
+    detail::Tokenizer::expandIncludes(tokens, std::filesystem::path(filePath).parent_path().string());
 
     //printTokens(tokens);
     Config config;
@@ -188,8 +201,16 @@ void classifyTokens(std::vector<ConfigParser::Token>& tokens) {
         "http", "server", "location", "include", "worker_processes", "worker_connections",
         "sendfile", "listen", "port", "host", "server_name", "root", "index",
         "error_page", "client_max_body_size", "autoindex", "allow_methods",
-        "cgi_pass", "return", "cgi_path", "cgi_ext"
+        "cgi_pass", "return", "cgi_path", "cgi_ext", "max_connections",
+        "max_cgi_processes", "max_body_memory", "max_bandwidth", "admin_endpoint",
+        "limit_rate", "limit_rate_after", "limit_rate_kernel", "types",
+        "redirect_map", "upload_store", "upload_resumable", "upload_durability",
+        "upload_splice", "bundle", "gzip_static", "brotli_static", "zstd_static", "expires",
+        "add_header", "immutable_pattern", "allow_list", "deny_list",
+        "client_header_buffer_size", "large_client_header_buffers"
     };
+    // `allow` and `deny` are also header values (X-Frame-Options), so they
+    // are directives only at the start of a statement
     for (size_t i = 0; i < tokens.size(); ++i) {
         if (tokens[i].type == ConfigParser::TokenType::UNKNOWN) {
             if (known_directives.count(tokens[i].value)) {
@@ -205,6 +226,57 @@ void classifyTokens(std::vector<ConfigParser::Token>& tokens) {
     }
 }
 
+/**
+ * @brief Replace every `include <file>;` with the tokens of that file
+ *
+ * Relative paths are resolved against the directory of the including file,
+ * included files may include further files (up to MAX_INCLUDE_DEPTH).
+ *
+ * @param tokens Classified tokens, modified in place
+ * @param base_dir Directory of the file the tokens come from
+ * @param depth Current nesting level of includes
+ */
+void expandIncludes(std::vector<ConfigParser::Token>& tokens, const std::string& base_dir, size_t depth) {
+    static const size_t MAX_INCLUDE_DEPTH = 8;
+    std::vector<ConfigParser::Token> expanded;
+
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        if (tokens[i].type != ConfigParser::TokenType::KEYWORD || tokens[i].value != "include") {
+            expanded.push_back(tokens[i]);
+            continue;
+        }
+        if (i + 2 >= tokens.size() || tokens[i + 1].type != ConfigParser::TokenType::VALUE ||
+            tokens[i + 2].type != ConfigParser::TokenType::SEMICOLON) {
+            throwError("Directive 'include' expects one file path and ';'", tokens[i].line);
+        }
+        if (depth >= MAX_INCLUDE_DEPTH) {
+            throwError("Too many nested includes of '" + tokens[i + 1].value + "'", tokens[i].line);
+        }
+
+        std::filesystem::path path(tokens[i + 1].value);
+        if (path.is_relative()) {
+            path = std::filesystem::path(base_dir) / path;
+        }
+        if (!std::filesystem::is_regular_file(path)) {
+            throwError("Included file does not exist: " + path.string(), tokens[i].line);
+        }
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            throwError("Failed to open included file: " + path.string(), tokens[i].line);
+        }
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+
+        std::vector<ConfigParser::Token> included = tokenize(buffer.str());
+        classifyTokens(included);
+        included.pop_back(); // END_OF_FILE
+        expandIncludes(included, path.parent_path().string(), depth + 1);
+        expanded.insert(expanded.end(), included.begin(), included.end());
+        i += 2; // path and ';'
+    }
+    tokens.swap(expanded);
+}
+
 } // namespace ConfigParser::detail::Tokenizer
 
 
@@ -283,7 +355,9 @@ void validatePort(int port) {
 void validateServerHasRootLocation(const ConfigParser::ServerConfig& server) {
     bool hasRootLocation = false;
     for (const auto& location : server.locations) {
-        if (location.path == "/") {
+        if (location.path == "/" &&
+            (location.modifier == ConfigParser::LocationModifier::PREFIX ||
+             location.modifier == ConfigParser::LocationModifier::PREFERRED_PREFIX)) {
             hasRootLocation = true;
             break;
         }
@@ -320,7 +394,13 @@ bool isValidDirective(const std::string& directive) {
         "http", "server", "location", "include", "worker_processes", "worker_connections",
         "sendfile", "listen", "port", "host", "server_name", "root", "index",
         "error_page", "client_max_body_size", "autoindex", "allow_methods",
-        "cgi_pass", "return", "cgi_path", "cgi_ext"
+        "cgi_pass", "return", "cgi_path", "cgi_ext", "max_connections",
+        "max_cgi_processes", "max_body_memory", "max_bandwidth", "admin_endpoint",
+        "limit_rate", "limit_rate_after", "limit_rate_kernel", "types",
+        "redirect_map", "upload_store", "upload_resumable", "upload_durability",
+        "upload_splice", "bundle", "gzip_static", "brotli_static", "zstd_static", "expires",
+        "add_header", "immutable_pattern", "allow", "deny", "allow_list",
+        "deny_list", "client_header_buffer_size", "large_client_header_buffers"
     };
     return valid.count(directive);
 }
@@ -333,7 +413,11 @@ bool isValidDirective(const std::string& directive) {
 bool isValidInServerContext(const std::string& directive) {
     static const std::unordered_set<std::string> valid = {
         "listen", "server_name", "host", "root", "index", "error_page",
-        "client_max_body_size", "cgi_path", "port"
+        "client_max_body_size", "cgi_path", "port", "max_connections",
+        "max_cgi_processes", "max_body_memory", "max_bandwidth", "limit_rate",
+        "limit_rate_after", "limit_rate_kernel", "redirect_map", "allow", "deny",
+        "allow_list", "deny_list", "client_header_buffer_size",
+        "large_client_header_buffers"
     };
     return valid.count(directive);
 }
@@ -346,7 +430,12 @@ bool isValidInServerContext(const std::string& directive) {
 bool isValidInLocationContext(const std::string& directive) {
     static const std::unordered_set<std::string> valid = {
         "root", "index", "autoindex", "allow_methods", "methods", "return",
-        "cgi_path", "cgi_ext", "error_page", "client_max_body_size"
+        "cgi_path", "cgi_ext", "error_page", "client_max_body_size",
+        "admin_endpoint", "limit_rate", "limit_rate_after", "limit_rate_kernel",
+        "upload_store", "upload_resumable", "upload_durability", "upload_splice",
+        "bundle",
+        "gzip_static", "brotli_static", "zstd_static", "expires", "add_header",
+        "immutable_pattern", "allow", "deny", "allow_list", "deny_list"
     };
     return valid.count(directive);
 }
@@ -383,6 +472,35 @@ static std::vector<std::string> getDirectiveValues(const std::string& keyword_na
     pos++; // Consume ';'
     return values;
 }
+/**
+ * @brief Adds an `allow`, `deny`, `allow_list` or `deny_list` rule
+ * @param access Rules of the server or location, created on first use
+ * @param keyword Directive
+ * @param values Directive values
+ * @throws std::runtime_error if the prefix or the list file is invalid
+ */
+static void parseAccessDirective(std::shared_ptr<const AccessList>& access, const ConfigParser::Token& keyword, const std::vector<std::string>& values) {
+    if (values.size() != 1) {
+        throwError("Directive '" + keyword.value + "' expects one value", keyword.line);
+    }
+    // still owned by this block only, so it can be extended in place
+    std::shared_ptr<AccessList> rules = access
+        ? std::const_pointer_cast<AccessList>(access)
+        : std::make_shared<AccessList>();
+    bool allow = (keyword.value == "allow" || keyword.value == "allow_list");
+    try {
+        if (keyword.value == "allow" || keyword.value == "deny") {
+            rules->addRule(allow, values[0]);
+        } else {
+            rules->load(allow, values[0]);
+        }
+    }
+    catch (const std::exception& e) {
+        throwError("Invalid " + keyword.value + ": " + e.what(), keyword.line);
+    }
+    access = rules;
+}
+
 /**
  * @brief Parse individual server-level directives and populate ServerConfig
  * @param server ServerConfig object to populate with directive values
@@ -406,7 +524,13 @@ void parseServerDirective(ConfigParser::ServerConfig& server, const std::vector<
     std::vector<std::string> values = getDirectiveValues(keyword.value, keyword.line, tokens, pos);
     
     // Populate ServerConfig based on the directive
-    if ((keyword.value == "listen" && !values.empty()) || (keyword.value == "port" && !values.empty())) {
+    if (keyword.value == "listen" && !values.empty() && values[0].rfind("unix:", 0) == 0) {
+        std::string path = values[0].substr(5);
+        if (path.empty() || path.size() >= sizeof(sockaddr_un::sun_path)) {
+            throwError("Invalid unix socket path '" + path + "'", keyword.line);
+        }
+        server.unix_paths.push_back(path);
+    } else if ((keyword.value == "listen" && !values.empty()) || (keyword.value == "port" && !values.empty())) {
         try { 
             server.port = std::stoi(values[0]);
             validatePort(server.port);
@@ -414,6 +538,7 @@ void parseServerDirective(ConfigParser::ServerConfig& server, const std::vector<
         catch (...) { 
             throwError("Invalid port number '" + values[0] + "'", keyword.line); 
         }
+        server.listen_tcp = true;
     } else if (keyword.value == "server_name") {
         server.server_names = values;
     } else if (keyword.value == "host" && !values.empty()) {
@@ -441,6 +566,100 @@ void parseServerDirective(ConfigParser::ServerConfig& server, const std::vector<
         server.cgi_path = values;
     } else if (keyword.value == "cgi_ext" && !values.empty()) {
         server.cgi_ext = values;
+    } else if (keyword.value == "max_connections" && !values.empty()) {
+        try {
+            server.max_connections = std::stoull(values[0]);
+        }
+        catch (...) {
+            throwError("Invalid max_connections '" + values[0] + "'", keyword.line);
+        }
+    } else if (keyword.value == "max_cgi_processes" && !values.empty()) {
+        try {
+            server.max_cgi_processes = std::stoull(values[0]);
+        }
+        catch (...) {
+            throwError("Invalid max_cgi_processes '" + values[0] + "'", keyword.line);
+        }
+    } else if (keyword.value == "max_body_memory" && !values.empty()) {
+        try {
+            server.max_body_memory = parseBodySize(values[0]);
+        }
+        catch (...) {
+            throwError("Invalid max_body_memory '" + values[0] + "'", keyword.line);
+        }
+    } else if (keyword.value == "client_header_buffer_size" && !values.empty()) {
+        size_t size = 0;
+        try {
+            size = parseBodySize(values[0]);
+        }
+        catch (...) {
+        }
+        if (size < 64 || size > 1048576) {
+            throwError("Invalid client_header_buffer_size '" + values[0] + "' (64 to 1M)", keyword.line);
+        }
+        server.client_header_buffer_size = size;
+    } else if (keyword.value == "large_client_header_buffers") {
+        if (values.size() != 2) {
+            throwError("Directive 'large_client_header_buffers' expects a number and a size", keyword.line);
+        }
+        size_t count = 0;
+        size_t size = 0;
+        try {
+            count = std::stoull(values[0]);
+            size = parseBodySize(values[1]);
+        }
+        catch (...) {
+        }
+        if (count < 1 || count > 64 || size < 64 || size > 1048576) {
+            throwError("Invalid large_client_header_buffers '" + values[0] + " " + values[1] + "' (1 to 64 buffers of 64 to 1M)", keyword.line);
+        }
+        server.large_header_buffers = count;
+        server.large_header_buffer_size = size;
+    } else if (keyword.value == "max_bandwidth" && !values.empty()) {
+        try {
+            server.max_bandwidth = parseBodySize(values[0]);
+        }
+        catch (...) {
+            throwError("Invalid max_bandwidth '" + values[0] + "'", keyword.line);
+        }
+    } else if (keyword.value == "limit_rate" && !values.empty()) {
+        try {
+            server.limit_rate = parseBodySize(values[0]);
+        }
+        catch (...) {
+            throwError("Invalid limit_rate '" + values[0] + "'", keyword.line);
+        }
+    } else if (keyword.value == "limit_rate_after" && !values.empty()) {
+        try {
+            server.limit_rate_after = parseBodySize(values[0]);
+        }
+        catch (...) {
+            throwError("Invalid limit_rate_after '" + values[0] + "'", keyword.line);
+        }
+    } else if (keyword.value == "limit_rate_kernel" && !values.empty()) {
+        server.limit_rate_kernel = (values[0] == "on" || values[0] == "true");
+    } else if (keyword.value == "redirect_map" && !values.empty()) {
+        int code = 301;
+        if (values.size() > 1) {
+            try { code = std::stoi(values[1]); } catch (...) { code = 0; }
+            if (!RedirectMap::isRedirectCode(code)) {
+                throwError("Invalid redirect_map code '" + values[1] + "'", keyword.line);
+            }
+        }
+        // still owned by this server only, so it can be extended in place
+        std::shared_ptr<RedirectMap> redirects = server.redirects
+            ? std::const_pointer_cast<RedirectMap>(server.redirects)
+            : std::make_shared<RedirectMap>();
+        try {
+            redirects->load(values[0], code);
+        }
+        catch (const std::exception& e) {
+            throwError(std::string("Invalid redirect_map: ") + e.what(), keyword.line);
+        }
+        server.redirects = redirects;
+    } else if (keyword.value == "allow" || keyword.value == "deny" ||
+               keyword.value == "allow_list" || keyword.value == "deny_list") {
+        parseAccessDirective(server.access, keyword, values);
     }
 }
 
@@ -474,7 +693,13 @@ void parseLocationDirective(ConfigParser::LocationConfig& location, const std::v
     } else if (keyword.value == "allow_methods" || keyword.value == "methods") {
         location.allowed_methods = values;
     } else if (keyword.value == "return" && !values.empty()) {
-        location.redirect_url = values[0];
+        location.redirect_url = values.back();
+        if (values.size() > 1) {
+            try { location.redirect_code = std::stoi(values[0]); } catch (...) { location.redirect_code = 0; }
+            if (!RedirectMap::isRedirectCode(location.redirect_code)) {
+                throwError("Invalid return code '" + values[0] + "'", keyword.line);
+            }
+        }
     } else if (keyword.value == "client_max_body_size" && !values.empty()) {
         try {
             location.client_max_body_size = parseBodySize(values[0]);
@@ -494,6 +719,87 @@ void parseLocationDirective(ConfigParser::LocationConfig& location, const std::v
         location.cgi_path = values;
     } else if (keyword.value == "cgi_ext" && !values.empty()) {
         location.cgi_ext = values;
+    } else if (keyword.value == "admin_endpoint" && !values.empty()) {
+        location.admin_endpoint = (values[0] == "on" || values[0] == "true");
+    } else if (keyword.value == "limit_rate" && !values.empty()) {
+        try {
+            location.limit_rate = parseBodySize(values[0]);
+        }
+        catch (...) {
+            throwError("Invalid limit_rate '" + values[0] + "'", keyword.line);
+        }
+    } else if (keyword.value == "limit_rate_after" && !values.empty()) {
+        try {
+            location.limit_rate_after = parseBodySize(values[0]);
+        }
+        catch (...) {
+            throwError("Invalid limit_rate_after '" + values[0] + "'", keyword.line);
+        }
+    } else if (keyword.value == "limit_rate_kernel" && !values.empty()) {
+        location.limit_rate_kernel = (values[0] == "on" || values[0] == "true");
+    } else if (keyword.value == "upload_store" && !values.empty()) {
+        if (values[0] != "name" && values[0] != "digest") {
+            throwError("Invalid upload_store '" + values[0] +
+                       "' (expected name or digest)", keyword.line);
+        }
+        location.upload_by_digest = (values[0] == "digest");
+    } else if (keyword.value == "upload_resumable" && !values.empty()) {
+        location.upload_resumable = (values[0] == "on" || values[0] == "true");
+    } else if (keyword.value == "upload_splice" && !values.empty()) {
+        location.upload_splice = (values[0] == "on" || values[0] == "true");
+    } else if (keyword.value == "upload_durability" && !values.empty()) {
+        static const std::map<std::string, ConfigParser::UploadDurability> levels = {
+            {"none", ConfigParser::UploadDurability::NONE},
+            {"fdatasync", ConfigParser::UploadDurability::FDATASYNC},
+            {"fsync", ConfigParser::UploadDurability::FSYNC}
+        };
+        auto level = levels.find(values[0]);
+        if (level == levels.end()) {
+            throwError("Invalid upload_durability '" + values[0] +
+                       "' (expected none, fdatasync or fsync)", keyword.line);
+        }
+        location.upload_durability = level->second;
+    } else if (keyword.value == "bundle" && !values.empty()) {
+        try {
+            location.bundle = std::make_shared<const AssetBundle>(values[0]);
+        }
+        catch (const std::exception& e) {
+            throwError(std::string("Invalid bundle: ") + e.what(), keyword.line);
+        }
+    } else if (keyword.value == "gzip_static" && !values.empty()) {
+        location.gzip_static = (values[0] == "on" || values[0] == "true");
+    } else if (keyword.value == "brotli_static" && !values.empty()) {
+        location.brotli_static = (values[0] == "on" || values[0] == "true");
+    } else if (keyword.value == "zstd_static" && !values.empty()) {
+        location.zstd_static = (values[0] == "on" || values[0] == "true");
+    } else if ((keyword.value == "expires" || keyword.value == "immutable_pattern" ||
+                keyword.value == "add_header") && !values.empty()) {
+        // still owned by this location only, so it can be extended in place
+        std::shared_ptr<CachePolicy> policy = location.cache_policy
+            ? std::const_pointer_cast<CachePolicy>(location.cache_policy)
+            : std::make_shared<CachePolicy>();
+        try {
+            if (keyword.value == "expires") {
+                policy->setExpires(values[0]);
+            } else if (keyword.value == "immutable_pattern") {
+                policy->setImmutablePattern(values[0]);
+            } else if (values.size() < 2) {
+                throw std::invalid_argument("expected a name and a value");
+            } else {
+                std::string value = values[1];
+                for (size_t i = 2; i < values.size(); ++i) {
+                    value += " " + values[i];
+                }
+                policy->addHeader(values[0], value);
+            }
+        }
+        catch (const std::exception& e) {
+            throwError("Invalid " + keyword.value + ": " + e.what(), keyword.line);
+        }
+        location.cache_policy = policy;
+    } else if (keyword.value == "allow" || keyword.value == "deny" ||
+               keyword.value == "allow_list" || keyword.value == "deny_list") {
+        parseAccessDirective(location.access, keyword, values);
     }
 }
 
@@ -507,13 +813,38 @@ void parseLocationDirective(ConfigParser::LocationConfig& location, const std::v
 void parseLocationBlock(ConfigParser::ServerConfig& server, const std::vector<ConfigParser::Token>& tokens, size_t& pos) {
     ConfigParser::LocationConfig location(server);
     pos++; // Consume "location"
-    
+
+    // Optional modifier before the path
+    static const std::map<std::string, ConfigParser::LocationModifier> modifiers = {
+        {"=", ConfigParser::LocationModifier::EXACT},
+        {"^~", ConfigParser::LocationModifier::PREFERRED_PREFIX},
+        {"~", ConfigParser::LocationModifier::REGEX},
+        {"~*", ConfigParser::LocationModifier::REGEX_CASELESS}
+    };
+    if (pos + 1 < tokens.size() && tokens[pos].type == ConfigParser::TokenType::VALUE &&
+        tokens[pos + 1].type == ConfigParser::TokenType::VALUE) {
+        auto modifier = modifiers.find(tokens[pos].value);
+        if (modifier == modifiers.end()) {
+            throwError("Invalid location modifier '" + tokens[pos].value + "'", tokens[pos].line);
+        }
+        location.modifier = modifier->second;
+        pos++;
+    }
+
     if (pos < tokens.size() && tokens[pos].type == ConfigParser::TokenType::VALUE) {
         location.path = tokens[pos].value;
         pos++;
     } else {
         throwError("Expected path for location block", tokens[pos-1].line);
     }
+    if (location.modifier == ConfigParser::LocationModifier::REGEX ||
+        location.modifier == ConfigParser::LocationModifier::REGEX_CASELESS) {
+        try {
+            RegexDfa().addPattern(location.path, false); // syntax check only
+        } catch (const std::exception& e) {
+            throwError(e.what(), tokens[pos-1].line);
+        }
+    }
 
     if (pos >= tokens.size() || tokens[pos].type != ConfigParser::TokenType::OPEN_BRACE) {
         throwError("Expected '{' after location path", tokens[pos-1].line);
@@ -525,6 +856,10 @@ void parseLocationBlock(ConfigParser::ServerConfig& server, const std::vector<Co
         if (tokens[pos].type != ConfigParser::TokenType::KEYWORD) {
             throwError("Expected a directive keyword", tokens[pos].line);
         }
+        if (tokens[pos].value == "types") {
+            parseTypesBlock(location.mime_types, tokens, pos);
+            continue;
+        }
         parseLocationDirective(location, tokens, pos);
     }
 
@@ -537,6 +872,55 @@ void parseLocationBlock(ConfigParser::ServerConfig& server, const std::vector<Co
     server.locations.push_back(location);
 }
 
+/**
+ * @brief Parse `types { type ext ...; }` block into a compiled MIME table
+ *
+ * A repeated block in the same context adds to the previous one, a later
+ * mapping of an extension wins.
+ *
+ * @param types Table of the server/location, replaced by the new table
+ * @param tokens Vector of tokens being parsed
+ * @param pos Current position in tokens (modified by reference)
+ * @throws std::runtime_error if block syntax is invalid
+ */
+void parseTypesBlock(std::shared_ptr<const MimeTypes::MimeTable>& types, const std::vector<ConfigParser::Token>& tokens, size_t& pos) {
+    std::shared_ptr<MimeTypes::MimeTable> table = std::make_shared<MimeTypes::MimeTable>();
+    if (types) {
+        table->merge(*types);
+    }
+    pos++; // Consume "types"
+
+    if (pos >= tokens.size() || tokens[pos].type != ConfigParser::TokenType::OPEN_BRACE) {
+        throwError("Expected '{' after 'types'", tokens[pos-1].line);
+    }
+    pos++; // Consume '{'
+
+    while (pos < tokens.size() && (tokens[pos].type == ConfigParser::TokenType::KEYWORD ||
+                                   tokens[pos].type == ConfigParser::TokenType::VALUE)) {
+        const ConfigParser::Token& type = tokens[pos++];
+        size_t extensions = 0;
+        while (pos < tokens.size() && (tokens[pos].type == ConfigParser::TokenType::KEYWORD ||
+                                       tokens[pos].type == ConfigParser::TokenType::VALUE)) {
+            table->add(type.value, tokens[pos++].value);
+            extensions++;
+        }
+        if (pos >= tokens.size() || tokens[pos].type != ConfigParser::TokenType::SEMICOLON) {
+            throwError("MIME type '" + type.value + "' must end with a semicolon ';'", type.line);
+        }
+        if (extensions == 0) {
+            writeWarning("MIME type '" + type.value + "' has no extensions", type.line);
+        }
+        pos++; // Consume ';'
+    }
+
+    if (pos >= tokens.size() || tokens[pos].type != ConfigParser::TokenType::CLOSE_BRACE) {
+        throwError("Expected '}' to close 'types' block", tokens[pos < tokens.size() ? pos : pos-1].line);
+    }
+    pos++; // Consume '}'
+    table->compile();
+    types = table;
+}
+
 /**
  * @brief Parse a complete server block and add it to the config
  * @param config Config object to add the parsed server to
@@ -560,6 +944,8 @@ void parseServerBlock(ConfigParser::Config& config, const std::vector<ConfigPars
         
         if (tokens[pos].value == "location") {
             parseLocationBlock(server, tokens, pos);
+        } else if (tokens[pos].value == "types") {
+            parseTypesBlock(server.mime_types, tokens, pos);
         } else {
             parseServerDirective(server, tokens, pos);
         }
@@ -569,21 +955,51 @@ void parseServerBlock(ConfigParser::Config& config, const std::vector<ConfigPars
         throwError("Expected '}' to close 'server' block", tokens.back().line);
     }
     pos++; // Consume '}'
-    
+
+    if (server.unix_paths.empty()) {
+        server.listen_tcp = true; // `listen <port>` or the default port
+    }
+
+    // `types` and access rules may follow the locations, so they are
+    // inherited once all are known (a location with rules replaces them)
+    for (ConfigParser::LocationConfig& location : server.locations) {
+        if (!location.mime_types) {
+            location.mime_types = server.mime_types;
+        }
+        if (!location.access) {
+            location.access = server.access;
+        }
+    }
     validateServerHasRootLocation(server);
+    for (auto& location : server.locations) {
+        location.pipeline = RequestPipeline::compose(location);
+    }
+    try {
+        server.location_matcher = std::make_shared<const LocationMatcher>(server.locations);
+    } catch (const std::exception& e) {
+        throwError(e.what(), tokens[pos-1].line);
+    }
     config.servers.push_back(server);
 }
 
 void final_validation(ConfigParser::Config& config) {
     // Check for duplicate server blocks with same port and server_name
     std::set<std::pair<int, std::string>> seen;
+    std::set<std::pair<std::string, std::string>> seen_unix;
     for (const auto& server : config.servers) {
         for (const auto& name : server.server_names) {
             auto key = std::make_pair(server.port, name);
-            if (seen.count(key)) {
+            if (server.listen_tcp && seen.count(key)) {
                 throw std::runtime_error("Duplicate server block for port " + std::to_string(server.port) + " and server_name " + name);
             }
-            seen.insert(key);
+            if (server.listen_tcp) {
+                seen.insert(key);
+            }
+            for (const auto& path : server.unix_paths) {
+                if (!seen_unix.insert(std::make_pair(path, name)).second) {
+                    throw std::runtime_error("Duplicate server block for unix:" + path + " and server_name " + name);
+                }
+            }
         }
     }
 }
@@ -615,14 +1031,67 @@ ConfigParser::Config parseTokens(std::vector<ConfigParser::Token>& tokens) {
 
 
 std::ostream& operator<<(std::ostream& os, const ConfigParser::LocationConfig& location) {
-    os << "      Location: " << location.path << "\n";
+    static const char* modifiers[] = {"", "= ", "^~ ", "~ ", "~* "};
+    os << "      Location: " << modifiers[static_cast<int>(location.modifier)] << location.path << "\n";
     os << "        Root: " << (location.root.empty() ? "(inherited)" : location.root) << "\n";
     os << "        Index: " << (location.index.empty() ? "(inherited)" : location.index) << "\n";
     os << "        Autoindex: " << (location.autoindex ? "on" : "off") << "\n";
     os << "        Client Max Body Size: " << location.client_max_body_size << " bytes\n";
     
     if (!location.redirect_url.empty()) {
-        os << "        Redirect: " << location.redirect_url << "\n";
+        os << "        Redirect: " << location.redirect_code << " " << location.redirect_url << "\n";
+    }
+
+    if (location.admin_endpoint) {
+        os << "        Admin Endpoint: on\n";
+    }
+
+    if (location.upload_by_digest) {
+        os << "        Upload Store: digest\n";
+    }
+
+    if (location.upload_resumable) {
+        os << "        Resumable Uploads: on\n";
+    }
+
+    if (location.upload_splice) {
+        os << "        Upload Splice: on\n";
+    }
+
+    if (location.upload_durability != ConfigParser::UploadDurability::NONE) {
+        static const char* levels[] = {"none", "fdatasync", "fsync"};
+        os << "        Upload Durability: "
+           << levels[static_cast<int>(location.upload_durability)] << "\n";
+    }
+
+    if (location.limit_rate != 0) {
+        os << "        Limit Rate: " << location.limit_rate << " bytes/s after "
+           << location.limit_rate_after << " bytes"
+           << (location.limit_rate_kernel ? " (kernel pacing)" : "") << "\n";
+    }
+
+    if (location.bundle) {
+        os << "        Bundle: " << location.bundle->size() << " assets\n";
+    }
+
+    if (location.gzip_static || location.brotli_static || location.zstd_static) {
+        os << "        Precompressed:"
+           << (location.brotli_static ? " br" : "")
+           << (location.zstd_static ? " zstd" : "")
+           << (location.gzip_static ? " gzip" : "") << "\n";
+    }
+
+    if (location.cache_policy) {
+        os << "        Cache Policy: "
+           << location.cache_policy->headerBlock(false).size() << " header bytes\n";
+    }
+
+    if (location.access) {
+        os << "        Access Rules: " << location.access->size() << " prefixes\n";
+    }
+
+    if (location.mime_types) {
+        os << "        MIME Types: " << location.mime_types->size() << " extensions\n";
     }
     
     if (!location.allowed_methods.empty()) {
@@ -656,10 +1125,28 @@ std::ostream& operator<<(std::ostream& os, const ConfigParser::LocationConfig& l
 std::ostream& operator<<(std::ostream& os, const ConfigParser::ServerConfig& server) {
     os << "  Server Configuration:\n";
     os << "    Host: " << server.host << "\n";
-    os << "    Port: " << server.port << "\n";
+    if (server.listen_tcp) {
+        os << "    Port: " << server.port << "\n";
+    }
+    for (const auto& path : server.unix_paths) {
+        os << "    Unix Socket: " << path << "\n";
+    }
     os << "    Root: " << (server.root.empty() ? "(not set)" : server.root) << "\n";
     os << "    Index: " << (server.index.empty() ? "(not set)" : server.index) << "\n";
     os << "    Client Max Body Size: " << server.client_max_body_size << " bytes\n";
+    os << "    Header Buffers: " << server.client_header_buffer_size << " bytes, "
+       << server.large_header_buffers << " x " << server.large_header_buffer_size << " bytes\n";
+    os << "    Quotas: connections " << server.max_connections
+       << ", cgi " << server.max_cgi_processes
+       << ", body memory " << server.max_body_memory << " bytes"
+       << ", bandwidth " << server.max_bandwidth << " bytes/s (0 = unlimited)\n";
+    if (server.redirects) {
+        os << "    Redirect Map: " << server.redirects->size() << " entries\n";
+    }
+
+    if (server.access) {
+        os << "    Access Rules: " << server.access->size() << " prefixes\n";
+    }
     
     if (!server.server_names.empty()) {
         os << "    Server Names: ";
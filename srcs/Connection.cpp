@@ -11,6 +11,7 @@
 // constructor and destructor
 
 Connection::~Connection() {
+  releaseVhost();
   if (_client_fd >= 0) {
     if (close(_client_fd) == -1) {
       Logger::warning("Failed to close client fd " +
@@ -20,69 +21,171 @@ Connection::~Connection() {
 }
 
 Connection::Connection(int client_socket_fd, int server_socket_fd,
-                       Webserv& webserv, HttpMethodHandler& method_handler)
+                       Webserv& webserv, HttpMethodHandler& method_handler,
+                       const ClientAddress& client)
     : _client_fd(client_socket_fd),
       _server_fd(server_socket_fd),
+      _header_buffer_size(0),
+      _large_header_buffer_size(0),
       _webserv(webserv),
       _method_handler(method_handler),
       _request(),
       _write_buffer(""),
+      _write_offset(0),
+      _body_source(nullptr),
+      _file_range(),
+      _sent_bytes(0),
+      _epoll_events(EPOLLIN),
       _keep_alive(true),
-      _last_active(std::chrono::steady_clock::now()) {}
+      _last_active(std::chrono::steady_clock::now()),
+      _vhost(nullptr),
+      _body_memory(0),
+      _splice_checked(false),
+      _limit_rate(0),
+      _limit_rate_after(0),
+      _kernel_pacing(false),
+      _kernel_pacing_active(false),
+      _rate_tokens(0),
+      _rate_refill(std::chrono::steady_clock::now()),
+      _resume_at(std::chrono::steady_clock::now()),
+      _is_paused(false) {
+  _request.setClientAddress(client);
+  // Host is not known before the head is read: nginx takes these limits
+  // from the default server of the address as well
+  const ConfigParser::ServerConfig& server =
+      _webserv.getServerConfigs(_server_fd, "");
+  _header_buffer_size = server.client_header_buffer_size;
+  _large_header_buffer_size = server.large_header_buffer_size;
+  _request.setHeaderLimits(
+      _large_header_buffer_size,
+      server.large_header_buffers * _large_header_buffer_size);
+}
 
 // public methods
 
-void Connection::processRequest(std::string&& data) {
-  HttpRequestParser::Status status =
-      HttpRequestParser::parseRequest(std::move(data), _request);
+/**
+ * @brief Parses bytes received into getReceiveBuffer() and answers the
+ *        request once it is complete
+ */
+void Connection::processRequest(void) {
+  HttpRequestParser::Status status = HttpRequestParser::parseRequest(_request);
 
+  // the log line is only built if the logger writes it somewhere
+  bool logging = Logger::isEnabled();
   std::stringstream msg;
-  msg << "Port: " << _webserv.getPortByServerSocket(_server_fd);
+  if (logging) {
+    msg << "Port: " << _webserv.getListenerName(_server_fd);
+  }
+  if (status == HttpRequestParser::Status::WAIT_FOR_DATA &&
+      _request.getParsingState() != HttpParsingState::REQUEST_LINE &&
+      _request.getParsingState() != HttpParsingState::HEADERS) {
+    // headers are known: account the body being received to its vhost
+    const ConfigParser::ServerConfig& server =
+        _webserv.getServerConfigs(_server_fd, _request.getHeader("Host"));
+    if (!bindVhost(server) ||
+        !VhostQuota::chargeBodyMemory(server, _body_memory,
+                                      getBufferedBodySize())) {
+      if (!_request.isErrorStatusCode()) {
+        _request.setErrorStatus(
+            "Request body memory quota exceeded for " +
+                VhostQuota::getServerLabel(server),
+            HttpUtils::HttpStatusCode::SERVICE_UNAVAILABLE);
+      }
+      VhostQuota::countRejected(server);
+      status = HttpRequestParser::Status::ERROR;
+    } else if (!_splice_checked && !VhostQuota::hasBandwidth(server)) {
+      // refused before a byte of the body is received or spliced to disk
+      _request.setErrorStatus(
+          "Bandwidth quota exceeded for " + VhostQuota::getServerLabel(server),
+          HttpUtils::HttpStatusCode::SERVICE_UNAVAILABLE);
+      VhostQuota::countRejected(server);
+      status = HttpRequestParser::Status::ERROR;
+    } else if (startSplicedBody(server)) {
+      // the start of the body went to the file, nothing is buffered
+      VhostQuota::chargeBodyMemory(server, _body_memory, 0);
+    }
+  }
+
   if (status == HttpRequestParser::Status::WAIT_FOR_DATA) {
-    msg << " -> Received partial request from client fd " << _client_fd
-        << ", waiting for more data";
-    Logger::info(msg.str());
+    if (logging) {
+      msg << " -> Received partial request from client fd " << _client_fd
+          << ", waiting for more data";
+      Logger::info(msg.str());
+    }
     return;
   }
 
   if (status == HttpRequestParser::Status::ERROR) {
-    if (_request.hasHeader("Host")) {
-      msg << ", Host: " << _request.getHeader("Host") << "\n";
+    if (logging) {
+      if (_request.hasHeader("Host")) {
+        msg << ", Host: " << _request.getHeader("Host") << "\n";
+      }
+      msg << "\t-> Failed to parse request from client fd " << _client_fd
+          << ": " << _request.getErrorMessage() << " ("
+          << static_cast<int>(_request.getStatusCode()) << ")";
+      Logger::error(msg.str());
     }
-    msg << "\t-> Failed to parse request from client fd " << _client_fd << ": "
-        << _request.getErrorMessage() << " ("
-        << static_cast<int>(_request.getStatusCode()) << ")";
-    Logger::error(msg.str());
     buildParserErrorResponse();
     DBG("\n----------- SENDING RESPONSE [1] -----------\n" << _write_buffer);
     sendResponse();
     return;
   }
 
-  HttpResponse response = _method_handler.processMethod(
-      _request,
-      _webserv.getServerConfigs(_server_fd, _request.getHeader("Host")));
+  const ConfigParser::ServerConfig& server =
+      _webserv.getServerConfigs(_server_fd, _request.getHeader("Host"));
+  if (!checkVhostQuotas(server)) {
+    if (logging) {
+      msg << ", Host: " << _request.getHeader("Host") << "\n"
+          << "\t-> Rejected request: \t\t" << _request.getRequestLine()
+          << " (" << _request.getErrorMessage() << ")";
+      Logger::warning(msg.str());
+    }
+    buildParserErrorResponse();
+    sendResponse();
+    return;
+  }
+
+  HttpResponse response = _method_handler.processMethod(_request, server);
 
-  msg << ", Host: " << _request.getHeader("Host") << "\n"
-      << "\t-> Received request: \t\t" << _request.getRequestLine()
-      << "\n\t-> Sending response: \t\t" << response.getStatusLine();
+  if (logging) {
+    msg << ", Host: " << _request.getHeader("Host") << "\n"
+        << "\t-> Received request: \t\t" << _request.getRequestLine()
+        << "\n\t-> Sending response: \t\t" << response.getStatusLine();
+  }
 
   if (response.isError()) {
-    msg << " (reason: " << response.getBody() << ")";
-    Logger::error(msg.str());
+    if (logging) {
+      msg << " (reason: " << response.getBody() << ")";
+      Logger::error(msg.str());
+    }
     buildMethodHandlerErrorResponse(response);
     DBG("----------- SENDING RESPONSE [2] -----------\n" << _write_buffer);
   } else {
-    Logger::info(msg.str());
+    if (logging) {
+      Logger::info(msg.str());
+    }
     response.setConnectionHeader(_request.getHeader("Connection"),
                                  _request.getHttpVersion());
     _keep_alive = response.isKeepAliveConnection();
     _write_buffer = response.convertToString();
+    _body_source = response.getBodySource();
+    _limit_rate = response.getLimitRate();
+    _limit_rate_after = response.getLimitRateAfter();
+    _kernel_pacing = response.isKernelPacing();
     DBG("----------- SENDING RESPONSE [3] -----------\n" << _write_buffer);
   }
   sendResponse();
 }
 
+/**
+ * @brief Continues transmission of the response (EPOLLOUT or pacing timer)
+ */
+void Connection::handleWritable(void) {
+  if (hasPendingWrite()) {
+    flushWriteBuffer();
+  }
+}
+
 // public helpers
 
 bool Connection::isTimedOut(std::chrono::seconds timeout) const {
@@ -94,38 +197,463 @@ bool Connection::isTimedOut(std::chrono::seconds timeout) const {
 
 bool Connection::keepAlive() const { return _keep_alive; }
 
+bool Connection::hasPendingWrite(void) const {
+  return _write_offset < _write_buffer.length() || _body_source != nullptr;
+}
+
+bool Connection::isWritePaused(void) const { return _is_paused; }
+
+std::chrono::steady_clock::time_point Connection::getResumeTime(void) const {
+  return _resume_at;
+}
+
+uint32_t Connection::getEpollEvents(void) const { return _epoll_events; }
+
+void Connection::setEpollEvents(uint32_t events) { _epoll_events = events; }
+
 void Connection::updateLastActiveTime(void) {
   _last_active = std::chrono::steady_clock::now();
 }
 
 // private
 
+/**
+ * @brief Starts transmission of _write_buffer
+ *
+ * The request is answered at this point, so it is reset right away. The
+ * response is written without blocking: whatever the socket doesn't accept
+ * is sent later on EPOLLOUT (see Webserv::updateConnectionEvents()).
+ */
 void Connection::sendResponse(void) {
   updateLastActiveTime();
-  ssize_t bytes =
-      send(_client_fd, _write_buffer.c_str(), _write_buffer.length(), 0);
+  cleanup();
+  _write_offset = 0;
+  _sent_bytes = 0;
+  _rate_tokens = 0;
+  _rate_refill = std::chrono::steady_clock::now();
+  flushWriteBuffer();
+}
 
-  if (bytes == -1) {
-    Logger::error("Failed to send response to client fd " +
-                  std::to_string(_client_fd) + ": " +
-                  std::string(strerror(errno)));
-  } else {
+/**
+ * @brief Writes as much of the response as the socket and pacing allow
+ *
+ * Stops when the socket buffer is full (EAGAIN, continue on EPOLLOUT) or
+ * when the limit_rate budget is spent (_is_paused, continue at _resume_at).
+ * A streamed body is pulled from its source whenever everything before has
+ * been sent, file ranges go out with sendfile(). It has no MSG_DONTWAIT:
+ * the socket itself is non-blocking (accept4() in Webserv::addConnection()),
+ * so a client that stops reading gets EAGAIN, not a stalled event loop.
+ */
+void Connection::flushWriteBuffer(void) {
+  _is_paused = false;
+  while (hasPendingWrite()) {
+    bool from_file = (_write_offset == _write_buffer.length());
+    if (from_file && _file_range.length == 0) {
+      if (!pullBodySource()) {
+        break;
+      }
+      continue;
+    }
+
+    size_t pending = from_file ? _file_range.length
+                               : _write_buffer.length() - _write_offset;
+    size_t budget = takeSendBudget(pending);
+    if (budget == 0) {
+      _is_paused = true;
+      return;
+    }
+
+    ssize_t bytes =
+        from_file
+            ? sendfile(_client_fd, _file_range.fd, &_file_range.offset, budget)
+            : send(_client_fd, _write_buffer.data() + _write_offset, budget,
+                   MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (bytes == -1) {
+      int error = errno;
+      refundSendBudget(budget);
+      if (error == EAGAIN || error == EWOULDBLOCK || error == EINTR) {
+        return;
+      }
+      Logger::error("Failed to send response to client fd " +
+                    std::to_string(_client_fd) + ": " +
+                    std::string(strerror(error)));
+      _keep_alive = false;
+      finishTransmission();
+      return;
+    }
+    if (bytes == 0 && from_file) {
+      // file is shorter than the source promised: keep Content-Length
+      refundSendBudget(budget);
+      size_t zeros =
+          std::min<size_t>(_file_range.length, CONNECTION_KEEP_CAPACITY);
+      _write_buffer.assign(zeros, '\0');
+      _write_offset = 0;
+      _file_range.length -= zeros;
+      continue;
+    }
+
+    updateLastActiveTime();
+    refundSendBudget(budget - static_cast<size_t>(bytes));
+    if (from_file) {
+      _file_range.length -= static_cast<size_t>(bytes);
+    } else {
+      _write_offset += static_cast<size_t>(bytes);
+    }
+    _sent_bytes += static_cast<size_t>(bytes);
+    if (_vhost != nullptr) {
+      VhostQuota::consumeBandwidth(*_vhost, static_cast<size_t>(bytes));
+    }
+  }
+
+  if (Logger::isEnabled()) {
     Logger::info("Successfully sent response to client fd " +
                  std::to_string(_client_fd) +
-                 ", bytes sent: " + std::to_string(bytes));
+                 ", bytes sent: " + std::to_string(_sent_bytes));
   }
-  cleanup();
+  finishTransmission();
+}
+
+/**
+ * @brief Replaces the sent write buffer with the next piece of the body
+ * @return false if the body source is complete
+ */
+bool Connection::pullBodySource(void) {
+  _write_buffer.clear();
+  _write_offset = 0;
+  if (!_body_source->next(_write_buffer, _file_range)) {
+    _body_source.reset();
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Token bucket of limit_rate: how many bytes may be sent right now
+ *
+ * The first limit_rate_after bytes of the response are never paced. After
+ * that the bucket refills with limit_rate bytes per second (one second burst
+ * at most) and is spent in slices, so the connection wakes up about
+ * CONNECTION_LIMIT_RATE_SLICES times per second. With kernel pacing the
+ * socket gets SO_MAX_PACING_RATE instead and the budget is unlimited.
+ *
+ * @param wanted Bytes waiting to be sent
+ * @return Bytes allowed to send, 0 means "paused until _resume_at"
+ */
+size_t Connection::takeSendBudget(size_t wanted) {
+  if (_limit_rate == 0) {
+    return wanted;
+  }
+  if (_sent_bytes < _limit_rate_after) {
+    _rate_refill = std::chrono::steady_clock::now();
+    return std::min(wanted, _limit_rate_after - _sent_bytes);
+  }
+  if (_kernel_pacing) {
+    if (!_kernel_pacing_active) {
+      setPacingRate(_limit_rate);
+    }
+    if (_kernel_pacing_active) {
+      return wanted;
+    }
+  }
+
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  double elapsed = std::chrono::duration<double>(now - _rate_refill).count();
+  _rate_refill = now;
+  _rate_tokens = std::min(_rate_tokens + elapsed * _limit_rate,
+                          static_cast<double>(_limit_rate));
+
+  size_t slice = std::max<size_t>(1, _limit_rate / CONNECTION_LIMIT_RATE_SLICES);
+  size_t needed = std::min(wanted, slice);
+  if (_rate_tokens < static_cast<double>(needed)) {
+    double wait = (static_cast<double>(needed) - _rate_tokens) / _limit_rate;
+    _resume_at = now + std::chrono::duration_cast<
+                           std::chrono::steady_clock::duration>(
+                           std::chrono::duration<double>(wait));
+    return 0;
+  }
+
+  size_t budget = std::min(wanted, static_cast<size_t>(_rate_tokens));
+  _rate_tokens -= static_cast<double>(budget);
+  return budget;
+}
+
+/**
+ * @brief Gives back the part of takeSendBudget() the socket didn't accept
+ * @param unused Bytes of the budget that were not sent
+ */
+void Connection::refundSendBudget(size_t unused) {
+  if (_limit_rate != 0 && !_kernel_pacing_active &&
+      _sent_bytes >= _limit_rate_after) {
+    _rate_tokens += static_cast<double>(unused);
+  }
+}
+
+/**
+ * @brief Lets the kernel pace the socket (fq qdisc or TCP internal pacing)
+ * @param rate Bytes per second, 0 removes the limit
+ * @note If the kernel refuses, pacing falls back to the token bucket
+ */
+void Connection::setPacingRate(size_t rate) {
+  unsigned int value = (rate == 0 || rate > UINT32_MAX)
+                           ? ~0U
+                           : static_cast<unsigned int>(rate);
+  if (setsockopt(_client_fd, SOL_SOCKET, SO_MAX_PACING_RATE, &value,
+                 sizeof(value)) == -1) {
+    Logger::warning("SO_MAX_PACING_RATE failed on client fd " +
+                    std::to_string(_client_fd) + ": " + strerror(errno) +
+                    ", pacing in userspace");
+    _kernel_pacing = false;
+    _kernel_pacing_active = false;
+    return;
+  }
+  _kernel_pacing_active = (rate != 0);
+}
+
+/**
+ * @brief Drops the sent response and resets pacing for the next one
+ */
+void Connection::finishTransmission(void) {
+  if (_kernel_pacing_active) {
+    setPacingRate(0);
+  }
+  if (_write_buffer.capacity() > CONNECTION_KEEP_CAPACITY) {
+    std::string().swap(_write_buffer);
+  } else {
+    _write_buffer.clear();
+  }
+  _write_offset = 0;
+  _body_source.reset();
+  _file_range = BodySource::FileRange();
+  _sent_bytes = 0;
+  _limit_rate = 0;
+  _limit_rate_after = 0;
+  _kernel_pacing = false;
+  _is_paused = false;
 }
 
 void Connection::cleanup(void) {
+  if (_vhost != nullptr) {
+    VhostQuota::releaseBodyMemory(*_vhost, _body_memory);
+  }
+  _splice_checked = false;
   _request.reset();
-  _write_buffer.clear();
+}
+
+/**
+ * @brief Moves the rest of a raw upload body to a file with splice()
+ *
+ * Tried once per request, right after the head: the location decides (see
+ * HttpMethodHandler::findSpliceDirectory()). If the file can't be made the
+ * body is simply buffered.
+ *
+ * @return true if the rest of the body is received by receiveSplicedBody()
+ */
+bool Connection::startSplicedBody(const ConfigParser::ServerConfig& server) {
+  if (_splice_checked ||
+      _request.getParsingState() != HttpParsingState::BODY) {
+    return false;
+  }
+  _splice_checked = true;
+  std::string directory;
+  if (!_method_handler.findSpliceDirectory(_request, server, directory)) {
+    return false;
+  }
+  auto body = std::make_shared<SplicedBody>();
+  std::string error_msg;
+  if (!body->open(directory, _request.getBodyLength(), error_msg) ||
+      !body->write(_request.getBody(), error_msg)) {
+    Logger::warning("Buffering upload body of client fd " +
+                    std::to_string(_client_fd) + ": " + error_msg);
+    return false;
+  }
+  _request.setSplicedBody(body);
+  return true;
+}
+
+/**
+ * @brief Applies quotas of the virtual host to the complete request
+ *
+ * On failure the request gets 503 error status and the caller is expected
+ * to answer with buildParserErrorResponse() (connection is closed).
+ *
+ * @param server Virtual host selected for the request
+ * @return true if the request may be processed, false otherwise
+ */
+bool Connection::checkVhostQuotas(const ConfigParser::ServerConfig& server) {
+  std::string reason;
+
+  if (!bindVhost(server)) {
+    reason = "Too many connections for ";
+  } else if (!VhostQuota::chargeBodyMemory(server, _body_memory,
+                                           getBufferedBodySize())) {
+    reason = "Request body memory quota exceeded for ";
+  } else if (!VhostQuota::hasBandwidth(server)) {
+    reason = "Bandwidth quota exceeded for ";
+  } else {
+    VhostQuota::countRequest(server);
+    return true;
+  }
+
+  VhostQuota::countRejected(server);
+  _request.setErrorStatus(reason + VhostQuota::getServerLabel(server),
+                          HttpUtils::HttpStatusCode::SERVICE_UNAVAILABLE);
+  return false;
+}
+
+/**
+ * @brief Accounts this connection to the virtual host of its latest request
+ * @param server Virtual host selected by Host header
+ * @return false if the virtual host has no free connection slots
+ */
+bool Connection::bindVhost(const ConfigParser::ServerConfig& server) {
+  if (_vhost == &server) {
+    return true;
+  }
+  releaseVhost();
+  if (!VhostQuota::acquireConnection(server)) {
+    return false;
+  }
+  _vhost = &server;
+  return true;
+}
+
+void Connection::releaseVhost(void) {
+  if (_vhost == nullptr) {
+    return;
+  }
+  VhostQuota::releaseBodyMemory(*_vhost, _body_memory);
+  VhostQuota::releaseConnection(*_vhost);
+  _vhost = nullptr;
+}
+
+/**
+ * @brief Connection waits for the next request: nothing received, nothing
+ *        left to send
+ */
+bool Connection::isIdle(void) const {
+  return _request.getParsingState() == HttpParsingState::REQUEST_LINE &&
+         _request.getUnparsedBuffer().empty() && !hasPendingWrite();
+}
+
+/**
+ * @brief Drops the connection to its minimal footprint while it is idle
+ */
+void Connection::releaseIdleMemory(void) {
+  if (!isIdle() || getMemoryUsage() == sizeof(Connection)) {
+    return;
+  }
+  _request.releaseMemory();
+  std::string().swap(_write_buffer);
+}
+
+/**
+ * @brief Heap and object memory used by the connection (admin `memory`)
+ * @return size_t Bytes
+ */
+size_t Connection::getMemoryUsage(void) const {
+  return sizeof(Connection) + HttpUtils::heapCapacity(_write_buffer) +
+         _request.getMemoryUsage();
+}
+
+/**
+ * @brief Copies what the admin report shows, no syscalls
+ * @param now Time the idle durations are measured to
+ */
+Connection::Snapshot Connection::getSnapshot(
+    std::chrono::steady_clock::time_point now) const {
+  Snapshot snapshot;
+  snapshot.peer = _request.getClientAddress();
+  snapshot.vhost = _vhost ? VhostQuota::getServerLabel(*_vhost) : "";
+  snapshot.state = _request.getParsingState();
+  snapshot.bytes_in = getBufferedBodySize();
+  snapshot.bytes_out =
+      _write_buffer.length() - _write_offset + _file_range.length;
+  snapshot.memory = getMemoryUsage();
+  snapshot.idle =
+      std::chrono::duration_cast<std::chrono::milliseconds>(now - _last_active);
+  if (!_request.getMethod().empty()) {
+    snapshot.request_line = _request.getMethod() + " " +
+                            _request.getRequestTarget() + " " +
+                            _request.getHttpVersion();
+  }
+  return snapshot;
+}
+
+/**
+ * @brief Buffer `recv()` writes to, it is the request's unparsed buffer
+ * @note Picks the size of the block added next: request heads start in a
+ *       `client_header_buffer_size` block and go on in large header blocks
+ *       once they outgrow it, bodies are read into BUFFER_BLOCK_SIZE blocks
+ */
+BufferChain& Connection::getReceiveBuffer(void) {
+  BufferChain& buffer = _request.getUnparsedBuffer();
+  HttpParsingState state = _request.getParsingState();
+  if (state != HttpParsingState::REQUEST_LINE &&
+      state != HttpParsingState::HEADERS) {
+    buffer.setBlockSize(BUFFER_BLOCK_SIZE);
+  } else if (buffer.size() < _header_buffer_size) {
+    buffer.setBlockSize(_header_buffer_size);
+  } else {
+    buffer.setBlockSize(_large_header_buffer_size);
+  }
+  return buffer;
+}
+
+/// @brief The rest of the request body goes to a file, not to a buffer
+bool Connection::isSplicingBody(void) const {
+  const SplicedBody* body = _request.getSplicedBody();
+  return body != nullptr && !body->isComplete();
+}
+
+/**
+ * @brief Receives the next part of a spliced body (instead of recv())
+ *
+ * Answers the request once the body is complete, or with 500 if the file
+ * can't be written.
+ *
+ * @return false if the client closed the connection or the socket failed
+ */
+bool Connection::receiveSplicedBody(void) {
+  SplicedBody& body = *_request.getSplicedBody();
+  std::string error_msg;
+  ssize_t bytes = body.receive(_client_fd, error_msg);
+  if (bytes < 0 && error_msg.empty()) {
+    return errno == EAGAIN || errno == EINTR;
+  }
+  if (bytes == 0) {
+    return false;
+  }
+  if (bytes < 0) {
+    std::stringstream msg;
+    msg << "Port: " << _webserv.getListenerName(_server_fd)
+        << "\n\t-> Failed to store upload body of client fd " << _client_fd
+        << ": " << error_msg;
+    Logger::error(msg.str());
+    _request.setErrorStatus("Failed to store upload body",
+                            HttpUtils::HttpStatusCode::INTERNAL_SERVER_ERROR);
+    buildParserErrorResponse();
+    sendResponse();
+    return true;
+  }
+  if (body.isComplete()) {
+    _request.setParsingState(HttpParsingState::COMPLETE);
+    processRequest();
+  }
+  return true;
+}
+
+size_t Connection::getBufferedBodySize(void) const {
+  return _request.getBody().size() + _request.getUnparsedBuffer().size();
 }
 
 void Connection::buildParserErrorResponse(void) {
   HttpResponse response;
   response.setStatusCode(_request.getStatusCode());
   response.setBody(_request.getErrorMessage());
+  if (_request.getStatusCode() ==
+      HttpUtils::HttpStatusCode::SERVICE_UNAVAILABLE) {
+    response.insertHeader("Retry-After", "1");
+  }
   response.setErrorPageBody(
       _webserv.getServerConfigs(_server_fd, _request.getHeader("Host")));
   response.insertHeader("Connection", "close");
@@ -141,3 +669,33 @@ void Connection::buildMethodHandlerErrorResponse(HttpResponse& response) {
   _keep_alive = response.isKeepAliveConnection();
   _write_buffer = response.convertToString();
 }
+
+// ConnectionFilter
+
+/// @brief true if the snapshot passes every filter that is set
+bool ConnectionFilter::matches(const Connection::Snapshot& snapshot) const {
+  return (!peer || peer->isAllowed(snapshot.peer)) &&
+         (vhost.empty() || vhost == snapshot.vhost) &&
+         (state.empty() || state == getStateName(snapshot.state)) &&
+         snapshot.idle >= min_idle;
+}
+
+const char* ConnectionFilter::getStateName(HttpParsingState state) {
+  switch (state) {
+    case HttpParsingState::REQUEST_LINE:
+      return "request_line";
+    case HttpParsingState::HEADERS:
+      return "headers";
+    case HttpParsingState::BODY:
+      return "body";
+    case HttpParsingState::CHUNKED_BODY_SIZE:
+      return "chunked_body_size";
+    case HttpParsingState::CHUNKED_BODY_DATA:
+      return "chunked_body_data";
+    case HttpParsingState::CHUNKED_BODY_TRAILER:
+      return "chunked_body_trailer";
+    case HttpParsingState::COMPLETE:
+      return "complete";
+  }
+  return "unknown";
+}
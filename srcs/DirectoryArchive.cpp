@@ -0,0 +1,518 @@
+/**
+ * @file DirectoryArchive.cpp
+ * @brief Directory tree streamed as tar or zip (`?archive=` of autoindex)
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-12
+ * @version 1.0
+ *
+ * @see https://pubs.opengroup.org/onlinepubs/9699919799/utilities/pax.html
+ * ustar and pax formats
+ * @see https://pkware.cachefly.net/webdocs/casestudies/APPNOTE.TXT
+ * zip format
+ */
+
+#include "DirectoryArchive.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#include "Logger.hpp"
+
+#define TAR_BLOCK 512
+// largest size of the 11 octal digits of a ustar header
+#define TAR_MAX_OCTAL_SIZE 077777777777ULL
+
+namespace {
+
+struct Crc32Table {
+  uint32_t values[256];
+};
+
+constexpr Crc32Table makeCrc32Table(void) {
+  Crc32Table table{};
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320U : crc >> 1;
+    }
+    table.values[i] = crc;
+  }
+  return table;
+}
+
+constexpr Crc32Table kCrc32Table = makeCrc32Table();
+
+void put16(std::string& out, uint32_t value) {
+  out.push_back(static_cast<char>(value & 0xFF));
+  out.push_back(static_cast<char>((value >> 8) & 0xFF));
+}
+
+void put32(std::string& out, uint64_t value) {
+  put16(out, static_cast<uint32_t>(value & 0xFFFF));
+  put16(out, static_cast<uint32_t>((value >> 16) & 0xFFFF));
+}
+
+/// @brief Writes value as zero-padded octal filling width - 1 digits
+void putOctal(char* field, size_t width, uint64_t value) {
+  std::snprintf(field, width, "%0*llo", static_cast<int>(width - 1),
+                static_cast<unsigned long long>(value));
+}
+
+uint64_t roundToBlock(uint64_t size) {
+  return (size + TAR_BLOCK - 1) / TAR_BLOCK * TAR_BLOCK;
+}
+
+/**
+ * @brief One ustar header block
+ * @param name Name field (at most 100 bytes are kept)
+ * @param prefix Prefix field (at most 155 bytes are kept)
+ */
+std::string ustarBlock(std::string_view name, std::string_view prefix,
+                       mode_t mode, uint64_t size, time_t mtime, char type) {
+  std::string block(TAR_BLOCK, '\0');
+  char* header = &block[0];
+  std::memcpy(header, name.data(), std::min<size_t>(name.size(), 100));
+  putOctal(header + 100, 8, mode & 07777);
+  putOctal(header + 108, 8, 0);  // uid
+  putOctal(header + 116, 8, 0);  // gid
+  putOctal(header + 124, 12, std::min<uint64_t>(size, TAR_MAX_OCTAL_SIZE));
+  putOctal(header + 136, 12,
+           static_cast<uint64_t>(std::max<time_t>(mtime, 0)) &
+               TAR_MAX_OCTAL_SIZE);
+  header[156] = type;
+  std::memcpy(header + 257, "ustar", 6);
+  std::memcpy(header + 263, "00", 2);
+  std::memcpy(header + 345, prefix.data(),
+              std::min<size_t>(prefix.size(), 155));
+
+  // checksum is computed with its own field filled with spaces
+  std::memset(header + 148, ' ', 8);
+  unsigned int checksum = 0;
+  for (unsigned char byte : block) {
+    checksum += byte;
+  }
+  std::snprintf(header + 148, 8, "%06o", checksum);
+  header[155] = ' ';
+  return block;
+}
+
+/// @brief pax record "<length> <key>=<value>\n", length counts itself
+std::string paxRecord(std::string_view key, std::string_view value) {
+  size_t body = key.size() + value.size() + 3;  // ' ', '=', '\n'
+  size_t length = body + 1;
+  while (std::to_string(length).size() + body != length) {
+    length = std::to_string(length).size() + body;
+  }
+  std::string record = std::to_string(length);
+  record.append(" ").append(key).append("=").append(value).append("\n");
+  return record;
+}
+
+/// @brief MS-DOS date and time of zip headers (local time, from 1980)
+void dosDateTime(time_t mtime, uint32_t& date, uint32_t& time) {
+  std::tm local{};
+  localtime_r(&mtime, &local);
+  if (local.tm_year < 80) {
+    date = (1 << 5) | 1;  // 1980-01-01
+    time = 0;
+    return;
+  }
+  date = static_cast<uint32_t>(((local.tm_year - 80) << 9) |
+                               ((local.tm_mon + 1) << 5) | local.tm_mday);
+  time = static_cast<uint32_t>((local.tm_hour << 11) | (local.tm_min << 5) |
+                               (local.tm_sec / 2));
+}
+
+/// @brief zip flags: names are UTF-8, CRC of files follows their data
+uint32_t zipFlags(bool directory) { return directory ? 0x0800 : 0x0808; }
+
+}  // namespace
+
+// constructor and destructor
+
+/**
+ * @brief Walks the directory tree and computes the archive size
+ *
+ * @param directory Directory on disk
+ * @param root_name Name of the top directory inside the archive
+ * @param format Archive format
+ * @throws std::runtime_error (or std::filesystem::filesystem_error) if the
+ *         directory can't be read or doesn't fit the format's limits
+ */
+DirectoryArchive::DirectoryArchive(const std::string& directory,
+                                   const std::string& root_name, Format format)
+    : _format(format) {
+  scan(directory, root_name);
+}
+
+DirectoryArchive::~DirectoryArchive() { closeEntry(); }
+
+// public methods
+
+uint64_t DirectoryArchive::size(void) const { return _size; }
+
+size_t DirectoryArchive::entryCount(void) const { return _entries.size(); }
+
+/**
+ * @brief Produces the next piece of the archive
+ *
+ * Headers, padding and (zip) file data are appended to the buffer up to
+ * about ARCHIVE_READ_CHUNK bytes. Tar file data is returned as a file range
+ * instead, the next call continues after it.
+ */
+bool DirectoryArchive::next(std::string& buffer, FileRange& range) {
+  range = FileRange();
+  size_t start = buffer.size();
+
+  while (buffer.size() - start < ARCHIVE_READ_CHUNK && _phase != Phase::DONE) {
+    switch (_phase) {
+      case Phase::HEADER: {
+        if (_index == _entries.size()) {
+          _phase = (_format == Format::ZIP) ? Phase::CENTRAL : Phase::END;
+          _index = 0;
+          _central_size = _produced;
+          break;
+        }
+        Entry& entry = _entries[_index];
+        entry.offset = _produced;
+        append(buffer, (_format == Format::TAR) ? tarHeader(entry)
+                                                : zipLocalHeader(entry));
+        _phase = Phase::ENTRY_END;
+        if (!entry.directory && entry.size > 0) {
+          openEntry(entry);
+          _phase = Phase::DATA;
+        }
+        break;
+      }
+      case Phase::DATA: {
+        Entry& entry = _entries[_index];
+        if (_format == Format::TAR && _fd >= 0) {
+          range.fd = _fd;
+          range.offset = 0;
+          range.length = entry.size;
+          _produced += entry.size;
+          _phase = Phase::ENTRY_END;
+          return true;
+        }
+        appendData(buffer, entry);
+        break;
+      }
+      case Phase::ENTRY_END: {
+        const Entry& entry = _entries[_index];
+        closeEntry();
+        if (_format == Format::TAR) {
+          append(buffer, std::string(roundToBlock(entry.size) - entry.size,
+                                     '\0'));
+        } else if (!entry.directory) {
+          append(buffer, zipDataDescriptor(entry));
+        }
+        _index++;
+        _phase = Phase::HEADER;
+        break;
+      }
+      case Phase::CENTRAL:
+        if (_index == _entries.size()) {
+          _central_size = _produced - _central_size;
+          _phase = Phase::END;
+          break;
+        }
+        append(buffer, zipCentralHeader(_entries[_index++]));
+        break;
+      case Phase::END:
+        append(buffer, (_format == Format::TAR)
+                           ? std::string(2 * TAR_BLOCK, '\0')
+                           : zipEndRecord());
+        _phase = Phase::DONE;
+        break;
+      case Phase::DONE:
+        break;
+    }
+  }
+  return buffer.size() > start;
+}
+
+/**
+ * @brief Archive format of the `archive` query parameter
+ * @param name "tar" or "zip"
+ * @param format [out] Format
+ * @return false if the format is not supported
+ */
+bool DirectoryArchive::parseFormat(std::string_view name, Format& format) {
+  if (name == "tar") {
+    format = Format::TAR;
+  } else if (name == "zip") {
+    format = Format::ZIP;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::string_view DirectoryArchive::contentType(Format format) {
+  return (format == Format::TAR) ? "application/x-tar" : "application/zip";
+}
+
+std::string_view DirectoryArchive::extension(Format format) {
+  return (format == Format::TAR) ? "tar" : "zip";
+}
+
+/**
+ * @brief Updates CRC-32 (IEEE 802.3, as in zip and gzip) with data
+ * @param crc CRC of the data before, 0 to start
+ * @return CRC of all data so far
+ */
+uint32_t DirectoryArchive::crc32(uint32_t crc, const void* data,
+                                 size_t length) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  crc = ~crc;
+  for (size_t i = 0; i < length; i++) {
+    crc = kCrc32Table.values[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+// private
+
+void DirectoryArchive::scan(const std::string& directory,
+                            const std::string& root_name) {
+  namespace fs = std::filesystem;
+
+  struct stat info;
+  if (lstat(directory.c_str(), &info) == -1 || !S_ISDIR(info.st_mode)) {
+    throw std::runtime_error("Not a directory: " + directory);
+  }
+  addEntry(directory, root_name + "/", info);
+
+  const fs::path base(directory);
+  for (fs::recursive_directory_iterator
+           it(base, fs::directory_options::skip_permission_denied),
+       end;
+       it != end; ++it) {
+    const fs::path& path = it->path();
+    if (path.filename().string()[0] == '.' ||
+        lstat(path.c_str(), &info) == -1 ||
+        (!S_ISDIR(info.st_mode) && !S_ISREG(info.st_mode))) {
+      it.disable_recursion_pending();
+      continue;
+    }
+    std::string name = root_name + "/" + path.lexically_relative(base).string();
+    if (S_ISDIR(info.st_mode)) {
+      name += '/';
+    }
+    addEntry(path.string(), name, info);
+    if (_entries.size() > ARCHIVE_MAX_ENTRIES) {
+      throw std::runtime_error("Directory has more than " +
+                               std::to_string(ARCHIVE_MAX_ENTRIES) +
+                               " entries: " + directory);
+    }
+  }
+  std::sort(_entries.begin(), _entries.end(),
+            [](const Entry& a, const Entry& b) { return a.name < b.name; });
+
+  for (const Entry& entry : _entries) {
+    if (_format == Format::TAR) {
+      _size += tarHeader(entry).size() + roundToBlock(entry.size);
+    } else {
+      _size += zipLocalHeader(entry).size() + entry.size +
+               (entry.directory ? 0 : zipDataDescriptor(entry).size()) +
+               zipCentralHeader(entry).size();
+    }
+  }
+  _size += (_format == Format::TAR) ? 2 * TAR_BLOCK : zipEndRecord().size();
+  if (_format == Format::ZIP && _size > ARCHIVE_ZIP_MAX_SIZE) {
+    throw std::runtime_error("Directory is too large for zip, use tar: " +
+                             directory);
+  }
+}
+
+void DirectoryArchive::addEntry(const std::string& path,
+                                const std::string& name,
+                                const struct stat& info) {
+  Entry entry;
+  entry.path = path;
+  entry.name = name;
+  entry.directory = S_ISDIR(info.st_mode);
+  entry.size = entry.directory ? 0 : static_cast<uint64_t>(info.st_size);
+  entry.mode = info.st_mode;
+  entry.mtime = info.st_mtime;
+  _entries.push_back(std::move(entry));
+}
+
+void DirectoryArchive::openEntry(Entry& entry) {
+  _data_sent = 0;
+  entry.crc = 0;
+  _fd = open(entry.path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+  if (_fd == -1) {
+    Logger::warning("Archive: failed to open " + entry.path + ": " +
+                    strerror(errno) + ", sending zeros");
+  }
+}
+
+void DirectoryArchive::closeEntry(void) {
+  if (_fd >= 0) {
+    close(_fd);
+    _fd = -1;
+  }
+}
+
+/**
+ * @brief Reads the next chunk of the entry's file into the buffer
+ *
+ * Whatever the file doesn't have anymore (shrunk, unreadable) is sent as
+ * zeros, the CRC covers exactly the bytes sent.
+ */
+void DirectoryArchive::appendData(std::string& buffer, Entry& entry) {
+  size_t length = static_cast<size_t>(
+      std::min<uint64_t>(entry.size - _data_sent, ARCHIVE_READ_CHUNK));
+  size_t start = buffer.size();
+  buffer.resize(start + length, '\0');
+
+  size_t got = 0;
+  while (_fd >= 0 && got < length) {
+    ssize_t bytes = pread(_fd, &buffer[start + got], length - got,
+                          static_cast<off_t>(_data_sent + got));
+    if (bytes == -1 && errno == EINTR) {
+      continue;
+    }
+    if (bytes <= 0) {
+      Logger::warning("Archive: " + entry.path +
+                      " changed while it was read, padding with zeros");
+      closeEntry();
+      break;
+    }
+    got += static_cast<size_t>(bytes);
+  }
+
+  if (_format == Format::ZIP) {
+    entry.crc = crc32(entry.crc, buffer.data() + start, length);
+  }
+  _data_sent += length;
+  _produced += length;
+  if (_data_sent == entry.size) {
+    _phase = Phase::ENTRY_END;
+  }
+}
+
+void DirectoryArchive::append(std::string& buffer, std::string_view bytes) {
+  buffer.append(bytes);
+  _produced += bytes.size();
+}
+
+/**
+ * @brief ustar header of the entry, preceded by a pax header when the name
+ *        or the size doesn't fit ustar fields
+ */
+std::string DirectoryArchive::tarHeader(const Entry& entry) const {
+  std::string_view name = entry.name;
+  std::string_view prefix;
+  std::string pax;
+
+  if (name.size() > 100) {
+    // split at a slash into prefix (155) and name (100)
+    size_t slash =
+        name.find_last_of('/', std::min<size_t>(155, name.size() - 2));
+    if (slash != std::string_view::npos && slash > 0 &&
+        name.size() - slash - 1 <= 100) {
+      prefix = name.substr(0, slash);
+      name = name.substr(slash + 1);
+    } else {
+      pax += paxRecord("path", entry.name);
+    }
+  }
+  if (entry.size > TAR_MAX_OCTAL_SIZE) {
+    pax += paxRecord("size", std::to_string(entry.size));
+  }
+
+  std::string header;
+  if (!pax.empty()) {
+    header = ustarBlock("././@PaxHeader", "", 0644, pax.size(), entry.mtime,
+                        'x');
+    header += pax;
+    header.resize(roundToBlock(header.size()), '\0');
+  }
+  header += ustarBlock(name, prefix, entry.mode, entry.size, entry.mtime,
+                       entry.directory ? '5' : '0');
+  return header;
+}
+
+std::string DirectoryArchive::zipLocalHeader(const Entry& entry) const {
+  uint32_t date = 0;
+  uint32_t time = 0;
+  dosDateTime(entry.mtime, date, time);
+
+  std::string header;
+  put32(header, 0x04034b50);
+  put16(header, 20);  // version needed: 2.0
+  put16(header, zipFlags(entry.directory));
+  put16(header, 0);  // stored
+  put16(header, time);
+  put16(header, date);
+  put32(header, 0);  // CRC follows the data
+  put32(header, entry.size);
+  put32(header, entry.size);
+  put16(header, static_cast<uint32_t>(entry.name.size()));
+  put16(header, 0);  // extra field
+  header += entry.name;
+  return header;
+}
+
+std::string DirectoryArchive::zipDataDescriptor(const Entry& entry) const {
+  std::string descriptor;
+  put32(descriptor, 0x08074b50);
+  put32(descriptor, entry.crc);
+  put32(descriptor, entry.size);
+  put32(descriptor, entry.size);
+  return descriptor;
+}
+
+std::string DirectoryArchive::zipCentralHeader(const Entry& entry) const {
+  uint32_t date = 0;
+  uint32_t time = 0;
+  dosDateTime(entry.mtime, date, time);
+  uint64_t attributes = static_cast<uint64_t>(entry.mode & 0xFFFF) << 16;
+  if (entry.directory) {
+    attributes |= 0x10;  // MS-DOS directory bit
+  }
+
+  std::string header;
+  put32(header, 0x02014b50);
+  put16(header, 0x031E);  // made by: Unix, version 3.0
+  put16(header, 20);
+  put16(header, zipFlags(entry.directory));
+  put16(header, 0);
+  put16(header, time);
+  put16(header, date);
+  put32(header, entry.crc);
+  put32(header, entry.size);
+  put32(header, entry.size);
+  put16(header, static_cast<uint32_t>(entry.name.size()));
+  put16(header, 0);  // extra field
+  put16(header, 0);  // comment
+  put16(header, 0);  // disk number
+  put16(header, 0);  // internal attributes
+  put32(header, attributes);
+  put32(header, entry.offset);
+  header += entry.name;
+  return header;
+}
+
+std::string DirectoryArchive::zipEndRecord(void) const {
+  std::string record;
+  put32(record, 0x06054b50);
+  put16(record, 0);  // this disk
+  put16(record, 0);  // disk of the central directory
+  put16(record, static_cast<uint32_t>(_entries.size()));
+  put16(record, static_cast<uint32_t>(_entries.size()));
+  put32(record, _central_size);
+  put32(record, _produced - _central_size);
+  put16(record, 0);  // comment
+  return record;
+}
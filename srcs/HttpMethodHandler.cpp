@@ -9,25 +9,42 @@
 
 #include "HttpMethodHandler.hpp"
 
+#include <sys/stat.h>
+
+#include "AccessList.hpp"
+#include "AdminHandler.hpp"
+#include "CachePolicy.hpp"
+#include "DirectoryArchive.hpp"
+#include "ResumableUpload.hpp"
+#include "UploadStore.hpp"
+
 // public methods
 
 /**
  * @brief Processes an HTTP request and returns the appropriate response
  *
- * This is the main entry point for HTTP method processing. It analyzes the
- * request method and routes it to the appropriate handler (GET, POST, DELETE).
- * The method also validates permissions and applies location-specific rules.
+ * This is the main entry point for HTTP method processing. Bulk redirects of
+ * the server are checked first, then the request runs through the phase
+ * handlers of its location (see RequestPipeline.hpp).
  *
  * @param request The HTTP request object containing method, URI, headers, and
  * body
+ * @param config Server block the request was sent to
  * @return HttpResponse object containing the complete response
  */
 HttpResponse HttpMethodHandler::processMethod(
     const HttpRequest& request, const ConfigParser::ServerConfig& config) {
   HttpResponse response;
-  const std::string uri = request.getRequestTarget();
+  const std::string& uri = request.getPath();
+
+  // bulk redirects of the server are checked before any location
+  std::string url;
+  int code = 0;
+  if (findServerRedirect(request, config, url, code)) {
+    return redirectTo(url, code);
+  }
 
-  // find the longest match of location (config) for given target URI
+  // find the best match of location (config) for the normalized path
   const ConfigParser::LocationConfig* location =
       HttpUtils::getLocation(uri, config);
   if (!location) {
@@ -36,68 +53,221 @@ HttpResponse HttpMethodHandler::processMethod(
     return response;
   }
 
-  if (request.getBodyLength() >= location->client_max_body_size) {
-    std::ostringstream error_msg;
-    error_msg << "Request body size (" << request.getBodyLength()
-              << " bytes) exceeds limit (" << location->client_max_body_size
-              << " bytes) for " << request.getMethod() << " request";
-    response.setErrorResponse(HttpUtils::HttpStatusCode::PAYLOAD_TOO_LARGE,
-                              error_msg.str());
-    return response;
+  RequestContext context{*this, request, config, *location, response, ""};
+  getPipeline(*location)->run(context);
+  return response;
+}
+
+/**
+ * @brief Registers handler for locations with `admin_endpoint on;`
+ * @param admin_handler Admin handler or nullptr to disable admin locations
+ */
+void HttpMethodHandler::setAdminHandler(AdminHandler* admin_handler) {
+  _admin_handler = admin_handler;
+}
+
+/**
+ * @brief Tells if the body of a request can be spliced to a file
+ *
+ * Called once the head is parsed and the body is still on its way. Only
+ * requests handlePostMethod() would store by name qualify: a raw POST with
+ * a Content-Length, to a location with `upload_splice on;`. The location's
+ * own rewrite and access phases decide if it is refused (RequestPipeline::
+ * admits()), its file path phase maps the URI, and no other content handler
+ * (admin, CGI) may take it. Everything else keeps the buffered body, the
+ * phases still run once it is complete.
+ *
+ * @param request Request with the head parsed
+ * @param config Server block the request was sent to
+ * @param directory [out] Upload directory of the request
+ * @return true if the body can go to a temporary file in directory
+ */
+bool HttpMethodHandler::findSpliceDirectory(
+    const HttpRequest& request, const ConfigParser::ServerConfig& config,
+    std::string& directory) {
+  if (request.getMethodCode() != HttpMethod::POST ||
+      request.getChunkedStatus() || request.hasHeader("Upload-Length") ||
+      request.getHeader("Content-Type").find("multipart/form-data") !=
+          std::string::npos) {
+    return false;
+  }
+  std::string url;
+  int code = 0;
+  if (findServerRedirect(request, config, url, code)) {
+    return false;
+  }
+  const ConfigParser::LocationConfig* location =
+      HttpUtils::getLocation(request.getPath(), config);
+  if (!location || !location->upload_splice || location->upload_by_digest ||
+      location->admin_endpoint ||
+      !isAllowedFileType(
+          HttpUtils::getExtension(request.getHeader("Content-Type")))) {
+    return false;
   }
 
-  // check if this location requires redirection to another one
-  if (!location->redirect_url.empty()) {
-    response.setErrorResponse(HttpUtils::HttpStatusCode::MOVED_PERMANENTLY,
-                              "Redirecting to " + location->redirect_url);
-    response.insertHeader("Location", location->redirect_url);
-    return response;
+  HttpResponse refusal;  // made again once the body is complete
+  RequestContext context{*this, request, config, *location, refusal, ""};
+  if (!getPipeline(*location)->admits(context) ||
+      filePathPhase(context) == PhaseResult::DONE ||
+      CgiHandler::isCgiRequest(context.file_path, *location)) {
+    return false;
   }
+  directory = context.file_path;
+  return std::filesystem::is_directory(directory);
+}
+
+/// request phases (composed per location by RequestPipeline::compose())
 
-  // find full path to requested target URI
-  const std::string file_path = HttpUtils::getFilePath(*location, uri);
+/// @brief Rewrite: `return <code> <url>` of the location
+PhaseResult HttpMethodHandler::redirectPhase(RequestContext& context) {
+  context.response = context.handler.redirectTo(
+      context.location.redirect_url, context.location.redirect_code);
+  return PhaseResult::DONE;
+}
+
+/// @brief Access: 403 for clients the `allow`/`deny` rules refuse
+PhaseResult HttpMethodHandler::clientAccessPhase(RequestContext& context) {
+  const ClientAddress& client = context.request.getClientAddress();
+  if (context.location.access->isAllowed(client)) {
+    return PhaseResult::NEXT;
+  }
+  context.response.setErrorResponse(HttpUtils::HttpStatusCode::FORBIDDEN,
+                                    "Access denied for " + client.toString());
+  return PhaseResult::DONE;
+}
+
+/// @brief Access: 413 if the body reaches `client_max_body_size`
+PhaseResult HttpMethodHandler::bodySizePhase(RequestContext& context) {
+  const HttpRequest& request = context.request;
+  const ConfigParser::LocationConfig& location = context.location;
+  if (request.getBodyLength() < location.client_max_body_size) {
+    return PhaseResult::NEXT;
+  }
+  std::ostringstream error_msg;
+  error_msg << "Request body size (" << request.getBodyLength()
+            << " bytes) exceeds limit (" << location.client_max_body_size
+            << " bytes) for " << request.getMethod() << " request";
+  context.response.setErrorResponse(
+      HttpUtils::HttpStatusCode::PAYLOAD_TOO_LARGE, error_msg.str());
+  return PhaseResult::DONE;
+}
+
+/// @brief Access: 405 if the method isn't in `allow_methods`
+PhaseResult HttpMethodHandler::allowedMethodPhase(RequestContext& context) {
+  const std::string& method = context.request.getMethod();
+  if (HttpUtils::isMethodAllowed(context.location, method)) {
+    return PhaseResult::NEXT;
+  }
+  context.response.setErrorResponse(
+      HttpUtils::HttpStatusCode::METHOD_NOT_ALLOWED,
+      "Method " + method + " not allowed");
+  return PhaseResult::DONE;
+}
+
+/// @brief Content: `admin_endpoint on;` (if an admin handler is registered)
+PhaseResult HttpMethodHandler::adminPhase(RequestContext& context) {
+  if (context.handler._admin_handler == nullptr) {
+    return PhaseResult::NEXT;
+  }
+  context.response =
+      context.handler._admin_handler->handle(context.request, context.location);
+  return PhaseResult::DONE;
+}
+
+/// @brief Content: GETs of a packed site, hits need no file system access
+PhaseResult HttpMethodHandler::bundlePhase(RequestContext& context) {
+  AssetBundle::Asset asset;
+  if (context.request.getMethodCode() != HttpMethod::GET ||
+      !context.handler.findBundleAsset(context.location,
+                                       context.request.getPath(), asset)) {
+    return PhaseResult::NEXT;
+  }
+  context.response = context.handler.serveBundleAsset(
+      context.request, context.location, asset);
+  return PhaseResult::DONE;
+}
+
+/// @brief Content: maps the URI to a file under root, 404 if it escapes it
+PhaseResult HttpMethodHandler::filePathPhase(RequestContext& context) {
+  const std::string& uri = context.request.getPath();
+  context.file_path = HttpUtils::getFilePath(context.location, uri);
   std::string message = "";
-  if (!HttpUtils::isFilePathSecure(file_path, location->root, message)) {
-    Logger::warning("Possible security problem " + uri);
-    Logger::warning("Failed to resolve uri " + uri + ": " + message);
-    response.setErrorResponse(HttpUtils::HttpStatusCode::NOT_FOUND,
-                              "Page/file doesn't exist");
-    return response;
+  if (HttpUtils::isFilePathSecure(context.file_path, context.location.root,
+                                  message)) {
+    return PhaseResult::NEXT;
   }
+  Logger::warning("Possible security problem " + uri);
+  Logger::warning("Failed to resolve uri " + uri + ": " + message);
+  context.response.setErrorResponse(HttpUtils::HttpStatusCode::NOT_FOUND,
+                                    "Page/file doesn't exist");
+  return PhaseResult::DONE;
+}
 
-  // check if method is allowed by location in config file
-  if (!HttpUtils::isMethodAllowed(*location, request.getMethod())) {
-    response.setErrorResponse(HttpUtils::HttpStatusCode::METHOD_NOT_ALLOWED,
-                              "Method " + request.getMethod() + " not allowed");
-    return response;
+/// @brief Content: scripts of `cgi_ext`, within the CGI quota of the vhost
+PhaseResult HttpMethodHandler::cgiPhase(RequestContext& context) {
+  if (!CgiHandler::isCgiRequest(context.file_path, context.location)) {
+    return PhaseResult::NEXT;
   }
+  const ConfigParser::ServerConfig& config = context.server;
+  if (!VhostQuota::acquireCgiProcess(config)) {
+    VhostQuota::countRejected(config);
+    context.response.setErrorResponse(
+        HttpUtils::HttpStatusCode::SERVICE_UNAVAILABLE,
+        "Too many CGI processes for " + VhostQuota::getServerLabel(config));
+    context.response.insertHeader("Retry-After", "1");
+    return PhaseResult::DONE;
+  }
+  Logger::info("Processing CGI request :" + context.request.getPath());
+  context.response = CgiHandler::execute(context.request, context.location,
+                                         context.file_path);
+  VhostQuota::releaseCgiProcess(config);
+  return PhaseResult::DONE;
+}
 
-  if (CgiHandler::isCgiRequest(file_path, *location)) {
-    Logger::info("Processing CGI request :" + uri);
-    return CgiHandler::execute(request, *location, file_path);
+/// @brief Content: PATCH/HEAD and creating POSTs of resumable uploads
+PhaseResult HttpMethodHandler::resumableUploadPhase(RequestContext& context) {
+  const HttpMethod method_code = context.request.getMethodCode();
+  if (method_code != HttpMethod::PATCH && method_code != HttpMethod::HEAD &&
+      (method_code != HttpMethod::POST ||
+       !context.request.hasHeader("Upload-Length"))) {
+    return PhaseResult::NEXT;
   }
+  context.response = context.handler.handleResumableUpload(
+      context.file_path, context.request, context.location);
+  return PhaseResult::DONE;
+}
 
-  // perform method GET, POST or DELETE or give error
-  const HttpMethod method_code = request.getMethodCode();
-  switch (method_code) {
+/// @brief Content: GET, POST or DELETE of files, 501 for other methods
+PhaseResult HttpMethodHandler::methodPhase(RequestContext& context) {
+  HttpMethodHandler& handler = context.handler;
+  switch (context.request.getMethodCode()) {
     case HttpMethod::GET:
-      response = handleGetMethod(file_path, uri, *location);
+      context.response = handler.handleGetMethod(
+          context.file_path, context.request, context.location);
       break;
     case HttpMethod::POST:
-      response = handlePostMethod(file_path, request);
+      context.response = handler.handlePostMethod(
+          context.file_path, context.request, context.location);
       break;
     case HttpMethod::DELETE:
-      response = handleDeleteMethod(file_path);
+      context.response = handler.handleDeleteMethod(context.file_path);
       break;
 
     default:
-      response.setErrorResponse(
+      context.response.setErrorResponse(
           HttpUtils::HttpStatusCode::NOT_IMPLEMENTED,
-          "Method " + request.getMethod() + " not implemented");
+          "Method " + context.request.getMethod() + " not implemented");
       break;
   }
+  return PhaseResult::DONE;
+}
 
-  return response;
+/// @brief Filter: `limit_rate` of the location
+PhaseResult HttpMethodHandler::rateLimitPhase(RequestContext& context) {
+  const ConfigParser::LocationConfig& location = context.location;
+  context.response.setRateLimit(location.limit_rate, location.limit_rate_after,
+                                location.limit_rate_kernel);
+  return PhaseResult::NEXT;
 }
 
 /// protected methods
@@ -107,20 +277,23 @@ HttpResponse HttpMethodHandler::processMethod(
  *
  * Processes GET requests by serving static files or generating directory
  * listings based on the requested path and location configuration.
+ * With auto-index on, `?archive=tar|zip` on a directory downloads it.
  *
  * @param path The file system path to the requested resource
- * @param uri The original URI from the request
+ * @param request The HTTP request (URI, query and Accept-Encoding)
  * @param location The location configuration block that matches this request
  *
  * @return HttpResponse containing the file content or directory listing
  *
  * @see serveStaticFile()
  * @see serveDirectoryContent()
+ * @see serveDirectoryArchive()
  */
 HttpResponse HttpMethodHandler::handleGetMethod(
-    const std::string& path, const std::string& uri,
+    const std::string& path, const HttpRequest& request,
     const ConfigParser::LocationConfig& location) {
   HttpResponse response;
+  const std::string& uri = request.getPath();
 
   // check if file/directory exists
   if (!std::filesystem::exists(path)) {
@@ -131,6 +304,12 @@ HttpResponse HttpMethodHandler::handleGetMethod(
 
   // check if it's a directory
   if (std::filesystem::is_directory(path)) {
+    std::string_view archive =
+        HttpUtils::getQueryParameter(request.getQuery(), "archive");
+    if (location.autoindex && !archive.empty()) {
+      return serveDirectoryArchive(path, uri, archive);
+    }
+
     // check if we have default file to serve
     if (!location.index.empty()) {
       std::string index_path = path;
@@ -140,8 +319,10 @@ HttpResponse HttpMethodHandler::handleGetMethod(
       index_path += location.index;
       if (std::filesystem::exists(index_path) &&
           std::filesystem::is_regular_file(index_path)) {
-        Logger::info("Serving file: " + index_path);
-        return serveStaticFile(index_path);
+        if (Logger::isEnabled()) {
+          Logger::info("Serving file: " + index_path);
+        }
+        return serveStaticFile(index_path, request, location);
       }
     }
 
@@ -158,8 +339,10 @@ HttpResponse HttpMethodHandler::handleGetMethod(
 
   // handle requested file
   if (std::filesystem::is_regular_file(path)) {
-    Logger::info("Serving file: " + path);
-    response = serveStaticFile(path);
+    if (Logger::isEnabled()) {
+      Logger::info("Serving file: " + path);
+    }
+    response = serveStaticFile(path, request, location);
   } else {
     response.setErrorResponse(HttpUtils::HttpStatusCode::FORBIDDEN,
                               "Access denied: " + path);
@@ -168,9 +351,21 @@ HttpResponse HttpMethodHandler::handleGetMethod(
   return response;
 }
 
-/// @warning IT IS PLACEHOLDER, implementation needed
-HttpResponse HttpMethodHandler::handlePostMethod(const std::string& path,
-                                                 const HttpRequest& request) {
+/**
+ * @brief Handles HTTP POST requests (file uploads)
+ *
+ * Multipart bodies are split into files, other bodies are stored as one
+ * file of the Content-Type's extension. With `upload_store digest;` files
+ * are stored under their SHA-256 digest and the digest is returned.
+ *
+ * @param path Upload directory
+ * @param request The HTTP request with the uploaded content
+ * @param location The location configuration block that matches this request
+ * @return 201 Created (200 OK if a digest store already had the content)
+ */
+HttpResponse HttpMethodHandler::handlePostMethod(
+    const std::string& path, const HttpRequest& request,
+    const ConfigParser::LocationConfig& location) {
   HttpResponse response;
 
   // check if file/directory exists
@@ -183,7 +378,7 @@ HttpResponse HttpMethodHandler::handlePostMethod(const std::string& path,
   // proccess file uploading depending on content type
   std::string content_type = request.getHeader("Content-Type");
   if (content_type.find("multipart/form-data") != std::string::npos) {
-    return handleMultipartFileUpload(request, path, content_type);
+    return handleMultipartFileUpload(request, path, content_type, location);
   }
 
   std::string extension = HttpUtils::getExtension(content_type);
@@ -194,10 +389,21 @@ HttpResponse HttpMethodHandler::handlePostMethod(const std::string& path,
     return response;
   }
 
-  // try to upload file
+  if (location.upload_by_digest) {
+    return storeUploadByDigest(request, path, extension, location);
+  }
+
+  // try to upload file (a spliced body is in a temporary file already)
   std::string file_name = generateFileName(extension);
   std::string error_msg = "";
-  if (!saveUploadedFile(path, file_name, request.getBody(), error_msg)) {
+  SplicedBody* spliced_body = request.getSplicedBody();
+  bool saved =
+      (spliced_body != nullptr)
+          ? spliced_body->publish(UploadStore::joinPath(path, file_name),
+                                  location.upload_durability, error_msg)
+          : saveUploadedFile(path, file_name, request.getBody(),
+                             location.upload_durability, error_msg);
+  if (!saved) {
     response.setErrorResponse(HttpUtils::HttpStatusCode::INTERNAL_SERVER_ERROR,
                               "Failed to upload file to " + path);
     return response;
@@ -207,6 +413,128 @@ HttpResponse HttpMethodHandler::handlePostMethod(const std::string& path,
   return response;
 }
 
+/**
+ * @brief Handles requests of the resumable upload protocol
+ *
+ * - POST with Upload-Length (and the file name in Upload-Metadata) creates
+ *   an upload in the directory `path`: 201 with its URL in Location;
+ * - HEAD `<location>/<id>`: 200 with Upload-Offset and Upload-Length;
+ * - PATCH `<location>/<id>` with Upload-Offset and a body of type
+ *   application/offset+octet-stream: 204 with the new Upload-Offset, the
+ *   last piece moves the file to its final name.
+ *
+ * @param path Upload directory (POST) or `<upload directory>/<id>`
+ * @param request The HTTP request
+ * @param location The location configuration block that matches this request
+ * @return HttpResponse with the tus headers
+ * @see ResumableUpload.hpp
+ */
+HttpResponse HttpMethodHandler::handleResumableUpload(
+    const std::string& path, const HttpRequest& request,
+    const ConfigParser::LocationConfig& location) {
+  HttpResponse response;
+  response.insertHeader("Tus-Resumable", RESUMABLE_PROTOCOL_VERSION);
+  const HttpMethod method_code = request.getMethodCode();
+  std::string error_msg;
+
+  if (method_code == HttpMethod::POST) {
+    uint64_t length = 0;
+    std::string file_name =
+        ResumableUpload::getMetadataFileName(request.getHeader("Upload-Metadata"));
+    std::string extension = std::filesystem::path(file_name).extension();
+    if (!parseUnsigned(request.getHeader("Upload-Length"), length)) {
+      response.setErrorResponse(HttpUtils::HttpStatusCode::BAD_REQUEST,
+                                "Invalid Upload-Length");
+    } else if (file_name.empty()) {
+      response.setErrorResponse(HttpUtils::HttpStatusCode::BAD_REQUEST,
+                                "Upload-Metadata must contain the filename");
+    } else if (extension.empty() || !isAllowedFileType(extension.substr(1))) {
+      response.setErrorResponse(
+          HttpUtils::HttpStatusCode::FORBIDDEN,
+          "Uploaded content type is not allowed: " + file_name);
+    } else if (!std::filesystem::is_directory(path)) {
+      response.setErrorResponse(HttpUtils::HttpStatusCode::NOT_FOUND,
+                                "Upload directory not found: " + path);
+    } else {
+      std::string id;
+      HttpUtils::HttpStatusCode status = ResumableUpload::create(
+          path, length, file_name, location.upload_durability, id, error_msg);
+      if (status != HttpUtils::HttpStatusCode::CREATED) {
+        Logger::error("Failed to create upload in " + path + ": " + error_msg);
+        response.setErrorResponse(status, "Failed to create upload");
+        return response;
+      }
+      Logger::info("Created resumable upload " + id + " (" + file_name + ", " +
+                   std::to_string(length) + " bytes)");
+      response.setStatusCode(status);
+      response.insertHeader("Location",
+                            UploadStore::joinPath(request.getPath(), id));
+      response.insertHeader("Upload-Offset", "0");
+    }
+    return response;
+  }
+
+  size_t slash = path.rfind('/');
+  std::string directory = path.substr(0, slash);
+  std::string id = path.substr(slash + 1);
+  ResumableUpload::State state;
+
+  if (method_code == HttpMethod::HEAD) {
+    // no body, not even an error page
+    HttpUtils::HttpStatusCode status =
+        ResumableUpload::getState(directory, id, state, error_msg);
+    response.setStatusCode(status);
+    if (status == HttpUtils::HttpStatusCode::OK) {
+      response.insertHeader("Upload-Offset", std::to_string(state.offset));
+      response.insertHeader("Upload-Length", std::to_string(state.length));
+    }
+    response.insertHeader("Cache-Control", "no-store");
+    return response;
+  }
+
+  uint64_t offset = 0;
+  if (request.getHeader("Content-Type") != "application/offset+octet-stream") {
+    response.setErrorResponse(
+        HttpUtils::HttpStatusCode::UNSUPPORTED_MEDIA_TYPE,
+        "PATCH body must be application/offset+octet-stream");
+    return response;
+  }
+  if (!parseUnsigned(request.getHeader("Upload-Offset"), offset)) {
+    response.setErrorResponse(HttpUtils::HttpStatusCode::BAD_REQUEST,
+                              "Invalid Upload-Offset");
+    return response;
+  }
+
+  HttpUtils::HttpStatusCode status = ResumableUpload::append(
+      directory, id, offset, request.getBody(), location.upload_durability,
+      state, error_msg);
+  if (status != HttpUtils::HttpStatusCode::NO_CONTENT) {
+    response.setErrorResponse(status, error_msg);
+    return response;
+  }
+  response.setStatusCode(status);
+  response.insertHeader("Upload-Offset", std::to_string(state.offset));
+  if (state.complete) {
+    Logger::info("Completed resumable upload " + id + " as " +
+                 state.file_name);
+    std::string uri = request.getPath();
+    response.insertHeader(
+        "Location", uri.substr(0, uri.rfind('/') + 1) + state.file_name);
+  }
+  return response;
+}
+
+/// @brief Parses a header value of decimal digits only (no sign, no spaces)
+bool HttpMethodHandler::parseUnsigned(const std::string& value,
+                                      uint64_t& result) {
+  if (value.empty() || value.size() > 19 ||
+      value.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+  result = std::stoull(value);
+  return true;
+}
+
 /**
  * @brief Handles HTTP DELETE requests for the specified file path.
  *
@@ -255,6 +583,51 @@ HttpResponse HttpMethodHandler::handleDeleteMethod(const std::string& path) {
 
 /// Helper functions
 
+/**
+ * @brief Builds redirect response
+ * @param url Value of the Location header
+ * @param code Redirect status code (301, 302, 303, 307 or 308)
+ * @return HttpResponse with the redirect
+ */
+HttpResponse HttpMethodHandler::redirectTo(const std::string& url, int code) {
+  HttpResponse response;
+  response.setErrorResponse(static_cast<HttpUtils::HttpStatusCode>(code),
+                            "Redirecting to " + url);
+  response.insertHeader("Location", url);
+  return response;
+}
+
+/**
+ * @brief Looks the request up in the bulk redirects of the server
+ * @param url [out] Target, the query of the request is kept unless it has one
+ * @param code [out] Redirect status code
+ * @return true if the request is redirected before any location
+ */
+bool HttpMethodHandler::findServerRedirect(
+    const HttpRequest& request, const ConfigParser::ServerConfig& config,
+    std::string& url, int& code) {
+  if (!config.redirects ||
+      !config.redirects->resolve(request.getPath(), url, code)) {
+    return false;
+  }
+  if (request.hasQuery() && url.find('?') == std::string::npos) {
+    url.append("?").append(request.getQuery());
+  }
+  return true;
+}
+
+/**
+ * @brief Phases of a location, composed per request for locations that
+ *        weren't made by the config parser
+ */
+std::shared_ptr<const RequestPipeline> HttpMethodHandler::getPipeline(
+    const ConfigParser::LocationConfig& location) {
+  if (location.pipeline) {
+    return location.pipeline;
+  }
+  return RequestPipeline::compose(location);
+}
+
 /**
  * @brief Serves a static file from the file system
  *
@@ -262,24 +635,166 @@ HttpResponse HttpMethodHandler::handleDeleteMethod(const std::string& path) {
  * appropriate headers including Content-Type, Content-Length, and caching
  * headers.
  *
+ * With `gzip_static` (`brotli_static`, `zstd_static`) a precompressed
+ * variant of the file is sent instead if the client accepts it. Caching
+ * headers come from the location's `expires`, `add_header` and
+ * `immutable_pattern`.
+ *
  * @param path The file system path to the file to serve
+ * @param request The HTTP request (Accept-Encoding)
+ * @param location Location block (its `types {}` table gives Content-Type)
  * @return HttpResponse containing the file content and appropriate headers
  */
-HttpResponse HttpMethodHandler::serveStaticFile(const std::string& path) {
+HttpResponse HttpMethodHandler::serveStaticFile(
+    const std::string& path, const HttpRequest& request,
+    const ConfigParser::LocationConfig& location) {
   HttpResponse response;
   std::string body = "";
 
-  if (HttpUtils::getFileContent(path, body) == -1) {
-    Logger::error(body + ": " + path);
+  std::string variant;
+  std::string_view coding;
+  bool precompressed =
+      findPrecompressed(path, request, location, variant, coding);
+  const std::string& file = precompressed ? variant : path;
+  if (HttpUtils::getFileContent(file, body) == -1) {
+    Logger::error(body + ": " + file);
     response.setErrorResponse(HttpUtils::HttpStatusCode::FORBIDDEN,
                               "Access denied: " + path);
     return response;
   }
-  response.setBody(body, HttpUtils::getMIME(path));
+  if (location.gzip_static || location.brotli_static || location.zstd_static) {
+    response.insertHeader("Vary", "Accept-Encoding");
+  }
+  if (precompressed) {
+    response.insertHeader("Content-Encoding", std::string(coding));
+  }
+  if (location.cache_policy) {
+    location.cache_policy->apply(request.getPath(), response);
+  }
+  response.setBody(body,
+                   HttpUtils::getMIME(path, location.mime_types.get()));
   response.setStatusCode(HttpUtils::HttpStatusCode::OK);
   return response;
 }
 
+/**
+ * @brief Picks the precompressed variant of a file to send
+ *
+ * Variants are preferred in the order br, zstd, gzip (smallest first). One
+ * older than the file itself is out of date and ignored.
+ *
+ * @param path The file system path to the requested file
+ * @param request The HTTP request (Accept-Encoding)
+ * @param location Location block with `*_static` switches
+ * @param variant [out] Path of the variant
+ * @param coding [out] Its content coding
+ * @return true if a variant should be sent
+ */
+bool HttpMethodHandler::findPrecompressed(
+    const std::string& path, const HttpRequest& request,
+    const ConfigParser::LocationConfig& location, std::string& variant,
+    std::string_view& coding) {
+  const struct {
+    bool enabled;
+    std::string_view coding;
+    const char* suffix;
+  } encodings[] = {{location.brotli_static, "br", ".br"},
+                   {location.zstd_static, "zstd", ".zst"},
+                   {location.gzip_static, "gzip", ".gz"}};
+
+  const std::string& accept = request.getHeader("Accept-Encoding");
+  struct stat source;
+  bool source_known = false;
+  for (const auto& encoding : encodings) {
+    if (!encoding.enabled ||
+        !HttpUtils::acceptsEncoding(accept, encoding.coding)) {
+      continue;
+    }
+    if (!source_known && stat(path.c_str(), &source) == -1) {
+      return false;
+    }
+    source_known = true;
+    variant = path + encoding.suffix;
+    struct stat info;
+    if (stat(variant.c_str(), &info) == 0 && S_ISREG(info.st_mode) &&
+        info.st_mtime >= source.st_mtime) {
+      coding = encoding.coding;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Looks up request path in the location's bundle
+ *
+ * A path ending with '/' is looked up with the location's index appended.
+ *
+ * @param location Location with `bundle`
+ * @param uri Normalized request path
+ * @param asset [out] Asset if found
+ * @return true if the bundle has the path
+ */
+bool HttpMethodHandler::findBundleAsset(
+    const ConfigParser::LocationConfig& location, const std::string& uri,
+    AssetBundle::Asset& asset) {
+  if (!uri.empty() && uri.back() == '/') {
+    return !location.index.empty() &&
+           location.bundle->find(uri + location.index, asset);
+  }
+  return location.bundle->find(uri, asset);
+}
+
+/**
+ * @brief Answers GET from an asset bundle
+ *
+ * The gzip variant is sent if there is one and the client accepts it
+ * (it has its own ETag). If-None-Match with the current ETag gives 304.
+ * Both carry the caching headers of the location.
+ *
+ * @param request The HTTP request
+ * @param location Location with `bundle`
+ * @param asset Asset found by findBundleAsset()
+ * @return 200 OK with the asset, or 304 Not Modified
+ */
+HttpResponse HttpMethodHandler::serveBundleAsset(
+    const HttpRequest& request, const ConfigParser::LocationConfig& location,
+    const AssetBundle::Asset& asset) {
+  HttpResponse response;
+  bool gzip = asset.gzip_length > 0 &&
+              HttpUtils::acceptsEncoding(request.getHeader("Accept-Encoding"),
+                                         "gzip");
+  std::string etag = "\"";
+  etag.append(asset.etag).append(gzip ? "-gzip\"" : "\"");
+  response.insertHeader("ETag", etag);
+  if (asset.gzip_length > 0) {
+    response.insertHeader("Vary", "Accept-Encoding");
+  }
+  if (location.cache_policy) {
+    location.cache_policy->apply(asset.path, response);
+  }
+  if (HttpUtils::matchesEntityTag(request.getHeader("If-None-Match"), etag)) {
+    response.setStatusCode(HttpUtils::HttpStatusCode::NOT_MODIFIED);
+    return response;
+  }
+
+  uint64_t offset = gzip ? asset.gzip_offset : asset.offset;
+  uint64_t length = gzip ? asset.gzip_length : asset.length;
+  if (gzip) {
+    response.insertHeader("Content-Encoding", "gzip");
+  }
+  response.setStatusCode(HttpUtils::HttpStatusCode::OK);
+  if (length <= BUNDLE_INLINE_MAX) {
+    response.setBody(std::string(location.bundle->data(offset, length)),
+                     asset.content_type);
+  } else {
+    response.setBodySource(
+        std::make_shared<AssetBundle::Body>(location.bundle, offset, length),
+        asset.content_type);
+  }
+  return response;
+}
+
 /**
  * @brief Generates and serves directory listing content
  *
@@ -360,9 +875,101 @@ HttpResponse HttpMethodHandler::serveDirectoryContent(const std::string& path,
   return response;
 }
 
+/**
+ * @brief Streams directory tree as an archive download
+ *
+ * The archive is produced while it is sent (see DirectoryArchive), file
+ * contents are not read into the response.
+ *
+ * @param path The file system path to the directory
+ * @param uri The original URI from the request (names the archive)
+ * @param format_name Value of the `archive` query parameter
+ * @return HttpResponse with the archive as body source
+ */
+HttpResponse HttpMethodHandler::serveDirectoryArchive(
+    const std::string& path, const std::string& uri,
+    std::string_view format_name) {
+  HttpResponse response;
+  DirectoryArchive::Format format;
+  if (!DirectoryArchive::parseFormat(format_name, format)) {
+    response.setErrorResponse(
+        HttpUtils::HttpStatusCode::BAD_REQUEST,
+        "Unsupported archive format: " + std::string(format_name));
+    return response;
+  }
+
+  // archive is named after the last segment of the URI
+  std::string name = uri.substr(0, uri.find_last_not_of('/') + 1);
+  name = name.substr(name.find_last_of('/') + 1);
+  for (char& c : name) {
+    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '-') {
+      c = '_';
+    }
+  }
+  if (name.empty() || name[0] == '.') {
+    name = "archive";
+  }
+
+  try {
+    std::shared_ptr<DirectoryArchive> archive =
+        std::make_shared<DirectoryArchive>(path, name, format);
+    Logger::info("Archiving directory: " + path + " (" +
+                 std::to_string(archive->entryCount()) + " entries, " +
+                 std::to_string(archive->size()) + " bytes)");
+    response.setStatusCode(HttpUtils::HttpStatusCode::OK);
+    response.setBodySource(archive, DirectoryArchive::contentType(format));
+    response.insertHeader("Content-Disposition",
+                          "attachment; filename=\"" + name + "." +
+                              std::string(DirectoryArchive::extension(format)) +
+                              "\"");
+  } catch (const std::exception& e) {
+    Logger::warning("Error archiving directory " + path + ": " + e.what());
+    response.setErrorResponse(HttpUtils::HttpStatusCode::INTERNAL_SERVER_ERROR,
+                              "Failed to archive directory");
+  }
+  return response;
+}
+
+/**
+ * @brief Stores raw request body under its SHA-256 digest
+ *
+ * @param request The HTTP request with the uploaded content
+ * @param path Upload directory
+ * @param extension File extension of the Content-Type
+ * @param location The location configuration block that matches this request
+ * @return 201 with the digest as body and Location of the stored file, 200
+ *         if the same content was stored before
+ */
+HttpResponse HttpMethodHandler::storeUploadByDigest(
+    const HttpRequest& request, const std::string& path,
+    const std::string& extension,
+    const ConfigParser::LocationConfig& location) {
+  HttpResponse response;
+  UploadStore::StoredObject object;
+  std::string error_msg;
+  if (!UploadStore::storeByDigest(path, extension, request.getBody(), object,
+                                  error_msg, location.upload_durability)) {
+    Logger::error("Failed to store upload in " + path + ": " + error_msg);
+    response.setErrorResponse(HttpUtils::HttpStatusCode::INTERNAL_SERVER_ERROR,
+                              "Failed to upload file to " + path);
+    return response;
+  }
+
+  Logger::info((object.created ? "Stored upload " : "Deduplicated upload ") +
+               object.file_name + " (" +
+               std::to_string(request.getBodyLength()) + " bytes)");
+  response.setStatusCode(object.created ? HttpUtils::HttpStatusCode::CREATED
+                                        : HttpUtils::HttpStatusCode::OK);
+  response.insertHeader("Location", UploadStore::joinPath(request.getPath(),
+                                                          object.file_name));
+  response.setBody(object.digest + "\n", "text/plain");
+  return response;
+}
+
 HttpResponse HttpMethodHandler::handleMultipartFileUpload(
     const HttpRequest& request, const std::string& path,
-    const std::string& content_type) {
+    const std::string& content_type,
+    const ConfigParser::LocationConfig& location) {
   HttpResponse response;
   std::vector<std::string> saved_files;
 
@@ -433,11 +1040,23 @@ HttpResponse HttpMethodHandler::handleMultipartFileUpload(
       content_end -= 1;
     }
 
-    std::string file_content =
-        body.substr(content_start, content_end - content_start);
+    std::string_view file_content = std::string_view(body).substr(
+        content_start, content_end - content_start);
 
     std::string error_msg;
-    if (!saveUploadedFile(path, filename, file_content, error_msg)) {
+    if (location.upload_by_digest) {
+      UploadStore::StoredObject object;
+      if (!UploadStore::storeByDigest(path, extension, file_content, object,
+                                      error_msg, location.upload_durability)) {
+        response.setErrorResponse(
+            HttpUtils::HttpStatusCode::INTERNAL_SERVER_ERROR,
+            "Failed to upload file: " + filename + " (" + error_msg + ")");
+        return response;
+      }
+      /// sha256sum format: "<digest>  <client file name>"
+      filename = object.digest + "  " + filename;
+    } else if (!saveUploadedFile(path, filename, file_content,
+                                 location.upload_durability, error_msg)) {
       response.setErrorResponse(
           HttpUtils::HttpStatusCode::INTERNAL_SERVER_ERROR,
           "Failed to upload file: " + filename + " (" + error_msg + ")");
@@ -457,6 +1076,14 @@ HttpResponse HttpMethodHandler::handleMultipartFileUpload(
   }
 
   response.setStatusCode(HttpUtils::HttpStatusCode::CREATED);
+  if (location.upload_by_digest) {
+    std::string digests;
+    for (const std::string& line : saved_files) {
+      digests.append(line).append("\n");
+    }
+    response.setBody(digests, "text/plain");
+    return response;
+  }
   response.setBody(generateUploadSuccessHtml(saved_files), "text/html");
   return response;
 }
@@ -512,35 +1139,14 @@ std::string HttpMethodHandler::getMultipartFileName(const std::string& body,
   return "";
 }
 
-bool HttpMethodHandler::saveUploadedFile(const std::string& upload_dir,
-                                         const std::string& file_name,
-                                         const std::string& content,
-                                         std::string& error_msg) {
-  std::string full_path;
-  if (!upload_dir.empty() && upload_dir.back() == '/')
-    full_path = upload_dir + file_name;
-  else
-    full_path = upload_dir + "/" + file_name;
-
-  if (std::filesystem::exists(full_path)) {
-    error_msg = "File already exists";
-    return false;
-  }
-
-  try {
-    std::ofstream fs(full_path, std::ios::binary);
-    if (!fs) {
-      error_msg = "Failed to open file for writing: " + full_path;
-      return false;
-    }
-    fs << content;
-    fs.close();
-  } catch (const std::exception& e) {
-    error_msg = e.what();
-    return false;
-  }
-
-  return true;
+/// @note The file appears under its name only when complete, an existing
+/// file is never overwritten (even if it appears after the name was chosen)
+bool HttpMethodHandler::saveUploadedFile(
+    const std::string& upload_dir, const std::string& file_name,
+    std::string_view content, ConfigParser::UploadDurability durability,
+    std::string& error_msg) {
+  return UploadStore::writeNewFile(UploadStore::joinPath(upload_dir, file_name),
+                                   content, error_msg, durability);
 }
 
 bool HttpMethodHandler::isAllowedFileType(const std::string& extension) {
@@ -557,19 +1163,29 @@ bool HttpMethodHandler::isAllowedFileType(const std::string& extension) {
   return false;
 }
 
+/**
+ * @brief Generates name of an upload without a client file name
+ *
+ * Date, time with microseconds and a per-process sequence number, e.g.
+ * "10.09.2025-142501-000123-7.png": uploads within the same microsecond
+ * get different names.
+ */
 std::string HttpMethodHandler::generateFileName(const std::string& extension) {
+  static uint64_t sequence = 0;
   auto now = std::chrono::system_clock::now();
   auto time_t = std::chrono::system_clock::to_time_t(now);
   auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(
-      now.time_since_epoch()) % 100000;
-  
+      now.time_since_epoch()) % 1000000;
+
   std::tm tm_buf;
   std::tm* ptm = localtime_r(&time_t, &tm_buf);
   char buf[48];
-  std::strftime(buf, 32, "%d.%m.%Y-%H%M%S", ptm);
-  
+  size_t length = std::strftime(buf, 32, "%d.%m.%Y-%H%M%S", ptm);
+  std::snprintf(buf + length, sizeof(buf) - length, "-%06lld-",
+                static_cast<long long>(microseconds.count()));
+
   std::string result(buf);
-  result += "-" + std::to_string(microseconds.count());
+  result += std::to_string(++sequence);
   return result + "." + extension;
 }
 
@@ -12,21 +12,27 @@
 // Constructor and destructor
 
 HttpRequest::HttpRequest()
-    : _buffer(""),
-      _parsed_buffer_offset(0),
+    : _buffer(),
       _method_code(HttpMethod::UNKNOWN),
       _method_raw(""),
       _request_target(""),
       _http_version(""),
+      _path(""),
+      _query_offset(std::string::npos),
+      _path_hash(0),
       _headers(),
       _body(""),
       _body_length(0),
+      _spliced_body(nullptr),
       _state(HttpParsingState::REQUEST_LINE),
       _is_chanked(false),
       _expected_chunk_length(0),
       _is_error(false),
       _status_code(HttpUtils::HttpStatusCode::I_AM_TEAPOD),
-      _err_message("") {}
+      _err_message(""),
+      _client(),
+      _header_line_max(SIZE_MAX),
+      _header_total_max(SIZE_MAX) {}
 
 HttpRequest::~HttpRequest() { _headers.clear(); }
 
@@ -47,6 +53,8 @@ void HttpRequest::setMethod(const std::string& method) {
     _method_code = HttpMethod::POST;
   } else if (method == "PUT") {
     _method_code = HttpMethod::PUT;
+  } else if (method == "PATCH") {
+    _method_code = HttpMethod::PATCH;
   } else if (method == "DELETE") {
     _method_code = HttpMethod::DELETE;
   } else if (method == "CONNECT") {
@@ -68,6 +76,19 @@ void HttpRequest::setRequestTarget(const std::string& request_target) {
   _request_target = request_target;
 }
 
+/**
+ * @brief Set result of request target normalization
+ * @param path Percent-decoded path without `.`/`..` segments and `//`
+ * @param query_offset Index of '?' in the request target or npos
+ * @param path_hash Hash of path (cache key)
+ */
+void HttpRequest::setNormalizedTarget(std::string&& path, size_t query_offset,
+                                      uint64_t path_hash) {
+  _path = std::move(path);
+  _query_offset = query_offset;
+  _path_hash = path_hash;
+}
+
 /**
  * @brief Set HTTP version
  * @param http_version HTTP version string (e.g., "HTTP/1.1")
@@ -123,13 +144,12 @@ void HttpRequest::setBodyLength(size_t content_length) {
   _body_length = content_length;
 }
 
-void HttpRequest::appendBuffer(std::string&& data) {
-  _buffer += std::move(data);
-
-  if (_parsed_buffer_offset >= PARSED_OFFSET_THRESHOLD) {
-    eraseParsedBuffer();
-  }
-}
+/**
+ * @brief Copy received data to the end of the unparsed buffer
+ * @param data Received bytes
+ * @note The event loop receives into getUnparsedBuffer() directly
+ */
+void HttpRequest::appendBuffer(std::string_view data) { _buffer.append(data); }
 
 void HttpRequest::setChunkedStatus(bool is_chanked) {
   _is_chanked = is_chanked;
@@ -163,6 +183,51 @@ const std::string& HttpRequest::getRequestTarget(void) const {
   return _request_target;
 }
 
+/**
+ * @brief Get normalized request path (see HttpRequestParser)
+ * @return const std::string& Decoded path without query, starts with '/'
+ */
+const std::string& HttpRequest::getPath(void) const { return _path; }
+
+/**
+ * @brief Get raw query string (without '?', not decoded)
+ * @return std::string_view View into the request target
+ */
+std::string_view HttpRequest::getQuery(void) const {
+  if (_query_offset == std::string::npos) {
+    return std::string_view();
+  }
+  return std::string_view(_request_target).substr(_query_offset + 1);
+}
+
+bool HttpRequest::hasQuery(void) const {
+  return _query_offset != std::string::npos;
+}
+
+/**
+ * @brief Get hash of the normalized path
+ * @return uint64_t Hash usable as cache key
+ */
+uint64_t HttpRequest::getPathHash(void) const { return _path_hash; }
+
+/// @brief Address of the client, AF_UNSPEC family if unknown (unix sockets)
+const ClientAddress& HttpRequest::getClientAddress(void) const {
+  return _client;
+}
+
+/// @brief Longest request line or header line accepted, in bytes
+size_t HttpRequest::getHeaderLineLimit(void) const { return _header_line_max; }
+
+/// @brief Body moved to a file by splice(), nullptr for buffered bodies
+SplicedBody* HttpRequest::getSplicedBody(void) const {
+  return _spliced_body.get();
+}
+
+/// @brief Longest header section accepted, in bytes
+size_t HttpRequest::getHeaderTotalLimit(void) const {
+  return _header_total_max;
+}
+
 /**
  * @brief Get HTTP version
  * @return const std::string& HTTP version string
@@ -209,24 +274,21 @@ const std::string& HttpRequest::getBody(void) const { return _body; }
  */
 size_t HttpRequest::getBodyLength(void) const { return _body_length; }
 
-std::string_view HttpRequest::getUnparsedBuffer(void) const {
-  if (_parsed_buffer_offset >= _buffer.size()) {
-    return std::string_view{};
-  }
-  return std::string_view{_buffer}.substr(_parsed_buffer_offset);
-}
-
-void HttpRequest::eraseParsedBuffer(size_t bytes) {
-  size_t amount = (bytes == 0) ? _parsed_buffer_offset
-                               : std::min(bytes, _parsed_buffer_offset);
+/**
+ * @brief Get received bytes the parser hasn't consumed yet
+ * @return BufferChain& Unparsed bytes, `recv()` may write to its tail
+ */
+BufferChain& HttpRequest::getUnparsedBuffer(void) { return _buffer; }
 
-  _buffer.erase(0, amount);
-  _parsed_buffer_offset -= amount;
+const BufferChain& HttpRequest::getUnparsedBuffer(void) const {
+  return _buffer;
 }
 
-void HttpRequest::commitParsedBytes(size_t bytes) {
-  _parsed_buffer_offset += bytes;
-}
+/**
+ * @brief Drop parsed bytes from the front of the unparsed buffer
+ * @param bytes Amount of bytes
+ */
+void HttpRequest::commitParsedBytes(size_t bytes) { _buffer.consume(bytes); }
 
 bool HttpRequest::isErrorStatusCode(void) const {
   return _state == HttpParsingState::COMPLETE && _is_error;
@@ -236,9 +298,6 @@ void HttpRequest::setParsingState(HttpParsingState state) {
   _state = state;
   if (state == HttpParsingState::COMPLETE) {
     _buffer.clear();
-    _parsed_buffer_offset = 0;
-  } else if (_parsed_buffer_offset >= PARSED_OFFSET_THRESHOLD) {
-    eraseParsedBuffer();
   }
 }
 
@@ -255,6 +314,42 @@ void HttpRequest::appendBody(std::string&& data) {
   _body += std::move(data);
 }
 
+/**
+ * @brief Move bytes of a Content-Length body from the unparsed buffer
+ * @param bytes Amount of bytes, body length must be set before
+ */
+void HttpRequest::moveToBody(size_t bytes) { _buffer.moveTo(_body, bytes); }
+
+/**
+ * @brief Set address of the client (once per connection)
+ * @param client Peer address returned by accept()
+ */
+void HttpRequest::setClientAddress(const ClientAddress& client) {
+  _client = client;
+}
+
+/**
+ * @brief Hand the rest of the body to a file being spliced from the socket
+ * @param body Open spliced body, the bytes of getBody() are already in it
+ * @note getBody() stays empty, getBodyLength() is still the Content-Length
+ */
+void HttpRequest::setSplicedBody(std::shared_ptr<SplicedBody> body) {
+  _spliced_body = std::move(body);
+  std::string().swap(_body);
+}
+
+/**
+ * @brief Set size limits of the request head (once per connection)
+ * @param line_max Longest request line or header line
+ * @param total_max Longest header section, with its closing empty line
+ * @note Unlimited (SIZE_MAX) unless set, the parser answers 414 for a long
+ *       request line and 431 for long headers
+ */
+void HttpRequest::setHeaderLimits(size_t line_max, size_t total_max) {
+  _header_line_max = line_max;
+  _header_total_max = total_max;
+}
+
 HttpUtils::HttpStatusCode HttpRequest::getStatusCode(void) const {
   return _status_code;
 }
@@ -263,16 +358,28 @@ const std::string& HttpRequest::getErrorMessage(void) const {
   return _err_message;
 }
 
+/**
+ * @brief Prepare the object for the next request on the connection
+ * @note Body capacity over KEEP_BODY_CAPACITY is released, so one large
+ *       upload doesn't stay pinned to a keep-alive connection
+ */
 void HttpRequest::reset(void) {
   _buffer.clear();
-  _parsed_buffer_offset = 0;
   _method_code = HttpMethod::UNKNOWN;
   _method_raw.clear();
   _request_target.clear();
   _http_version.clear();
+  _path.clear();
+  _query_offset = std::string::npos;
+  _path_hash = 0;
   _headers.clear();
-  _body.clear();
+  if (_body.capacity() > KEEP_BODY_CAPACITY) {
+    std::string().swap(_body);
+  } else {
+    _body.clear();
+  }
   _body_length = 0;
+  _spliced_body.reset();  // an unpublished body file is removed
   _state = HttpParsingState::REQUEST_LINE;
   _is_chanked = false;
   _expected_chunk_length = 0;
@@ -281,6 +388,33 @@ void HttpRequest::reset(void) {
   _err_message.clear();
 }
 
+/**
+ * @brief Reset and free all buffers (idle keep-alive connection)
+ */
+void HttpRequest::releaseMemory(void) {
+  reset();
+  std::string().swap(_body);
+  std::string().swap(_request_target);
+  std::string().swap(_path);
+  std::string().swap(_err_message);
+}
+
+/**
+ * @brief Heap memory held by the request (buffer blocks and strings)
+ * @return size_t Bytes, header map nodes are estimated
+ */
+size_t HttpRequest::getMemoryUsage(void) const {
+  size_t bytes = _buffer.capacity() +
+                 HttpUtils::heapCapacity(_body) +
+                 HttpUtils::heapCapacity(_request_target) +
+                 HttpUtils::heapCapacity(_path);
+  for (const auto& header : _headers) {
+    bytes += sizeof(header) + HttpUtils::heapCapacity(header.first) +
+             HttpUtils::heapCapacity(header.second);
+  }
+  return bytes;
+}
+
 std::string HttpRequest::getRequestLine(void) const {
   std::stringstream request_line;
   request_line << getMethod() << " " << getRequestTarget() << " "
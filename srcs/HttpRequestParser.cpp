@@ -36,7 +36,22 @@ HttpRequestParser::Status HttpRequestParser::parseRequest(
     return HttpRequestParser::Status::WAIT_FOR_DATA;
   }
 
-  request.appendBuffer(std::move(data));
+  request.appendBuffer(data);
+  return parseRequest(request);
+}
+
+/**
+ * @brief Parse data already received into the request's unparsed buffer
+ * @param request HttpRequest object to populate
+ * @return HttpRequestParser::Status::DONE, WAIT_FOR_DATA or ERROR
+ */
+HttpRequestParser::Status HttpRequestParser::parseRequest(
+    HttpRequest& request) {
+  // a spliced body completes the request without passing the buffer
+  if (request.getUnparsedBuffer().empty() &&
+      request.getParsingState() != HttpParsingState::COMPLETE) {
+    return HttpRequestParser::Status::WAIT_FOR_DATA;
+  }
 
   HttpRequestParser::Status status;
   while (true) {
@@ -106,15 +121,21 @@ HttpRequestParser::Status HttpRequestParser::parseRequest(
  */
 HttpRequestParser::Status HttpRequestParser::parseRequestLine(
     HttpRequest& request) {
-  std::string_view message = request.getUnparsedBuffer();
+  BufferChain& message = request.getUnparsedBuffer();
 
-  size_t request_line_end = std::string_view::npos;
-  request_line_end = message.find("\r\n");
-  if (request_line_end == std::string_view::npos) {
+  size_t request_line_end = message.find("\r\n");
+  if (request_line_end == std::string::npos &&
+      message.size() <= request.getHeaderLineLimit()) {
     return HttpRequestParser::Status::WAIT_FOR_DATA;
   }
+  if (request_line_end == std::string::npos ||
+      request_line_end > request.getHeaderLineLimit()) {
+    request.setErrorStatus("Request line is too long",
+                           HttpUtils::HttpStatusCode::URI_TOO_LONG);
+    return HttpRequestParser::Status::ERROR;
+  }
   // get request line
-  std::string_view request_line = message.substr(0, request_line_end);
+  std::string_view request_line = message.peek(request_line_end);
   if (request_line.empty()) {
     request.setErrorStatus("Empty request line",
                            HttpUtils::HttpStatusCode::BAD_REQUEST);
@@ -155,6 +176,9 @@ HttpRequestParser::Status HttpRequestParser::parseRequestLine(
     return HttpRequestParser::Status::ERROR;
   }
   request.setRequestTarget(target);
+  if (!normalizeRequestTarget(request.getRequestTarget(), request)) {
+    return HttpRequestParser::Status::ERROR;
+  }
   // set and validate version
   if (!validateHttpVersion(version, request)) {
     return HttpRequestParser::Status::ERROR;
@@ -172,7 +196,7 @@ HttpRequestParser::Status HttpRequestParser::parseRequestLine(
  */
 HttpRequestParser::Status HttpRequestParser::parseRequestHeaders(
     HttpRequest& request) {
-  std::string_view message = request.getUnparsedBuffer();
+  BufferChain& message = request.getUnparsedBuffer();
 
   if (message.find("\r\n") == 0) {
     request.setErrorStatus("Malformed header - missing Host",
@@ -181,11 +205,19 @@ HttpRequestParser::Status HttpRequestParser::parseRequestHeaders(
   }
 
   size_t headers_end = message.find("\r\n\r\n");
-  if (headers_end == std::string_view::npos) {
+  if (headers_end == std::string::npos &&
+      message.size() <= request.getHeaderTotalLimit()) {
     return HttpRequestParser::Status::WAIT_FOR_DATA;
   }
+  if (headers_end == std::string::npos ||
+      headers_end + 4 > request.getHeaderTotalLimit()) {
+    request.setErrorStatus(
+        "Request header fields are too large",
+        HttpUtils::HttpStatusCode::REQUEST_HEADER_FIELDS_TOO_LARGE);
+    return HttpRequestParser::Status::ERROR;
+  }
 
-  std::string_view headers_content = message.substr(0, headers_end);
+  std::string_view headers_content = message.peek(headers_end);
 
   size_t header_counter = 0;
   size_t start_pos = 0;
@@ -199,6 +231,12 @@ HttpRequestParser::Status HttpRequestParser::parseRequestHeaders(
 
     std::string_view header_line =
         headers_content.substr(start_pos, end_pos - start_pos);
+    if (header_line.size() > request.getHeaderLineLimit()) {
+      request.setErrorStatus(
+          "Request header field is too large",
+          HttpUtils::HttpStatusCode::REQUEST_HEADER_FIELDS_TOO_LARGE);
+      return HttpRequestParser::Status::ERROR;
+    }
 
     if (parseRequestHeaderLine(header_line, request) ==
         HttpRequestParser::Status::ERROR) {
@@ -268,22 +306,23 @@ HttpRequestParser::Status HttpRequestParser::parseRequestHeaderLine(
  */
 HttpRequestParser::Status HttpRequestParser::parseRequestBody(
     HttpRequest& request) {
-  std::string_view message = request.getUnparsedBuffer();
-  if (request.getBodyLength() > message.length()) {
-    return HttpRequestParser::Status::WAIT_FOR_DATA;
-  }
+  BufferChain& message = request.getUnparsedBuffer();
+  size_t received = request.getBody().length() + message.size();
 
-  if (request.getBodyLength() != message.length()) {
+  if (received > request.getBodyLength()) {
     request.setErrorStatus("Content-Length mismatch: expected " +
                                std::to_string(request.getBodyLength()) +
-                               " bytes, got " +
-                               std::to_string(message.length()) + " bytes",
+                               " bytes, got " + std::to_string(received) +
+                               " bytes",
                            HttpUtils::HttpStatusCode::BAD_REQUEST);
     return HttpRequestParser::Status::ERROR;
   }
 
-  request.setBody(std::string(message));
-  request.commitParsedBytes(message.length());
+  // move what arrived so far, the buffer blocks can go back to the pool
+  request.moveToBody(message.size());
+  if (received < request.getBodyLength()) {
+    return HttpRequestParser::Status::WAIT_FOR_DATA;
+  }
   request.setParsingState(HttpParsingState::COMPLETE);
 
   return HttpRequestParser::Status::CONTINUE;
@@ -291,14 +330,14 @@ HttpRequestParser::Status HttpRequestParser::parseRequestBody(
 
 HttpRequestParser::Status HttpRequestParser::parseRequestChunkedBodySize(
     HttpRequest& request) {
-  std::string_view message = request.getUnparsedBuffer();
+  BufferChain& message = request.getUnparsedBuffer();
 
   size_t chunk_size_end = message.find("\r\n");
-  if (chunk_size_end == std::string_view::npos) {
+  if (chunk_size_end == std::string::npos) {
     return HttpRequestParser::Status::WAIT_FOR_DATA;
   }
 
-  std::string hex_chunk_size = std::string(message.substr(0, chunk_size_end));
+  std::string hex_chunk_size = std::string(message.peek(chunk_size_end));
   try {
     size_t chunk_size = std::stoull(hex_chunk_size, 0, 16);
     request.setExpectedChunkLength(chunk_size);
@@ -327,24 +366,25 @@ HttpRequestParser::Status HttpRequestParser::parseRequestChunkedBodySize(
 
 HttpRequestParser::Status HttpRequestParser::parseRequestChunkedBodyData(
     HttpRequest& request) {
-  std::string_view message = request.getUnparsedBuffer();
+  BufferChain& message = request.getUnparsedBuffer();
+  size_t expected = request.getExpectedChunkLength();
 
-  size_t chunk_data_end = message.find("\r\n");
-  if (chunk_data_end == std::string_view::npos) {
+  // chunk data may contain CRLF itself, its end is known from the size line
+  if (message.size() < expected + 2) {
     return HttpRequestParser::Status::WAIT_FOR_DATA;
   }
-
-  std::string chunk_data = std::string(message.substr(0, chunk_data_end));
-  if (chunk_data.length() != request.getExpectedChunkLength()) {
-    request.setErrorStatus(
-        "Chunk length mismatch: expected " +
-            std::to_string(request.getExpectedChunkLength()) + " bytes, got " +
-            std::to_string(chunk_data.length()) + " bytes",
-        HttpUtils::HttpStatusCode::BAD_REQUEST);
+  if (message.find("\r\n", expected) != expected) {
+    request.setErrorStatus("Chunk length mismatch: expected " +
+                               std::to_string(expected) +
+                               " bytes, chunk isn't followed by CRLF",
+                           HttpUtils::HttpStatusCode::BAD_REQUEST);
     return HttpRequestParser::Status::ERROR;
   }
 
-  request.commitParsedBytes(chunk_data_end + 2);
+  std::string chunk_data;
+  chunk_data.reserve(expected);
+  message.moveTo(chunk_data, expected);
+  request.commitParsedBytes(2);
   request.appendBody(std::move(chunk_data));
   request.setParsingState(HttpParsingState::CHUNKED_BODY_SIZE);
 
@@ -353,22 +393,21 @@ HttpRequestParser::Status HttpRequestParser::parseRequestChunkedBodyData(
 
 HttpRequestParser::Status HttpRequestParser::parseRequestChunkedBodyTrailer(
     HttpRequest& request) {
-  std::string_view message = request.getUnparsedBuffer();
+  BufferChain& message = request.getUnparsedBuffer();
 
   size_t chunk_trailer_end = message.find("\r\n");
-  if (chunk_trailer_end == std::string_view::npos) {
+  if (chunk_trailer_end == std::string::npos) {
     return HttpRequestParser::Status::WAIT_FOR_DATA;
   }
 
   // the trailer after the last chunk must be just "\r\n"
-  if (chunk_trailer_end != 0 || message.length() != 2) {
+  if (chunk_trailer_end != 0 || message.size() != 2) {
     request.setErrorStatus("Malformed chunked body trailer",
                            HttpUtils::HttpStatusCode::BAD_REQUEST);
     return HttpRequestParser::Status::ERROR;
   }
 
   request.commitParsedBytes(chunk_trailer_end + 2);
-  request.eraseParsedBuffer();
   request.setParsingState(HttpParsingState::COMPLETE);
   return HttpRequestParser::Status::CONTINUE;
 }
@@ -420,6 +459,107 @@ bool HttpRequestParser::validateRequestTarget(const std::string& target,
   return true;
 }
 
+/**
+ * @brief Percent-decodes the path of the target and resolves its dot
+ *        segments in one pass, stores the result in the request
+ *
+ * `%XX` is decoded before segments are looked at, so `%2e%2e` and `%2F`
+ * can't be used to sneak `..` or extra segments past the location lookup.
+ * `//` is merged into `/`, `.` segments are dropped and `..` removes the
+ * previous segment (a trailing slash is kept). Paths without `%`, `//` and
+ * `/.` (the common case) are copied as they are.
+ *
+ * @param target Validated request target (origin or absolute form)
+ * @param request HttpRequest object to store the result / report errors
+ * @return true on success, false (400) on bad escapes, `%00` or a `..`
+ *         above the root
+ */
+bool HttpRequestParser::normalizeRequestTarget(const std::string& target,
+                                               HttpRequest& request) {
+  std::string_view uri(target);
+  size_t path_start = 0;
+  if (uri[0] != '/') {  // absolute form: skip "scheme://authority"
+    path_start = uri.find_first_of("/?#", uri.find("://") + 3);
+    path_start = (path_start == std::string_view::npos) ? uri.size()
+                                                         : path_start;
+  }
+  size_t query_offset = uri.find('?', path_start);
+  size_t path_end = uri.find_first_of("?#", path_start);
+  path_end = (path_end == std::string_view::npos) ? uri.size() : path_end;
+  std::string_view raw = uri.substr(path_start, path_end - path_start);
+
+  // fast path: nothing to decode or resolve
+  bool plain = !raw.empty();
+  char prev = 0;
+  for (char c : raw) {
+    plain &= (c != '%') & !((prev == '/') & ((c == '/') | (c == '.')));
+    prev = c;
+  }
+  if (plain) {
+    std::string path(raw);
+    uint64_t hash = HttpUtils::hashPath(path);
+    request.setNormalizedTarget(std::move(path), query_offset, hash);
+    return true;
+  }
+
+  std::string path("/");
+  path.reserve(raw.size() + 1);
+  // resolves the segment after the last '/' of path if it's "." or ".."
+  auto closeSegment = [&path]() -> bool {
+    size_t segment = path.rfind('/') + 1;
+    size_t length = path.size() - segment;
+    if (length == 1 && path[segment] == '.') {
+      path.pop_back();
+    } else if (length == 2 && path[segment] == '.' &&
+               path[segment + 1] == '.') {
+      if (segment == 1) {
+        return false;
+      }
+      path.resize(segment - 1);
+      path.resize(path.rfind('/') + 1);
+    }
+    return true;
+  };
+
+  for (size_t i = 0; i <= raw.size(); i++) {
+    char c = (i < raw.size()) ? raw[i] : '/';
+    if (c == '%') {
+      if (i + 2 >= raw.size() || !std::isxdigit(raw[i + 1]) ||
+          !std::isxdigit(raw[i + 2])) {
+        request.setErrorStatus("Invalid percent-encoding in request target",
+                               HttpUtils::HttpStatusCode::BAD_REQUEST);
+        return false;
+      }
+      auto hex = [](char digit) {
+        return std::isdigit(digit) ? digit - '0' : (digit | 0x20) - 'a' + 10;
+      };
+      c = static_cast<char>(hex(raw[i + 1]) << 4 | hex(raw[i + 2]));
+      i += 2;
+      if (c == '\0') {
+        request.setErrorStatus("Request target contains encoded NUL byte",
+                               HttpUtils::HttpStatusCode::BAD_REQUEST);
+        return false;
+      }
+    }
+    if (c != '/') {
+      path += c;
+    } else if (path.back() != '/') {  // "//" is merged
+      if (!closeSegment()) {
+        request.setErrorStatus("Request target points above the root",
+                               HttpUtils::HttpStatusCode::BAD_REQUEST);
+        return false;
+      }
+      if (path.back() != '/' && i < raw.size()) {
+        path += '/';
+      }
+    }
+  }
+
+  uint64_t hash = HttpUtils::hashPath(path);
+  request.setNormalizedTarget(std::move(path), query_offset, hash);
+  return true;
+}
+
 /**
  * @brief Validate HTTP version format
  * @param version HTTP version string
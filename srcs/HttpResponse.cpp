@@ -3,10 +3,15 @@
 HttpResponse::HttpResponse()
     : _status_code(HttpUtils::HttpStatusCode::I_AM_TEAPOD),
       _headers(),
+      _raw_headers(),
       _body(""),
       _content_type(""),
+      _body_source(nullptr),
       _is_error_response(false),
-      _is_keep_alive_connection(true) {}
+      _is_keep_alive_connection(true),
+      _limit_rate(0),
+      _limit_rate_after(0),
+      _kernel_pacing(false) {}
 
 HttpResponse& HttpResponse::operator=(const HttpResponse& other) {
   if (this == &other) {
@@ -16,10 +21,15 @@ HttpResponse& HttpResponse::operator=(const HttpResponse& other) {
   this->_body = other._body;
   this->_headers.clear();
   this->_headers = other._headers;
+  this->_raw_headers = other._raw_headers;
   this->_status_code = other._status_code;
   this->_content_type = other._content_type;
+  this->_body_source = other._body_source;
   this->_is_error_response = other._is_error_response;
   this->_is_keep_alive_connection = other._is_keep_alive_connection;
+  this->_limit_rate = other._limit_rate;
+  this->_limit_rate_after = other._limit_rate_after;
+  this->_kernel_pacing = other._kernel_pacing;
 
   return *this;
 }
@@ -44,17 +54,40 @@ void HttpResponse::insertHeader(const std::string& field_name,
   auto it = _headers.find(lowercase_name);
   if (it != _headers.end()) {
     it->second = value;
+  } else {
+    _headers.insert({lowercase_name, value});
   }
 }
 
+/**
+ * @brief Appends header lines rendered ahead of time, sent as they are
+ * @param header_lines "Name: value\r\n" lines
+ */
+void HttpResponse::appendRawHeaders(std::string_view header_lines) {
+  _raw_headers.append(header_lines);
+}
+
 void HttpResponse::setBody(const std::string& body,
-                           const std::string& content_type) {
+                           std::string_view content_type) {
   _body = body;
-  _content_type = content_type;
+  _content_type.assign(content_type);
+  _body_source.reset();
 }
 
-void HttpResponse::setContentType(const std::string& content_type) {
-  _content_type = content_type;
+void HttpResponse::setContentType(std::string_view content_type) {
+  _content_type.assign(content_type);
+}
+
+/**
+ * @brief Makes the body be produced by source while the response is sent
+ * @param source Body source, its size() becomes Content-Length
+ * @param content_type Content-Type of the body
+ */
+void HttpResponse::setBodySource(std::shared_ptr<BodySource> source,
+                                 std::string_view content_type) {
+  _body.clear();
+  _body_source = std::move(source);
+  _content_type.assign(content_type);
 }
 
 void HttpResponse::setConnectionHeader(
@@ -74,6 +107,19 @@ void HttpResponse::setConnectionHeader(
   }
 }
 
+/**
+ * @brief Asks the connection to pace transmission of this response
+ * @param limit_rate Bytes per second (0 disables pacing)
+ * @param limit_rate_after Bytes sent at full speed before pacing starts
+ * @param kernel_pacing Let the kernel pace the socket (SO_MAX_PACING_RATE)
+ */
+void HttpResponse::setRateLimit(size_t limit_rate, size_t limit_rate_after,
+                                bool kernel_pacing) {
+  _limit_rate = limit_rate;
+  _limit_rate_after = limit_rate_after;
+  _kernel_pacing = kernel_pacing;
+}
+
 void HttpResponse::setErrorResponse(const HttpUtils::HttpStatusCode& code,
                                     const std::string& message) {
   setStatusCode(code);
@@ -103,7 +149,8 @@ void HttpResponse::setErrorPageBody(
   std::string tmp_body = "";
   if (std::filesystem::exists(path) && std::filesystem::is_regular_file(path) &&
       HttpUtils::getFileContent(path, tmp_body) == 0) {
-    setBody(tmp_body, HttpUtils::getMIME(path));
+    setBody(tmp_body,
+            HttpUtils::getMIME(path, server_config.mime_types.get()));
   } else {
     setDefaultCatErrorPage();
   }
@@ -143,9 +190,11 @@ std::string HttpResponse::convertToString(void) {
   raw_response << "Server: Webserv" << "\r\n"
                << "Date: " << whatDateGMT() << "\r\n"
                << "Content-Length: "
-               << (_body.empty() ? "0" : std::to_string(_body.length()))
+               << (_body_source ? std::to_string(_body_source->size())
+                   : _body.empty() ? "0"
+                                   : std::to_string(_body.length()))
                << "\r\n";
-  if (!_body.empty()) {
+  if (!_body.empty() || _body_source) {
     raw_response << "Content-Type: "
                  << (_content_type.empty() ? "text/plain" : _content_type)
                  << "\r\n";
@@ -154,6 +203,7 @@ std::string HttpResponse::convertToString(void) {
     raw_response << capitalizeHeaderFieldName(it.first) << ": " << it.second
                  << "\r\n";
   }
+  raw_response << _raw_headers;
   // add body
   raw_response << "\r\n" << _body;
   return raw_response.str();
@@ -205,6 +255,8 @@ std::string HttpResponse::whatReasonPhrase(
       return "Use Proxy";
     case HttpUtils::HttpStatusCode::TEMPORARY_REDIRECT:
       return "Temporary Redirect";
+    case HttpUtils::HttpStatusCode::PERMANENT_REDIRECT:
+      return "Permanent Redirect";
     case HttpUtils::HttpStatusCode::BAD_REQUEST:
       return "Bad Request";
     case HttpUtils::HttpStatusCode::UNAUTHORIZED:
@@ -241,6 +293,8 @@ std::string HttpResponse::whatReasonPhrase(
       return "I'm a teapot";
     case HttpUtils::HttpStatusCode::TOO_MANY_REQUESTS:
       return "Too Many Requests";
+    case HttpUtils::HttpStatusCode::REQUEST_HEADER_FIELDS_TOO_LARGE:
+      return "Request Header Fields Too Large";
     case HttpUtils::HttpStatusCode::INTERNAL_SERVER_ERROR:
       return "Internal Server Error";
     case HttpUtils::HttpStatusCode::NOT_IMPLEMENTED:
@@ -253,6 +307,8 @@ std::string HttpResponse::whatReasonPhrase(
       return "Gateway Timeout";
     case HttpUtils::HttpStatusCode::HTTP_VERSION_NOT_SUPPORTED:
       return "HTTP Version Not Supported";
+    case HttpUtils::HttpStatusCode::INSUFFICIENT_STORAGE:
+      return "Insufficient Storage";
     default:
       return "Unknown";
   }
@@ -281,6 +337,10 @@ bool HttpResponse::isKeepAliveConnection(void) const {
 
 const std::string& HttpResponse::getBody(void) const { return _body; }
 
+std::shared_ptr<BodySource> HttpResponse::getBodySource(void) const {
+  return _body_source;
+}
+
 HttpUtils::HttpStatusCode HttpResponse::getStatusCode(void) const {
   return _status_code;
 }
@@ -291,3 +351,9 @@ std::string HttpResponse::getStatusLine(void) const {
               << whatReasonPhrase(_status_code);
   return status_line.str();
 }
+
+size_t HttpResponse::getLimitRate(void) const { return _limit_rate; }
+
+size_t HttpResponse::getLimitRateAfter(void) const { return _limit_rate_after; }
+
+bool HttpResponse::isKernelPacing(void) const { return _kernel_pacing; }
@@ -13,6 +13,12 @@
 
 #include "HttpUtils.hpp"
 
+#include <strings.h>
+
+#include <algorithm>
+
+#include "LocationMatcher.hpp"
+
 /**
  * @brief Converts a string to lowercase
  * @param str The input string to convert to lowercase
@@ -28,22 +34,28 @@ std::string HttpUtils::toLowerCase(const std::string& str) {
 }
 
 /**
- * @brief Finds the best matching location configuration for a given URI
+ * @brief Finds the best matching location configuration for a given path
  *
- * This function searches through all location configurations in the server
- * config and returns the one with the longest matching path prefix.
+ * Uses the server's LocationMatcher (nginx order: `=`, longest prefix,
+ * `^~`, regex in config order). Servers built without parser fall back to
+ * the longest matching path prefix.
  *
- * @param request_uri The URI from the HTTP request to match against
+ * @param path Normalized request path (HttpRequest::getPath())
  * @param config The server configuration containing location blocks
  * @return Pointer to the best matching LocationConfig, or nullptr if no match
  */
 const ConfigParser::LocationConfig* HttpUtils::getLocation(
-    const std::string& request_uri, const ConfigParser::ServerConfig& config) {
+    std::string_view path, const ConfigParser::ServerConfig& config) {
+  if (config.location_matcher) {
+    int index = config.location_matcher->find(path);
+    return (index < 0) ? nullptr : &config.locations[index];
+  }
+
   const ConfigParser::LocationConfig* location = nullptr;
   size_t max_location_length = 0;
 
   for (const ConfigParser::LocationConfig& loc : config.locations) {
-    if (request_uri.find(loc.path) == 0 &&
+    if (path.compare(0, loc.path.length(), loc.path) == 0 &&
         loc.path.length() > max_location_length) {
       location = &loc;
       max_location_length = loc.path.length();
@@ -54,36 +66,51 @@ const ConfigParser::LocationConfig* HttpUtils::getLocation(
 }
 
 /**
- * @brief Constructs the file system path for a given request URI
+ * @brief Constructs the file system path for a given request path
  *
- * This function combines the location's root directory with the request URI
+ * This function combines the location's root directory with the request path
  * to create the complete file system path.
  *
  * @param location The location configuration containing the root directory
- * @param request_uri The URI from the HTTP request
+ * @param path Normalized request path (decoded, no query string)
  * @return Complete file system path to the requested resource
- *
- * @note Automatically strips query parameters (everything after '?')
  */
 const std::string HttpUtils::getFilePath(
-    const ConfigParser::LocationConfig& location,
-    const std::string& request_uri) {
-  std::string path = location.root;
+    const ConfigParser::LocationConfig& location, std::string_view path) {
+  std::string file_path = location.root;
 
-  if (!path.empty() && path.back() != '/') {
-    path += '/';
+  if (!file_path.empty() && file_path.back() != '/') {
+    file_path += '/';
+  }
+  if (!path.empty() && path[0] == '/') {
+    path.remove_prefix(1);
   }
+  file_path.append(path);
 
-  size_t end = (request_uri.find('?') != std::string::npos)
-                   ? request_uri.find('?')
-                   : request_uri.length();
-  if (request_uri[0] == '/') {
-    path += request_uri.substr(1, end - 1);
-  } else {
-    path += request_uri.substr(0, end);
+  return file_path;
+}
+
+/**
+ * @brief Hashes a normalized path (64-bit FNV-1a)
+ * @param path Request path
+ * @return Hash usable as cache key
+ */
+uint64_t HttpUtils::hashPath(std::string_view path) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (char c : path) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
   }
+  return hash;
+}
 
-  return path;
+/**
+ * @brief Heap bytes held by a string (0 if it fits the inline buffer)
+ * @param str String to measure
+ * @return Allocated capacity in bytes
+ */
+size_t HttpUtils::heapCapacity(const std::string& str) {
+  static const size_t inline_capacity = std::string().capacity();
+  return (str.capacity() > inline_capacity) ? str.capacity() : 0;
 }
 
 /**
@@ -170,146 +197,30 @@ bool HttpUtils::isMethodAllowed(const ConfigParser::LocationConfig& location,
 /**
  * @brief Determines the MIME type based on file extension
  *
- * This function analyzes the file extension of a given path and returns the
- * appropriate MIME type. It supports a comprehensive list of web file types
- * and defaults to "application/octet-stream" for unknown extensions.
+ * Looks up the extension of the file name in the `types {}` table of the
+ * location or, without one, in the built-in table. Defaults to
+ * "application/octet-stream" for unknown extensions.
  *
  * @param path The file path or filename to analyze
- * @return The MIME type string corresponding to the file extension
+ * @param types Configured MIME types or nullptr for the built-in ones
+ * @return The MIME type corresponding to the file extension
  *
  * @note Extension matching is case-insensitive
- * @note Based on standard nginx MIME type mappings
+ * @note Doesn't allocate, the view points into a static or config table
  */
-const std::string HttpUtils::getMIME(const std::string& path) {
-  static const std::unordered_map<std::string, std::string> extension_to_mime =
-      {{"html", "text/html"},
-       {"htm", "text/html"},
-       {"shtml", "text/html"},
-       {"css", "text/css"},
-       {"xml", "text/xml"},
-       {"txt", "text/plain"},
-       {"mml", "text/mathml"},
-       {"jad", "text/vnd.sun.j2me.app-descriptor"},
-       {"wml", "text/vnd.wap.wml"},
-       {"htc", "text/x-component"},
-
-       {"gif", "image/gif"},
-       {"jpeg", "image/jpeg"},
-       {"jpg", "image/jpeg"},
-       {"png", "image/png"},
-       {"tif", "image/tiff"},
-       {"tiff", "image/tiff"},
-       {"wbmp", "image/vnd.wap.wbmp"},
-       {"ico", "image/x-icon"},
-       {"jng", "image/x-jng"},
-       {"bmp", "image/x-ms-bmp"},
-       {"svg", "image/svg+xml"},
-       {"svgz", "image/svg+xml"},
-       {"webp", "image/webp"},
-
-       {"js", "application/javascript"},
-       {"atom", "application/atom+xml"},
-       {"rss", "application/rss+xml"},
-       {"woff", "application/font-woff"},
-       {"jar", "application/java-archive"},
-       {"war", "application/java-archive"},
-       {"ear", "application/java-archive"},
-       {"json", "application/json"},
-       {"hqx", "application/mac-binhex40"},
-       {"doc", "application/msword"},
-       {"pdf", "application/pdf"},
-       {"ps", "application/postscript"},
-       {"eps", "application/postscript"},
-       {"ai", "application/postscript"},
-       {"rtf", "application/rtf"},
-       {"m3u8", "application/vnd.apple.mpegurl"},
-       {"xls", "application/vnd.ms-excel"},
-       {"eot", "application/vnd.ms-fontobject"},
-       {"ppt", "application/vnd.ms-powerpoint"},
-       {"wmlc", "application/vnd.wap.wmlc"},
-       {"kml", "application/vnd.google-earth.kml+xml"},
-       {"kmz", "application/vnd.google-earth.kmz"},
-       {"7z", "application/x-7z-compressed"},
-       {"cco", "application/x-cocoa"},
-       {"jardiff", "application/x-java-archive-diff"},
-       {"jnlp", "application/x-java-jnlp-file"},
-       {"run", "application/x-makeself"},
-       {"pl", "application/x-perl"},
-       {"pm", "application/x-perl"},
-       {"prc", "application/x-pilot"},
-       {"pdb", "application/x-pilot"},
-       {"rar", "application/x-rar-compressed"},
-       {"rpm", "application/x-redhat-package-manager"},
-       {"sea", "application/x-sea"},
-       {"swf", "application/x-shockwave-flash"},
-       {"sit", "application/x-stuffit"},
-       {"tcl", "application/x-tcl"},
-       {"tk", "application/x-tcl"},
-       {"der", "application/x-x509-ca-cert"},
-       {"pem", "application/x-x509-ca-cert"},
-       {"crt", "application/x-x509-ca-cert"},
-       {"xpi", "application/x-xpinstall"},
-       {"xhtml", "application/xhtml+xml"},
-       {"xspf", "application/xspf+xml"},
-       {"zip", "application/zip"},
-       {"docx",
-        "application/"
-        "vnd.openxmlformats-officedocument.wordprocessingml.document"},
-       {"xlsx",
-        "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet"},
-       {"pptx",
-        "application/"
-        "vnd.openxmlformats-officedocument.presentationml.presentation"},
-
-       {"mid", "audio/midi"},
-       {"midi", "audio/midi"},
-       {"kar", "audio/midi"},
-       {"mp3", "audio/mpeg"},
-       {"ogg", "audio/ogg"},
-       {"m4a", "audio/x-m4a"},
-       {"ra", "audio/x-realaudio"},
-
-       {"3gpp", "video/3gpp"},
-       {"3gp", "video/3gpp"},
-       {"ts", "video/mp2t"},
-       {"mp4", "video/mp4"},
-       {"mpeg", "video/mpeg"},
-       {"mpg", "video/mpeg"},
-       {"mov", "video/quicktime"},
-       {"webm", "video/webm"},
-       {"flv", "video/x-flv"},
-       {"m4v", "video/x-m4v"},
-       {"mng", "video/x-mng"},
-       {"asx", "video/x-ms-asf"},
-       {"asf", "video/x-ms-asf"},
-       {"wmv", "video/x-ms-wmv"},
-       {"avi", "video/x-msvideo"},
-
-       {"bin", "application/octet-stream"},
-       {"exe", "application/octet-stream"},
-       {"dll", "application/octet-stream"},
-       {"deb", "application/octet-stream"},
-       {"dmg", "application/octet-stream"},
-       {"iso", "application/octet-stream"},
-       {"img", "application/octet-stream"},
-       {"msi", "application/octet-stream"},
-       {"msp", "application/octet-stream"},
-       {"msm", "application/octet-stream"}};
-
-  size_t dot_pos = path.find_last_of('.');
-  if (dot_pos == std::string::npos) {
-    return "application/octet-stream";
-  }
-
-  std::string extension = HttpUtils::toLowerCase(path.substr(dot_pos + 1));
-
-  std::unordered_map<std::string, std::string>::const_iterator it =
-      extension_to_mime.find(extension);
-  if (it != extension_to_mime.end()) {
-    return it->second;
+std::string_view HttpUtils::getMIME(std::string_view path,
+                                    const MimeTypes::MimeTable* types) {
+  std::string_view name = path.substr(path.find_last_of('/') + 1);
+  size_t dot_pos = name.find_last_of('.');
+  if (dot_pos == std::string_view::npos) {
+    return MimeTypes::DEFAULT_TYPE;
   }
 
-  return "application/octet-stream";
+  std::string_view extension = name.substr(dot_pos + 1);
+  std::string_view type = (types != nullptr)
+                              ? types->find(extension)
+                              : MimeTypes::findBuiltin(extension);
+  return type.empty() ? MimeTypes::DEFAULT_TYPE : type;
 }
 
 /**
@@ -425,3 +336,119 @@ const std::string HttpUtils::getExtension(const std::string& content_type) {
   }
   return "";
 }
+
+/**
+ * @brief Value of a query string parameter, as sent (not percent-decoded)
+ * @param query Query string without '?'
+ * @param name Parameter name
+ * @return Value of the first parameter with the name, empty if there is none
+ */
+std::string_view HttpUtils::getQueryParameter(std::string_view query,
+                                              std::string_view name) {
+  while (!query.empty()) {
+    size_t end = query.find('&');
+    std::string_view pair = query.substr(0, end);
+    size_t equals = pair.find('=');
+    if (pair.substr(0, equals) == name) {
+      return (equals == std::string_view::npos) ? std::string_view()
+                                                : pair.substr(equals + 1);
+    }
+    if (end == std::string_view::npos) {
+      break;
+    }
+    query.remove_prefix(end + 1);
+  }
+  return std::string_view();
+}
+
+/**
+ * @brief Text-like types worth serving compressed (images, archives and
+ *        media are compressed already)
+ * @param content_type MIME type without parameters
+ */
+bool HttpUtils::isCompressibleType(std::string_view content_type) {
+  static constexpr std::string_view kTypes[] = {
+      "application/javascript", "application/json", "application/xml",
+      "application/rss+xml",    "application/atom+xml",
+      "application/xhtml+xml",  "image/svg+xml",    "image/x-icon"};
+  if (content_type.substr(0, 5) == "text/") {
+    return true;
+  }
+  return std::find(std::begin(kTypes), std::end(kTypes), content_type) !=
+         std::end(kTypes);
+}
+
+/**
+ * @brief Checks if Accept-Encoding allows a content coding
+ * @param accept_encoding Value of the header, e.g. "gzip, deflate;q=0.5"
+ * @param coding Content coding, e.g. "gzip"
+ * @return true if the coding is listed without q=0
+ */
+bool HttpUtils::acceptsEncoding(std::string_view accept_encoding,
+                                std::string_view coding) {
+  while (!accept_encoding.empty()) {
+    size_t comma = accept_encoding.find(',');
+    std::string_view item = accept_encoding.substr(0, comma);
+    accept_encoding.remove_prefix(
+        comma == std::string_view::npos ? accept_encoding.size() : comma + 1);
+
+    size_t semicolon = item.find(';');
+    std::string_view name = item.substr(0, semicolon);
+    size_t start = name.find_first_not_of(" \t");
+    size_t end = name.find_last_not_of(" \t");
+    if (start == std::string_view::npos ||
+        name.substr(start, end - start + 1).size() != coding.size() ||
+        strncasecmp(name.data() + start, coding.data(), coding.size()) != 0) {
+      continue;
+    }
+    if (semicolon == std::string_view::npos) {
+      return true;
+    }
+    // "q=0", "q=0.0", "q=0.00" and "q=0.000" refuse the coding
+    std::string_view q = item.substr(semicolon + 1);
+    q.remove_prefix(std::min(q.find_first_not_of(" \t"), q.size()));
+    if (q.substr(0, 2) != "q=" && q.substr(0, 2) != "Q=") {
+      return true;
+    }
+    q.remove_prefix(2);
+    q = q.substr(0, q.find_last_not_of(" \t") + 1);
+    return q.find_first_not_of("0.") != std::string_view::npos ||
+           q.empty() || q[0] != '0';
+  }
+  return false;
+}
+
+/**
+ * @brief Checks If-None-Match against the ETag of the current representation
+ *        (weak comparison, RFC 9110 section 13.1.2)
+ * @param if_none_match Value of the header, e.g. "\"a\", W/\"b\"" or "*"
+ * @param etag Quoted entity tag
+ * @return true if the client has it already (answer 304)
+ */
+bool HttpUtils::matchesEntityTag(std::string_view if_none_match,
+                                 std::string_view etag) {
+  if (etag.substr(0, 2) == "W/") {
+    etag.remove_prefix(2);
+  }
+  while (!if_none_match.empty()) {
+    size_t start = if_none_match.find_first_not_of(" \t,");
+    if (start == std::string_view::npos) {
+      break;
+    }
+    if_none_match.remove_prefix(start);
+    if (if_none_match[0] == '*') {
+      return true;
+    }
+    if (if_none_match.substr(0, 2) == "W/") {
+      if_none_match.remove_prefix(2);
+    }
+    size_t end = if_none_match.find('"', 1);
+    std::string_view tag = if_none_match.substr(
+        0, end == std::string_view::npos ? end : end + 1);
+    if (tag == etag) {
+      return true;
+    }
+    if_none_match.remove_prefix(tag.size());
+  }
+  return false;
+}
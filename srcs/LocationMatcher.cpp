@@ -0,0 +1,84 @@
+/**
+ * @file LocationMatcher.cpp
+ * @brief Location lookup with nginx modifiers (`=`, `^~`, `~`, `~*`)
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-07
+ * @version 1.0
+ */
+
+#include "LocationMatcher.hpp"
+
+#include <algorithm>
+
+/**
+ * @brief Builds lookup tables for the locations of one server block
+ * @param locations Locations of the server, indices refer to this vector
+ * @throws std::runtime_error if a regex is invalid or the regex set is too
+ *         large to be compiled
+ */
+LocationMatcher::LocationMatcher(
+    const std::vector<ConfigParser::LocationConfig>& locations) {
+  _exact_paths.reserve(locations.size());
+  for (size_t i = 0; i < locations.size(); i++) {
+    const ConfigParser::LocationConfig& location = locations[i];
+    switch (location.modifier) {
+      case ConfigParser::LocationModifier::EXACT:
+        _exact_paths.push_back(location.path);
+        _exact.emplace(_exact_paths.back(), i);  // first one wins
+        break;
+      case ConfigParser::LocationModifier::PREFIX:
+      case ConfigParser::LocationModifier::PREFERRED_PREFIX:
+        _prefixes.push_back(
+            {location.path, i,
+             location.modifier ==
+                 ConfigParser::LocationModifier::PREFERRED_PREFIX});
+        break;
+      case ConfigParser::LocationModifier::REGEX:
+      case ConfigParser::LocationModifier::REGEX_CASELESS:
+        _regex.addPattern(
+            location.path,
+            location.modifier ==
+                ConfigParser::LocationModifier::REGEX_CASELESS);
+        _regex_locations.push_back(i);
+        break;
+    }
+  }
+  std::stable_sort(_prefixes.begin(), _prefixes.end(),
+                   [](const Prefix& a, const Prefix& b) {
+                     return a.path.length() > b.path.length();
+                   });
+  _regex.compile();
+}
+
+/**
+ * @brief Finds the location serving path
+ * @param path Request path without query string
+ * @return Index of the location, -1 if no location matches
+ */
+int LocationMatcher::find(std::string_view path) const {
+  auto exact = _exact.find(path);
+  if (exact != _exact.end()) {
+    return static_cast<int>(exact->second);
+  }
+
+  const Prefix* prefix = nullptr;
+  for (const Prefix& candidate : _prefixes) {
+    if (path.compare(0, candidate.path.length(), candidate.path) == 0) {
+      prefix = &candidate;
+      break;
+    }
+  }
+  if (prefix && prefix->preferred) {
+    return static_cast<int>(prefix->index);
+  }
+
+  int pattern = _regex.match(path);
+  if (pattern >= 0) {
+    return static_cast<int>(_regex_locations[pattern]);
+  }
+  return prefix ? static_cast<int>(prefix->index) : -1;
+}
+
+size_t LocationMatcher::regexStateCount(void) const {
+  return _regex.stateCount();
+}
@@ -6,6 +6,7 @@
 
 std::ofstream Logger::_log_file;
 std::mutex    Logger::_log_mutex;
+std::atomic<bool> Logger::_enabled(true);
 
 /**
  * @brief Get the log level as a string
@@ -78,6 +79,23 @@ void Logger::shutdown() {
     }
 }
 
+/**
+ * @brief Turn the logger into a null sink, later messages are dropped
+ * @note Callers on the request path check isEnabled() before building a
+ *       message, so a disabled logger costs no allocations or writes
+ */
+void Logger::disable() {
+    _enabled = false;
+}
+
+/**
+ * @brief Check whether messages are written anywhere
+ * @return false after disable()
+ */
+bool Logger::isEnabled() {
+    return _enabled;
+}
+
 /**
  * @brief Log a message with the specified level
  * @param message The message to log
@@ -86,6 +104,9 @@ void Logger::shutdown() {
  * @note Warning and Error messages are flushed immediately
  */
 void Logger::log(const std::string& message, LogLevel level) {
+    if (!_enabled) {
+        return;
+    }
     std::lock_guard<std::mutex> lock(_log_mutex);
 
     if (!_log_file.is_open()) {
@@ -0,0 +1,233 @@
+/**
+ * @file MimeTypes.cpp
+ * @brief Built-in MIME types and tables compiled from `types {}` blocks
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-05
+ * @version 1.0
+ */
+
+#include "MimeTypes.hpp"
+
+#include <stdexcept>
+
+/// @note Based on standard nginx MIME type mappings
+static constexpr MimeTypes::Entry kBuiltinTypes[] = {
+    {"html", "text/html"},
+    {"htm", "text/html"},
+    {"shtml", "text/html"},
+    {"css", "text/css"},
+    {"xml", "text/xml"},
+    {"txt", "text/plain"},
+    {"mml", "text/mathml"},
+    {"jad", "text/vnd.sun.j2me.app-descriptor"},
+    {"wml", "text/vnd.wap.wml"},
+    {"htc", "text/x-component"},
+
+    {"gif", "image/gif"},
+    {"jpeg", "image/jpeg"},
+    {"jpg", "image/jpeg"},
+    {"png", "image/png"},
+    {"tif", "image/tiff"},
+    {"tiff", "image/tiff"},
+    {"wbmp", "image/vnd.wap.wbmp"},
+    {"ico", "image/x-icon"},
+    {"jng", "image/x-jng"},
+    {"bmp", "image/x-ms-bmp"},
+    {"svg", "image/svg+xml"},
+    {"svgz", "image/svg+xml"},
+    {"webp", "image/webp"},
+
+    {"js", "application/javascript"},
+    {"atom", "application/atom+xml"},
+    {"rss", "application/rss+xml"},
+    {"woff", "application/font-woff"},
+    {"jar", "application/java-archive"},
+    {"war", "application/java-archive"},
+    {"ear", "application/java-archive"},
+    {"json", "application/json"},
+    {"hqx", "application/mac-binhex40"},
+    {"doc", "application/msword"},
+    {"pdf", "application/pdf"},
+    {"ps", "application/postscript"},
+    {"eps", "application/postscript"},
+    {"ai", "application/postscript"},
+    {"rtf", "application/rtf"},
+    {"m3u8", "application/vnd.apple.mpegurl"},
+    {"xls", "application/vnd.ms-excel"},
+    {"eot", "application/vnd.ms-fontobject"},
+    {"ppt", "application/vnd.ms-powerpoint"},
+    {"wmlc", "application/vnd.wap.wmlc"},
+    {"kml", "application/vnd.google-earth.kml+xml"},
+    {"kmz", "application/vnd.google-earth.kmz"},
+    {"7z", "application/x-7z-compressed"},
+    {"cco", "application/x-cocoa"},
+    {"jardiff", "application/x-java-archive-diff"},
+    {"jnlp", "application/x-java-jnlp-file"},
+    {"run", "application/x-makeself"},
+    {"pl", "application/x-perl"},
+    {"pm", "application/x-perl"},
+    {"prc", "application/x-pilot"},
+    {"pdb", "application/x-pilot"},
+    {"rar", "application/x-rar-compressed"},
+    {"rpm", "application/x-redhat-package-manager"},
+    {"sea", "application/x-sea"},
+    {"swf", "application/x-shockwave-flash"},
+    {"sit", "application/x-stuffit"},
+    {"tcl", "application/x-tcl"},
+    {"tk", "application/x-tcl"},
+    {"der", "application/x-x509-ca-cert"},
+    {"pem", "application/x-x509-ca-cert"},
+    {"crt", "application/x-x509-ca-cert"},
+    {"xpi", "application/x-xpinstall"},
+    {"xhtml", "application/xhtml+xml"},
+    {"xspf", "application/xspf+xml"},
+    {"zip", "application/zip"},
+    {"docx",
+     "application/"
+     "vnd.openxmlformats-officedocument.wordprocessingml.document"},
+    {"xlsx",
+     "application/"
+     "vnd.openxmlformats-officedocument.spreadsheetml.sheet"},
+    {"pptx",
+     "application/"
+     "vnd.openxmlformats-officedocument.presentationml.presentation"},
+
+    {"mid", "audio/midi"},
+    {"midi", "audio/midi"},
+    {"kar", "audio/midi"},
+    {"mp3", "audio/mpeg"},
+    {"ogg", "audio/ogg"},
+    {"m4a", "audio/x-m4a"},
+    {"ra", "audio/x-realaudio"},
+
+    {"3gpp", "video/3gpp"},
+    {"3gp", "video/3gpp"},
+    {"ts", "video/mp2t"},
+    {"mp4", "video/mp4"},
+    {"mpeg", "video/mpeg"},
+    {"mpg", "video/mpeg"},
+    {"mov", "video/quicktime"},
+    {"webm", "video/webm"},
+    {"flv", "video/x-flv"},
+    {"m4v", "video/x-m4v"},
+    {"mng", "video/x-mng"},
+    {"asx", "video/x-ms-asf"},
+    {"asf", "video/x-ms-asf"},
+    {"wmv", "video/x-ms-wmv"},
+    {"avi", "video/x-msvideo"},
+
+    {"bin", "application/octet-stream"},
+    {"exe", "application/octet-stream"},
+    {"dll", "application/octet-stream"},
+    {"deb", "application/octet-stream"},
+    {"dmg", "application/octet-stream"},
+    {"iso", "application/octet-stream"},
+    {"img", "application/octet-stream"},
+    {"msi", "application/octet-stream"},
+    {"msp", "application/octet-stream"},
+    {"msm", "application/octet-stream"},
+};
+
+static constexpr size_t kBuiltinCount =
+    sizeof(kBuiltinTypes) / sizeof(kBuiltinTypes[0]);
+static constexpr size_t kBuiltinBuckets = MimeTypes::bucketCount(kBuiltinCount);
+static constexpr size_t kBuiltinSlots = MimeTypes::slotCount(kBuiltinCount);
+
+struct BuiltinTable {
+  uint32_t displacement[kBuiltinBuckets];
+  uint32_t slots[kBuiltinSlots];
+  bool compiled;
+};
+
+static constexpr BuiltinTable compileBuiltinTable(void) {
+  BuiltinTable table{};
+  table.compiled = MimeTypes::buildPerfectHash(
+      kBuiltinTypes, kBuiltinCount, table.displacement, kBuiltinBuckets,
+      table.slots, kBuiltinSlots);
+  return table;
+}
+
+static constexpr BuiltinTable kBuiltinTable = compileBuiltinTable();
+static_assert(kBuiltinTable.compiled,
+              "No perfect hash for built-in MIME types (duplicate extension?)");
+static_assert(MimeTypes::lookup(kBuiltinTypes, kBuiltinTable.displacement,
+                                kBuiltinBuckets, kBuiltinTable.slots,
+                                kBuiltinSlots, "HTML") == "text/html");
+
+/**
+ * @brief Looks up extension in the built-in table
+ * @param extension File extension without dot (case-insensitive)
+ * @return MIME type or empty view if the extension is unknown
+ */
+std::string_view MimeTypes::findBuiltin(std::string_view extension) {
+  return lookup(kBuiltinTypes, kBuiltinTable.displacement, kBuiltinBuckets,
+                kBuiltinTable.slots, kBuiltinSlots, extension);
+}
+
+// MimeTable
+
+/**
+ * @brief Maps extension to MIME type, a later mapping of the same extension
+ *        replaces the earlier one (as in nginx)
+ * @param type MIME type, e.g. "text/html"
+ * @param extension File extension without dot
+ */
+void MimeTypes::MimeTable::add(const std::string& type,
+                               const std::string& extension) {
+  std::string key = extension;
+  for (char& c : key) {
+    c = toLower(c);
+  }
+  auto it = _index.find(key);
+  if (it != _index.end()) {
+    _types[it->second] = type;
+    return;
+  }
+  _index[key] = _extensions.size();
+  _extensions.push_back(extension);
+  _types.push_back(type);
+}
+
+/// @brief Adds all mappings of other table (used by repeated `types` blocks)
+void MimeTypes::MimeTable::merge(const MimeTable& other) {
+  for (size_t i = 0; i < other._extensions.size(); i++) {
+    add(other._types[i], other._extensions[i]);
+  }
+}
+
+/**
+ * @brief Builds the lookup structure, the table must not be changed after
+ * @throws std::runtime_error if no perfect hash was found
+ */
+void MimeTypes::MimeTable::compile(void) {
+  _entries.clear();
+  for (size_t i = 0; i < _extensions.size(); i++) {
+    _entries.push_back({_extensions[i], _types[i]});
+  }
+
+  size_t buckets = bucketCount(_entries.size());
+  size_t slots = slotCount(_entries.size());
+  for (int attempt = 0; attempt < 4; attempt++, slots *= 2) {
+    _displacement.assign(buckets, 0);
+    _slots.assign(slots, 0);
+    if (buildPerfectHash(_entries.data(), _entries.size(),
+                         _displacement.data(), buckets, _slots.data(),
+                         slots)) {
+      return;
+    }
+  }
+  throw std::runtime_error("Failed to build MIME types table of " +
+                           std::to_string(_entries.size()) + " extensions");
+}
+
+/**
+ * @brief Looks up extension in the compiled table
+ * @param extension File extension without dot (case-insensitive)
+ * @return MIME type or empty view if the extension is unknown
+ */
+std::string_view MimeTypes::MimeTable::find(std::string_view extension) const {
+  return lookup(_entries.data(), _displacement.data(), _displacement.size(),
+                _slots.data(), _slots.size(), extension);
+}
+
+size_t MimeTypes::MimeTable::size(void) const { return _entries.size(); }
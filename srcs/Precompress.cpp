@@ -0,0 +1,193 @@
+/**
+ * @file Precompress.cpp
+ * @brief Compressed variants of static files (`webserv-precompress`)
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-14
+ * @version 1.0
+ */
+
+#include "Precompress.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+#include "HttpUtils.hpp"
+
+namespace {
+
+bool sameTime(const struct timespec& a, const struct timespec& b) {
+  return a.tv_sec == b.tv_sec && a.tv_nsec == b.tv_nsec;
+}
+
+/**
+ * @brief Replaces path with data, stamped with the source's mtime
+ *
+ * Written to a hidden temporary file in the same directory and renamed, so
+ * the server never sends a half-written variant.
+ */
+bool writeVariant(const std::string& path, const std::string& data,
+                  const struct stat& source) {
+  size_t slash = path.rfind('/');
+  std::string temp = path.substr(0, slash + 1) + "." +
+                     path.substr(slash + 1) + ".XXXXXX";
+  int fd = mkstemp(&temp[0]);
+  if (fd == -1) {
+    return false;
+  }
+  bool written = fchmod(fd, source.st_mode & 0666) == 0;
+  for (size_t offset = 0; written && offset < data.size();) {
+    ssize_t n = write(fd, data.data() + offset, data.size() - offset);
+    if (n == -1 && errno == EINTR) {
+      continue;
+    }
+    written = n > 0;
+    offset += written ? static_cast<size_t>(n) : 0;
+  }
+  struct timespec times[2] = {source.st_atim, source.st_mtim};
+  written = written && futimens(fd, times) == 0;
+  written = close(fd) == 0 && written;
+  if (!written || rename(temp.c_str(), path.c_str()) == -1) {
+    unlink(temp.c_str());
+    return false;
+  }
+  return true;
+}
+
+/// @brief Brings every variant of one file up to date
+void compressFile(const std::string& path,
+                  const std::vector<Precompress::Encoding>& encodings,
+                  Precompress::Stats& stats) {
+  struct stat source;
+  if (stat(path.c_str(), &source) == -1 || !S_ISREG(source.st_mode)) {
+    stats.failed++;
+    return;
+  }
+  std::string content;
+  bool loaded = false;
+  for (const Precompress::Encoding& encoding : encodings) {
+    std::string variant = path + std::string(encoding.suffix);
+    struct stat info;
+    if (stat(variant.c_str(), &info) == 0 && S_ISREG(info.st_mode) &&
+        sameTime(info.st_mtim, source.st_mtim)) {
+      stats.up_to_date++;
+      continue;
+    }
+    if (!loaded && HttpUtils::getFileContent(path, content) == -1) {
+      stats.failed++;
+      return;
+    }
+    loaded = true;
+
+    std::string compressed;
+    if (!encoding.compress(content, compressed)) {
+      stats.failed++;
+    } else if (compressed.size() >= content.size()) {
+      unlink(variant.c_str());  // stale one of an older version
+      stats.not_smaller++;
+    } else if (!writeVariant(variant, compressed, source)) {
+      stats.failed++;
+    } else {
+      stats.written++;
+      stats.bytes_in += content.size();
+      stats.bytes_out += compressed.size();
+    }
+  }
+}
+
+}  // namespace
+
+namespace Precompress {
+
+/**
+ * @brief Writes compressed variants of the compressible files under root
+ *
+ * Hidden files and directories, symlinks, files smaller than
+ * PRECOMPRESS_MIN_SIZE and existing variants are skipped. The files are
+ * shared out to the threads one at a time, so a few large ones don't leave
+ * the others idle.
+ *
+ * @param root Document root
+ * @param encodings Variants to write
+ * @param threads Worker threads, 0 for one per core
+ * @return Counts of the run; stats.failed is 1 and nothing else is done if
+ *         root can't be walked
+ */
+Stats run(const std::string& root, const std::vector<Encoding>& encodings,
+          size_t threads) {
+  namespace fs = std::filesystem;
+
+  Stats total;
+  std::vector<std::string> files;
+  try {
+    for (fs::recursive_directory_iterator it(root), end; it != end; ++it) {
+      std::string name = it->path().filename().string();
+      if (name[0] == '.') {
+        it.disable_recursion_pending();
+        continue;
+      }
+      std::string path = it->path().string();
+      if (it->symlink_status().type() == fs::file_type::regular &&
+          it->file_size() >= PRECOMPRESS_MIN_SIZE &&
+          HttpUtils::isCompressibleType(HttpUtils::getMIME(path)) &&
+          !isVariant(path, encodings)) {
+        files.push_back(std::move(path));
+      }
+    }
+  } catch (const fs::filesystem_error&) {
+    total.failed = 1;
+    return total;
+  }
+  total.files = files.size();
+
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  threads = std::min(threads, std::max<size_t>(1, files.size()));
+
+  std::atomic<size_t> next_file{0};
+  std::mutex total_mutex;
+  auto work = [&]() {
+    Stats stats;
+    for (size_t i = next_file++; i < files.size(); i = next_file++) {
+      compressFile(files[i], encodings, stats);
+    }
+    std::lock_guard<std::mutex> lock(total_mutex);
+    total.written += stats.written;
+    total.up_to_date += stats.up_to_date;
+    total.not_smaller += stats.not_smaller;
+    total.failed += stats.failed;
+    total.bytes_in += stats.bytes_in;
+    total.bytes_out += stats.bytes_out;
+  };
+  std::vector<std::thread> pool;
+  for (size_t i = 1; i < threads; i++) {
+    pool.emplace_back(work);
+  }
+  work();
+  for (std::thread& thread : pool) {
+    thread.join();
+  }
+  return total;
+}
+
+/// @brief Checks if path ends with the suffix of one of the encodings
+bool isVariant(std::string_view path, const std::vector<Encoding>& encodings) {
+  for (const Encoding& encoding : encodings) {
+    if (path.size() > encoding.suffix.size() &&
+        path.substr(path.size() - encoding.suffix.size()) == encoding.suffix) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace Precompress
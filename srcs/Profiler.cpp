@@ -0,0 +1,426 @@
+/**
+ * @file Profiler.cpp
+ * @brief On-demand CPU sampling and heap allocation sampling
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-17
+ * @version 1.0
+ */
+
+#include "Profiler.hpp"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <ucontext.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct CpuSample {
+  uint32_t depth;
+  uintptr_t frames[PROFILER_MAX_FRAMES];  // innermost first
+};
+
+struct HeapSite {
+  uint64_t hash;  // 0 = free slot
+  uint32_t depth;
+  uintptr_t frames[PROFILER_HEAP_FRAMES];
+  uint64_t samples;
+  uint64_t bytes;  // estimated allocated bytes
+};
+
+// CPU profile, the SIGPROF handler only touches these while g_running
+std::vector<CpuSample> g_samples;  // sized by start(), never grows
+std::atomic<size_t> g_sample_count(0);
+std::atomic<bool> g_running(false);
+int64_t g_deadline_ns = 0;
+uintptr_t g_stack_low = 0;
+uintptr_t g_stack_high = 0;
+bool g_handler_installed = false;
+bool g_has_profile = false;
+std::string g_folded;  // the samples are dropped once folded
+
+// heap profile, constant-initialized: operator new runs before main()
+std::atomic<bool> g_heap_hook(false);
+std::atomic_flag g_heap_busy = ATOMIC_FLAG_INIT;
+thread_local long g_heap_countdown = PROFILER_HEAP_INTERVAL;
+HeapSite g_heap_sites[PROFILER_HEAP_SITES];
+uint64_t g_heap_dropped = 0;
+uintptr_t g_heap_stack_low = 0;
+uintptr_t g_heap_stack_high = 0;
+
+int64_t monotonicNs(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+bool getStackBounds(uintptr_t& low, uintptr_t& high) {
+  pthread_attr_t attr;
+  void* address = nullptr;
+  size_t size = 0;
+  if (pthread_getattr_np(pthread_self(), &attr) != 0) {
+    return false;
+  }
+  bool found = pthread_attr_getstack(&attr, &address, &size) == 0;
+  pthread_attr_destroy(&attr);
+  low = reinterpret_cast<uintptr_t>(address);
+  high = low + size;
+  return found;
+}
+
+/**
+ * @brief Follows the frame pointer chain, async-signal-safe
+ *
+ * Every frame starts with the caller's frame pointer followed by the return
+ * address. The walk stops at the first frame outside the stack or not above
+ * the previous one, so a register without a frame pointer in it (library
+ * code) ends the stack instead of faulting.
+ *
+ * @return Number of return addresses written to frames
+ */
+size_t walkFrames(uintptr_t fp, uintptr_t low, uintptr_t high,
+                  uintptr_t* frames, size_t max) {
+  size_t depth = 0;
+  while (depth < max && fp >= low && fp + 2 * sizeof(uintptr_t) <= high &&
+         fp % sizeof(uintptr_t) == 0) {
+    const uintptr_t* frame = reinterpret_cast<const uintptr_t*>(fp);
+    if (frame[1] == 0) {
+      break;
+    }
+    frames[depth++] = frame[1];
+    if (frame[0] <= fp) {
+      break;
+    }
+    fp = frame[0];
+  }
+  return depth;
+}
+
+void disarmTimer(void) {
+  struct itimerval off;
+  std::memset(&off, 0, sizeof(off));
+  setitimer(ITIMER_PROF, &off, nullptr);
+  g_running.store(false, std::memory_order_release);
+}
+
+/// @brief SIGPROF: one sample of the interrupted code, disarms when over
+void onProfileSignal(int, siginfo_t*, void* context) {
+  if (!g_running.load(std::memory_order_acquire)) {
+    return;
+  }
+  int saved_errno = errno;
+  size_t index = g_sample_count.load(std::memory_order_relaxed);
+  if (monotonicNs() >= g_deadline_ns || index >= g_samples.size()) {
+    disarmTimer();
+    errno = saved_errno;
+    return;
+  }
+
+  const ucontext_t* interrupted = static_cast<const ucontext_t*>(context);
+  uintptr_t pc = 0;
+  uintptr_t fp = 0;
+#if defined(__x86_64__)
+  pc = static_cast<uintptr_t>(interrupted->uc_mcontext.gregs[REG_RIP]);
+  fp = static_cast<uintptr_t>(interrupted->uc_mcontext.gregs[REG_RBP]);
+#elif defined(__aarch64__)
+  pc = static_cast<uintptr_t>(interrupted->uc_mcontext.pc);
+  fp = static_cast<uintptr_t>(interrupted->uc_mcontext.regs[29]);
+#else
+  (void)interrupted;  // no unwinding: the samples only have the pc
+#endif
+  CpuSample& sample = g_samples[index];
+  sample.frames[0] = pc;
+  size_t callers = walkFrames(fp, g_stack_low, g_stack_high,
+                              sample.frames + 1, PROFILER_MAX_FRAMES - 1);
+  sample.depth = 1 + static_cast<uint32_t>(callers);
+  g_sample_count.store(index + 1, std::memory_order_release);
+  errno = saved_errno;
+}
+
+/// @brief Stops a profile whose time is over (the handler may not run again)
+void finishIfOver(void) {
+  if (g_running.load(std::memory_order_acquire) &&
+      monotonicNs() >= g_deadline_ns) {
+    disarmTimer();
+  }
+}
+
+/**
+ * @brief Name of the function containing address
+ * @return Demangled symbol, `module+0xoffset` for symbols dladdr() can't see
+ *         (static functions, executables without -rdynamic)
+ */
+const std::string& symbolize(
+    uintptr_t address, std::unordered_map<uintptr_t, std::string>& cache) {
+  auto it = cache.find(address);
+  if (it != cache.end()) {
+    return it->second;
+  }
+  std::string& symbol = cache[address];
+  Dl_info info;
+  std::memset(&info, 0, sizeof(info));
+  if (dladdr(reinterpret_cast<void*>(address), &info) != 0 &&
+      info.dli_sname != nullptr) {
+    int status = 0;
+    char* name =
+        abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    symbol = (status == 0) ? name : info.dli_sname;
+    std::free(name);
+    return symbol;
+  }
+  std::ostringstream text;
+  if (info.dli_fname != nullptr) {
+    const char* slash = std::strrchr(info.dli_fname, '/');
+    text << (slash ? slash + 1 : info.dli_fname) << "+0x" << std::hex
+         << address - reinterpret_cast<uintptr_t>(info.dli_fbase);
+  } else {
+    text << "0x" << std::hex << address;
+  }
+  symbol = text.str();
+  return symbol;
+}
+
+/**
+ * @brief Outermost-first `a;b;c` line of a stack
+ * @param frames Innermost first; return addresses are looked up one byte
+ *        back, inside the call instruction
+ * @param leaf_is_pc true if frames[0] is an interrupted pc, not a return
+ */
+std::string foldStack(const uintptr_t* frames, size_t depth, bool leaf_is_pc,
+                      std::unordered_map<uintptr_t, std::string>& cache) {
+  std::string line;
+  for (size_t i = depth; i-- > 0;) {
+    uintptr_t address = (i == 0 && leaf_is_pc) ? frames[i] : frames[i] - 1;
+    line += symbolize(address, cache);
+    if (i > 0) {
+      line += ';';
+    }
+  }
+  return line.empty() ? "[unknown]" : line;
+}
+
+}  // namespace
+
+namespace Profiler {
+
+/**
+ * @brief Starts a CPU profile of this process
+ *
+ * Samples are taken every 1/PROFILER_HZ s of CPU time (an idle server takes
+ * few) until `seconds` of wall time have passed. The sample buffer for the
+ * whole profile is allocated here.
+ *
+ * @param seconds Profile time, 1 to PROFILER_MAX_SECONDS
+ * @param error_msg [out] Why the profile didn't start
+ * @return false if a profile is running, the time is invalid or the timer
+ *         can't be armed
+ */
+bool start(unsigned seconds, std::string& error_msg) {
+  if (isRunning()) {
+    error_msg = "a profile is already running";
+    return false;
+  }
+  if (seconds == 0 || seconds > PROFILER_MAX_SECONDS) {
+    error_msg = "profile time must be 1 to " +
+                std::to_string(PROFILER_MAX_SECONDS) + " seconds";
+    return false;
+  }
+  if (!getStackBounds(g_stack_low, g_stack_high)) {
+    error_msg = "stack bounds unknown";
+    return false;
+  }
+  if (!g_handler_installed) {
+    // stays installed: a late SIGPROF must never meet the default action
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_sigaction = onProfileSignal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, nullptr) == -1) {
+      error_msg = std::string("sigaction() failed: ") + strerror(errno);
+      return false;
+    }
+    g_handler_installed = true;
+  }
+
+  // a single thread can't use more CPU time than wall time
+  g_samples.assign((seconds + 1) * PROFILER_HZ, CpuSample());
+  g_sample_count.store(0);
+  g_folded.clear();
+  g_deadline_ns = monotonicNs() + static_cast<int64_t>(seconds) * 1000000000;
+  g_running.store(true, std::memory_order_release);
+
+  struct itimerval timer;
+  timer.it_interval.tv_sec = 0;
+  timer.it_interval.tv_usec = 1000000 / PROFILER_HZ;
+  timer.it_value = timer.it_interval;
+  if (setitimer(ITIMER_PROF, &timer, nullptr) == -1) {
+    g_running.store(false);
+    std::vector<CpuSample>().swap(g_samples);
+    error_msg = std::string("setitimer() failed: ") + strerror(errno);
+    return false;
+  }
+  g_has_profile = true;
+  return true;
+}
+
+bool isRunning(void) {
+  finishIfOver();
+  return g_running.load(std::memory_order_acquire);
+}
+
+/// @brief Seconds until the running profile is over (rounded up)
+unsigned getRemainingSeconds(void) {
+  if (!isRunning()) {
+    return 0;
+  }
+  int64_t left = g_deadline_ns - monotonicNs();
+  return static_cast<unsigned>((left + 999999999) / 1000000000);
+}
+
+/// @brief A profile was started since the server started
+bool hasProfile(void) { return g_has_profile; }
+
+/**
+ * @brief Samples of the last profile as folded stacks
+ *
+ * Identical stacks are merged into one `outer;...;inner count` line. Built
+ * on the first call after the profile is over, the samples are freed then.
+ *
+ * @return Folded stacks, empty while a profile is running
+ */
+std::string foldedStacks(void) {
+  if (isRunning()) {
+    return "";
+  }
+  if (!g_samples.empty()) {
+    std::unordered_map<uintptr_t, std::string> symbols;
+    std::map<std::string, size_t> stacks;
+    size_t count = g_sample_count.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; i++) {
+      stacks[foldStack(g_samples[i].frames, g_samples[i].depth, true,
+                       symbols)]++;
+    }
+    std::ostringstream folded;
+    for (const auto& stack : stacks) {
+      folded << stack.first << ' ' << stack.second << '\n';
+    }
+    g_folded = folded.str();
+    std::vector<CpuSample>().swap(g_samples);
+  }
+  return g_folded;
+}
+
+/// @brief Called once by the sampling operator new of heap_hook.cpp
+void installHeapHook(void) { g_heap_hook.store(true); }
+
+bool isHeapHookInstalled(void) { return g_heap_hook.load(); }
+
+/**
+ * @brief Counts an allocation, records its call stack now and then
+ *
+ * Every PROFILER_HEAP_INTERVAL allocated bytes the allocation that crosses
+ * the mark is recorded, weighted by the interval (or its size if larger).
+ * Never allocates; a sample taken while the table is in use is skipped.
+ *
+ * @param size Bytes asked for
+ */
+void sampleAllocation(size_t size) {
+  g_heap_countdown -= static_cast<long>(size);
+  if (g_heap_countdown > 0) {
+    return;
+  }
+  g_heap_countdown = PROFILER_HEAP_INTERVAL;
+  if (g_heap_busy.test_and_set(std::memory_order_acquire)) {
+    return;
+  }
+  if (g_heap_stack_high != 0 ||
+      getStackBounds(g_heap_stack_low, g_heap_stack_high)) {
+    // the first frame returns into operator new, the site is its caller
+    uintptr_t frames[PROFILER_HEAP_FRAMES + 1];
+    size_t depth = walkFrames(
+        reinterpret_cast<uintptr_t>(__builtin_frame_address(0)),
+        g_heap_stack_low, g_heap_stack_high, frames, PROFILER_HEAP_FRAMES + 1);
+    depth = (depth > 1) ? depth - 1 : 0;
+
+    uint64_t hash = 1469598103934665603ull;  // FNV-1a over the addresses
+    for (size_t i = 0; i < depth; i++) {
+      hash = (hash ^ frames[i + 1]) * 1099511628211ull;
+    }
+    hash |= 1;
+
+    size_t slot = hash % PROFILER_HEAP_SITES;
+    size_t probes = 0;
+    while (g_heap_sites[slot].hash != 0 && g_heap_sites[slot].hash != hash &&
+           probes < PROFILER_HEAP_SITES) {
+      slot = (slot + 1) % PROFILER_HEAP_SITES;
+      probes++;
+    }
+    HeapSite& site = g_heap_sites[slot];
+    if (probes == PROFILER_HEAP_SITES) {
+      g_heap_dropped++;
+    } else {
+      if (site.hash == 0) {
+        site.hash = hash;
+        site.depth = static_cast<uint32_t>(depth);
+        std::memcpy(site.frames, frames + 1, depth * sizeof(uintptr_t));
+      }
+      site.samples++;
+      site.bytes += std::max<uint64_t>(size, PROFILER_HEAP_INTERVAL);
+    }
+  }
+  g_heap_busy.clear(std::memory_order_release);
+}
+
+/**
+ * @brief Allocation sites by estimated allocated bytes since start
+ *
+ * One `outer;...;site bytes` line per site, heaviest first, so the report
+ * also renders with flamegraph.pl. Samples taken while the report is built
+ * are skipped.
+ *
+ * @param top Number of sites to list
+ */
+std::string heapReport(size_t top) {
+  while (g_heap_busy.test_and_set(std::memory_order_acquire)) {
+  }
+  std::vector<HeapSite> sites;
+  for (const HeapSite& site : g_heap_sites) {
+    if (site.hash != 0) {
+      sites.push_back(site);
+    }
+  }
+  uint64_t dropped = g_heap_dropped;
+  g_heap_busy.clear(std::memory_order_release);
+
+  std::sort(sites.begin(), sites.end(),
+            [](const HeapSite& a, const HeapSite& b) {
+              return a.bytes > b.bytes;
+            });
+  std::unordered_map<uintptr_t, std::string> symbols;
+  std::ostringstream report;
+  report << "# allocation sites: " << sites.size() << ", one sample per "
+         << PROFILER_HEAP_INTERVAL << " bytes allocated, samples dropped: "
+         << dropped << "\n";
+  for (size_t i = 0; i < sites.size() && i < top; i++) {
+    report << foldStack(sites[i].frames, sites[i].depth, false, symbols)
+           << ' ' << sites[i].bytes << '\n';
+  }
+  return report.str();
+}
+
+}  // namespace Profiler
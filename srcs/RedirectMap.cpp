@@ -0,0 +1,189 @@
+/**
+ * @file RedirectMap.cpp
+ * @brief Bulk redirects loaded from `redirect_map` files
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-06
+ * @version 1.0
+ */
+
+#include "RedirectMap.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * @brief Reads redirects from map file
+ *
+ * @param path Path to the map file
+ * @param default_code Status code of lines without their own code
+ * @throws std::runtime_error if file can't be read or a line is invalid
+ */
+void RedirectMap::load(const std::string& path, int default_code) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open redirect map: " + path);
+  }
+
+  std::string line;
+  size_t line_number = 0;
+  while (std::getline(file, line)) {
+    line_number++;
+    line = line.substr(0, line.find('#'));
+    size_t semicolon = line.find_last_not_of(" \t\r");
+    if (semicolon != std::string::npos && line[semicolon] == ';') {
+      line.erase(semicolon);
+    }
+
+    std::istringstream fields(line);
+    std::string from;
+    std::string to;
+    std::string code_field;
+    std::string extra;
+    if (!(fields >> from)) {
+      continue;  // empty line or comment
+    }
+    int code = default_code;
+    if (!(fields >> to) || (fields >> code_field && fields >> extra) ||
+        from[0] != '/') {
+      throw std::runtime_error(path + ":" + std::to_string(line_number) +
+                               ": expected '/path target [code];'");
+    }
+    if (!code_field.empty()) {
+      try {
+        code = std::stoi(code_field);
+      } catch (...) {
+        code = 0;
+      }
+      if (!isRedirectCode(code)) {
+        throw std::runtime_error(path + ":" + std::to_string(line_number) +
+                                 ": invalid redirect code '" + code_field +
+                                 "'");
+      }
+    }
+
+    if (from.size() >= 2 && from.compare(from.size() - 2, 2, "/*") == 0) {
+      addPrefix(from.substr(0, from.size() - 1), to, code);
+    } else {
+      addExact(from, to, code);
+    }
+  }
+}
+
+/**
+ * @brief Adds redirect of one path, a later entry for the same path wins
+ */
+void RedirectMap::addExact(const std::string& from, const std::string& to,
+                           int code) {
+  auto it = _exact.find(from);
+  if (it != _exact.end()) {
+    it->second = {to, code};
+    return;
+  }
+  _exact.emplace(storeKey(from), Target{to, code});
+}
+
+/**
+ * @brief Adds redirect of every path under prefix
+ * @param prefix Path prefix, matched by whole segments ("/old/" or "/old")
+ * @param to Target URL, `*` is replaced with the rest of the path
+ * @param code Redirect status code
+ */
+void RedirectMap::addPrefix(const std::string& prefix, const std::string& to,
+                            int code) {
+  size_t node = 0;
+  size_t start = 0;
+  while (start < prefix.size()) {
+    size_t end = prefix.find('/', start);
+    end = (end == std::string::npos) ? prefix.size() : end;
+    if (end > start) {
+      std::string_view segment =
+          std::string_view(prefix).substr(start, end - start);
+      auto it = _trie[node].children.find(segment);
+      if (it == _trie[node].children.end()) {
+        _trie.push_back(Node());
+        it = _trie[node]
+                 .children.emplace(storeKey(segment), _trie.size() - 1)
+                 .first;
+      }
+      node = it->second;
+    }
+    start = end + 1;
+  }
+
+  if (_trie[node].rule >= 0) {
+    _prefix_targets[_trie[node].rule] = {to, code};
+    return;
+  }
+  _trie[node].rule = static_cast<int>(_prefix_targets.size());
+  _prefix_targets.push_back({to, code});
+}
+
+/**
+ * @brief Finds redirect for request path
+ *
+ * @param path Request path without query string
+ * @param url [out] Redirect target
+ * @param code [out] Redirect status code
+ * @return true if the path is redirected
+ */
+bool RedirectMap::resolve(std::string_view path, std::string& url,
+                          int& code) const {
+  auto exact = _exact.find(path);
+  if (exact != _exact.end()) {
+    url = exact->second.url;
+    code = exact->second.code;
+    return true;
+  }
+  if (_prefix_targets.empty()) {
+    return false;
+  }
+
+  size_t node = 0;
+  int rule = _trie[0].rule;
+  size_t rest = std::min<size_t>(1, path.size());  // part after the rule
+  size_t start = 0;
+  while (start < path.size()) {
+    size_t end = path.find('/', start);
+    end = (end == std::string_view::npos) ? path.size() : end;
+    if (end > start) {
+      auto it = _trie[node].children.find(path.substr(start, end - start));
+      if (it == _trie[node].children.end()) {
+        break;
+      }
+      node = it->second;
+      if (_trie[node].rule >= 0) {
+        rule = _trie[node].rule;
+        rest = std::min(end + 1, path.size());
+      }
+    }
+    start = end + 1;
+  }
+  if (rule < 0) {
+    return false;
+  }
+
+  const Target& target = _prefix_targets[rule];
+  url = target.url;
+  size_t star = url.find('*');
+  if (star != std::string::npos) {
+    url.replace(star, 1, path.substr(rest));
+  }
+  code = target.code;
+  return true;
+}
+
+size_t RedirectMap::size(void) const {
+  return _exact.size() + _prefix_targets.size();
+}
+
+bool RedirectMap::isRedirectCode(int code) {
+  return code == 301 || code == 302 || code == 303 || code == 307 ||
+         code == 308;
+}
+
+std::string_view RedirectMap::storeKey(std::string_view key) {
+  _keys.emplace_back(key);
+  return _keys.back();
+}
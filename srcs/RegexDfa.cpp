@@ -0,0 +1,608 @@
+/**
+ * @file RegexDfa.cpp
+ * @brief Set of regular expressions compiled into one DFA
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-07
+ * @version 1.0
+ */
+
+#include "RegexDfa.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <stdexcept>
+
+/**
+ * @brief Parses one pattern into an AST and appends its NFA to the RegexDfa
+ */
+class RegexCompiler {
+ public:
+  RegexCompiler(RegexDfa& dfa, const std::string& pattern, bool caseless)
+      : _dfa(dfa), _pattern(pattern), _pos(0), _caseless(caseless) {}
+
+  void compile(int pattern_index);
+
+ private:
+  struct Node {
+    enum Type { CHARSET, CONCAT, ALTERNATE, REPEAT } type = CONCAT;
+    std::bitset<256> set;
+    std::vector<Node> children;
+    int min = 0;
+    int max = -1;  // REPEAT: -1 = unbounded
+  };
+
+  RegexDfa& _dfa;
+  const std::string& _pattern;
+  size_t _pos;
+  bool _caseless;
+
+ private:
+  Node parseAlternation(void);
+  Node parseConcat(void);
+  Node parseRepeat(void);
+  Node parseAtom(void);
+  Node parseClass(void);
+  bool parseBounds(int& min, int& max);
+  std::bitset<256> parseEscape(void);
+
+  Node charset(const std::bitset<256>& set) const;
+  static Node repeat(Node child, int min, int max);
+  int build(const Node& node, int from);
+  void addEpsilon(int from, int to);
+  [[noreturn]] void fail(const std::string& message) const;
+};
+
+// RegexCompiler
+
+/**
+ * @brief Adds the pattern to the NFA, accepting with pattern_index
+ *
+ * Without `^` the pattern may start anywhere and without `$` anything may
+ * follow, which is expressed as an implicit "any byte" loop on either side.
+ */
+void RegexCompiler::compile(int pattern_index) {
+  std::bitset<256> any;
+  any.set();
+
+  size_t end = _pattern.length();
+  bool anchored_start = (!_pattern.empty() && _pattern[0] == '^');
+  bool anchored_end = false;
+  if (end > 0 && _pattern[end - 1] == '$') {
+    size_t backslashes = 0;
+    while (backslashes + 1 < end && _pattern[end - 2 - backslashes] == '\\') {
+      backslashes++;
+    }
+    anchored_end = (backslashes % 2 == 0);
+  }
+
+  std::string body = _pattern.substr(
+      anchored_start ? 1 : 0,
+      end - (anchored_start ? 1 : 0) - (anchored_end ? 1 : 0));
+  RegexCompiler inner(_dfa, body, _caseless);
+  Node root;
+  root.type = Node::CONCAT;
+  if (!anchored_start) {
+    root.children.push_back(repeat(charset(any), 0, -1));
+  }
+  root.children.push_back(inner.parseAlternation());
+  if (inner._pos != body.length()) {
+    inner.fail("unbalanced ')'");
+  }
+  if (!anchored_end) {
+    root.children.push_back(repeat(charset(any), 0, -1));
+  }
+
+  int start = _dfa.newState();
+  int accept = build(root, start);
+  _dfa._nfa[accept].accept = pattern_index;
+  _dfa._pattern_starts.push_back(start);
+}
+
+RegexCompiler::Node RegexCompiler::parseAlternation(void) {
+  Node first = parseConcat();
+  if (_pos >= _pattern.length() || _pattern[_pos] != '|') {
+    return first;
+  }
+  Node node;
+  node.type = Node::ALTERNATE;
+  node.children.push_back(first);
+  while (_pos < _pattern.length() && _pattern[_pos] == '|') {
+    _pos++;
+    node.children.push_back(parseConcat());
+  }
+  return node;
+}
+
+RegexCompiler::Node RegexCompiler::parseConcat(void) {
+  Node node;
+  node.type = Node::CONCAT;
+  while (_pos < _pattern.length() && _pattern[_pos] != '|' &&
+         _pattern[_pos] != ')') {
+    node.children.push_back(parseRepeat());
+  }
+  return node;
+}
+
+RegexCompiler::Node RegexCompiler::parseRepeat(void) {
+  Node node = parseAtom();
+  while (_pos < _pattern.length()) {
+    char c = _pattern[_pos];
+    int min = 0;
+    int max = -1;
+    if (c == '*') {
+      _pos++;
+    } else if (c == '+') {
+      min = 1;
+      _pos++;
+    } else if (c == '?') {
+      max = 1;
+      _pos++;
+    } else if (c != '{' || !parseBounds(min, max)) {
+      break;
+    }
+    if (_pos < _pattern.length() && _pattern[_pos] == '?') {
+      _pos++;  // lazy quantifier, same set of matches
+    }
+    node = repeat(node, min, max);
+  }
+  return node;
+}
+
+/**
+ * @brief Parses `{n}`, `{n,}` or `{n,m}` at _pos
+ * @return false (nothing consumed) if it isn't a quantifier, PCRE then
+ *         treats `{` as a literal
+ */
+bool RegexCompiler::parseBounds(int& min, int& max) {
+  size_t pos = _pos + 1;
+  auto number = [&](int& value) {
+    size_t start = pos;
+    value = 0;
+    while (pos < _pattern.length() && std::isdigit(_pattern[pos]) &&
+           value <= REGEX_MAX_REPEAT) {
+      value = value * 10 + (_pattern[pos++] - '0');
+    }
+    return pos > start;
+  };
+
+  if (!number(min)) {
+    return false;
+  }
+  max = min;
+  if (pos < _pattern.length() && _pattern[pos] == ',') {
+    pos++;
+    max = -1;
+    if (pos < _pattern.length() && _pattern[pos] != '}' && !number(max)) {
+      return false;
+    }
+  }
+  if (pos >= _pattern.length() || _pattern[pos] != '}') {
+    return false;
+  }
+  if (min > REGEX_MAX_REPEAT || max > REGEX_MAX_REPEAT ||
+      (max != -1 && max < min)) {
+    fail("invalid repeat bounds");
+  }
+  _pos = pos + 1;
+  return true;
+}
+
+RegexCompiler::Node RegexCompiler::parseAtom(void) {
+  char c = _pattern[_pos];
+  std::bitset<256> set;
+
+  switch (c) {
+    case '(': {
+      _pos++;
+      if (_pattern.compare(_pos, 2, "?:") == 0) {
+        _pos += 2;
+      } else if (_pos < _pattern.length() && _pattern[_pos] == '?') {
+        fail("only (?:...) groups are supported");
+      }
+      Node node = parseAlternation();
+      if (_pos >= _pattern.length() || _pattern[_pos] != ')') {
+        fail("missing ')'");
+      }
+      _pos++;
+      return node;
+    }
+    case '[':
+      return parseClass();
+    case '.':
+      _pos++;
+      set.set();
+      set.reset('\n');
+      return charset(set);
+    case '\\':
+      return charset(parseEscape());
+    case '^':
+    case '$':
+      fail("anchors are only supported at the start and the end");
+    case '*':
+    case '+':
+    case '?':
+      fail("nothing to repeat");
+    default:
+      _pos++;
+      set.set(static_cast<unsigned char>(c));
+      return charset(set);
+  }
+}
+
+RegexCompiler::Node RegexCompiler::parseClass(void) {
+  std::bitset<256> set;
+  bool negate = false;
+
+  _pos++;  // '['
+  if (_pos < _pattern.length() && _pattern[_pos] == '^') {
+    negate = true;
+    _pos++;
+  }
+  bool first = true;
+  while (_pos < _pattern.length() && (_pattern[_pos] != ']' || first)) {
+    first = false;
+    if (_pattern[_pos] == '\\') {
+      std::bitset<256> escaped = parseEscape();
+      set |= escaped;
+      continue;
+    }
+    unsigned char low = static_cast<unsigned char>(_pattern[_pos++]);
+    if (_pos + 1 < _pattern.length() && _pattern[_pos] == '-' &&
+        _pattern[_pos + 1] != ']') {
+      _pos++;
+      unsigned char high;
+      if (_pattern[_pos] == '\\') {
+        std::bitset<256> escaped = parseEscape();
+        if (escaped.count() != 1) {
+          fail("invalid range in character class");
+        }
+        high = 0;
+        while (!escaped.test(high)) {
+          high++;
+        }
+      } else {
+        high = static_cast<unsigned char>(_pattern[_pos++]);
+      }
+      if (high < low) {
+        fail("invalid range in character class");
+      }
+      for (unsigned int b = low; b <= high; b++) {
+        set.set(b);
+      }
+    } else {
+      set.set(low);
+    }
+  }
+  if (_pos >= _pattern.length()) {
+    fail("missing ']'");
+  }
+  _pos++;  // ']'
+
+  Node node = charset(set);  // case folding before negation
+  if (negate) {
+    node.set.flip();
+  }
+  return node;
+}
+
+std::bitset<256> RegexCompiler::parseEscape(void) {
+  std::bitset<256> set;
+  _pos++;  // '\'
+  if (_pos >= _pattern.length()) {
+    fail("trailing '\\'");
+  }
+  char c = _pattern[_pos++];
+
+  switch (c) {
+    case 'd':
+    case 'D':
+      for (int b = '0'; b <= '9'; b++) set.set(b);
+      break;
+    case 'w':
+    case 'W':
+      for (int b = 0; b < 256; b++) {
+        if (std::isalnum(b) || b == '_') set.set(b);
+      }
+      break;
+    case 's':
+    case 'S':
+      for (char b : std::string(" \t\n\r\f\v")) set.set(b);
+      break;
+    case 't':
+      set.set('\t');
+      return set;
+    case 'n':
+      set.set('\n');
+      return set;
+    case 'r':
+      set.set('\r');
+      return set;
+    case 'x': {
+      if (_pos + 2 > _pattern.length() || !std::isxdigit(_pattern[_pos]) ||
+          !std::isxdigit(_pattern[_pos + 1])) {
+        fail("expected two hex digits after \\x");
+      }
+      set.set(std::stoi(_pattern.substr(_pos, 2), nullptr, 16));
+      _pos += 2;
+      return set;
+    }
+    default:
+      if (std::isalnum(static_cast<unsigned char>(c))) {
+        fail(std::string("unsupported escape \\") + c);
+      }
+      set.set(static_cast<unsigned char>(c));
+      return set;
+  }
+  if (std::isupper(static_cast<unsigned char>(c))) {
+    set.flip();
+  }
+  return set;
+}
+
+/// @brief Character set node, with both letter cases for `~*` patterns
+RegexCompiler::Node RegexCompiler::charset(const std::bitset<256>& set) const {
+  Node node;
+  node.type = Node::CHARSET;
+  node.set = set;
+  if (_caseless) {
+    for (int b = 'a'; b <= 'z'; b++) {
+      if (set.test(b) || set.test(std::toupper(b))) {
+        node.set.set(b);
+        node.set.set(std::toupper(b));
+      }
+    }
+  }
+  return node;
+}
+
+RegexCompiler::Node RegexCompiler::repeat(Node child, int min, int max) {
+  Node node;
+  node.type = Node::REPEAT;
+  node.min = min;
+  node.max = max;
+  node.children.push_back(std::move(child));
+  return node;
+}
+
+/**
+ * @brief Thompson construction: adds states for node starting at `from`
+ * @return State reached after the node matched
+ */
+int RegexCompiler::build(const Node& node, int from) {
+  switch (node.type) {
+    case Node::CHARSET: {
+      int state = _dfa.newState();
+      int next = _dfa.newState();
+      _dfa._charsets.push_back(node.set);
+      _dfa._nfa[state].charset = static_cast<int>(_dfa._charsets.size() - 1);
+      _dfa._nfa[state].next = next;
+      addEpsilon(from, state);
+      return next;
+    }
+    case Node::CONCAT: {
+      int current = from;
+      for (const Node& child : node.children) {
+        current = build(child, current);
+      }
+      return current;
+    }
+    case Node::ALTERNATE: {
+      int end = _dfa.newState();
+      for (const Node& child : node.children) {
+        int start = _dfa.newState();
+        addEpsilon(from, start);
+        addEpsilon(build(child, start), end);
+      }
+      return end;
+    }
+    case Node::REPEAT: {
+      const Node& child = node.children[0];
+      int current = from;
+      for (int i = 0; i < node.min; i++) {
+        current = build(child, current);
+      }
+      if (node.max == -1) {
+        int loop = _dfa.newState();
+        addEpsilon(current, loop);
+        addEpsilon(build(child, loop), loop);
+        return loop;
+      }
+      int end = _dfa.newState();
+      addEpsilon(current, end);
+      for (int i = node.min; i < node.max; i++) {
+        current = build(child, current);
+        addEpsilon(current, end);
+      }
+      return end;
+    }
+  }
+  return from;
+}
+
+void RegexCompiler::addEpsilon(int from, int to) {
+  _dfa._nfa[from].epsilon.push_back(to);
+}
+
+void RegexCompiler::fail(const std::string& message) const {
+  throw std::runtime_error("regex '" + _pattern + "': " + message +
+                           " at offset " + std::to_string(_pos));
+}
+
+// RegexDfa
+
+/**
+ * @brief Adds pattern to the set, patterns are numbered in order of adding
+ * @param pattern Regular expression
+ * @param caseless Match letters in any case (nginx `~*`)
+ * @throws std::runtime_error on syntax errors and unsupported features
+ */
+void RegexDfa::addPattern(const std::string& pattern, bool caseless) {
+  if (_nfa.empty()) {
+    newState();  // common start state, see compile()
+  }
+  RegexCompiler compiler(*this, pattern, caseless);
+  compiler.compile(static_cast<int>(_pattern_starts.size()));
+}
+
+/**
+ * @brief Builds the DFA of all patterns added so far (subset construction)
+ * @param max_states Limit for the amount of DFA states
+ * @throws std::runtime_error if the DFA would exceed max_states
+ */
+void RegexDfa::compile(size_t max_states) {
+  _transitions.clear();
+  _accept.clear();
+  if (_pattern_starts.empty()) {
+    return;
+  }
+  computeByteClasses();
+  _nfa[0].epsilon = _pattern_starts;
+
+  uint8_t representative[256] = {};
+  for (int b = 255; b >= 0; b--) {
+    representative[_classes[b]] = static_cast<uint8_t>(b);
+  }
+
+  std::vector<uint32_t> marks(_nfa.size(), 0);
+  uint32_t stamp = 0;
+  std::map<std::vector<int>, int32_t> known;
+  std::vector<std::vector<int>> pending;
+
+  auto addState = [&](std::vector<int>& states) -> int32_t {
+    auto it = known.find(states);
+    if (it != known.end()) {
+      return it->second;
+    }
+    if (_accept.size() >= max_states) {
+      throw std::runtime_error("regex set needs more than " +
+                               std::to_string(max_states) + " DFA states");
+    }
+    int32_t id = static_cast<int32_t>(_accept.size());
+    int accept = -1;
+    for (int state : states) {
+      if (_nfa[state].accept >= 0 &&
+          (accept == -1 || _nfa[state].accept < accept)) {
+        accept = _nfa[state].accept;
+      }
+    }
+    _accept.push_back(accept);
+    _transitions.resize(_transitions.size() + _class_count, 0);
+    known.emplace(states, id);
+    pending.push_back(states);
+    return id;
+  };
+
+  std::vector<int> states;
+  addState(states);  // 0: dead state
+  states.push_back(0);
+  closure(states, marks, ++stamp);
+  _start = addState(states);
+
+  for (size_t id = 1; id < pending.size(); id++) {
+    for (size_t cls = 0; cls < _class_count; cls++) {
+      unsigned char byte = representative[cls];
+      std::vector<int> next;
+      for (int state : pending[id]) {
+        const NfaState& nfa = _nfa[state];
+        if (nfa.charset >= 0 && _charsets[nfa.charset].test(byte)) {
+          next.push_back(nfa.next);
+        }
+      }
+      closure(next, marks, ++stamp);
+      int32_t target = addState(next);
+      _transitions[id * _class_count + cls] = target;
+    }
+    pending[id].clear();
+    pending[id].shrink_to_fit();
+  }
+}
+
+/**
+ * @brief Runs the DFA over input
+ * @param input Text to match (e.g. request path)
+ * @return Lowest index of the matching patterns, -1 if none matched
+ */
+int RegexDfa::match(std::string_view input) const {
+  if (_accept.empty()) {
+    return -1;
+  }
+  int32_t state = _start;
+  for (char c : input) {
+    state = _transitions[state * _class_count +
+                         _classes[static_cast<unsigned char>(c)]];
+    if (state == 0) {
+      return -1;
+    }
+  }
+  return _accept[state];
+}
+
+size_t RegexDfa::patternCount(void) const { return _pattern_starts.size(); }
+
+size_t RegexDfa::stateCount(void) const { return _accept.size(); }
+
+int RegexDfa::newState(void) {
+  _nfa.push_back(NfaState());
+  return static_cast<int>(_nfa.size() - 1);
+}
+
+/**
+ * @brief Splits the 256 byte values into classes no charset tells apart
+ */
+void RegexDfa::computeByteClasses(void) {
+  int classes[256] = {};
+  int count = 1;
+  for (const std::bitset<256>& set : _charsets) {
+    std::map<std::pair<int, bool>, int> split;
+    for (int b = 0; b < 256; b++) {
+      split.emplace(std::make_pair(classes[b], set.test(b)), 0);
+    }
+    if (static_cast<int>(split.size()) == count) {
+      continue;
+    }
+    int id = 0;
+    for (auto& entry : split) {
+      entry.second = id++;
+    }
+    for (int b = 0; b < 256; b++) {
+      classes[b] = split[std::make_pair(classes[b], set.test(b))];
+    }
+    count = id;
+  }
+  for (int b = 0; b < 256; b++) {
+    _classes[b] = static_cast<uint8_t>(classes[b]);
+  }
+  _class_count = static_cast<size_t>(count);
+}
+
+/**
+ * @brief Extends states with everything reachable by epsilon edges
+ * @param states [in/out] NFA states, sorted and unique on return
+ * @param marks Visited stamps per NFA state
+ * @param stamp Stamp unique to this call
+ */
+void RegexDfa::closure(std::vector<int>& states, std::vector<uint32_t>& marks,
+                       uint32_t stamp) const {
+  std::vector<int> stack;
+  std::vector<int> result;
+  for (int state : states) {
+    if (marks[state] != stamp) {
+      marks[state] = stamp;
+      stack.push_back(state);
+    }
+  }
+  while (!stack.empty()) {
+    int state = stack.back();
+    stack.pop_back();
+    result.push_back(state);
+    for (int next : _nfa[state].epsilon) {
+      if (marks[next] != stamp) {
+        marks[next] = stamp;
+        stack.push_back(next);
+      }
+    }
+  }
+  std::sort(result.begin(), result.end());
+  states.swap(result);
+}
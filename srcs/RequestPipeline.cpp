@@ -0,0 +1,127 @@
+/**
+ * @file RequestPipeline.cpp
+ * @brief Per-location chain of request phase handlers
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-17
+ * @version 1.0
+ */
+
+#include "RequestPipeline.hpp"
+
+#include "HttpMethodHandler.hpp"
+
+/**
+ * @brief Composes the handlers a location needs
+ *
+ * The order inside a phase is the order of the checks before the pipeline
+ * existed: admin, bundle, file path, CGI, resumable uploads, then methods.
+ *
+ * @param location Location with its final settings
+ * @return Pipeline to store in the location
+ */
+std::shared_ptr<const RequestPipeline> RequestPipeline::compose(
+    const ConfigParser::LocationConfig& location) {
+  auto pipeline = std::make_shared<RequestPipeline>();
+  if (!location.redirect_url.empty()) {
+    pipeline->add(Phase::REWRITE, &HttpMethodHandler::redirectPhase);
+    return pipeline;
+  }
+
+  if (location.access) {
+    pipeline->add(Phase::ACCESS, &HttpMethodHandler::clientAccessPhase);
+  }
+  pipeline->add(Phase::ACCESS, &HttpMethodHandler::bodySizePhase);
+  if (!location.allowed_methods.empty()) {
+    pipeline->add(Phase::ACCESS, &HttpMethodHandler::allowedMethodPhase);
+  }
+
+  if (location.admin_endpoint) {
+    pipeline->add(Phase::CONTENT, &HttpMethodHandler::adminPhase);
+  }
+  if (location.bundle) {
+    pipeline->add(Phase::CONTENT, &HttpMethodHandler::bundlePhase);
+  }
+  pipeline->add(Phase::CONTENT, &HttpMethodHandler::filePathPhase);
+  if (!location.cgi_ext.empty()) {
+    pipeline->add(Phase::CONTENT, &HttpMethodHandler::cgiPhase);
+  }
+  if (location.upload_resumable) {
+    pipeline->add(Phase::CONTENT, &HttpMethodHandler::resumableUploadPhase);
+  }
+  pipeline->add(Phase::CONTENT, &HttpMethodHandler::methodPhase);
+
+  if (location.limit_rate > 0) {
+    pipeline->add(Phase::FILTER, &HttpMethodHandler::rateLimitPhase);
+  }
+  return pipeline;
+}
+
+/**
+ * @brief Appends a handler to a phase
+ * @param phase Phase the handler runs in
+ * @param handler Handler, runs after the handlers already in the phase
+ */
+void RequestPipeline::add(Phase phase, Handler handler) {
+  size_t index = static_cast<size_t>(phase);
+  _handlers.insert(_handlers.begin() + _phase_start[index + 1], handler);
+  for (size_t i = index + 1; i < _phase_start.size(); i++) {
+    _phase_start[i]++;
+  }
+}
+
+/**
+ * @brief Runs the phases for a request
+ *
+ * Rewrite and access handlers run until one of them is DONE, its response
+ * skips content and filter. Content handlers run until one is DONE, then
+ * every filter handler runs. Log handlers always run.
+ *
+ * @param context Request, its location and the response to fill
+ */
+void RequestPipeline::run(RequestContext& context) const {
+  const size_t content = _phase_start[static_cast<size_t>(Phase::CONTENT)];
+  const size_t filter = _phase_start[static_cast<size_t>(Phase::FILTER)];
+  const size_t log = _phase_start[static_cast<size_t>(Phase::LOG)];
+
+  size_t i = 0;
+  while (i < filter && _handlers[i](context) != PhaseResult::DONE) {
+    i++;
+  }
+  if (i == filter) {
+    context.response.setErrorResponse(HttpUtils::HttpStatusCode::NOT_FOUND,
+                                      "No content handler for location " +
+                                          context.location.path);
+  } else if (i >= content) {
+    for (i = filter; i < log; i++) {
+      _handlers[i](context);
+    }
+  }
+  for (i = log; i < _handlers.size(); i++) {
+    _handlers[i](context);
+  }
+}
+
+/**
+ * @brief Runs only the rewrite and access phases
+ *
+ * For decisions made before the request is complete (a body on its way):
+ * the handlers that would refuse the request later refuse it now.
+ *
+ * @param context Request, its location and a response for the refusal
+ * @return true if no handler answered: the request reaches content
+ */
+bool RequestPipeline::admits(RequestContext& context) const {
+  const size_t content = _phase_start[static_cast<size_t>(Phase::CONTENT)];
+  for (size_t i = 0; i < content; i++) {
+    if (_handlers[i](context) == PhaseResult::DONE) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// @brief Number of handlers in a phase
+size_t RequestPipeline::count(Phase phase) const {
+  size_t index = static_cast<size_t>(phase);
+  return _phase_start[index + 1] - _phase_start[index];
+}
@@ -0,0 +1,386 @@
+/**
+ * @file ResumableUpload.cpp
+ * @brief Resumable uploads (tus 1.0 core protocol with creation)
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-11
+ * @version 1.0
+ */
+
+#include "ResumableUpload.hpp"
+
+#include <fcntl.h>
+#include <sys/random.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+
+#include "UploadStore.hpp"
+
+#define RESUMABLE_FILE_PREFIX ".resumable-"
+#define RESUMABLE_ID_BYTES 16
+
+static std::string dataPath(const std::string& directory,
+                            const std::string& id) {
+  return UploadStore::joinPath(directory, RESUMABLE_FILE_PREFIX + id + ".part");
+}
+
+static std::string infoPath(const std::string& directory,
+                            const std::string& id) {
+  return UploadStore::joinPath(directory, RESUMABLE_FILE_PREFIX + id + ".info");
+}
+
+static std::string errnoMessage(const std::string& what) {
+  return what + ": " + std::strerror(errno);
+}
+
+/**
+ * @brief Reads length and final name of an upload from its sidecar
+ * @return false if the upload doesn't exist (or the sidecar is damaged)
+ */
+static bool readInfo(const std::string& directory, const std::string& id,
+                     ResumableUpload::State& state) {
+  std::ifstream info(infoPath(directory, id));
+  std::string key;
+  bool has_length = false;
+  while (info >> key) {
+    if (key == "length" && info >> state.length) {
+      has_length = true;
+    } else if (key == "name") {
+      info >> std::ws;
+      std::getline(info, state.file_name);
+    }
+  }
+  return has_length && !state.file_name.empty();
+}
+
+/**
+ * @brief Moves the complete data file to its final name
+ *
+ * An existing file of that name is never replaced (RENAME_NOREPLACE), the
+ * upload is stored as `<id>-<name>` instead.
+ */
+static bool finish(const std::string& directory, const std::string& id,
+                   ConfigParser::UploadDurability durability,
+                   ResumableUpload::State& state, std::string& error_msg) {
+  std::string data = dataPath(directory, id);
+  for (const std::string& name : {state.file_name, id + "-" + state.file_name}) {
+    std::string target = UploadStore::joinPath(directory, name);
+    int result =
+        renameat2(AT_FDCWD, data.c_str(), AT_FDCWD, target.c_str(),
+                  RENAME_NOREPLACE);
+    if (result != 0 && (errno == EINVAL || errno == ENOSYS)) {
+      // file system without RENAME_NOREPLACE: link() fails on existing too
+      result = link(data.c_str(), target.c_str());
+      if (result == 0) {
+        unlink(data.c_str());
+      }
+    }
+    if (result == 0) {
+      unlink(infoPath(directory, id).c_str());
+      state.file_name = name;
+      state.complete = true;
+      return UploadStore::syncDirectory(directory, durability, error_msg);
+    }
+    if (errno != EEXIST) {
+      break;
+    }
+  }
+  error_msg = errnoMessage("Failed to move upload to " + state.file_name);
+  return false;
+}
+
+/**
+ * @brief Creates an upload
+ *
+ * @param directory Upload directory
+ * @param length Size of the whole file (Upload-Length)
+ * @param file_name Final file name (validated by the caller)
+ * @param durability What to sync before a write is acknowledged
+ * @param id [out] Upload id, the last segment of the upload URL
+ * @param error_msg [out] Reason of the failure
+ * @return CREATED, INSUFFICIENT_STORAGE if the space can't be reserved,
+ *         INTERNAL_SERVER_ERROR otherwise
+ */
+HttpUtils::HttpStatusCode ResumableUpload::create(
+    const std::string& directory, uint64_t length,
+    const std::string& file_name, ConfigParser::UploadDurability durability,
+    std::string& id, std::string& error_msg) {
+  unsigned char random[RESUMABLE_ID_BYTES];
+  if (getrandom(random, sizeof(random), 0) !=
+      static_cast<ssize_t>(sizeof(random))) {
+    error_msg = errnoMessage("getrandom failed");
+    return HttpUtils::HttpStatusCode::INTERNAL_SERVER_ERROR;
+  }
+  static const char digits[] = "0123456789abcdef";
+  id.clear();
+  for (unsigned char byte : random) {
+    id += digits[byte >> 4];
+    id += digits[byte & 0x0f];
+  }
+
+  std::string data = dataPath(directory, id);
+  int fd = open(data.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    error_msg = errnoMessage("Failed to create " + data);
+    return HttpUtils::HttpStatusCode::INTERNAL_SERVER_ERROR;
+  }
+  // reserve the blocks up front (no fragmentation, no ENOSPC at 95%), but
+  // keep the size: it is the offset of the upload
+  if (length > 0 && fallocate(fd, FALLOC_FL_KEEP_SIZE, 0,
+                              static_cast<off_t>(length)) != 0 &&
+      errno != EOPNOTSUPP && errno != ENOSYS) {
+    int error = errno;
+    error_msg = errnoMessage("Failed to reserve " + std::to_string(length) +
+                             " bytes");
+    close(fd);
+    unlink(data.c_str());
+    return (error == ENOSPC || error == EFBIG)
+               ? HttpUtils::HttpStatusCode::INSUFFICIENT_STORAGE
+               : HttpUtils::HttpStatusCode::INTERNAL_SERVER_ERROR;
+  }
+  close(fd);
+
+  std::string info =
+      "length " + std::to_string(length) + "\nname " + file_name + "\n";
+  if (!UploadStore::writeNewFile(infoPath(directory, id), info, error_msg,
+                                 durability)) {
+    unlink(data.c_str());
+    return HttpUtils::HttpStatusCode::INTERNAL_SERVER_ERROR;
+  }
+
+  State state;
+  state.length = length;
+  state.file_name = file_name;
+  if (length == 0 && !finish(directory, id, durability, state, error_msg)) {
+    return HttpUtils::HttpStatusCode::INTERNAL_SERVER_ERROR;
+  }
+  return HttpUtils::HttpStatusCode::CREATED;
+}
+
+/**
+ * @brief Reads progress of an upload
+ * @return OK or NOT_FOUND (unknown, expired or already complete)
+ */
+HttpUtils::HttpStatusCode ResumableUpload::getState(
+    const std::string& directory, const std::string& id, State& state,
+    std::string& error_msg) {
+  struct stat data;
+  if (!isValidId(id) || !readInfo(directory, id, state) ||
+      stat(dataPath(directory, id).c_str(), &data) != 0) {
+    error_msg = "Unknown upload: " + id;
+    return HttpUtils::HttpStatusCode::NOT_FOUND;
+  }
+  state.offset = static_cast<uint64_t>(data.st_size);
+  return HttpUtils::HttpStatusCode::OK;
+}
+
+/**
+ * @brief Writes the next piece of an upload, the last piece completes it
+ *
+ * @param directory Upload directory
+ * @param id Upload id
+ * @param offset Offset the client sends from (Upload-Offset)
+ * @param data Piece of the file
+ * @param durability What to sync before the write is acknowledged
+ * @param state [out] Progress after the write
+ * @param error_msg [out] Reason of the failure
+ * @return NO_CONTENT, NOT_FOUND, CONFLICT if the offset isn't the current
+ *         one, PAYLOAD_TOO_LARGE if data goes past Upload-Length
+ */
+HttpUtils::HttpStatusCode ResumableUpload::append(
+    const std::string& directory, const std::string& id, uint64_t offset,
+    std::string_view data, ConfigParser::UploadDurability durability,
+    State& state, std::string& error_msg) {
+  if (!isValidId(id) || !readInfo(directory, id, state)) {
+    error_msg = "Unknown upload: " + id;
+    return HttpUtils::HttpStatusCode::NOT_FOUND;
+  }
+  std::string path = dataPath(directory, id);
+  int fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+  struct stat info;
+  if (fd < 0 || fstat(fd, &info) != 0) {
+    error_msg = "Unknown upload: " + id;
+    if (fd >= 0) {
+      close(fd);
+    }
+    return HttpUtils::HttpStatusCode::NOT_FOUND;
+  }
+
+  state.offset = static_cast<uint64_t>(info.st_size);
+  if (offset != state.offset) {
+    close(fd);
+    error_msg = "Upload-Offset " + std::to_string(offset) +
+                " doesn't match offset " + std::to_string(state.offset);
+    return HttpUtils::HttpStatusCode::CONFLICT;
+  }
+  if (data.size() > state.length - state.offset) {
+    close(fd);
+    error_msg = "Data goes past Upload-Length " + std::to_string(state.length);
+    return HttpUtils::HttpStatusCode::PAYLOAD_TOO_LARGE;
+  }
+
+  // the size of the file is the offset, a failed write keeps what arrived
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t bytes = pwrite(fd, data.data() + written, data.size() - written,
+                           static_cast<off_t>(state.offset + written));
+    if (bytes < 0 && errno == EINTR) {
+      continue;
+    }
+    if (bytes <= 0) {
+      error_msg = errnoMessage("Failed to write upload " + id);
+      close(fd);
+      state.offset += written;
+      return HttpUtils::HttpStatusCode::INTERNAL_SERVER_ERROR;
+    }
+    written += static_cast<size_t>(bytes);
+  }
+  bool synced = UploadStore::syncFile(fd, durability, error_msg);
+  close(fd);
+  state.offset += written;
+  if (!synced) {
+    return HttpUtils::HttpStatusCode::INTERNAL_SERVER_ERROR;
+  }
+
+  if (state.offset == state.length &&
+      !finish(directory, id, durability, state, error_msg)) {
+    return HttpUtils::HttpStatusCode::INTERNAL_SERVER_ERROR;
+  }
+  return HttpUtils::HttpStatusCode::NO_CONTENT;
+}
+
+/**
+ * @brief Removes uploads without progress for max_age
+ *
+ * The age of an upload is the age of its last write (mtime of the data
+ * file); the sidecar and the data file are removed together. Leftovers of
+ * an interrupted create (one of the two files) expire the same way.
+ *
+ * @param directory Upload directory
+ * @param max_age Uploads older than this are removed
+ * @return Number of removed uploads
+ */
+size_t ResumableUpload::sweep(const std::string& directory,
+                              std::chrono::seconds max_age) {
+  static const std::string prefix = RESUMABLE_FILE_PREFIX;
+  std::error_code error;
+  std::filesystem::directory_iterator it(directory, error);
+  if (error) {
+    return 0;
+  }
+
+  time_t now = time(nullptr);
+  size_t removed = 0;
+  for (; it != std::filesystem::directory_iterator(); it.increment(error)) {
+    std::string name = it->path().filename().string();
+    size_t dot = name.rfind('.');
+    if (name.compare(0, prefix.size(), prefix) != 0 || dot <= prefix.size()) {
+      continue;
+    }
+    std::string id = name.substr(prefix.size(), dot - prefix.size());
+    bool is_info = name.compare(dot, std::string::npos, ".info") == 0;
+    std::string data_path = dataPath(directory, id);
+    struct stat data;
+    if (!is_info && access(infoPath(directory, id).c_str(), F_OK) == 0) {
+      continue;  // goes with its sidecar
+    }
+    if (stat(data_path.c_str(), &data) != 0 &&
+        stat(it->path().c_str(), &data) != 0) {
+      continue;
+    }
+    if (now - data.st_mtime < max_age.count()) {
+      continue;
+    }
+    // sidecar first: a data file left alone is a leftover of its own
+    if (unlink(it->path().c_str()) == 0 && is_info) {
+      unlink(data_path.c_str());
+      removed++;
+    }
+  }
+  return removed;
+}
+
+/// @brief Upload ids are 32 lowercase hex digits (no path can be injected)
+bool ResumableUpload::isValidId(std::string_view id) {
+  if (id.size() != RESUMABLE_ID_BYTES * 2) {
+    return false;
+  }
+  for (char c : id) {
+    if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Decodes `filename` of an Upload-Metadata header
+ *
+ * Upload-Metadata is a comma separated list of `key base64(value)` pairs.
+ * Spaces of the name are replaced with '-' (as for multipart uploads).
+ *
+ * @return File name, empty if missing or not a plain file name
+ */
+std::string ResumableUpload::getMetadataFileName(const std::string& metadata) {
+  size_t start = 0;
+  while (start < metadata.size()) {
+    size_t end = metadata.find(',', start);
+    end = (end == std::string::npos) ? metadata.size() : end;
+    std::string pair = metadata.substr(start, end - start);
+    start = end + 1;
+
+    size_t key_start = pair.find_first_not_of(" \t");
+    if (key_start == std::string::npos ||
+        pair.compare(key_start, 9, "filename ") != 0) {
+      continue;
+    }
+
+    std::string name;
+    uint32_t bits = 0;
+    int bit_count = 0;
+    for (size_t i = key_start + 9; i < pair.size(); i++) {
+      char c = pair[i];
+      int value;
+      if (c >= 'A' && c <= 'Z') {
+        value = c - 'A';
+      } else if (c >= 'a' && c <= 'z') {
+        value = c - 'a' + 26;
+      } else if (c >= '0' && c <= '9') {
+        value = c - '0' + 52;
+      } else if (c == '+') {
+        value = 62;
+      } else if (c == '/') {
+        value = 63;
+      } else if (c == '=' || c == ' ' || c == '\t') {
+        continue;
+      } else {
+        return "";
+      }
+      bits = (bits << 6) | static_cast<uint32_t>(value);
+      bit_count += 6;
+      if (bit_count >= 8) {
+        bit_count -= 8;
+        name += static_cast<char>((bits >> bit_count) & 0xff);
+      }
+    }
+
+    if (name.empty() || name[0] == '.' ||
+        name.find_first_of("/\\") != std::string::npos) {
+      return "";
+    }
+    for (char& c : name) {
+      if (static_cast<unsigned char>(c) < 0x20 || c == 0x7f) {
+        return "";  // control characters, the sidecar is line based
+      }
+      c = (c == ' ') ? '-' : c;
+    }
+    return name;
+  }
+  return "";
+}
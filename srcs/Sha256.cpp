@@ -0,0 +1,264 @@
+/**
+ * @file Sha256.cpp
+ * @brief Incremental SHA-256 with a SHA-NI code path
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-10
+ * @version 1.0
+ *
+ * @see https://nvlpubs.nist.gov/nistpubs/FIPS/NIST.FIPS.180-4.pdf
+ */
+
+#include "Sha256.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define SHA256_X86 1
+#endif
+
+static constexpr uint32_t kInitialState[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+static constexpr uint32_t kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+static inline uint32_t rotr(uint32_t x, int n) {
+  return (x >> n) | (x << (32 - n));
+}
+
+/// @brief Block function of FIPS 180-4, 6.2.2
+static void compressPortable(uint32_t state[8], const uint8_t* data,
+                             size_t blocks) {
+  uint32_t w[64];
+  while (blocks-- > 0) {
+    for (int t = 0; t < 16; t++) {
+      w[t] = (uint32_t(data[t * 4]) << 24) | (uint32_t(data[t * 4 + 1]) << 16) |
+             (uint32_t(data[t * 4 + 2]) << 8) | uint32_t(data[t * 4 + 3]);
+    }
+    for (int t = 16; t < 64; t++) {
+      uint32_t s0 = rotr(w[t - 15], 7) ^ rotr(w[t - 15], 18) ^ (w[t - 15] >> 3);
+      uint32_t s1 = rotr(w[t - 2], 17) ^ rotr(w[t - 2], 19) ^ (w[t - 2] >> 10);
+      w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int t = 0; t < 64; t++) {
+      uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+      uint32_t ch = (e & f) ^ (~e & g);
+      uint32_t t1 = h + s1 + ch + kRoundConstants[t] + w[t];
+      uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+      uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+      uint32_t t2 = s0 + maj;
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+    data += Sha256::BLOCK_SIZE;
+  }
+}
+
+#ifdef SHA256_X86
+/**
+ * @brief Block function on the SHA extensions
+ *
+ * The state is kept as ABEF/CDGH register pairs, every sha256rnds2 does two
+ * rounds, sha256msg1/msg2 compute the message schedule four words at once.
+ */
+__attribute__((target("sha,sse4.1"))) static void compressShaNi(
+    uint32_t state[8], const uint8_t* data, size_t blocks) {
+  const __m128i byte_swap =
+      _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+  __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0]));
+  __m128i state1 =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4]));
+  tmp = _mm_shuffle_epi32(tmp, 0xB1);            // CDAB
+  state1 = _mm_shuffle_epi32(state1, 0x1B);      // EFGH
+  __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);  // ABEF
+  state1 = _mm_blend_epi16(state1, tmp, 0xF0);   // CDGH
+
+  while (blocks-- > 0) {
+    const __m128i abef_saved = state0;
+    const __m128i cdgh_saved = state1;
+    __m128i words[4];
+
+    for (int i = 0; i < 16; i++) {
+      if (i < 4) {
+        words[i] = _mm_shuffle_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16)),
+            byte_swap);
+      } else {
+        // W[t-16] + s0(W[t-15]) + W[t-7], then + s1(W[t-2])
+        __m128i next = _mm_sha256msg1_epu32(words[i % 4], words[(i + 1) % 4]);
+        next = _mm_add_epi32(
+            next, _mm_alignr_epi8(words[(i + 3) % 4], words[(i + 2) % 4], 4));
+        words[i % 4] = _mm_sha256msg2_epu32(next, words[(i + 3) % 4]);
+      }
+      __m128i message = _mm_add_epi32(
+          words[i % 4], _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+                            &kRoundConstants[i * 4])));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+      message = _mm_shuffle_epi32(message, 0x0E);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, message);
+    }
+
+    state0 = _mm_add_epi32(state0, abef_saved);
+    state1 = _mm_add_epi32(state1, cdgh_saved);
+    data += Sha256::BLOCK_SIZE;
+  }
+
+  tmp = _mm_shuffle_epi32(state0, 0x1B);         // FEBA
+  state1 = _mm_shuffle_epi32(state1, 0xB1);      // DCHG
+  state0 = _mm_blend_epi16(tmp, state1, 0xF0);   // DCBA
+  state1 = _mm_alignr_epi8(state1, tmp, 8);      // HGFE
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+}
+#endif
+
+/**
+ * @brief Checks CPUID for the SHA extensions (and SSE4.1 used with them)
+ */
+bool Sha256::hasHardwareSupport(void) {
+#ifdef SHA256_X86
+  static const bool supported = [] {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_SSE4_1)) {
+      return false;
+    }
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+      return false;
+    }
+    return (ebx & bit_SHA) != 0;
+  }();
+  return supported;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @param use_hardware Use SHA-NI if the CPU has it (false forces the
+ *        portable code, for tests and comparisons)
+ */
+Sha256::Sha256(bool use_hardware)
+    : _hardware(use_hardware && hasHardwareSupport()) {
+  std::memcpy(_state, kInitialState, sizeof(_state));
+}
+
+void Sha256::update(std::string_view data) {
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data());
+  size_t size = data.size();
+  _length += size;
+
+  if (_block_size > 0) {
+    size_t take = std::min(size, BLOCK_SIZE - _block_size);
+    std::memcpy(_block + _block_size, bytes, take);
+    _block_size += take;
+    bytes += take;
+    size -= take;
+    if (_block_size < BLOCK_SIZE) {
+      return;
+    }
+    compress(_block, 1);
+    _block_size = 0;
+  }
+
+  // whole blocks straight from the input, no copy
+  size_t blocks = size / BLOCK_SIZE;
+  if (blocks > 0) {
+    compress(bytes, blocks);
+    bytes += blocks * BLOCK_SIZE;
+    size -= blocks * BLOCK_SIZE;
+  }
+  std::memcpy(_block, bytes, size);
+  _block_size = size;
+}
+
+/**
+ * @brief Pads the message and returns the digest, the object must not be
+ *        updated afterwards
+ */
+Sha256::Digest Sha256::finish(void) {
+  uint64_t bit_length = _length * 8;
+  _block[_block_size++] = 0x80;
+  if (_block_size > BLOCK_SIZE - 8) {
+    std::memset(_block + _block_size, 0, BLOCK_SIZE - _block_size);
+    compress(_block, 1);
+    _block_size = 0;
+  }
+  std::memset(_block + _block_size, 0, BLOCK_SIZE - 8 - _block_size);
+  for (int i = 0; i < 8; i++) {
+    _block[BLOCK_SIZE - 1 - i] = static_cast<uint8_t>(bit_length >> (i * 8));
+  }
+  compress(_block, 1);
+  _block_size = 0;
+
+  Digest digest;
+  for (int i = 0; i < 8; i++) {
+    digest[i * 4] = static_cast<uint8_t>(_state[i] >> 24);
+    digest[i * 4 + 1] = static_cast<uint8_t>(_state[i] >> 16);
+    digest[i * 4 + 2] = static_cast<uint8_t>(_state[i] >> 8);
+    digest[i * 4 + 3] = static_cast<uint8_t>(_state[i]);
+  }
+  return digest;
+}
+
+std::string Sha256::finishHex(void) { return toHex(finish()); }
+
+bool Sha256::usesHardware(void) const { return _hardware; }
+
+std::string Sha256::toHex(const Digest& digest) {
+  static const char digits[] = "0123456789abcdef";
+  std::string hex(DIGEST_SIZE * 2, '0');
+  for (size_t i = 0; i < DIGEST_SIZE; i++) {
+    hex[i * 2] = digits[digest[i] >> 4];
+    hex[i * 2 + 1] = digits[digest[i] & 0x0f];
+  }
+  return hex;
+}
+
+/// @brief Hex digest of data in one call
+std::string Sha256::hashHex(std::string_view data) {
+  Sha256 hash;
+  hash.update(data);
+  return hash.finishHex();
+}
+
+void Sha256::compress(const uint8_t* data, size_t blocks) {
+#ifdef SHA256_X86
+  if (_hardware) {
+    compressShaNi(_state, data, blocks);
+    return;
+  }
+#endif
+  compressPortable(_state, data, blocks);
+}
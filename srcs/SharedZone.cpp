@@ -0,0 +1,312 @@
+/**
+ * @file SharedZone.cpp
+ * @brief Named shared memory zones with a slab allocator
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-17
+ * @version 1.0
+ */
+
+#include "SharedZone.hpp"
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include "HttpUtils.hpp"
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "zone locks must not depend on process-local state");
+
+#define SHARED_ZONE_MAGIC 0x5a6f6e65u
+// page map entries: 0 = free page
+#define PAGE_SLAB 0x80000000u  // | slab class: page cut into chunks
+#define PAGE_RUN 0x40000000u   // | page count: first page of a block
+#define PAGE_TAIL 0x20000000u  // other pages of a block
+#define PAGE_VALUE 0x0fffffffu
+// spins before a waiting process gives up its time slice
+#define LOCK_SPINS 64
+
+struct SharedZone::Header {
+  uint32_t magic = SHARED_ZONE_MAGIC;
+  uint32_t page_count = 0;
+  uint32_t used_pages = 0;
+  uint32_t buckets = 0;  // offset of the table buckets
+  Lock page_lock;
+  Lock table_lock;
+  Lock slab_locks[SHARED_ZONE_SLAB_CLASSES];
+  uint32_t free_chunks[SHARED_ZONE_SLAB_CLASSES] = {};  // 0 = none
+};
+
+/// @brief Named object, the key follows the entry
+struct SharedZone::Entry {
+  uint32_t next;
+  uint32_t object;
+  uint64_t hash;
+  uint32_t key_length;
+};
+
+// Lock
+
+void SharedZone::Lock::lock(void) {
+  unsigned spins = 0;
+  while (_state.exchange(1, std::memory_order_acquire) != 0) {
+    while (_state.load(std::memory_order_relaxed) != 0) {
+      if (++spins >= LOCK_SPINS) {
+        sched_yield();
+        spins = 0;
+      }
+    }
+  }
+}
+
+void SharedZone::Lock::unlock(void) {
+  _state.store(0, std::memory_order_release);
+}
+
+bool SharedZone::Lock::try_lock(void) {
+  return _state.exchange(1, std::memory_order_acquire) == 0;
+}
+
+// SharedZone
+
+/**
+ * @brief Creates and maps a zone
+ *
+ * The memory is shared with processes forked afterwards. The first pages
+ * hold the header, the page map and the table buckets.
+ *
+ * @param name Zone name (for /proc/<pid>/maps and error messages)
+ * @param size Bytes, rounded up to whole pages (less than 4 GiB)
+ * @throws std::invalid_argument if the zone can't hold its own metadata
+ * @throws std::runtime_error if the memory can't be created or mapped
+ */
+SharedZone::SharedZone(const std::string& name, size_t size)
+    : _name(name), _fd(-1), _base(nullptr), _size(0) {
+  size_t pages = (size + SHARED_ZONE_PAGE_SIZE - 1) / SHARED_ZONE_PAGE_SIZE;
+  size_t metadata = sizeof(Header) + pages * sizeof(uint32_t) +
+                    SHARED_ZONE_BUCKETS * sizeof(uint32_t);
+  size_t metadata_pages =
+      (metadata + SHARED_ZONE_PAGE_SIZE - 1) / SHARED_ZONE_PAGE_SIZE;
+  if (pages <= metadata_pages || pages > UINT32_MAX / SHARED_ZONE_PAGE_SIZE) {
+    throw std::invalid_argument("shared zone '" + name + "': invalid size " +
+                                std::to_string(size));
+  }
+
+  _fd = memfd_create(("webserv:" + name).c_str(), MFD_CLOEXEC);
+  if (_fd == -1) {
+    throw std::runtime_error("shared zone '" + name +
+                             "': memfd_create() failed: " + strerror(errno));
+  }
+  _size = pages * SHARED_ZONE_PAGE_SIZE;
+  void* memory = MAP_FAILED;
+  if (ftruncate(_fd, _size) == 0) {
+    memory = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+  }
+  if (memory == MAP_FAILED) {
+    std::string error = strerror(errno);
+    close(_fd);
+    throw std::runtime_error("shared zone '" + name + "': " + error);
+  }
+  _base = static_cast<char*>(memory);
+
+  Header* zone = new (_base) Header();
+  zone->page_count = static_cast<uint32_t>(pages);
+  zone->buckets = static_cast<uint32_t>(sizeof(Header) +
+                                        pages * sizeof(uint32_t));
+  uint32_t* map = pageMap();
+  map[0] = PAGE_RUN | static_cast<uint32_t>(metadata_pages);
+  for (size_t i = 1; i < metadata_pages; i++) {
+    map[i] = PAGE_TAIL;
+  }
+  zone->used_pages = static_cast<uint32_t>(metadata_pages);
+}
+
+/// @brief Unmaps the zone, the memory lives on in processes still using it
+SharedZone::~SharedZone() {
+  munmap(_base, _size);
+  close(_fd);
+}
+
+/**
+ * @brief Allocates zeroed memory in the zone
+ * @param size Bytes; up to half a page comes from a slab class, more takes
+ *        whole pages
+ * @return Memory aligned to 16 bytes (up to its size), nullptr if the zone
+ *         is full
+ */
+void* SharedZone::allocate(size_t size) {
+  if (size <= SHARED_ZONE_PAGE_SIZE / 2) {
+    size_t slab_class = 0;
+    while ((static_cast<size_t>(SHARED_ZONE_MIN_CHUNK) << slab_class) < size) {
+      slab_class++;
+    }
+    uint32_t offset = allocateChunk(slab_class);
+    return offset == 0 ? nullptr : at(offset);
+  }
+  size_t pages = (size + SHARED_ZONE_PAGE_SIZE - 1) / SHARED_ZONE_PAGE_SIZE;
+  if (pages > header().page_count) {
+    return nullptr;
+  }
+  uint32_t page = allocatePages(static_cast<uint32_t>(pages));
+  if (page == 0) {
+    return nullptr;
+  }
+  void* block = at(page * SHARED_ZONE_PAGE_SIZE);
+  std::memset(block, 0, pages * SHARED_ZONE_PAGE_SIZE);
+  return block;
+}
+
+/**
+ * @brief Returns memory of allocate() to the zone
+ * @param block Allocated block or nullptr
+ */
+void SharedZone::deallocate(void* block) {
+  if (block == nullptr) {
+    return;
+  }
+  uint32_t offset = offsetOf(block);
+  uint32_t page = offset / SHARED_ZONE_PAGE_SIZE;
+  uint32_t entry = pageMap()[page];
+  if (entry & PAGE_SLAB) {
+    size_t slab_class = entry & PAGE_VALUE;
+    LockGuard guard(header().slab_locks[slab_class]);
+    *static_cast<uint32_t*>(block) = header().free_chunks[slab_class];
+    header().free_chunks[slab_class] = offset;
+  } else if ((entry & PAGE_RUN) && offset % SHARED_ZONE_PAGE_SIZE == 0) {
+    freePages(page);
+  }
+}
+
+/**
+ * @brief Finds the object of a key, creates it (zeroed) on first use
+ * @param key Object name
+ * @param size Object size, only used when the object is created
+ * @return The object, nullptr if the zone is full
+ */
+void* SharedZone::lookup(std::string_view key, size_t size) {
+  uint64_t hash = HttpUtils::hashPath(key);
+  uint32_t* buckets = static_cast<uint32_t*>(at(header().buckets));
+  uint32_t& bucket = buckets[hash % SHARED_ZONE_BUCKETS];
+
+  LockGuard guard(header().table_lock);
+  for (uint32_t offset = bucket; offset != 0;) {
+    const Entry* entry = static_cast<const Entry*>(at(offset));
+    const char* entry_key = reinterpret_cast<const char*>(entry + 1);
+    if (entry->hash == hash && entry->key_length == key.size() &&
+        std::memcmp(entry_key, key.data(), key.size()) == 0) {
+      return at(entry->object);
+    }
+    offset = entry->next;
+  }
+
+  Entry* entry = static_cast<Entry*>(allocate(sizeof(Entry) + key.size()));
+  void* object = allocate(size);
+  if (entry == nullptr || object == nullptr) {
+    deallocate(entry);
+    deallocate(object);
+    return nullptr;
+  }
+  entry->next = bucket;
+  entry->object = offsetOf(object);
+  entry->hash = hash;
+  entry->key_length = static_cast<uint32_t>(key.size());
+  std::memcpy(entry + 1, key.data(), key.size());
+  bucket = offsetOf(entry);
+  return object;
+}
+
+const std::string& SharedZone::getName(void) const { return _name; }
+
+size_t SharedZone::getPageCount(void) const { return header().page_count; }
+
+/// @brief Pages taken by metadata, slabs and blocks
+size_t SharedZone::getUsedPages(void) const {
+  LockGuard guard(header().page_lock);
+  return header().used_pages;
+}
+
+// private
+
+SharedZone::Header& SharedZone::header(void) const {
+  return *reinterpret_cast<Header*>(_base);
+}
+
+uint32_t* SharedZone::pageMap(void) const {
+  return reinterpret_cast<uint32_t*>(_base + sizeof(Header));
+}
+
+/**
+ * @brief Takes the first run of free pages (first fit)
+ * @return Index of the first page, 0 if there is no such run
+ */
+uint32_t SharedZone::allocatePages(uint32_t count) {
+  Header& zone = header();
+  uint32_t* map = pageMap();
+  LockGuard guard(zone.page_lock);
+  uint32_t run = 0;
+  for (uint32_t page = 1; page < zone.page_count; page++) {
+    run = (map[page] == 0) ? run + 1 : 0;
+    if (run == count) {
+      uint32_t first = page + 1 - count;
+      map[first] = PAGE_RUN | count;
+      for (uint32_t i = first + 1; i <= page; i++) {
+        map[i] = PAGE_TAIL;
+      }
+      zone.used_pages += count;
+      return first;
+    }
+  }
+  return 0;
+}
+
+/// @brief Frees the run of pages starting at first
+void SharedZone::freePages(uint32_t first) {
+  Header& zone = header();
+  uint32_t* map = pageMap();
+  LockGuard guard(zone.page_lock);
+  uint32_t count = map[first] & PAGE_VALUE;
+  for (uint32_t i = first; i < first + count; i++) {
+    map[i] = 0;
+  }
+  zone.used_pages -= count;
+}
+
+/**
+ * @brief Takes a chunk of a slab class, cuts a new page if the class is empty
+ * @return Offset of the zeroed chunk, 0 if the zone is full
+ */
+uint32_t SharedZone::allocateChunk(size_t slab_class) {
+  Header& zone = header();
+  const uint32_t chunk = SHARED_ZONE_MIN_CHUNK << slab_class;
+  LockGuard guard(zone.slab_locks[slab_class]);
+  if (zone.free_chunks[slab_class] == 0) {
+    uint32_t page = allocatePages(1);
+    if (page == 0) {
+      return 0;
+    }
+    pageMap()[page] = PAGE_SLAB | static_cast<uint32_t>(slab_class);
+    uint32_t start = page * SHARED_ZONE_PAGE_SIZE;
+    for (uint32_t offset = start; offset < start + SHARED_ZONE_PAGE_SIZE;
+         offset += chunk) {
+      uint32_t next = offset + chunk;
+      *static_cast<uint32_t*>(at(offset)) =
+          (next < start + SHARED_ZONE_PAGE_SIZE) ? next : 0;
+    }
+    zone.free_chunks[slab_class] = start;
+  }
+  uint32_t offset = zone.free_chunks[slab_class];
+  zone.free_chunks[slab_class] = *static_cast<uint32_t*>(at(offset));
+  std::memset(at(offset), 0, chunk);
+  return offset;
+}
+
+void* SharedZone::at(uint32_t offset) const { return _base + offset; }
+
+uint32_t SharedZone::offsetOf(const void* block) const {
+  return static_cast<uint32_t>(static_cast<const char*>(block) - _base);
+}
@@ -0,0 +1,105 @@
+/**
+ * @file SocketActivation.cpp
+ * @brief Listening sockets opened by a supervisor (socket activation)
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-16
+ * @version 1.0
+ */
+
+#include "SocketActivation.hpp"
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+namespace SocketActivation {
+
+/**
+ * @brief Takes the sockets passed with LISTEN_FDS and LISTEN_PID
+ *
+ * The variables are removed from the environment, so child processes don't
+ * take sockets meant for webserv. The sockets are made close-on-exec.
+ *
+ * @return Inherited fds, empty if none were passed to this process
+ */
+std::vector<int> takeEnvironmentFds(void) {
+  const char* pid = std::getenv("LISTEN_PID");
+  const char* fds = std::getenv("LISTEN_FDS");
+  std::vector<int> result;
+  if (pid != nullptr && fds != nullptr &&
+      std::strtol(pid, nullptr, 10) == getpid()) {
+    char* end = nullptr;
+    long count = std::strtol(fds, &end, 10);
+    for (long i = 0; *end == '\0' && i < count && i < 1024; i++) {
+      int fd = LISTEN_FDS_START + static_cast<int>(i);
+      fcntl(fd, F_SETFD, FD_CLOEXEC);
+      result.push_back(fd);
+    }
+  }
+  unsetenv("LISTEN_PID");
+  unsetenv("LISTEN_FDS");
+  unsetenv("LISTEN_FDNAMES");
+  return result;
+}
+
+/**
+ * @brief Checks that fd is a listening stream socket and reads its address
+ * @param fd Inherited socket
+ * @param listener [out] Its address
+ * @param error_msg [out] Why fd can't be used
+ * @return true for a listening TCP (IPv4 or IPv6) or unix stream socket
+ */
+bool describe(int fd, Listener& listener, std::string& error_msg) {
+  int type = 0;
+  int listening = 0;
+  socklen_t length = sizeof(type);
+  if (getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &length) == -1) {
+    error_msg = "not a socket: " + std::string(strerror(errno));
+    return false;
+  }
+  length = sizeof(listening);
+  if (type != SOCK_STREAM ||
+      getsockopt(fd, SOL_SOCKET, SO_ACCEPTCONN, &listening, &length) == -1 ||
+      !listening) {
+    error_msg = "not a listening stream socket";
+    return false;
+  }
+
+  struct sockaddr_storage address{};
+  length = sizeof(address);
+  if (getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) == -1) {
+    error_msg = "getsockname() failed: " + std::string(strerror(errno));
+    return false;
+  }
+  listener = Listener();
+  listener.fd = fd;
+  if (address.ss_family == AF_INET) {
+    listener.port =
+        ntohs(reinterpret_cast<sockaddr_in*>(&address)->sin_port);
+  } else if (address.ss_family == AF_INET6) {
+    listener.port =
+        ntohs(reinterpret_cast<sockaddr_in6*>(&address)->sin6_port);
+  } else if (address.ss_family == AF_UNIX) {
+    const sockaddr_un* unix_address = reinterpret_cast<sockaddr_un*>(&address);
+    size_t path_length = length - offsetof(sockaddr_un, sun_path);
+    if (path_length == 0 || unix_address->sun_path[0] == '\0') {
+      error_msg = "unnamed or abstract unix socket";
+      return false;
+    }
+    listener.unix_path.assign(unix_address->sun_path,
+                              strnlen(unix_address->sun_path, path_length));
+  } else {
+    error_msg = "unsupported address family";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace SocketActivation
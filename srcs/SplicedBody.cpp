@@ -0,0 +1,180 @@
+/**
+ * @file SplicedBody.cpp
+ * @brief Raw upload body moved from the socket to a file by the kernel
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-17
+ * @version 1.0
+ */
+
+#include "SplicedBody.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <initializer_list>
+
+#include "UploadStore.hpp"
+
+static std::string errnoMessage(const std::string& what) {
+  return what + ": " + std::strerror(errno);
+}
+
+SplicedBody::SplicedBody()
+    : _file_fd(-1),
+      _pipe{-1, -1},
+      _temp_path(""),
+      _length(0),
+      _received(0),
+      _written_behind(0) {}
+
+/// @brief Closes the descriptors, an unpublished file is removed
+SplicedBody::~SplicedBody() {
+  closeFiles();
+  if (!_temp_path.empty()) {
+    unlink(_temp_path.c_str());
+  }
+}
+
+/**
+ * @brief Creates the temporary file and the pipe
+ * @param directory Upload directory, the file is moved within it later
+ * @param length Content-Length of the body, reserved up front
+ * @return false if the file or the pipe can't be made (nothing is left)
+ */
+bool SplicedBody::open(const std::string& directory, size_t length,
+                       std::string& error_msg) {
+  _file_fd = UploadStore::createTempFile(directory, _temp_path, error_msg);
+  if (_file_fd < 0) {
+    return false;
+  }
+  if (!UploadStore::reserveSpace(_file_fd, length, error_msg)) {
+    return false;
+  }
+  if (pipe2(_pipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+    error_msg = errnoMessage("Failed to create pipe");
+    return false;
+  }
+  // fewer, larger splices; the default 64 KiB pipe still works
+  fcntl(_pipe[1], F_SETPIPE_SZ, SPLICED_BODY_PIPE_SIZE);
+  _length = length;
+  return true;
+}
+
+/**
+ * @brief Writes body bytes that were received with the request head
+ * @param data Start of the body (at most the length left)
+ */
+bool SplicedBody::write(std::string_view data, std::string& error_msg) {
+  while (!data.empty()) {
+    ssize_t bytes = pwrite(_file_fd, data.data(), data.size(),
+                           static_cast<off_t>(_received));
+    if (bytes < 0 && errno == EINTR) {
+      continue;
+    }
+    if (bytes <= 0) {
+      error_msg = errnoMessage("write failed");
+      return false;
+    }
+    advance(static_cast<size_t>(bytes));
+    data.remove_prefix(static_cast<size_t>(bytes));
+  }
+  return true;
+}
+
+/**
+ * @brief Moves what the socket has of the rest of the body into the file
+ *
+ * One splice() from the socket into the pipe (never past the body, a
+ * pipelined request stays in the socket), then the pipe is drained into
+ * the file at the body offset, so it is empty between calls.
+ *
+ * @param socket_fd Client socket
+ * @param error_msg [out] Set if the file couldn't be written
+ * @return Bytes moved; 0 if the client closed the connection; -1 with
+ *         error_msg for a file error, with errno for a socket error
+ *         (EAGAIN: nothing to read yet)
+ */
+ssize_t SplicedBody::receive(int socket_fd, std::string& error_msg) {
+  ssize_t bytes = splice(socket_fd, nullptr, _pipe[1], nullptr,
+                         _length - _received,
+                         SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (bytes <= 0) {
+    return bytes;
+  }
+  size_t left = static_cast<size_t>(bytes);
+  while (left > 0) {
+    loff_t offset = static_cast<loff_t>(_received);
+    ssize_t moved =
+        splice(_pipe[0], nullptr, _file_fd, &offset, left, SPLICE_F_MOVE);
+    if (moved < 0 && errno == EINTR) {
+      continue;
+    }
+    if (moved <= 0) {
+      error_msg = errnoMessage("splice to file failed");
+      return -1;
+    }
+    advance(static_cast<size_t>(moved));
+    left -= static_cast<size_t>(moved);
+  }
+  return bytes;
+}
+
+/**
+ * @brief Syncs the complete body and moves it to path
+ * @param path Path of the new file, must not exist yet
+ * @param durability What to sync before the file appears
+ * @return false if the body is incomplete or can't be stored (the
+ *         temporary file is removed either way)
+ */
+bool SplicedBody::publish(const std::string& path,
+                          ConfigParser::UploadDurability durability,
+                          std::string& error_msg) {
+  if (_file_fd < 0 || !isComplete()) {
+    error_msg = "Upload body is incomplete";
+    return false;
+  }
+  bool synced = UploadStore::syncFile(_file_fd, durability, error_msg);
+  closeFiles();
+  std::string temp_path;
+  temp_path.swap(_temp_path);
+  if (!synced) {
+    unlink(temp_path.c_str());
+    return false;
+  }
+  return UploadStore::publishFile(temp_path, path, error_msg, durability);
+}
+
+bool SplicedBody::isComplete(void) const { return _received == _length; }
+
+size_t SplicedBody::getLength(void) const { return _length; }
+
+size_t SplicedBody::getReceived(void) const { return _received; }
+
+// private
+
+/// @brief Counts bytes in the file, large bodies are written behind
+void SplicedBody::advance(size_t bytes) {
+  _received += bytes;
+  if (_length < UPLOAD_WRITE_BEHIND_MIN) {
+    return;
+  }
+  while (_received - _written_behind >= UPLOAD_WRITE_CHUNK ||
+         (_received == _length && _written_behind < _length)) {
+    size_t chunk = std::min<size_t>(UPLOAD_WRITE_CHUNK,
+                                    _received - _written_behind);
+    UploadStore::writeBehind(_file_fd, _written_behind, chunk);
+    _written_behind += chunk;
+  }
+}
+
+void SplicedBody::closeFiles(void) {
+  for (int* fd : {&_file_fd, &_pipe[0], &_pipe[1]}) {
+    if (*fd >= 0) {
+      ::close(*fd);
+      *fd = -1;
+    }
+  }
+}
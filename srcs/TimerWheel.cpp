@@ -0,0 +1,75 @@
+/**
+ * @file TimerWheel.cpp
+ * @brief Hashed timing wheel for connection timers of the event loop
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-04
+ * @version 1.0
+ */
+
+#include "TimerWheel.hpp"
+
+TimerWheel::TimerWheel()
+    : _slots(TIMER_WHEEL_SLOTS),
+      _origin(Clock::now()),
+      _current_tick(0),
+      _size(0) {}
+
+/**
+ * @brief Adds timer for file descriptor
+ * @param fd File descriptor reported back on expiration
+ * @param when Expiration time (past times expire on the next collect)
+ */
+void TimerWheel::schedule(int fd, Clock::time_point when) {
+  uint64_t tick = std::max(toTick(when), _current_tick);
+  _slots[tick % TIMER_WHEEL_SLOTS].push_back({fd, when});
+  _size += 1;
+}
+
+/**
+ * @brief Removes all expired timers and reports their file descriptors
+ *
+ * Visits buckets of every tick since the previous call (at most one full
+ * turn). Timers of later turns stay in their bucket.
+ *
+ * @param now Current time
+ * @param expired [out] File descriptors of expired timers are appended
+ */
+void TimerWheel::collectExpired(Clock::time_point now,
+                                std::vector<int>& expired) {
+  if (_size == 0) {
+    _current_tick = std::max(toTick(now), _current_tick);
+    return;
+  }
+
+  uint64_t now_tick = std::max(toTick(now), _current_tick);
+  uint64_t steps =
+      std::min<uint64_t>(now_tick - _current_tick + 1, TIMER_WHEEL_SLOTS);
+
+  for (uint64_t step = 0; step < steps; step++) {
+    std::vector<Timer>& slot =
+        _slots[(_current_tick + step) % TIMER_WHEEL_SLOTS];
+    size_t index = 0;
+    while (index < slot.size()) {
+      if (slot[index].when <= now) {
+        expired.push_back(slot[index].fd);
+        slot[index] = slot.back();
+        slot.pop_back();
+        _size -= 1;
+      } else {
+        index++;
+      }
+    }
+  }
+  _current_tick = now_tick;
+}
+
+size_t TimerWheel::size(void) const { return _size; }
+
+uint64_t TimerWheel::toTick(Clock::time_point time) const {
+  if (time <= _origin) {
+    return 0;
+  }
+  return std::chrono::duration_cast<std::chrono::milliseconds>(time - _origin)
+             .count() /
+         TIMER_WHEEL_TICK_MS;
+}
@@ -0,0 +1,314 @@
+/**
+ * @file UploadStore.cpp
+ * @brief Writing uploaded files to disk, by name or by content digest
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-10
+ * @version 1.0
+ */
+
+#include "UploadStore.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "Sha256.hpp"
+
+static std::string errnoMessage(const std::string& what) {
+  return what + ": " + std::strerror(errno);
+}
+
+static std::string parentDirectory(const std::string& path) {
+  size_t slash = path.rfind('/');
+  if (slash == std::string::npos) {
+    return ".";
+  }
+  return (slash == 0) ? "/" : path.substr(0, slash);
+}
+
+/**
+ * @brief Creates an empty temporary file (mode 0644) in directory
+ * @param path [out] Path of the file
+ * @return File descriptor or -1
+ */
+int UploadStore::createTempFile(const std::string& directory,
+                                std::string& path, std::string& error_msg) {
+  std::string pattern = joinPath(directory, ".upload-XXXXXX");
+  std::vector<char> name(pattern.begin(), pattern.end());
+  name.push_back('\0');
+  int fd = mkostemp(name.data(), O_CLOEXEC);
+  if (fd < 0) {
+    error_msg = errnoMessage("Failed to create temporary file");
+    return -1;
+  }
+  fchmod(fd, 0644);  // mkstemp creates files as 0600
+  path = name.data();
+  return fd;
+}
+
+/**
+ * @brief Reserves size bytes for the empty file fd (fallocate())
+ * @return false if the disk is full, file systems without fallocate() pass
+ */
+bool UploadStore::reserveSpace(int fd, size_t size, std::string& error_msg) {
+  if (size != 0 && fallocate(fd, 0, 0, static_cast<off_t>(size)) != 0 &&
+      errno != EOPNOTSUPP && errno != ENOSYS) {
+    error_msg =
+        errnoMessage("Failed to reserve " + std::to_string(size) + " bytes");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Bounds dirty pages of a large file being written
+ *
+ * Starts writeback of the chunk just written, waits for the previous one
+ * and drops it from the page cache.
+ *
+ * @param offset Offset of the chunk just written
+ * @param length Its length (UPLOAD_WRITE_CHUNK but for the last one)
+ */
+void UploadStore::writeBehind(int fd, size_t offset, size_t length) {
+  sync_file_range(fd, static_cast<off_t>(offset), static_cast<off_t>(length),
+                  SYNC_FILE_RANGE_WRITE);
+  if (offset >= UPLOAD_WRITE_CHUNK) {
+    off_t previous = static_cast<off_t>(offset - UPLOAD_WRITE_CHUNK);
+    sync_file_range(fd, previous, UPLOAD_WRITE_CHUNK,
+                    SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE |
+                        SYNC_FILE_RANGE_WAIT_AFTER);
+    posix_fadvise(fd, previous, UPLOAD_WRITE_CHUNK, POSIX_FADV_DONTNEED);
+  }
+}
+
+/**
+ * @brief Writes content to the empty file fd
+ *
+ * Reserves the size, then pwrite()s UPLOAD_WRITE_CHUNK pieces. Large files
+ * are written behind: writeback of each chunk starts right away, the
+ * previous chunk is waited for and evicted from the page cache.
+ *
+ * @param hash Also hashes every piece before writing it, if not nullptr
+ */
+static bool writeContent(int fd, std::string_view content, Sha256* hash,
+                         std::string& error_msg) {
+  if (!UploadStore::reserveSpace(fd, content.size(), error_msg)) {
+    return false;
+  }
+
+  const bool write_behind = content.size() >= UPLOAD_WRITE_BEHIND_MIN;
+  size_t offset = 0;
+  while (offset < content.size()) {
+    std::string_view chunk = content.substr(offset, UPLOAD_WRITE_CHUNK);
+    if (hash != nullptr) {
+      hash->update(chunk);
+    }
+    size_t written = 0;
+    while (written < chunk.size()) {
+      ssize_t bytes = pwrite(fd, chunk.data() + written,
+                             chunk.size() - written,
+                             static_cast<off_t>(offset + written));
+      if (bytes < 0 && errno == EINTR) {
+        continue;
+      }
+      if (bytes <= 0) {
+        error_msg = errnoMessage("write failed");
+        return false;
+      }
+      written += static_cast<size_t>(bytes);
+    }
+
+    if (write_behind) {
+      UploadStore::writeBehind(fd, offset, chunk.size());
+    }
+    offset += chunk.size();
+  }
+  return true;
+}
+
+/**
+ * @brief Writes content to a new temporary file and syncs it
+ * @param path [out] Path of the temporary file (removed on failure)
+ */
+static bool writeTempFile(const std::string& directory,
+                          std::string_view content, Sha256* hash,
+                          UploadStore::Durability durability,
+                          std::string& path, std::string& error_msg) {
+  int fd = UploadStore::createTempFile(directory, path, error_msg);
+  if (fd < 0) {
+    return false;
+  }
+  bool written = writeContent(fd, content, hash, error_msg) &&
+                 UploadStore::syncFile(fd, durability, error_msg);
+  if (close(fd) != 0 && written) {
+    error_msg = errnoMessage("close failed");
+    written = false;
+  }
+  if (!written) {
+    unlink(path.c_str());
+  }
+  return written;
+}
+
+/**
+ * @brief Moves the temporary file to path unless path exists
+ * @return 0, EEXIST or another errno value
+ */
+static int publish(const std::string& temp_path, const std::string& path) {
+  if (renameat2(AT_FDCWD, temp_path.c_str(), AT_FDCWD, path.c_str(),
+                RENAME_NOREPLACE) == 0) {
+    return 0;
+  }
+  if (errno != EINVAL && errno != ENOSYS) {
+    return errno;
+  }
+  // file system without RENAME_NOREPLACE: link() doesn't replace either
+  if (link(temp_path.c_str(), path.c_str()) != 0) {
+    return errno;
+  }
+  unlink(temp_path.c_str());
+  return 0;
+}
+
+/**
+ * @brief Creates a file that must not exist yet
+ *
+ * The content is written to a temporary file first and moved to path when
+ * complete (and synced as durability asks).
+ *
+ * @param path Path of the new file
+ * @param content File content
+ * @param error_msg [out] Reason of the failure ("File already exists" if
+ *        path exists)
+ * @param durability What to sync before the file appears
+ * @return false if the file exists or can't be written
+ */
+bool UploadStore::writeNewFile(const std::string& path,
+                               std::string_view content,
+                               std::string& error_msg,
+                               Durability durability) {
+  std::string temp_path;
+  if (!writeTempFile(parentDirectory(path), content, nullptr, durability,
+                     temp_path, error_msg)) {
+    return false;
+  }
+  return publishFile(temp_path, path, error_msg, durability);
+}
+
+/**
+ * @brief Moves a complete temporary file to path, which must not exist yet
+ * @param temp_path Synced temporary file in the directory of path, removed
+ *        if it can't be moved
+ * @param path Path of the new file
+ * @param error_msg [out] Reason of the failure ("File already exists" if
+ *        path exists)
+ * @param durability FSYNC also syncs the directory after the move
+ */
+bool UploadStore::publishFile(const std::string& temp_path,
+                              const std::string& path, std::string& error_msg,
+                              Durability durability) {
+  int error = publish(temp_path, path);
+  if (error != 0) {
+    unlink(temp_path.c_str());
+    error_msg = (error == EEXIST) ? "File already exists"
+                                  : "Failed to move upload to " + path + ": " +
+                                        std::strerror(error);
+    return false;
+  }
+  return syncDirectory(parentDirectory(path), durability, error_msg);
+}
+
+/**
+ * @brief Stores content under its SHA-256 digest
+ *
+ * @param directory Upload directory
+ * @param extension File extension without dot (may be empty)
+ * @param content File content
+ * @param object [out] Digest and file name of the stored content
+ * @param error_msg [out] Reason of the failure
+ * @param durability What to sync before the file appears
+ * @return false if the content couldn't be stored
+ */
+bool UploadStore::storeByDigest(const std::string& directory,
+                                const std::string& extension,
+                                std::string_view content,
+                                StoredObject& object, std::string& error_msg,
+                                Durability durability) {
+  Sha256 hash;
+  std::string temp_path;
+  if (!writeTempFile(directory, content, &hash, durability, temp_path,
+                     error_msg)) {
+    return false;
+  }
+
+  object.digest = hash.finishHex();
+  object.file_name =
+      extension.empty() ? object.digest : object.digest + "." + extension;
+  std::string path = joinPath(directory, object.file_name);
+  object.created = true;
+  if (link(temp_path.c_str(), path.c_str()) != 0) {
+    if (errno != EEXIST) {
+      error_msg = errnoMessage("Failed to store " + object.file_name);
+      unlink(temp_path.c_str());
+      return false;
+    }
+    object.created = false;  // same content is already stored
+  }
+  unlink(temp_path.c_str());
+  return !object.created || syncDirectory(directory, durability, error_msg);
+}
+
+/**
+ * @brief Flushes file to disk as durability asks
+ * @param fd Open file
+ * @param durability NONE: nothing, FDATASYNC: data and size, FSYNC: all
+ */
+bool UploadStore::syncFile(int fd, Durability durability,
+                           std::string& error_msg) {
+  int result = 0;
+  if (durability == Durability::FDATASYNC) {
+    result = fdatasync(fd);
+  } else if (durability == Durability::FSYNC) {
+    result = fsync(fd);
+  }
+  if (result != 0) {
+    error_msg = errnoMessage("sync failed");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Makes new names in directory durable (only for FSYNC)
+ */
+bool UploadStore::syncDirectory(const std::string& directory,
+                                Durability durability,
+                                std::string& error_msg) {
+  if (durability != Durability::FSYNC) {
+    return true;
+  }
+  int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0 || fsync(fd) != 0) {
+    error_msg = errnoMessage("Failed to sync directory " + directory);
+    if (fd >= 0) {
+      close(fd);
+    }
+    return false;
+  }
+  close(fd);
+  return true;
+}
+
+/// @brief Joins directory and file name with exactly one slash
+std::string UploadStore::joinPath(const std::string& directory,
+                                  const std::string& name) {
+  if (!directory.empty() && directory.back() == '/') {
+    return directory + name;
+  }
+  return directory + "/" + name;
+}
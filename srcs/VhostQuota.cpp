@@ -0,0 +1,214 @@
+/**
+ * @file VhostQuota.cpp
+ * @brief Per virtual host resource quotas and live usage counters
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-02
+ * @version 1.0
+ *
+ * @note A limit of 0 means "unlimited" for every quota.
+ */
+
+#include "VhostQuota.hpp"
+
+/**
+ * @brief Binds one more client connection to the virtual host
+ * @param server Virtual host configuration
+ * @return true if the connection fits into max_connections, false otherwise
+ */
+bool VhostQuota::acquireConnection(const ConfigParser::ServerConfig& server) {
+  if (server.usage == nullptr) {
+    return true;
+  }
+  SharedZone::LockGuard guard(server.usage->lock);
+  if (server.max_connections != 0 &&
+      server.usage->connections >= server.max_connections) {
+    return false;
+  }
+  server.usage->connections += 1;
+  return true;
+}
+
+/**
+ * @brief Releases connection slot taken by acquireConnection()
+ * @param server Virtual host configuration
+ */
+void VhostQuota::releaseConnection(const ConfigParser::ServerConfig& server) {
+  if (server.usage == nullptr) {
+    return;
+  }
+  SharedZone::LockGuard guard(server.usage->lock);
+  if (server.usage->connections > 0) {
+    server.usage->connections -= 1;
+  }
+}
+
+/**
+ * @brief Reserves CGI process slot for the virtual host
+ * @param server Virtual host configuration
+ * @return true if one more CGI script is allowed to run, false otherwise
+ */
+bool VhostQuota::acquireCgiProcess(const ConfigParser::ServerConfig& server) {
+  if (server.usage == nullptr) {
+    return true;
+  }
+  SharedZone::LockGuard guard(server.usage->lock);
+  if (server.max_cgi_processes != 0 &&
+      server.usage->cgi_processes >= server.max_cgi_processes) {
+    return false;
+  }
+  server.usage->cgi_processes += 1;
+  return true;
+}
+
+/**
+ * @brief Releases CGI process slot taken by acquireCgiProcess()
+ * @param server Virtual host configuration
+ */
+void VhostQuota::releaseCgiProcess(const ConfigParser::ServerConfig& server) {
+  if (server.usage == nullptr) {
+    return;
+  }
+  SharedZone::LockGuard guard(server.usage->lock);
+  if (server.usage->cgi_processes > 0) {
+    server.usage->cgi_processes -= 1;
+  }
+}
+
+/**
+ * @brief Updates the amount of request body memory charged by one connection
+ *
+ * The connection keeps track of what it has already charged, so calling this
+ * function repeatedly while the body grows only applies the difference.
+ *
+ * @param server Virtual host configuration
+ * @param charged [in/out] Bytes currently charged by the caller
+ * @param total Bytes the caller buffers now
+ * @return false if the new total exceeds max_body_memory (nothing is charged)
+ */
+bool VhostQuota::chargeBodyMemory(const ConfigParser::ServerConfig& server,
+                                  size_t& charged, size_t total) {
+  if (server.usage == nullptr) {
+    return true;
+  }
+  SharedZone::LockGuard guard(server.usage->lock);
+  size_t others = server.usage->body_memory - charged;
+  if (server.max_body_memory != 0 && total > charged &&
+      others + total > server.max_body_memory) {
+    return false;
+  }
+  server.usage->body_memory = others + total;
+  charged = total;
+  return true;
+}
+
+/**
+ * @brief Releases everything charged by chargeBodyMemory()
+ * @param server Virtual host configuration
+ * @param charged [in/out] Bytes charged by the caller, reset to 0
+ */
+void VhostQuota::releaseBodyMemory(const ConfigParser::ServerConfig& server,
+                                   size_t& charged) {
+  if (server.usage != nullptr) {
+    SharedZone::LockGuard guard(server.usage->lock);
+    server.usage->body_memory -= std::min(charged, server.usage->body_memory);
+  }
+  charged = 0;
+}
+
+/**
+ * @brief Refills bandwidth token bucket and checks if it has tokens left
+ *
+ * The bucket holds up to one second worth of max_bandwidth. Responses are
+ * charged after they were sent and may push the bucket into debt, so the
+ * virtual host stays throttled until the debt is paid back.
+ *
+ * @param server Virtual host configuration
+ * @return true if a new response can be started, false otherwise
+ */
+bool VhostQuota::hasBandwidth(const ConfigParser::ServerConfig& server) {
+  if (server.usage == nullptr || server.max_bandwidth == 0) {
+    return true;
+  }
+  VhostUsage& usage = *server.usage;
+  SharedZone::LockGuard guard(usage.lock);
+  auto now = std::chrono::steady_clock::now();
+  double elapsed =
+      std::chrono::duration<double>(now - usage.bandwidth_refill).count();
+  usage.bandwidth_refill = now;
+  usage.bandwidth_tokens =
+      std::min(usage.bandwidth_tokens + elapsed * server.max_bandwidth,
+               static_cast<double>(server.max_bandwidth));
+  return usage.bandwidth_tokens > 0;
+}
+
+/**
+ * @brief Accounts bytes sent to the client of the virtual host
+ * @param server Virtual host configuration
+ * @param bytes Amount of bytes written to the socket
+ */
+void VhostQuota::consumeBandwidth(const ConfigParser::ServerConfig& server,
+                                  size_t bytes) {
+  if (server.usage == nullptr) {
+    return;
+  }
+  SharedZone::LockGuard guard(server.usage->lock);
+  server.usage->bytes_sent += bytes;
+  if (server.max_bandwidth != 0) {
+    server.usage->bandwidth_tokens -= static_cast<double>(bytes);
+  }
+}
+
+void VhostQuota::countRequest(const ConfigParser::ServerConfig& server) {
+  if (server.usage != nullptr) {
+    SharedZone::LockGuard guard(server.usage->lock);
+    server.usage->requests += 1;
+  }
+}
+
+void VhostQuota::countRejected(const ConfigParser::ServerConfig& server) {
+  if (server.usage != nullptr) {
+    SharedZone::LockGuard guard(server.usage->lock);
+    server.usage->rejected += 1;
+  }
+}
+
+/**
+ * @brief Builds human readable name of the virtual host
+ * @param server Virtual host configuration
+ * @return "first_server_name:port" or "host:port" ("name:unix:<path>" for
+ *         a server listening on unix sockets only)
+ */
+std::string VhostQuota::getServerLabel(
+    const ConfigParser::ServerConfig& server) {
+  std::string name =
+      server.server_names.empty() ? server.host : server.server_names[0];
+  if (!server.listen_tcp && !server.unix_paths.empty()) {
+    return name + ":unix:" + server.unix_paths[0];
+  }
+  return name + ":" + std::to_string(server.port);
+}
+
+/**
+ * @brief Exports usage counters of all virtual hosts as plain text
+ *
+ * One line per server block in "key=value" format, limits are printed
+ * as "used/limit" (limit 0 means unlimited), bandwidth is bytes per second.
+ *
+ * @param config Parsed webserv configuration
+ * @return Report text
+ */
+std::string VhostQuota::report(const ConfigParser::Config& config) {
+  std::ostringstream out;
+  for (const ConfigParser::ServerConfig& server : config.servers) {
+    VhostUsage empty;
+    const VhostUsage& usage = server.usage ? *server.usage : empty;
+    out << "vhost=" << getServerLabel(server)
+        << " connections=" << usage.connections << "/"
+        << server.max_connections << " cgi=" << usage.cgi_processes << "/"
+        << server.max_cgi_processes << " body_memory=" << usage.body_memory
+        << "/" << server.max_body_memory << " bytes_sent=" << usage.bytes_sent
+        << " bandwidth=" << server.max_bandwidth << " requests=" << usage.requests
+        << " rejected=" << usage.rejected << "\n";
+  }
+  return out.str();
+}
@@ -1,10 +1,21 @@
 #include "Webserver.hpp"
 
+#include <new>
+
 #include "Config.hpp"
+#include "ResumableUpload.hpp"
+#include "SocketActivation.hpp"
 
 // Constructor and destructor
 
-Webserv::Webserv(const std::string &config_path) {
+/**
+ * @param config_path Configuration file
+ * @param inherited_fds Listening sockets opened by a supervisor (socket
+ *        activation), used for the `listen` directives they match
+ */
+Webserv::Webserv(const std::string &config_path,
+                 const std::vector<int> &inherited_fds)
+    : _epoll_fd(-1), _admin_handler(*this) {
   // init static Logger
   try {
     Logger::init("logs/webserv.log");
@@ -36,7 +47,10 @@ Webserv::Webserv(const std::string &config_path) {
     Logger::error(msg);
     throw std::runtime_error(msg);
   }
-  /// 3. create socket for each unique port
+  attachVhostUsage();
+  _method_handler.setAdminHandler(&_admin_handler);
+  /// 3. create socket for each unique port (or take the supervisor's one)
+  adoptInheritedSockets(inherited_fds);
   openServerSockets();
   /// 4. give the socket FD the local address
   bindServerSockets();
@@ -48,14 +62,21 @@ Webserv::Webserv(const std::string &config_path) {
 }
 
 Webserv::~Webserv() {
-  for (auto it = _port_to_servfd.begin(); it != _port_to_servfd.end(); it++) {
-    if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, it->second, nullptr) == -1) {
+  for (int server_socket_fd : getServerSockets()) {
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, server_socket_fd, nullptr) == -1) {
       Logger::warning("Failed to remove server fd from epoll " +
-                      std::to_string(it->second) + ": " + strerror(errno));
+                      std::to_string(server_socket_fd) + ": " +
+                      strerror(errno));
     }
-    if (close(it->second) == -1) {
+    if (close(server_socket_fd) == -1) {
       Logger::warning("Failed to close server fd " +
-                      std::to_string(it->second) + ": " + strerror(errno));
+                      std::to_string(server_socket_fd) + ": " +
+                      strerror(errno));
+    }
+  }
+  for (const auto &listener : _unix_path_to_servfd) {
+    if (_inherited_fds.count(listener.second) == 0) {
+      unlink(listener.first.c_str());
     }
   }
   close(_epoll_fd);
@@ -68,7 +89,10 @@ void Webserv::run(void) {
   struct epoll_event events[WEBSERV_MAX_EVENTS];
   while (shutdown_requested == false) {
     int events_total =
-        epoll_wait(_epoll_fd, events, WEBSERV_MAX_EVENTS, NONBLOCKING);
+        epoll_wait(_epoll_fd, events, WEBSERV_MAX_EVENTS, getEpollWaitTime());
+    if (events_total == -1 && errno == EINTR) {
+      continue;  // interrupted by signal, shutdown_requested is checked
+    }
     if (events_total == -1) {
       Logger::error("The epoll_wait() system call failed: " +
                     std::string(strerror(errno)));
@@ -79,12 +103,17 @@ void Webserv::run(void) {
       auto it = _connections.find(fd);
       if (it == _connections.end()) {
         addConnection(fd);  // If it is not in connections it is a server fd
+      } else if (events[index].events & EPOLLOUT) {
+        handleWritableConnection(fd);  // response did not fit the socket
+        handleKeepAliveConnection(fd);
       } else {
         handleConnection(fd);  // if it was found it is a client fd
         handleKeepAliveConnection(fd);
       }
     }
+    resumePausedConnections();
     cleanupTimeOutConnections();
+    sweepResumableUploads();
   }
 }
 
@@ -95,6 +124,25 @@ int Webserv::getPortByServerSocket(int server_socket_fd) {
   return -1;
 }
 
+int Webserv::getServerSocketByPort(int port) const {
+  auto it = _port_to_servfd.find(port);
+  return it == _port_to_servfd.end() ? -1 : it->second;
+}
+
+/**
+ * @brief Names the listener of a server socket for logs
+ * @return "8080", "unix:/run/webserv.sock" or "-1" if unknown
+ */
+std::string Webserv::getListenerName(int server_socket_fd) const {
+  for (const auto &[path, fd] : _unix_path_to_servfd) {
+    if (fd == server_socket_fd) return "unix:" + path;
+  }
+  for (const auto &[port, fd] : _port_to_servfd) {
+    if (fd == server_socket_fd) return std::to_string(port);
+  }
+  return "-1";
+}
+
 const ConfigParser::ServerConfig &Webserv::getServerConfigs(
     int server_socket_fd, const std::string &host) {
   auto it = _servfd_to_config.find(server_socket_fd);
@@ -130,10 +178,170 @@ const ConfigParser::ServerConfig &Webserv::getServerConfigs(
   return *(servers[0]);
 }
 
+const ConfigParser::Config &Webserv::getConfig(void) const { return _config; }
+
+/**
+ * @brief Memory held by client connections, the receive buffer pool and
+ *        the shared zone
+ * @return Plain text report, one summary line and one line per connection
+ */
+std::string Webserv::reportMemory(void) const {
+  std::ostringstream out;
+  std::ostringstream details;
+  size_t total = 0;
+  size_t idle = 0;
+
+  for (const auto &[fd, connection] : _connections) {
+    size_t bytes = connection->getMemoryUsage();
+    total += bytes;
+    idle += connection->isIdle() ? 1 : 0;
+    details << "fd=" << fd << " bytes=" << bytes
+            << " state=" << (connection->isIdle() ? "idle" : "active") << "\n";
+  }
+  out << "connections=" << _connections.size() << " idle=" << idle
+      << " bytes=" << total << " pool_blocks=" << BufferPool::allocatedBlocks()
+      << " pool_free=" << BufferPool::freeBlocks()
+      << " pool_bytes=" << BufferPool::allocatedBytes() << " zone_pages="
+      << _usage_zone->getUsedPages() << "/" << _usage_zone->getPageCount()
+      << "\n"
+      << details.str();
+  return out.str();
+}
+
+/**
+ * @brief Exports the connections the filter lets through as plain text
+ *
+ * One line per connection in "key=value" format, ordered by fd. Built in a
+ * single pass over the connection table from data the connections already
+ * hold, so listing thousands of connections costs the loop one iteration.
+ *
+ * @param filter Which connections to list
+ * @return "connections=<total> listed=<n>" line, then the connections
+ */
+std::string Webserv::reportConnections(const ConnectionFilter &filter) const {
+  std::vector<int> fds;
+  fds.reserve(_connections.size());
+  for (const auto &entry : _connections) {
+    fds.push_back(entry.first);
+  }
+  std::sort(fds.begin(), fds.end());
+
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  std::ostringstream details;
+  size_t listed = 0;
+  for (int fd : fds) {
+    Connection::Snapshot snapshot = _connections.at(fd)->getSnapshot(now);
+    if (!filter.matches(snapshot)) {
+      continue;
+    }
+    listed++;
+    details << "fd=" << fd << " peer=" << snapshot.peer.toString()
+            << " vhost=" << (snapshot.vhost.empty() ? "-" : snapshot.vhost)
+            << " state=" << ConnectionFilter::getStateName(snapshot.state)
+            << " in=" << snapshot.bytes_in << " out=" << snapshot.bytes_out
+            << " memory=" << snapshot.memory
+            << " idle_ms=" << snapshot.idle.count() << " request="
+            << (snapshot.request_line.empty()
+                    ? "-"
+                    : "\"" + snapshot.request_line + "\"")
+            << "\n";
+  }
+  return "connections=" + std::to_string(_connections.size()) +
+         " listed=" + std::to_string(listed) + "\n" + details.str();
+}
+
 // private helper methods
 
+/**
+ * @brief Gives every virtual host its own quota usage counters
+ *
+ * The counters are the objects `vhost/<index>` of the shared zone
+ * `vhost_usage`.
+ *
+ * @note _config.servers must not be resized afterwards, connections keep
+ *       pointers to the server configurations
+ * @throws std::runtime_error if the zone can't be created
+ */
+void Webserv::attachVhostUsage(void) {
+  // a page holds the counters of 32 server blocks, the rest is headroom
+  size_t pages = 8 + _config.servers.size() / 16;
+  _usage_zone = std::make_unique<SharedZone>(
+      "vhost_usage", pages * SHARED_ZONE_PAGE_SIZE);
+  for (size_t i = 0; i < _config.servers.size(); i++) {
+    void* memory = _usage_zone->lookup("vhost/" + std::to_string(i),
+                                       sizeof(VhostUsage));
+    if (memory == nullptr) {
+      throw std::runtime_error("Shared zone vhost_usage is full");
+    }
+    _config.servers[i].usage = new (memory) VhostUsage();
+  }
+}
+
+/**
+ * @brief Takes the supervisor's sockets for the `listen` directives
+ *
+ * A TCP socket serves the servers listening on its port, a unix socket the
+ * ones listening on its path. Sockets no server listens on are closed.
+ *
+ * @param inherited_fds Listening sockets opened by a supervisor
+ */
+void Webserv::adoptInheritedSockets(const std::vector<int> &inherited_fds) {
+  for (int fd : inherited_fds) {
+    SocketActivation::Listener listener;
+    std::string error_msg;
+    if (!SocketActivation::describe(fd, listener, error_msg)) {
+      throw std::runtime_error("Inherited fd " + std::to_string(fd) + ": " +
+                               error_msg);
+    }
+    bool used = false;
+    for (const ConfigParser::ServerConfig &serv : _config.servers) {
+      used = used ||
+             (listener.port != -1 && serv.listen_tcp &&
+              serv.port == listener.port) ||
+             std::find(serv.unix_paths.begin(), serv.unix_paths.end(),
+                       listener.unix_path) != serv.unix_paths.end();
+    }
+    std::string name = listener.port != -1 ? std::to_string(listener.port)
+                                           : "unix:" + listener.unix_path;
+    bool duplicate = listener.port != -1
+                         ? _port_to_servfd.count(listener.port) != 0
+                         : _unix_path_to_servfd.count(listener.unix_path) != 0;
+    if (!used || duplicate) {
+      Logger::warning("Inherited fd " + std::to_string(fd) + " (" + name +
+                      ") matches no listen directive, closing it");
+      close(fd);
+      continue;
+    }
+    if (listener.port != -1) {
+      _port_to_servfd[listener.port] = fd;
+    } else {
+      _unix_path_to_servfd[listener.unix_path] = fd;
+    }
+    _inherited_fds.insert(fd);
+    Logger::info("Listening on inherited fd " + std::to_string(fd) + " (" +
+                 name + ")");
+  }
+}
+
 void Webserv::openServerSockets(void) {
   for (ConfigParser::ServerConfig &serv : _config.servers) {
+    // one socket per unix path, shared by the servers listening on it
+    for (const std::string &path : serv.unix_paths) {
+      auto it = _unix_path_to_servfd.find(path);
+      if (it == _unix_path_to_servfd.end()) {
+        int server_socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (server_socket_fd == -1) {
+          Logger::error("The socket() system call failed: " +
+                        std::string(strerror(errno)));
+          throw std::runtime_error(std::string(strerror(errno)));
+        }
+        it = _unix_path_to_servfd.emplace(path, server_socket_fd).first;
+      }
+      _servfd_to_config[it->second].push_back(&serv);
+    }
+    if (!serv.listen_tcp) {
+      continue;
+    }
     if (_port_to_servfd.find(serv.port) == _port_to_servfd.end()) {
       ///			-	create socket for each unique port
       int server_socket_fd = socket(AF_INET, SOCK_STREAM, 0);
@@ -157,6 +365,9 @@ void Webserv::bindServerSockets(void) {
   serv_addr.sin_family = AF_INET;
   serv_addr.sin_addr.s_addr = INADDR_ANY;
   for (auto it = _port_to_servfd.begin(); it != _port_to_servfd.end(); it++) {
+    if (_inherited_fds.count(it->second) != 0) {
+      continue;  // bound by the supervisor
+    }
     serv_addr.sin_port = htons(it->first);
     setServerSocketOptions(it->second);
     if (bind(it->second, (struct sockaddr *)&serv_addr, sizeof(serv_addr))) {
@@ -164,11 +375,35 @@ void Webserv::bindServerSockets(void) {
       throw std::runtime_error("Binding socket failed");
     }
   }
+
+  for (const auto &[path, server_socket_fd] : _unix_path_to_servfd) {
+    if (_inherited_fds.count(server_socket_fd) != 0) {
+      continue;
+    }
+    struct sockaddr_un unix_addr{};
+    unix_addr.sun_family = AF_UNIX;
+    std::memcpy(unix_addr.sun_path, path.c_str(), path.size() + 1);
+    // a socket left by a previous run would make bind() fail, anything
+    // else at the path is not ours to remove
+    struct stat info;
+    if (lstat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+      unlink(path.c_str());
+    }
+    if (bind(server_socket_fd, (struct sockaddr *)&unix_addr,
+             sizeof(unix_addr)) == -1) {
+      Logger::error("The bind() method failed for unix:" + path + ": " +
+                    strerror(errno));
+      throw std::runtime_error("Binding socket failed");
+    }
+  }
 }
 
 void Webserv::listenServerSockets(void) {
-  for (auto it = _port_to_servfd.begin(); it != _port_to_servfd.end(); it++) {
-    if (listen(it->second, WEBSERV_MAX_PENDING_CONNECTIONS) == -1) {
+  for (int server_socket_fd : getServerSockets()) {
+    if (_inherited_fds.count(server_socket_fd) != 0) {
+      continue;  // keeps the supervisor's backlog
+    }
+    if (listen(server_socket_fd, WEBSERV_MAX_PENDING_CONNECTIONS) == -1) {
       Logger::error("The listen() function failed.");
       throw std::runtime_error("Listen failed");
     }
@@ -184,29 +419,50 @@ void Webserv::createEpoll(void) {
 }
 
 void Webserv::addServerSocketsToEpoll(void) {
-  for (auto it = _port_to_servfd.begin(); it != _port_to_servfd.end(); it++) {
+  for (int server_socket_fd : getServerSockets()) {
     struct epoll_event ev;
     ev.events = EPOLLIN;
-    ev.data.fd = it->second;
-    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, it->second, &ev) == -1) {
+    ev.data.fd = server_socket_fd;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, server_socket_fd, &ev) == -1) {
       Logger::error("The epoll_ctl() failed: server listen socket.");
       throw std::runtime_error("Epoll_ctl() failed");
     }
   }
 }
 
+/// @brief Listening sockets of TCP ports and unix paths
+std::vector<int> Webserv::getServerSockets(void) const {
+  std::vector<int> server_sockets;
+  for (const auto &listener : _port_to_servfd) {
+    server_sockets.push_back(listener.second);
+  }
+  for (const auto &listener : _unix_path_to_servfd) {
+    server_sockets.push_back(listener.second);
+  }
+  return server_sockets;
+}
+
 void Webserv::addConnection(int server_socket_fd) {
   int client_socketfd = -1;
-  struct sockaddr_in cli_addr;
+  struct sockaddr_storage cli_addr;
   size_t client_socklen = sizeof(cli_addr);
 
-  client_socketfd = accept(server_socket_fd, (struct sockaddr *)&cli_addr,
-                           (socklen_t *)&client_socklen);
+  // non-blocking: a client that doesn't read must never stall the loop
+  client_socketfd = accept4(server_socket_fd, (struct sockaddr *)&cli_addr,
+                            (socklen_t *)&client_socklen,
+                            SOCK_NONBLOCK | SOCK_CLOEXEC);
   if (client_socketfd == -1) {
     Logger::error("Failed to accept connection: " +
                   std::string(strerror(errno)));
     throw std::runtime_error("Creating client socket failed");
   }
+  // blocked clients cost one lookup and a close, nothing is logged or read
+  ClientAddress client = ClientAddress::fromSockaddr(cli_addr);
+  if (!isClientAllowed(server_socket_fd, client)) {
+    DBG("Denied connection from " << client.toString());
+    close(client_socketfd);
+    return;
+  }
   Logger::info("New connection accepted on fd " +
                std::to_string(client_socketfd));
   /// 3. add to epoll
@@ -222,25 +478,128 @@ void Webserv::addConnection(int server_socket_fd) {
 
   /// 4. create connection and add it as unique poiner to _connections
   _connections[client_socketfd] = std::make_unique<Connection>(
-      client_socketfd, server_socket_fd, *this, _method_handler);
+      client_socketfd, server_socket_fd, *this, _method_handler, client);
   Logger::info("New connection (fd " + std::to_string(client_socketfd) +
-               ") accepted on port " +
-               std::to_string(getPortByServerSocket(server_socket_fd)));
+               ") accepted on " + getListenerName(server_socket_fd));
+}
+
+/**
+ * @brief Checks a new client against the `allow`/`deny` rules of the servers
+ *        listening on the socket
+ * @return false if every server on the socket denies the client (the Host
+ *         isn't known yet, so one server allowing it is enough)
+ */
+bool Webserv::isClientAllowed(int server_socket_fd,
+                              const ClientAddress &client) const {
+  auto it = _servfd_to_config.find(server_socket_fd);
+  if (it == _servfd_to_config.end()) {
+    return true;
+  }
+  for (const ConfigParser::ServerConfig *serv : it->second) {
+    if (!serv->access || serv->access->isAllowed(client)) {
+      return true;
+    }
+  }
+  return false;
 }
 
 void Webserv::handleConnection(int client_socket_fd) {
-  ssize_t bytes_read = recv(client_socket_fd, _buffer, sizeof(_buffer), 0);
-  if (bytes_read <= 0) {
+  Connection &connection = *_connections[client_socket_fd];
+  bool is_connected = true;
+  if (connection.isSplicingBody()) {
+    // rest of a raw upload: socket -> pipe -> file, never copied to userspace
+    is_connected = connection.receiveSplicedBody();
+  } else {
+    // receive straight into the request's buffer chain
+    BufferChain &buffer = connection.getReceiveBuffer();
+    size_t available = 0;
+    char *tail = buffer.prepare(available);
+    ssize_t bytes_read = recv(client_socket_fd, tail, available, 0);
+    is_connected = bytes_read > 0 ||
+                   (bytes_read == -1 && (errno == EAGAIN || errno == EINTR));
+    if (bytes_read > 0) {
+      DBG("----------- RECEIVED REQUEST -----------\n"
+          << std::string_view(tail, bytes_read));
+      buffer.commit(bytes_read);
+      connection.processRequest();
+    }
+  }
+  if (!is_connected) {
     Logger::warning("Client disconnected on fd " +
                     std::to_string(client_socket_fd));
     ///    - disconnect client if received data is empty;
     epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, client_socket_fd, nullptr);
     _connections.erase(client_socket_fd);
   } else {
-    _buffer[bytes_read] = '\0';
-    DBG("----------- RECEIVED REQUEST -----------\n" << _buffer);
-    _connections[client_socket_fd]->processRequest(
-        std::string(_buffer, bytes_read));
+    updateConnectionEvents(client_socket_fd);
+  }
+}
+
+void Webserv::handleWritableConnection(int client_socket_fd) {
+  _connections[client_socket_fd]->handleWritable();
+  updateConnectionEvents(client_socket_fd);
+}
+
+/**
+ * @brief Picks epoll events for the client from the state of its response
+ *
+ * - response partially sent: wait for EPOLLOUT
+ * - response paused by limit_rate: no events, the timer wheel wakes it up
+ * - otherwise: wait for the next request (EPOLLIN)
+ *
+ * @param client_socket_fd Client socket file descriptor
+ */
+void Webserv::updateConnectionEvents(int client_socket_fd) {
+  Connection &connection = *_connections[client_socket_fd];
+  uint32_t events = EPOLLIN;
+
+  if (connection.isWritePaused()) {
+    events = 0;
+    _timers.schedule(client_socket_fd, connection.getResumeTime());
+  } else if (connection.hasPendingWrite()) {
+    events = EPOLLOUT;
+  }
+  if (events == connection.getEpollEvents()) {
+    return;
+  }
+
+  struct epoll_event ev;
+  ev.events = events;
+  ev.data.fd = client_socket_fd;
+  if (epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, client_socket_fd, &ev) == -1) {
+    Logger::warning("Failed to update client fd in epoll " +
+                    std::to_string(client_socket_fd) + ": " + strerror(errno));
+    return;
+  }
+  connection.setEpollEvents(events);
+}
+
+/**
+ * @brief How long the event loop may sleep in epoll_wait()
+ * @return One timer wheel tick if paused responses wait for their timer,
+ *         IDLE_WAIT_MS otherwise
+ */
+int Webserv::getEpollWaitTime(void) const {
+  return (_timers.size() > 0) ? TIMER_WHEEL_TICK_MS : IDLE_WAIT_MS;
+}
+
+/**
+ * @brief Continues responses paused by limit_rate whose timer expired
+ * @note Timers can't be cancelled, stale ones are skipped here
+ */
+void Webserv::resumePausedConnections(void) {
+  std::vector<int> expired;
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+  _timers.collectExpired(now, expired);
+  for (int fd : expired) {
+    auto it = _connections.find(fd);
+    if (it == _connections.end() || !it->second->isWritePaused() ||
+        it->second->getResumeTime() > now) {
+      continue;
+    }
+    handleWritableConnection(fd);
+    handleKeepAliveConnection(fd);
   }
 }
 
@@ -258,8 +617,42 @@ void Webserv::cleanupTimeOutConnections(void) {
                         std::to_string(it->first) + ": " + strerror(errno));
       }
       it = _connections.erase(it);
-    } else
+    } else {
+      if (it->second->isTimedOut(
+              std::chrono::seconds(CONNECTION_IDLE_RELEASE_SEC))) {
+        it->second->releaseIdleMemory();
+      }
       it++;
+    }
+  }
+}
+
+/**
+ * @brief Removes expired unfinished uploads of `upload_resumable` locations
+ * @note Runs every RESUMABLE_SWEEP_INTERVAL_SEC, the check in between is a
+ *       clock comparison
+ */
+void Webserv::sweepResumableUploads(void) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  if (now < _next_upload_sweep) {
+    return;
+  }
+  _next_upload_sweep =
+      now + std::chrono::seconds(RESUMABLE_SWEEP_INTERVAL_SEC);
+
+  for (const ConfigParser::ServerConfig &server : _config.servers) {
+    for (const ConfigParser::LocationConfig &location : server.locations) {
+      if (!location.upload_resumable) {
+        continue;
+      }
+      std::string directory = HttpUtils::getFilePath(location, location.path);
+      size_t removed = ResumableUpload::sweep(
+          directory, std::chrono::seconds(RESUMABLE_UPLOAD_EXPIRE_SEC));
+      if (removed > 0) {
+        Logger::info("Removed " + std::to_string(removed) +
+                     " expired upload(s) from " + directory);
+      }
+    }
   }
 }
 
@@ -268,7 +661,8 @@ void Webserv::handleKeepAliveConnection(int client_socket_fd) {
       _connections.find(client_socket_fd);
 
   if (it != _connections.end()) {
-    if (_connections[client_socket_fd]->keepAlive()) {
+    if (_connections[client_socket_fd]->keepAlive() ||
+        _connections[client_socket_fd]->hasPendingWrite()) {
       return;
     }
     if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, client_socket_fd, nullptr) == -1) {
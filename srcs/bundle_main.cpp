@@ -0,0 +1,53 @@
+/**
+ * @file bundle_main.cpp
+ * @brief `webserv-bundle`: packs a document root into an asset bundle
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-13
+ * @version 1.0
+ *
+ * Usage: ./webserv-bundle <root> <output.bundle>
+ *
+ * gzip variants are added when the tool is built with zlib (HAVE_ZLIB,
+ * set by the Makefile if zlib.h is found).
+ */
+
+#include <csignal>
+#include <iostream>
+#include <string>
+
+#include "AssetBundle.hpp"
+#include "Compressors.hpp"
+
+// defined by main.cpp in the server, the library links against it
+volatile std::sig_atomic_t shutdown_requested = 0;
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    std::cerr << "Usage: ./webserv-bundle <root> <output.bundle>" << std::endl;
+    return 1;
+  }
+
+#ifdef HAVE_ZLIB
+  AssetBundle::Compressor gzip = Compressors::gzip;
+#else
+  AssetBundle::Compressor gzip = nullptr;
+  std::cerr << "Built without zlib: no gzip variants" << std::endl;
+#endif
+
+  size_t assets = 0;
+  std::string error_msg;
+  if (!AssetBundle::build(argv[1], argv[2], gzip, assets, error_msg)) {
+    std::cerr << "Failed to build bundle: " << error_msg << std::endl;
+    return 1;
+  }
+
+  try {
+    AssetBundle bundle(argv[2]);  // the server will map it the same way
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  std::cout << "Packed " << assets << " files from " << argv[1] << " into "
+            << argv[2] << std::endl;
+  return 0;
+}
@@ -0,0 +1,51 @@
+/**
+ * @file heap_hook.cpp
+ * @brief Sampling global operator new for the heap profile
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-17
+ * @version 1.0
+ *
+ * Linked into the server only by `make HEAP_PROFILE=1` (the library stays
+ * free of it, test binaries replace operator new themselves). Allocations
+ * go to malloc() as usual, Profiler::sampleAllocation() records a stack now
+ * and then for `<admin location>/heap`.
+ */
+
+#include <cstdlib>
+#include <new>
+
+#include "Profiler.hpp"
+
+namespace {
+
+struct HeapHook {
+  HeapHook() { Profiler::installHeapHook(); }
+};
+
+HeapHook heap_hook;
+
+void* allocate(size_t size) {
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+}  // namespace
+
+// sampleAllocation() is called right here: the frame above it is the site
+void* operator new(size_t size) {
+  Profiler::sampleAllocation(size);
+  return allocate(size);
+}
+
+void* operator new[](size_t size) {
+  Profiler::sampleAllocation(size);
+  return allocate(size);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
@@ -1,4 +1,10 @@
+#include <fcntl.h>
+
+#include <climits>
+#include <cstdlib>
+
 #include "Connection.hpp"
+#include "SocketActivation.hpp"
 #include "Webserver.hpp"
 
 volatile std::sig_atomic_t shutdown_requested = 0;
@@ -11,18 +17,34 @@ int main(int argc, char **argv) {
   signal(SIGCHLD, SIG_IGN);  // Apparently this tells the kernel to reap
                              // children, so no zombies?
 
-  if (argc > 2) {
-    std::cerr << "Usage: ./webserv [path_to_config_file]" << std::endl;
-    return 1;
-  }
-
+  // sockets of a supervisor: LISTEN_FDS (systemd) or --inherit-fd <fd>
+  std::vector<int> inherited_fds = SocketActivation::takeEnvironmentFds();
   std::string path = "tests/test-configs/test.conf";
-  if (argc == 2) {
-    path = argv[1];
+  bool has_path = false;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    char *end = nullptr;
+    if (arg == "--inherit-fd" && i + 1 < argc) {
+      long fd = std::strtol(argv[++i], &end, 10);
+      if (*argv[i] == '\0' || *end != '\0' || fd < 0 || fd > INT_MAX) {
+        std::cerr << "Invalid fd: " << argv[i] << std::endl;
+        return 1;
+      }
+      fcntl(static_cast<int>(fd), F_SETFD, FD_CLOEXEC);
+      inherited_fds.push_back(static_cast<int>(fd));
+    } else if (!has_path && arg.rfind("--", 0) != 0) {
+      path = arg;
+      has_path = true;
+    } else {
+      std::cerr << "Usage: ./webserv [--inherit-fd <fd>]... "
+                   "[path_to_config_file]"
+                << std::endl;
+      return 1;
+    }
   }
 
   try {
-    Webserv webserv(path);
+    Webserv webserv(path, inherited_fds);
     webserv.run();
   } catch (const std::runtime_error &e) {
     std::cerr << "\n\n[RUNTIME ERROR] " << e.what() << "\n" << std::endl;
@@ -0,0 +1,68 @@
+/**
+ * @file precompress_main.cpp
+ * @brief `webserv-precompress`: writes compressed variants of static files
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-14
+ * @version 1.0
+ *
+ * Usage: ./webserv-precompress <root> [threads]
+ *
+ * Writes `.gz`, `.br` and `.zst` variants, each if the tool is built with
+ * its library (zlib, brotli, zstd), for the `*_static` directives.
+ */
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Compressors.hpp"
+#include "Precompress.hpp"
+
+// defined by main.cpp in the server, the library links against it
+volatile std::sig_atomic_t shutdown_requested = 0;
+
+int main(int argc, char** argv) {
+  if (argc != 2 && argc != 3) {
+    std::cerr << "Usage: ./webserv-precompress <root> [threads]" << std::endl;
+    return 1;
+  }
+  size_t threads = 0;
+  if (argc == 3) {
+    char* end = nullptr;
+    threads = std::strtoul(argv[2], &end, 10);
+    if (*argv[2] == '\0' || *end != '\0' || threads == 0) {
+      std::cerr << "Invalid thread count: " << argv[2] << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<Precompress::Encoding> encodings;
+#ifdef HAVE_ZLIB
+  encodings.push_back({".gz", Compressors::gzip});
+#endif
+#ifdef HAVE_BROTLI
+  encodings.push_back({".br", Compressors::brotli});
+#endif
+#ifdef HAVE_ZSTD
+  encodings.push_back({".zst", Compressors::zstd});
+#endif
+  if (encodings.empty()) {
+    std::cerr << "Built without zlib, brotli and zstd: nothing to do"
+              << std::endl;
+    return 1;
+  }
+
+  Precompress::Stats stats = Precompress::run(argv[1], encodings, threads);
+  if (stats.files == 0 && stats.failed > 0) {
+    std::cerr << "Failed to walk " << argv[1] << std::endl;
+    return 1;
+  }
+  std::cout << stats.files << " compressible files: " << stats.written
+            << " variants written (" << stats.bytes_in << " -> "
+            << stats.bytes_out << " bytes), " << stats.up_to_date
+            << " up to date, " << stats.not_smaller << " not smaller, "
+            << stats.failed << " failed" << std::endl;
+  return stats.failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,265 @@
+/**
+ * @file test_access_list.cpp
+ * @brief Unit tests for client address access rules
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-17
+ * @version 1.0
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "AccessList.hpp"
+#include "HttpMethodHandler.hpp"
+#include "HttpRequest.hpp"
+#include "RequestPipeline.hpp"
+
+static ClientAddress address(const std::string& text) {
+  ClientAddress client;
+  assert(ClientAddress::parse(text, client));
+  return client;
+}
+
+static bool throwsInvalid(AccessList& list, const std::string& prefix) {
+  try {
+    list.addRule(false, prefix);
+  } catch (const std::invalid_argument&) {
+    return true;
+  }
+  return false;
+}
+
+static void test_first_match(void) {
+  std::cout << "Testing first matching rule..." << std::flush;
+
+  // nginx example: the host is denied, its /24 allowed, the rest denied
+  AccessList list;
+  list.addRule(false, "192.168.1.1");
+  list.addRule(true, "192.168.1.0/24");
+  list.addRule(true, "10.1.1.0/16");  // host bits are ignored
+  list.addRule(true, "2001:db8::/32");
+  list.addRule(false, "all");
+  assert(!list.isAllowed(address("192.168.1.1")));
+  assert(list.isAllowed(address("192.168.1.2")));
+  assert(!list.isAllowed(address("192.168.2.1")));
+  assert(list.isAllowed(address("10.1.200.3")));
+  assert(!list.isAllowed(address("10.2.0.1")));
+  assert(list.isAllowed(address("2001:db8:1::1")));
+  assert(!list.isAllowed(address("2001:db9::1")));
+  assert(!list.isAllowed(ClientAddress()));  // unix clients only match all
+
+  // a wider rule first hides the narrower ones after it
+  AccessList wide;
+  wide.addRule(true, "10.0.0.0/8");
+  wide.addRule(false, "10.0.0.0/24");
+  wide.addRule(false, "10.0.0.7");
+  assert(wide.isAllowed(address("10.0.0.7")));
+  assert(wide.isAllowed(ClientAddress()));  // no rule matches
+  assert(wide.size() == 3);
+
+  AccessList invalid;
+  assert(throwsInvalid(invalid, "10.0.0.0/33"));
+  assert(throwsInvalid(invalid, "10.0.0.0/"));
+  assert(throwsInvalid(invalid, "10.0.0.0/8x"));
+  assert(throwsInvalid(invalid, "10.0.0"));
+  assert(throwsInvalid(invalid, "::/129"));
+  assert(throwsInvalid(invalid, "localhost"));
+  assert(!throwsInvalid(invalid, "::/0"));
+  assert(!invalid.isAllowed(address("2001:db8::1")));
+  assert(invalid.isAllowed(address("127.0.0.1")));
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_list_file(void) {
+  std::cout << "Testing access list files..." << std::flush;
+
+  char path[] = "/tmp/webserv_access_XXXXXX";
+  int fd = mkstemp(path);
+  assert(fd != -1);
+  close(fd);
+  {
+    std::ofstream file(path);
+    file << "# blocklist\n"
+         << "203.0.113.0/24\n"
+         << "\n"
+         << "198.51.100.7;  # one host\n"
+         << "2001:db8::/48;\n";
+  }
+  AccessList list;
+  list.addRule(true, "203.0.113.9");
+  list.load(false, path);
+  assert(list.size() == 4);
+  assert(list.isAllowed(address("203.0.113.9")));
+  assert(!list.isAllowed(address("203.0.113.10")));
+  assert(!list.isAllowed(address("198.51.100.7")));
+  assert(list.isAllowed(address("198.51.100.8")));
+  assert(!list.isAllowed(address("2001:db8:0:1::")));
+  assert(list.isAllowed(address("2001:db8:1::")));
+
+  {
+    std::ofstream file(path);
+    file << "192.0.2.0/24\n"
+         << "192.0.2.0/24 192.0.3.0/24\n";
+  }
+  std::string error;
+  try {
+    list.load(false, path);
+  } catch (const std::runtime_error& e) {
+    error = e.what();
+  }
+  assert(error.find(std::string(path) + ":2:") == 0);
+  unlink(path);
+
+  bool thrown = false;
+  try {
+    list.load(false, path);
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+struct Prefix {
+  uint32_t key;
+  unsigned length;
+  bool allow;
+};
+
+static bool bruteForce(const std::vector<Prefix>& rules, uint32_t client) {
+  for (const Prefix& rule : rules) {
+    uint32_t mask = rule.length == 0 ? 0 : ~0u << (32 - rule.length);
+    if (((client ^ rule.key) & mask) == 0) {
+      return rule.allow;
+    }
+  }
+  return true;
+}
+
+static std::string toText(uint32_t key) {
+  in_addr ipv4;
+  ipv4.s_addr = htonl(key);
+  return inet_ntoa(ipv4);
+}
+
+static void test_random_prefixes(void) {
+  std::cout << "Testing random prefixes against a scan..." << std::flush;
+
+  // few short prefixes so that lookups hit nested rules
+  std::mt19937 random(42);
+  std::vector<Prefix> rules;
+  AccessList list;
+  for (int i = 0; i < 2000; i++) {
+    Prefix rule;
+    rule.key = random() & 0xff00ffffu;
+    rule.length = 8 + random() % 25;
+    rule.allow = random() % 2;
+    rules.push_back(rule);
+    list.addRule(rule.allow,
+                 toText(rule.key) + "/" + std::to_string(rule.length));
+  }
+  for (int i = 0; i < 20000; i++) {
+    uint32_t client = random() & 0xff00ffffu;
+    if (i % 2) {
+      client = rules[random() % rules.size()].key ^ (random() & 0xff);
+    }
+    ClientAddress peer;
+    peer.family = AF_INET;
+    peer.v4 = client;
+    assert(list.isAllowed(peer) == bruteForce(rules, client));
+  }
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_socket_addresses(void) {
+  std::cout << "Testing peer addresses..." << std::flush;
+
+  sockaddr_storage storage;
+  std::memset(&storage, 0, sizeof(storage));
+  sockaddr_in6* ipv6 = reinterpret_cast<sockaddr_in6*>(&storage);
+  ipv6->sin6_family = AF_INET6;
+  inet_pton(AF_INET6, "::ffff:192.0.2.1", &ipv6->sin6_addr);
+  ClientAddress mapped = ClientAddress::fromSockaddr(storage);
+  assert(mapped.family == AF_INET);
+  assert(mapped.toString() == "192.0.2.1");
+
+  inet_pton(AF_INET6, "2001:db8::5", &ipv6->sin6_addr);
+  assert(ClientAddress::fromSockaddr(storage).toString() == "2001:db8::5");
+
+  std::memset(&storage, 0, sizeof(storage));
+  sockaddr_in* ipv4 = reinterpret_cast<sockaddr_in*>(&storage);
+  ipv4->sin_family = AF_INET;
+  inet_pton(AF_INET, "127.0.0.1", &ipv4->sin_addr);
+  assert(ClientAddress::fromSockaddr(storage).v4 == 0x7f000001u);
+
+  storage.ss_family = AF_UNIX;
+  assert(ClientAddress::fromSockaddr(storage).toString() == "unix");
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_location_rules(void) {
+  std::cout << "Testing location access phase..." << std::flush;
+
+  auto rules = std::make_shared<AccessList>();
+  rules->addRule(true, "127.0.0.0/8");
+  rules->addRule(false, "all");
+
+  ConfigParser::ServerConfig server;
+  server.root = "docs/fusion_web";
+  ConfigParser::LocationConfig root(server);
+  root.path = "/";
+  root.index = "index.html";
+  root.access = rules;
+  server.locations = {root};
+  server.locations[0].pipeline = RequestPipeline::compose(server.locations[0]);
+  assert(server.locations[0].pipeline->count(Phase::ACCESS) == 2);
+
+  HttpMethodHandler handler;
+  HttpRequest local;
+  local.setMethod("GET");
+  local.setNormalizedTarget("/", std::string::npos, 0);
+  local.setClientAddress(address("127.0.0.1"));
+  HttpResponse response = handler.processMethod(local, server);
+  assert(response.getStatusCode() == HttpUtils::HttpStatusCode::OK);
+
+  HttpRequest remote;
+  remote.setMethod("GET");
+  remote.setNormalizedTarget("/", std::string::npos, 0);
+  remote.setClientAddress(address("192.0.2.1"));
+  remote.reset();  // the address belongs to the connection
+  remote.setMethod("GET");
+  remote.setNormalizedTarget("/", std::string::npos, 0);
+  response = handler.processMethod(remote, server);
+  assert(response.getStatusCode() == HttpUtils::HttpStatusCode::FORBIDDEN);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+void run_access_list_tests() {
+  std::cout << "=== Running AccessList Tests ===\n" << std::endl;
+
+  test_first_match();
+  test_list_file();
+  test_random_prefixes();
+  test_socket_addresses();
+  test_location_rules();
+
+  std::cout << "\nAll AccessList tests passed!\n" << std::endl;
+}
@@ -0,0 +1,167 @@
+/**
+ * @file test_asset_bundle.cpp
+ * @brief Unit tests for asset bundles
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-13
+ * @version 1.0
+ */
+
+#include <unistd.h>
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "AssetBundle.hpp"
+
+static void writeFile(const std::string& path, const std::string& content) {
+  std::ofstream file(path, std::ios::binary);
+  file << content;
+}
+
+/// @brief Stand-in for gzip: keeps every other byte
+static bool halve(std::string_view input, std::string& output) {
+  output.clear();
+  for (size_t i = 0; i < input.size(); i += 2) {
+    output += input[i];
+  }
+  return true;
+}
+
+static std::string makeSite(const std::string& dir) {
+  std::string site = dir + "/site";
+  std::filesystem::create_directories(site + "/css");
+  std::filesystem::create_directories(site + "/.git");
+  writeFile(site + "/index.html", "<h1>home</h1>");
+  writeFile(site + "/css/style.css", std::string(40000, 'c'));
+  writeFile(site + "/logo.png", "png-bytes");
+  writeFile(site + "/copy.html", "<h1>home</h1>");
+  writeFile(site + "/empty.txt", "");
+  writeFile(site + "/.env", "secret");
+  writeFile(site + "/.git/config", "secret");
+  return site;
+}
+
+static void test_build_and_find(const std::string& dir) {
+  std::cout << "Testing bundle build and lookup..." << std::flush;
+
+  std::string path = dir + "/site.bundle";
+  size_t assets = 0;
+  std::string error_msg;
+  assert(AssetBundle::build(makeSite(dir), path, halve, assets, error_msg));
+  assert(assets == 5);  // hidden files left out
+  assert(!std::filesystem::exists(path + ".tmp"));
+
+  AssetBundle bundle(path);
+  assert(bundle.size() == 5);
+  AssetBundle::Asset asset;
+  assert(bundle.find("/index.html", asset));
+  assert(asset.path == "/index.html");
+  assert(asset.content_type == "text/html");
+  assert(bundle.data(asset.offset, asset.length) == "<h1>home</h1>");
+  assert(asset.etag.size() == 32);
+  std::string etag(asset.etag);
+
+  // same content, same ETag
+  assert(bundle.find("/copy.html", asset) && asset.etag == etag);
+
+  // compressible type gets a variant, images don't
+  assert(bundle.find("/css/style.css", asset));
+  assert(asset.content_type == "text/css" && asset.length == 40000);
+  assert(asset.gzip_length == 20000);
+  assert(bundle.data(asset.gzip_offset, asset.gzip_length) ==
+         std::string(20000, 'c'));
+  assert(bundle.find("/logo.png", asset) && asset.gzip_length == 0);
+  assert(asset.content_type == "image/png");
+  assert(bundle.find("/empty.txt", asset) && asset.length == 0);
+
+  assert(!bundle.find("/missing.html", asset));
+  assert(!bundle.find("/css", asset));
+  assert(!bundle.find("/.env", asset));
+  assert(!bundle.find("/.git/config", asset));
+  assert(!bundle.find("index.html", asset));
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_body_source(const std::string& dir) {
+  std::cout << "Testing bundle body source..." << std::flush;
+
+  std::shared_ptr<const AssetBundle> bundle =
+      std::make_shared<const AssetBundle>(dir + "/site.bundle");
+  AssetBundle::Asset asset;
+  assert(bundle->find("/css/style.css", asset));
+
+  AssetBundle::Body body(bundle, asset.offset, asset.length);
+  assert(body.size() == 40000);
+  std::string buffer;
+  BodySource::FileRange range;
+  assert(body.next(buffer, range));
+  assert(buffer.empty() && range.fd == bundle->getFd());
+  assert(range.offset == static_cast<off_t>(asset.offset));
+  assert(range.length == 40000);
+  assert(!body.next(buffer, range));
+
+  std::cout << "\t\t✓ passed" << std::endl;
+}
+
+static void test_invalid_bundles(const std::string& dir) {
+  std::cout << "Testing invalid bundles..." << std::flush;
+
+  std::string path = dir + "/site.bundle";
+  std::string bytes;
+  {
+    std::ifstream file(path, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(file),
+                 std::istreambuf_iterator<char>());
+  }
+  auto rejects = [&dir](const std::string& content) {
+    writeFile(dir + "/bad.bundle", content);
+    try {
+      AssetBundle bundle(dir + "/bad.bundle");
+    } catch (const std::runtime_error&) {
+      return true;
+    }
+    return false;
+  };
+  assert(rejects(""));
+  assert(rejects("not a bundle at all, just some text of a file"));
+  assert(rejects(bytes.substr(0, bytes.size() - 1)));  // truncated
+  std::string damaged = bytes;
+  damaged[8] = 100;  // asset count
+  assert(rejects(damaged));
+
+  bool thrown = false;
+  try {
+    AssetBundle bundle(dir + "/missing.bundle");
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  size_t assets = 0;
+  std::string error_msg;
+  assert(!AssetBundle::build(dir + "/missing", dir + "/x.bundle", nullptr,
+                             assets, error_msg));
+  assert(!error_msg.empty());
+
+  std::cout << "\t\t✓ passed" << std::endl;
+}
+
+void run_asset_bundle_tests() {
+  std::cout << "=== Running AssetBundle Tests ===\n" << std::endl;
+
+  std::string dir = std::filesystem::temp_directory_path() /
+                    ("webserv-bundle-test-" + std::to_string(getpid()));
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+
+  test_build_and_find(dir);
+  test_body_source(dir);
+  test_invalid_bundles(dir);
+  std::filesystem::remove_all(dir);
+
+  std::cout << "\nAll AssetBundle tests passed!\n" << std::endl;
+}
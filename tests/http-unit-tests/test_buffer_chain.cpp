@@ -0,0 +1,217 @@
+/**
+ * @file test_buffer_chain.cpp
+ * @brief Unit tests for pooled receive buffers
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-08
+ * @version 1.0
+ */
+
+#include <cassert>
+#include <iostream>
+#include <string>
+
+#include "BufferChain.hpp"
+#include "HttpRequest.hpp"
+#include "HttpRequestParser.hpp"
+
+static void test_append_and_consume() {
+  std::cout << "Testing block chaining..." << std::flush;
+
+  size_t allocated = BufferPool::allocatedBlocks();
+  BufferChain chain;
+  std::string data;
+  for (size_t i = 0; i < 3 * BUFFER_BLOCK_SIZE; i++) {
+    data += static_cast<char>('a' + i % 26);
+  }
+
+  chain.append(data);
+  assert(chain.size() == data.size());
+  assert(chain.blockCount() == 3);
+
+  chain.consume(BUFFER_BLOCK_SIZE + 10);
+  assert(chain.blockCount() == 2);
+  assert(chain.peek(5) == data.substr(BUFFER_BLOCK_SIZE + 10, 5));
+
+  std::string out;
+  chain.moveTo(out, BUFFER_BLOCK_SIZE);
+  assert(out == data.substr(BUFFER_BLOCK_SIZE + 10, BUFFER_BLOCK_SIZE));
+  assert(chain.size() == BUFFER_BLOCK_SIZE - 10);
+
+  chain.consume(chain.size());
+  assert(chain.empty() && chain.blockCount() == 0);
+  assert(BufferPool::allocatedBlocks() <= allocated + 3);
+  assert(BufferPool::freeBlocks() >= 3);
+
+  std::cout << "\t\t✓ passed" << std::endl;
+}
+
+static void test_boundaries() {
+  std::cout << "Testing data across block boundaries..." << std::flush;
+
+  BufferChain chain;
+  chain.append(std::string(BUFFER_BLOCK_SIZE - 2, 'x'));
+  chain.append("\r\n\r\nbody");
+
+  assert(chain.find("\r\n\r\n") == BUFFER_BLOCK_SIZE - 2);
+  assert(chain.find("\r\n", BUFFER_BLOCK_SIZE - 1) == BUFFER_BLOCK_SIZE);
+  assert(chain.find("body") == BUFFER_BLOCK_SIZE + 2);
+  assert(chain.find("bodyx") == std::string::npos);
+  assert(chain.peek(BUFFER_BLOCK_SIZE + 6).substr(BUFFER_BLOCK_SIZE - 3) ==
+         "x\r\n\r\nbody");
+
+  size_t available = 0;
+  char* tail = chain.prepare(available);
+  assert(available == BUFFER_BLOCK_SIZE - 6);
+  tail[0] = '!';
+  chain.commit(1);
+  assert(chain.find("y!") == BUFFER_BLOCK_SIZE + 5);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_split_request() {
+  std::cout << "Testing request split between blocks..." << std::flush;
+
+  HttpRequest request;
+  std::string body(3 * BUFFER_BLOCK_SIZE, 'b');
+  std::string message =
+      "POST /upload HTTP/1.1\r\n"
+      "Host: localhost\r\n"
+      "Content-Length: " +
+      std::to_string(body.size()) + "\r\n\r\n" + body;
+
+  // deliver in odd-sized pieces, as recv() would
+  BufferChain& buffer = request.getUnparsedBuffer();
+  HttpRequestParser::Status status = HttpRequestParser::Status::WAIT_FOR_DATA;
+  for (size_t offset = 0; offset < message.size(); offset += 1000) {
+    buffer.append(std::string_view(message).substr(offset, 1000));
+    status = HttpRequestParser::parseRequest(request);
+    assert(status != HttpRequestParser::Status::ERROR);
+    assert(buffer.blockCount() <= 1);  // body leaves the chain on arrival
+  }
+  assert(status == HttpRequestParser::Status::DONE);
+  assert(request.getPath() == "/upload");
+  assert(request.getBody() == body);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_request_memory_release() {
+  std::cout << "Testing request memory release..." << std::flush;
+
+  HttpRequest request;
+  std::string body(1 << 20, 'b');
+  std::string message =
+      "POST /upload HTTP/1.1\r\n"
+      "Host: localhost\r\n"
+      "Content-Length: " +
+      std::to_string(body.size()) + "\r\n\r\n" + body;
+  request.getUnparsedBuffer().append(message);
+  assert(HttpRequestParser::parseRequest(request) ==
+         HttpRequestParser::Status::DONE);
+  assert(request.getMemoryUsage() >= body.size());
+
+  request.reset();  // large body isn't kept for the next request
+  assert(request.getMemoryUsage() < 1024);
+  assert(request.getUnparsedBuffer().blockCount() == 0);
+
+  request.getUnparsedBuffer().append("GET / HTTP/1.1\r\n");
+  request.releaseMemory();
+  assert(request.getMemoryUsage() == 0);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_block_sizes() {
+  std::cout << "Testing mixed block sizes..." << std::flush;
+
+  size_t bytes = BufferPool::allocatedBytes();
+  BufferChain chain;
+  chain.setBlockSize(1024);
+  chain.append(std::string(1000, 'h'));
+  chain.setBlockSize(8192);
+  chain.append(std::string(100, 'h') + "\r\n\r\n");
+  assert(chain.blockCount() == 2 && chain.capacity() == 1024 + 8192);
+  assert(chain.find("\r\n\r\n") == 1100);
+  assert(chain.peek(1104).substr(1020) == std::string(80, 'h') + "\r\n\r\n");
+
+  chain.consume(1050);  // the small block goes back to its own free list
+  assert(chain.blockCount() == 1 && chain.capacity() == 8192);
+  chain.clear();
+  assert(BufferPool::allocatedBytes() <= bytes + 1024 + 8192);
+
+  BufferChain other;
+  other.setBlockSize(1024);
+  other.append("GET / HTTP/1.1\r\n");
+  assert(BufferPool::allocatedBytes() <= bytes + 1024 + 8192);  // reused
+  other.clear();
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+// parses a request head with 64 byte lines and 128 bytes of headers at most
+static HttpRequestParser::Status parseHead(const std::string& head,
+                                           HttpRequest& request) {
+  request.setHeaderLimits(64, 128);
+  request.getUnparsedBuffer().append(head);
+  return HttpRequestParser::parseRequest(request);
+}
+
+static void test_header_limits() {
+  std::cout << "Testing request head limits..." << std::flush;
+
+  const std::string line = "GET / HTTP/1.1\r\n";
+  const std::string host = "Host: localhost\r\n";
+  HttpRequest request;
+  assert(parseHead(line + host + "\r\n", request) ==
+         HttpRequestParser::Status::DONE);
+
+  // incomplete heads wait until they outgrow the limits
+  request.reset();
+  assert(parseHead("GET /" + std::string(40, 'a'), request) ==
+         HttpRequestParser::Status::WAIT_FOR_DATA);
+  assert(parseHead(std::string(40, 'a'), request) ==
+         HttpRequestParser::Status::ERROR);
+  assert(request.getStatusCode() == HttpUtils::HttpStatusCode::URI_TOO_LONG);
+
+  request.reset();
+  assert(parseHead(line + host + "X-Long: " + std::string(60, 'v') +
+                       "\r\n\r\n",
+                   request) == HttpRequestParser::Status::ERROR);
+  assert(request.getStatusCode() ==
+         HttpUtils::HttpStatusCode::REQUEST_HEADER_FIELDS_TOO_LARGE);
+
+  std::string headers = host;
+  for (int i = 0; i < 5; i++) {
+    headers += "X-Header-" + std::to_string(i) + ": " + std::string(20, 'v') +
+               "\r\n";
+  }
+  request.reset();
+  assert(parseHead(line + headers.substr(0, 100), request) ==
+         HttpRequestParser::Status::WAIT_FOR_DATA);
+  assert(parseHead(headers.substr(100), request) ==
+         HttpRequestParser::Status::ERROR);
+  assert(request.getStatusCode() ==
+         HttpUtils::HttpStatusCode::REQUEST_HEADER_FIELDS_TOO_LARGE);
+
+  request.reset();
+  assert(parseHead(line + headers + "\r\n", request) ==
+         HttpRequestParser::Status::ERROR);
+  assert(request.getStatusCode() ==
+         HttpUtils::HttpStatusCode::REQUEST_HEADER_FIELDS_TOO_LARGE);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+void run_buffer_chain_tests() {
+  std::cout << "=== Running BufferChain Tests ===\n" << std::endl;
+
+  test_append_and_consume();
+  test_boundaries();
+  test_split_request();
+  test_request_memory_release();
+  test_block_sizes();
+  test_header_limits();
+
+  std::cout << "\nAll BufferChain tests passed!\n" << std::endl;
+}
@@ -0,0 +1,144 @@
+/**
+ * @file test_cache_policy.cpp
+ * @brief Unit tests for caching headers of static responses
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-15
+ * @version 1.0
+ */
+
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "CachePolicy.hpp"
+#include "HttpResponse.hpp"
+
+static bool rejects(void (*configure)(CachePolicy&)) {
+  CachePolicy policy;
+  try {
+    configure(policy);
+  } catch (const std::exception&) {
+    return true;
+  }
+  return false;
+}
+
+static void test_parse_duration(void) {
+  std::cout << "Testing expires durations..." << std::flush;
+
+  assert(CachePolicy::parseDuration("3600") == 3600);
+  assert(CachePolicy::parseDuration("30s") == 30);
+  assert(CachePolicy::parseDuration("5m") == 300);
+  assert(CachePolicy::parseDuration("1h30m") == 5400);
+  assert(CachePolicy::parseDuration("30d") == 2592000);
+  assert(CachePolicy::parseDuration("1w") == 604800);
+  assert(CachePolicy::parseDuration("1M") == 2592000);
+  assert(CachePolicy::parseDuration("1y") == 31536000);
+  assert(CachePolicy::parseDuration("-1") == -1);
+  assert(CachePolicy::parseDuration("0") == 0);
+
+  assert(rejects([](CachePolicy& p) { p.setExpires(""); }));
+  assert(rejects([](CachePolicy& p) { p.setExpires("-"); }));
+  assert(rejects([](CachePolicy& p) { p.setExpires("d"); }));
+  assert(rejects([](CachePolicy& p) { p.setExpires("10x"); }));
+  assert(rejects([](CachePolicy& p) { p.setExpires("1h-5m"); }));
+  assert(rejects([](CachePolicy& p) { p.setExpires("99999y"); }));
+  assert(rejects([](CachePolicy& p) { p.setExpires("99999999999"); }));
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_header_blocks(void) {
+  std::cout << "Testing precomputed header blocks..." << std::flush;
+
+  CachePolicy policy;
+  assert(policy.headerBlock(false).empty());
+
+  policy.setExpires("30d");
+  assert(policy.headerBlock(false) == "Cache-Control: max-age=2592000\r\n");
+  policy.setExpires("-1");
+  assert(policy.headerBlock(false) == "Cache-Control: no-cache\r\n");
+  policy.setExpires("epoch");
+  assert(policy.headerBlock(false) ==
+         "Expires: Thu, 01 Jan 1970 00:00:01 GMT\r\n"
+         "Cache-Control: no-cache\r\n");
+  policy.setExpires("max");
+  assert(policy.headerBlock(false) ==
+         "Expires: Thu, 31 Dec 2037 23:55:55 GMT\r\n"
+         "Cache-Control: max-age=315360000\r\n");
+
+  // add_header Cache-Control replaces the one of expires
+  policy.addHeader("X-Frame-Options", "DENY");
+  policy.addHeader("Cache-Control", "  public, no-transform ");
+  assert(policy.headerBlock(false) ==
+         "X-Frame-Options: DENY\r\n"
+         "Cache-Control: public, no-transform\r\n"
+         "Expires: Thu, 31 Dec 2037 23:55:55 GMT\r\n");
+  assert(policy.headerBlock(true) ==
+         "X-Frame-Options: DENY\r\n"
+         "Cache-Control: public, max-age=31536000, immutable\r\n");
+
+  policy.setExpires("off");
+  assert(policy.headerBlock(false) ==
+         "X-Frame-Options: DENY\r\n"
+         "Cache-Control: public, no-transform\r\n");
+
+  assert(rejects([](CachePolicy& p) { p.addHeader("Bad Name", "x"); }));
+  assert(rejects([](CachePolicy& p) { p.addHeader("X-A", "a\r\nB: c"); }));
+  assert(rejects([](CachePolicy& p) { p.addHeader("X-A", " "); }));
+  assert(rejects([](CachePolicy& p) { p.addHeader("Content-Length", "1"); }));
+  assert(rejects([](CachePolicy& p) { p.addHeader("date", "x"); }));
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_immutable_paths(void) {
+  std::cout << "Testing fingerprinted paths..." << std::flush;
+
+  CachePolicy policy;
+  policy.setExpires("1h");
+  policy.setImmutablePattern("on");
+
+  HttpResponse fingerprinted;
+  policy.apply("/assets/app.3f2a9c1b.js", fingerprinted);
+  std::string raw = fingerprinted.convertToString();
+  assert(raw.find("Cache-Control: public, max-age=31536000, immutable\r\n") !=
+         std::string::npos);
+  assert(raw.find("Expires:") == std::string::npos);
+
+  HttpResponse plain;
+  policy.apply("/style.css", plain);
+  raw = plain.convertToString();
+  assert(raw.find("Cache-Control: max-age=3600\r\n") != std::string::npos);
+  assert(raw.find("Expires: ") != std::string::npos);
+  assert(raw.find("immutable") == std::string::npos);
+
+  HttpResponse dashed;
+  policy.apply("/img/logo-0123456789abcdef.png", dashed);
+  assert(dashed.convertToString().find("immutable") != std::string::npos);
+  HttpResponse short_hash;
+  policy.apply("/app.3f2a.js", short_hash);
+  assert(short_hash.convertToString().find("immutable") == std::string::npos);
+
+  policy.setImmutablePattern("^/static/");
+  HttpResponse custom;
+  policy.apply("/static/anything.css", custom);
+  assert(custom.convertToString().find("immutable") != std::string::npos);
+  policy.setImmutablePattern("off");
+  assert(policy.headerBlock(false) == "Cache-Control: max-age=3600\r\n");
+
+  assert(rejects([](CachePolicy& p) { p.setImmutablePattern("(a"); }));
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+void run_cache_policy_tests() {
+  std::cout << "=== Running CachePolicy Tests ===\n" << std::endl;
+
+  test_parse_duration();
+  test_header_blocks();
+  test_immutable_paths();
+
+  std::cout << "\nAll CachePolicy tests passed!\n" << std::endl;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file test_connection_filter.cpp
+ * @brief Unit tests for the filters of the admin connection report
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-17
+ * @version 1.0
+ */
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "Connection.hpp"
+
+static Connection::Snapshot makeSnapshot(const std::string& peer,
+                                         HttpParsingState state,
+                                         std::chrono::milliseconds idle) {
+  Connection::Snapshot snapshot;
+  ClientAddress::parse(peer, snapshot.peer);
+  snapshot.vhost = "localhost:8002";
+  snapshot.state = state;
+  snapshot.bytes_in = 0;
+  snapshot.bytes_out = 0;
+  snapshot.memory = 0;
+  snapshot.idle = idle;
+  return snapshot;
+}
+
+static void test_filters(void) {
+  std::cout << "Testing connection filters..." << std::flush;
+
+  using std::chrono::milliseconds;
+  Connection::Snapshot slow = makeSnapshot(
+      "203.0.113.5", HttpParsingState::HEADERS, milliseconds(15000));
+  Connection::Snapshot busy =
+      makeSnapshot("2001:db8::1", HttpParsingState::BODY, milliseconds(20));
+
+  ConnectionFilter all;
+  assert(all.matches(slow) && all.matches(busy));
+
+  ConnectionFilter stalled;
+  stalled.state = "headers";
+  stalled.min_idle = std::chrono::seconds(10);
+  assert(stalled.matches(slow) && !stalled.matches(busy));
+  slow.idle = milliseconds(9999);
+  assert(!stalled.matches(slow));
+
+  auto network = std::make_shared<AccessList>();
+  network->addRule(true, "2001:db8::/32");
+  network->addRule(false, "all");
+  ConnectionFilter peer;
+  peer.peer = network;
+  assert(!peer.matches(slow) && peer.matches(busy));
+  assert(!peer.matches(Connection::Snapshot{
+      ClientAddress(), "", HttpParsingState::REQUEST_LINE, 0, 0, 0,
+      milliseconds(0), ""}));  // unix socket client
+
+  ConnectionFilter vhost;
+  vhost.vhost = "example.com:8002";
+  assert(!vhost.matches(busy));
+  vhost.vhost = "localhost:8002";
+  assert(vhost.matches(busy));
+
+  assert(std::string(ConnectionFilter::getStateName(
+             HttpParsingState::CHUNKED_BODY_DATA)) == "chunked_body_data");
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+void run_connection_filter_tests() {
+  std::cout << "=== Running ConnectionFilter Tests ===\n" << std::endl;
+
+  test_filters();
+
+  std::cout << "\nAll ConnectionFilter tests passed!\n" << std::endl;
+}
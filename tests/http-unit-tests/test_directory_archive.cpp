@@ -0,0 +1,258 @@
+/**
+ * @file test_directory_archive.cpp
+ * @brief Unit tests for streamed tar and zip archives of directories
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-12
+ * @version 1.0
+ */
+
+#include <unistd.h>
+
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "DirectoryArchive.hpp"
+
+static void writeFile(const std::string& path, const std::string& content) {
+  std::ofstream file(path, std::ios::binary);
+  file << content;
+}
+
+/**
+ * @brief Sends the whole archive the way Connection does: buffer pieces as
+ *        they are, file ranges read from the fd (zeros past end of file)
+ */
+static std::string produce(DirectoryArchive& archive, size_t& ranges) {
+  std::string body;
+  std::string buffer;
+  BodySource::FileRange range;
+  ranges = 0;
+  while (archive.next(buffer, range)) {
+    body += buffer;
+    buffer.clear();
+    if (range.length > 0) {
+      std::string data(range.length, '\0');
+      ssize_t got = pread(range.fd, &data[0], range.length, range.offset);
+      assert(got >= 0);
+      body += data;
+      ranges++;
+    }
+    assert(buffer.size() <= 2 * ARCHIVE_READ_CHUNK);
+  }
+  return body;
+}
+
+static uint64_t octal(const std::string& tar, size_t offset, size_t width) {
+  return std::stoull(tar.substr(offset, width - 1), nullptr, 8);
+}
+
+static uint32_t read16(const std::string& zip, size_t offset) {
+  return static_cast<unsigned char>(zip[offset]) |
+         (static_cast<unsigned char>(zip[offset + 1]) << 8);
+}
+
+static uint32_t read32(const std::string& zip, size_t offset) {
+  return read16(zip, offset) | (read16(zip, offset + 2) << 16);
+}
+
+static std::string makeTree(void) {
+  std::string dir = std::filesystem::temp_directory_path() /
+                    ("webserv-archive-test-" + std::to_string(getpid()));
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir + "/docs/empty");
+  writeFile(dir + "/a.txt", "hello");
+  writeFile(dir + "/docs/big.bin", std::string(70000, 'x') + "end");
+  writeFile(dir + "/.hidden", "secret");
+  std::filesystem::create_directories(dir + "/.cache");
+  writeFile(dir + "/.cache/item", "cached");
+  std::filesystem::create_symlink("/etc/passwd", dir + "/link");
+  return dir;
+}
+
+static void test_crc32() {
+  std::cout << "Testing CRC-32..." << std::flush;
+
+  assert(DirectoryArchive::crc32(0, "", 0) == 0);
+  assert(DirectoryArchive::crc32(0, "123456789", 9) == 0xCBF43926U);
+  uint32_t crc = DirectoryArchive::crc32(0, "1234", 4);
+  assert(DirectoryArchive::crc32(crc, "56789", 5) == 0xCBF43926U);
+
+  std::cout << "\t\t\t✓ passed" << std::endl;
+}
+
+static void test_tar(const std::string& dir) {
+  std::cout << "Testing tar archive..." << std::flush;
+
+  DirectoryArchive archive(dir, "site", DirectoryArchive::Format::TAR);
+  // site/, site/a.txt, site/docs/, site/docs/big.bin, site/docs/empty/
+  assert(archive.entryCount() == 5);
+  size_t ranges = 0;
+  std::string tar = produce(archive, ranges);
+  assert(tar.size() == archive.size());
+  assert(tar.size() % 512 == 0);
+  assert(ranges == 2);  // file contents were never copied by the source
+
+  size_t offset = 0;
+  std::string names;
+  while (tar[offset] != '\0') {
+    std::string name = tar.substr(offset, 100).c_str();
+    assert(tar.compare(offset + 257, 6, std::string("ustar\0", 6)) == 0);
+    unsigned int sum = 0;
+    for (size_t i = 0; i < 512; i++) {
+      unsigned char byte = static_cast<unsigned char>(tar[offset + i]);
+      sum += (i >= 148 && i < 156) ? ' ' : byte;
+    }
+    assert(sum == octal(tar, offset + 148, 7));
+    uint64_t size = octal(tar, offset + 124, 12);
+    if (name == "site/a.txt") {
+      assert(tar.compare(offset + 512, 5, "hello") == 0);
+    }
+    if (name == "site/docs/big.bin") {
+      assert(size == 70003 && tar.compare(offset + 512 + 70000, 3, "end") == 0);
+    }
+    names += name + " ";
+    offset += 512 + (size + 511) / 512 * 512;
+  }
+  assert(names == "site/ site/a.txt site/docs/ site/docs/big.bin "
+                  "site/docs/empty/ ");
+  assert(tar.size() - offset == 1024);  // two zero blocks end the archive
+
+  std::cout << "\t\t✓ passed" << std::endl;
+}
+
+static void test_tar_long_names(const std::string& dir) {
+  std::cout << "Testing tar long names..." << std::flush;
+
+  std::string sub = dir + "/long";
+  std::string deep =
+      sub + "/" + std::string(60, 'd') + "/" + std::string(60, 'e');
+  std::filesystem::create_directories(deep);
+  writeFile(deep + "/file.txt", "deep");
+  writeFile(sub + "/" + std::string(150, 'n'), "long");
+
+  DirectoryArchive archive(sub, "long", DirectoryArchive::Format::TAR);
+  size_t ranges = 0;
+  std::string tar = produce(archive, ranges);
+  assert(tar.size() == archive.size());
+
+  // path split into prefix and name
+  std::string deep_name = "long/" + std::string(60, 'd') + "/" +
+                          std::string(60, 'e') + "/file.txt";
+  size_t prefix = tar.find(deep_name.substr(0, deep_name.rfind('/')));
+  assert(prefix != std::string::npos);
+  assert(tar.substr(prefix - 345, 100).c_str() == std::string("file.txt"));
+  // name without a usable slash goes into a pax record
+  std::string record = "path=long/" + std::string(150, 'n') + "\n";
+  assert(tar.find(record) != std::string::npos);
+  assert(tar.find("././@PaxHeader") != std::string::npos);
+  std::filesystem::remove_all(sub);
+
+  std::cout << "\t\t✓ passed" << std::endl;
+}
+
+static void test_zip(const std::string& dir) {
+  std::cout << "Testing zip archive..." << std::flush;
+
+  DirectoryArchive archive(dir, "site", DirectoryArchive::Format::ZIP);
+  size_t ranges = 0;
+  std::string zip = produce(archive, ranges);
+  assert(zip.size() == archive.size());
+  assert(ranges == 0);  // data passes through the CRC
+
+  size_t end = zip.size() - 22;
+  assert(read32(zip, end) == 0x06054b50);
+  assert(read16(zip, end + 10) == 5);
+  size_t central = read32(zip, end + 16);
+  assert(central + read32(zip, end + 12) == end);
+
+  std::string content = std::string(70000, 'x') + "end";
+  uint32_t expected =
+      DirectoryArchive::crc32(0, content.data(), content.size());
+  bool found = false;
+  for (size_t offset = central; offset < end;) {
+    assert(read32(zip, offset) == 0x02014b50);
+    size_t name_length = read16(zip, offset + 28);
+    std::string name = zip.substr(offset + 46, name_length);
+    size_t local = read32(zip, offset + 42);
+    assert(read32(zip, local) == 0x04034b50);
+    assert(zip.compare(local + 30, name_length, name) == 0);
+    if (name == "site/docs/big.bin") {
+      assert(read32(zip, offset + 16) == expected);
+      assert(read32(zip, offset + 24) == content.size());
+      assert(zip.compare(local + 30 + name_length, content.size(), content) ==
+             0);
+      // data descriptor repeats the CRC
+      assert(read32(zip, local + 30 + name_length + content.size()) ==
+             0x08074b50);
+      assert(read32(zip, local + 34 + name_length + content.size()) ==
+             expected);
+      found = true;
+    }
+    offset += 46 + name_length;
+  }
+  assert(found);
+
+  std::cout << "\t\t✓ passed" << std::endl;
+}
+
+static void test_file_changed(const std::string& dir) {
+  std::cout << "Testing file changed while sent..." << std::flush;
+
+  DirectoryArchive zip(dir, "site", DirectoryArchive::Format::ZIP);
+  DirectoryArchive tar(dir, "site", DirectoryArchive::Format::TAR);
+  std::filesystem::resize_file(dir + "/docs/big.bin", 10);
+  std::filesystem::remove(dir + "/a.txt");
+
+  size_t ranges = 0;
+  std::string body = produce(zip, ranges);
+  assert(body.size() == zip.size());
+  std::string padded = std::string(10, 'x') + std::string(69993, '\0');
+  assert(body.find(padded) != std::string::npos);
+  body = produce(tar, ranges);
+  assert(body.size() == tar.size());
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_formats() {
+  std::cout << "Testing archive formats..." << std::flush;
+
+  DirectoryArchive::Format format = DirectoryArchive::Format::TAR;
+  assert(DirectoryArchive::parseFormat("zip", format) &&
+         format == DirectoryArchive::Format::ZIP);
+  assert(DirectoryArchive::parseFormat("tar", format) &&
+         format == DirectoryArchive::Format::TAR);
+  assert(!DirectoryArchive::parseFormat("tgz", format));
+  assert(!DirectoryArchive::parseFormat("", format));
+  assert(DirectoryArchive::contentType(format) == "application/x-tar");
+
+  bool thrown = false;
+  try {
+    DirectoryArchive archive("/nonexistent-dir", "x",
+                             DirectoryArchive::Format::TAR);
+  } catch (const std::exception&) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  std::cout << "\t\t✓ passed" << std::endl;
+}
+
+void run_directory_archive_tests() {
+  std::cout << "=== Running DirectoryArchive Tests ===\n" << std::endl;
+
+  std::string dir = makeTree();
+  test_crc32();
+  test_tar(dir);
+  test_tar_long_names(dir);
+  test_zip(dir);
+  test_file_changed(dir);
+  test_formats();
+  std::filesystem::remove_all(dir);
+
+  std::cout << "\nAll DirectoryArchive tests passed!\n" << std::endl;
+}
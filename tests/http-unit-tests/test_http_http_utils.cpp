@@ -163,6 +163,48 @@ static void test_isMethodAllowed(ConfigParser::ServerConfig& config) {
   std::cout << "\t✓ passed" << std::endl;
 }
 
+static void test_getQueryParameter() {
+  std::cout << "Testing getQueryParameter method..." << std::flush;
+
+  assert(HttpUtils::getQueryParameter("archive=tar", "archive") == "tar");
+  assert(HttpUtils::getQueryParameter("a=1&archive=zip&b", "archive") ==
+         "zip");
+  assert(HttpUtils::getQueryParameter("myarchive=zip", "archive").empty());
+  assert(HttpUtils::getQueryParameter("archive", "archive").empty());
+  assert(HttpUtils::getQueryParameter("", "archive").empty());
+  assert(HttpUtils::getQueryParameter("b=2&a=", "a").empty());
+  assert(HttpUtils::getQueryParameter("x=1&x=2", "x") == "1");
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_acceptsEncoding() {
+  std::cout << "Testing acceptsEncoding method..." << std::flush;
+
+  assert(HttpUtils::acceptsEncoding("gzip, deflate, br", "gzip"));
+  assert(HttpUtils::acceptsEncoding("deflate,GZIP", "gzip"));
+  assert(HttpUtils::acceptsEncoding("br;q=1.0, gzip;q=0.8", "gzip"));
+  assert(!HttpUtils::acceptsEncoding("gzip;q=0", "gzip"));
+  assert(!HttpUtils::acceptsEncoding("br, gzip; q=0.000", "gzip"));
+  assert(!HttpUtils::acceptsEncoding("x-gzip, gzipped", "gzip"));
+  assert(!HttpUtils::acceptsEncoding("", "gzip"));
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_matchesEntityTag() {
+  std::cout << "Testing matchesEntityTag method..." << std::flush;
+
+  assert(HttpUtils::matchesEntityTag("\"abc\"", "\"abc\""));
+  assert(HttpUtils::matchesEntityTag("\"x\", W/\"abc\"", "\"abc\""));
+  assert(HttpUtils::matchesEntityTag("*", "\"abc\""));
+  assert(!HttpUtils::matchesEntityTag("\"abc-gzip\"", "\"abc\""));
+  assert(!HttpUtils::matchesEntityTag("abc", "\"abc\""));
+  assert(!HttpUtils::matchesEntityTag("", "\"abc\""));
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
 void run_http_method_handler_tests() {
   std::cout << "=== Running HttpMethodHandler Tests ===\n" << std::endl;
 
@@ -172,6 +214,9 @@ void run_http_method_handler_tests() {
   test_getFilePath(config);
   test_isFilePathSecure();
   test_isMethodAllowed(config);
+  test_getQueryParameter();
+  test_acceptsEncoding();
+  test_matchesEntityTag();
 
   std::cout << "\nAll HttpMethodHandler tests passed!\n" << std::endl;
 }
@@ -38,6 +38,10 @@ static void test_method_operations() {
 
   request.setMethod("PATCH");
   assert(request.getMethod() == "PATCH");
+  assert(request.getMethodCode() == HttpMethod::PATCH);
+
+  request.setMethod("PROPFIND");
+  assert(request.getMethod() == "PROPFIND");
   assert(request.getMethodCode() == HttpMethod::UNKNOWN);
 
   std::cout << "\t\t✓ passed" << std::endl;
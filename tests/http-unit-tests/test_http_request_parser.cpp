@@ -16,14 +16,14 @@
 static void ASSERT_PARSE_SUCCESS(const std::string& request_str,
                                  HttpRequest& request_obj) {
   HttpRequestParser::Status status =
-      HttpRequestParser::parseRequest(request_str, request_obj);
+      HttpRequestParser::parseRequest(std::string(request_str), request_obj);
   assert(status == HttpRequestParser::Status::DONE);
 }
 
 static void ASSERT_PARSE_ERROR(const std::string& request_str,
                                HttpRequest& request_obj) {
   HttpRequestParser::Status status =
-      HttpRequestParser::parseRequest(request_str, request_obj);
+      HttpRequestParser::parseRequest(std::string(request_str), request_obj);
   assert(status == HttpRequestParser::Status::ERROR);
 }
 
@@ -171,7 +171,7 @@ static void test_empty_request_error() {
   std::string empty_request = "";
 
   HttpRequestParser::Status status =
-      HttpRequestParser::parseRequest(empty_request, request);
+      HttpRequestParser::parseRequest(std::string(empty_request), request);
   assert(status == HttpRequestParser::Status::WAIT_FOR_DATA);
 
   std::cout << "\t\t✓ passed" << std::endl;
@@ -185,7 +185,7 @@ static void test_missing_crlf_error() {
   std::string no_crlf_request = "GET /index.html HTTP/1.1\nHost: example.com\n";
 
   HttpRequestParser::Status status =
-      HttpRequestParser::parseRequest(no_crlf_request, request);
+      HttpRequestParser::parseRequest(std::string(no_crlf_request), request);
   assert(status == HttpRequestParser::Status::WAIT_FOR_DATA);
 
   std::cout << "\t\t✓ passed" << std::endl;
@@ -225,7 +225,7 @@ static void test_unknown_method_error() {
   HttpRequest request;
 
   std::string unknown_method =
-      "PATCH /index.html HTTP/1.1\r\n"
+      "PROPFIND /index.html HTTP/1.1\r\n"
       "Host: example.com\r\n"
       "\r\n";
 
@@ -285,6 +285,52 @@ static void test_request_target_validation() {
   std::cout << "\t✓ passed" << std::endl;
 }
 
+static void test_request_target_normalization() {
+  std::cout << "Testing request target normalization..." << std::flush;
+
+  HttpRequest request;
+
+  ASSERT_PARSE_SUCCESS(
+      "GET /api/users?id=1&x=%20 HTTP/1.1\r\nHost: a\r\n\r\n", request);
+  assert(request.getPath() == "/api/users");
+  assert(request.getQuery() == "id=1&x=%20");
+  assert(request.getRequestTarget() == "/api/users?id=1&x=%20");
+  assert(request.getPathHash() == HttpUtils::hashPath("/api/users"));
+  request.reset();
+
+  ASSERT_PARSE_SUCCESS(
+      "GET //a/./b/../c%2Fd%20e/ HTTP/1.1\r\nHost: a\r\n\r\n", request);
+  assert(request.getPath() == "/a/c/d e/");
+  assert(!request.hasQuery());
+  request.reset();
+
+  ASSERT_PARSE_SUCCESS("GET /a/%2e%2E HTTP/1.1\r\nHost: a\r\n\r\n",
+                       request);
+  assert(request.getPath() == "/");
+  request.reset();
+
+  ASSERT_PARSE_SUCCESS(
+      "GET http://example.com?q HTTP/1.1\r\nHost: a\r\n\r\n", request);
+  assert(request.getPath() == "/");
+  assert(request.getQuery() == "q");
+  request.reset();
+
+  ASSERT_PARSE_ERROR("GET /a/../../etc HTTP/1.1\r\nHost: a\r\n\r\n",
+                     request);
+  assert(request.getStatusCode() == HttpUtils::HttpStatusCode::BAD_REQUEST);
+  request.reset();
+  ASSERT_PARSE_ERROR("GET /%2e%2e/etc HTTP/1.1\r\nHost: a\r\n\r\n",
+                     request);
+  request.reset();
+  ASSERT_PARSE_ERROR("GET /a%00.php HTTP/1.1\r\nHost: a\r\n\r\n",
+                     request);
+  request.reset();
+  ASSERT_PARSE_ERROR("GET /a%2 HTTP/1.1\r\nHost: a\r\n\r\n", request);
+  request.reset();
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
 static void test_edge_cases() {
   std::cout << "Testing edge cases..." << std::flush;
 
@@ -372,15 +418,15 @@ static void test_http_partual_request() {
   std::string part5 = "{\"name\":\"John\",\"age\":30}";
 
   HttpRequestParser::Status status =
-      HttpRequestParser::parseRequest(part1, request);
+      HttpRequestParser::parseRequest(std::string(part1), request);
   assert(status == HttpRequestParser::Status::WAIT_FOR_DATA);
-  status = HttpRequestParser::parseRequest(part2, request);
+  status = HttpRequestParser::parseRequest(std::string(part2), request);
   assert(status == HttpRequestParser::Status::WAIT_FOR_DATA);
-  status = HttpRequestParser::parseRequest(part3, request);
+  status = HttpRequestParser::parseRequest(std::string(part3), request);
   assert(status == HttpRequestParser::Status::WAIT_FOR_DATA);
-  status = HttpRequestParser::parseRequest(part4, request);
+  status = HttpRequestParser::parseRequest(std::string(part4), request);
   assert(status == HttpRequestParser::Status::WAIT_FOR_DATA);
-  status = HttpRequestParser::parseRequest(part5, request);
+  status = HttpRequestParser::parseRequest(std::string(part5), request);
   assert(status == HttpRequestParser::Status::DONE);
 
   assert(request.getMethod() == "GET");
@@ -409,23 +455,23 @@ static void test_http_cunked_request() {
   std::string part7 = "\r\n";
 
   HttpRequestParser::Status status =
-      HttpRequestParser::parseRequest(part1, request);
+      HttpRequestParser::parseRequest(std::string(part1), request);
   assert(status == HttpRequestParser::Status::WAIT_FOR_DATA);
-  status = HttpRequestParser::parseRequest(part2, request);
+  status = HttpRequestParser::parseRequest(std::string(part2), request);
   assert(status == HttpRequestParser::Status::WAIT_FOR_DATA);
-  status = HttpRequestParser::parseRequest(part3, request);
+  status = HttpRequestParser::parseRequest(std::string(part3), request);
   assert(status == HttpRequestParser::Status::WAIT_FOR_DATA);
   assert(request.getParsingState() == HttpParsingState::CHUNKED_BODY_SIZE);
-  status = HttpRequestParser::parseRequest(part4, request);
+  status = HttpRequestParser::parseRequest(std::string(part4), request);
   assert(status == HttpRequestParser::Status::WAIT_FOR_DATA);
   assert(request.getParsingState() == HttpParsingState::CHUNKED_BODY_DATA);
-  status = HttpRequestParser::parseRequest(part5, request);
+  status = HttpRequestParser::parseRequest(std::string(part5), request);
   assert(status == HttpRequestParser::Status::WAIT_FOR_DATA);
   assert(request.getParsingState() == HttpParsingState::CHUNKED_BODY_SIZE);
-  status = HttpRequestParser::parseRequest(part6, request);
+  status = HttpRequestParser::parseRequest(std::string(part6), request);
   assert(status == HttpRequestParser::Status::WAIT_FOR_DATA);
   assert(request.getParsingState() == HttpParsingState::CHUNKED_BODY_TRAILER);
-  status = HttpRequestParser::parseRequest(part7, request);
+  status = HttpRequestParser::parseRequest(std::string(part7), request);
   assert(status == HttpRequestParser::Status::DONE);
   assert(request.getParsingState() == HttpParsingState::COMPLETE);
 
@@ -455,6 +501,7 @@ void run_http_request_parser_tests() {
   test_unknown_method_error();
   test_invalid_http_version();
   test_request_target_validation();
+  test_request_target_normalization();
   test_http_version_support();
   test_edge_cases();
   test_http_partual_request();
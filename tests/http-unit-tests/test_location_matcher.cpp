@@ -0,0 +1,150 @@
+/**
+ * @file test_location_matcher.cpp
+ * @brief Unit tests for the regex DFA and nginx-style location lookup
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-07
+ * @version 1.0
+ */
+
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Config.hpp"
+#include "HttpUtils.hpp"
+#include "LocationMatcher.hpp"
+#include "RegexDfa.hpp"
+
+static void test_regex_syntax() {
+  std::cout << "Testing regex syntax..." << std::flush;
+
+  RegexDfa dfa;
+  dfa.addPattern("\\.(php|cgi)$", false);     // 0
+  dfa.addPattern("^/img/[a-z0-9_-]+\\.png$", false);  // 1
+  dfa.addPattern("^/v\\d{1,2}/", false);      // 2
+  dfa.addPattern("\\.JPE?G$", true);          // 3
+  dfa.compile();
+  assert(dfa.patternCount() == 4);
+
+  assert(dfa.match("/index.php") == 0);
+  assert(dfa.match("/cgi-bin/run.cgi") == 0);
+  assert(dfa.match("/index.php/") == -1);
+  assert(dfa.match("/img/logo_2.png") == 1);
+  assert(dfa.match("/img/Logo.png") == -1);
+  assert(dfa.match("/x/img/logo.png") == -1);
+  assert(dfa.match("/v1/users") == 2);
+  assert(dfa.match("/v12/users") == 2);
+  assert(dfa.match("/v123/users") == -1);
+  assert(dfa.match("/photo.jpeg") == 3);
+  assert(dfa.match("/PHOTO.JpG") == 3);
+  assert(dfa.match("/photo.png") == -1);
+
+  std::cout << "\t\t\t✓ passed" << std::endl;
+}
+
+static void test_regex_first_pattern_wins() {
+  std::cout << "Testing regex pattern order..." << std::flush;
+
+  RegexDfa dfa;
+  dfa.addPattern("^/api/", false);
+  dfa.addPattern("\\.json$", false);
+  dfa.addPattern("[^/]+", false);
+  dfa.compile();
+
+  assert(dfa.match("/api/users.json") == 0);
+  assert(dfa.match("/data/users.json") == 1);
+  assert(dfa.match("/data") == 2);
+  assert(dfa.match("/") == -1);
+
+  std::cout << "\t\t✓ passed" << std::endl;
+}
+
+static void test_regex_errors() {
+  std::cout << "Testing invalid regexes..." << std::flush;
+
+  const std::vector<std::string> invalid = {
+      "(abc", "abc)", "[abc", "*abc", "a{3,1}", "a^b", "(?=x)", "\\1", "a\\",
+  };
+  for (const std::string& pattern : invalid) {
+    RegexDfa dfa;
+    bool threw = false;
+    try {
+      dfa.addPattern(pattern, false);
+    } catch (const std::runtime_error&) {
+      threw = true;
+    }
+    assert(threw);
+  }
+
+  RegexDfa literal_brace;  // not a quantifier: literal '{'
+  literal_brace.addPattern("^/a{x}$", false);
+  literal_brace.compile();
+  assert(literal_brace.match("/a{x}") == 0);
+
+  RegexDfa too_large;  // (a|b)*a(a|b){12} needs 2^13 states
+  too_large.addPattern("(a|b)*a(a|b){12}$", false);
+  bool threw = false;
+  try {
+    too_large.compile(1000);
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  assert(threw);
+
+  std::cout << "\t\t\t✓ passed" << std::endl;
+}
+
+static void test_location_order() {
+  std::cout << "Testing location lookup order..." << std::flush;
+
+  ConfigParser::ServerConfig server;
+  auto add = [&](ConfigParser::LocationModifier modifier,
+                 const std::string& path) {
+    ConfigParser::LocationConfig location(server);
+    location.modifier = modifier;
+    location.path = path;
+    server.locations.push_back(location);
+  };
+  add(ConfigParser::LocationModifier::PREFIX, "/");                   // 0
+  add(ConfigParser::LocationModifier::EXACT, "/");                    // 1
+  add(ConfigParser::LocationModifier::PREFERRED_PREFIX, "/static/");  // 2
+  add(ConfigParser::LocationModifier::REGEX, "\\.php$");              // 3
+  add(ConfigParser::LocationModifier::REGEX_CASELESS, "\\.(gif|png)$");  // 4
+  add(ConfigParser::LocationModifier::PREFIX, "/docs/");              // 5
+  add(ConfigParser::LocationModifier::REGEX, "^/docs/.*\\.php$");     // 6
+
+  LocationMatcher matcher(server.locations);
+  assert(matcher.find("/") == 1);
+  assert(matcher.find("/about.html") == 0);
+  assert(matcher.find("/static/logo.png") == 2);
+  assert(matcher.find("/static/run.php") == 2);
+  assert(matcher.find("/img/logo.PNG") == 4);
+  assert(matcher.find("/index.php") == 3);
+  assert(matcher.find("/docs/intro.html") == 5);
+  assert(matcher.find("/docs/run.php") == 3);  // first regex in config order
+
+  server.location_matcher =
+      std::make_shared<const LocationMatcher>(server.locations);
+  const ConfigParser::LocationConfig* location =
+      HttpUtils::getLocation("/index.php", server);
+  assert(location == &server.locations[3]);
+
+  ConfigParser::ServerConfig no_root;
+  LocationMatcher empty(no_root.locations);
+  assert(empty.find("/") == -1);
+
+  std::cout << "\t\t✓ passed" << std::endl;
+}
+
+void run_location_matcher_tests() {
+  std::cout << "=== Running LocationMatcher Tests ===\n" << std::endl;
+
+  test_regex_syntax();
+  test_regex_first_pattern_wins();
+  test_regex_errors();
+  test_location_order();
+
+  std::cout << "\nAll LocationMatcher tests passed!\n" << std::endl;
+}
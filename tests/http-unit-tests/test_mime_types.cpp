@@ -0,0 +1,86 @@
+/**
+ * @file test_mime_types.cpp
+ * @brief Unit tests for MIME type tables and `types` / `include` config
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-05
+ * @version 1.0
+ */
+
+#include <cassert>
+#include <iostream>
+#include <string>
+
+#include "Config.hpp"
+#include "HttpUtils.hpp"
+#include "MimeTypes.hpp"
+
+static void test_builtin_table() {
+  std::cout << "Testing built-in MIME types..." << std::flush;
+
+  assert(MimeTypes::findBuiltin("html") == "text/html");
+  assert(MimeTypes::findBuiltin("JPG") == "image/jpeg");
+  assert(MimeTypes::findBuiltin("msm") == "application/octet-stream");
+  assert(MimeTypes::findBuiltin("unknown").empty());
+  assert(MimeTypes::findBuiltin("").empty());
+
+  assert(HttpUtils::getMIME("/var/www/index.HTML") == "text/html");
+  assert(HttpUtils::getMIME("archive.tar.zip") == "application/zip");
+  assert(HttpUtils::getMIME("README") == MimeTypes::DEFAULT_TYPE);
+  assert(HttpUtils::getMIME("dir.css/file") == MimeTypes::DEFAULT_TYPE);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_configured_table() {
+  std::cout << "Testing configured MIME table..." << std::flush;
+
+  MimeTypes::MimeTable table;
+  table.add("text/html", "html");
+  table.add("application/wasm", "wasm");
+  table.add("text/plain", "HTML");  // later mapping wins
+  for (int i = 0; i < 500; i++) {
+    table.add("application/x-test", "ext" + std::to_string(i));
+  }
+  table.compile();
+
+  assert(table.size() == 502);
+  assert(table.find("html") == "text/plain");
+  assert(table.find("Wasm") == "application/wasm");
+  assert(table.find("ext499") == "application/x-test");
+  assert(table.find("css").empty());
+  assert(HttpUtils::getMIME("a.css", &table) == MimeTypes::DEFAULT_TYPE);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_types_and_include() {
+  std::cout << "Testing types block and include..." << std::flush;
+
+  ConfigParser::Config config =
+      ConfigParser::parse("tests/test-configs/mime.conf");
+  const ConfigParser::ServerConfig& server = config.servers.at(0);
+
+  assert(server.mime_types != nullptr);
+  assert(server.mime_types->find("mjs") == "application/javascript");
+  assert(server.mime_types->find("png").empty());
+
+  const ConfigParser::LocationConfig& root = server.locations.at(0);
+  const ConfigParser::LocationConfig& raw = server.locations.at(1);
+  assert(root.mime_types == server.mime_types);
+  assert(HttpUtils::getMIME("app.wasm", root.mime_types.get()) ==
+         "application/wasm");
+  assert(HttpUtils::getMIME("page.html", raw.mime_types.get()) ==
+         "text/plain");
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+void run_mime_types_tests() {
+  std::cout << "=== Running MimeTypes Tests ===\n" << std::endl;
+
+  test_builtin_table();
+  test_configured_table();
+  test_types_and_include();
+
+  std::cout << "\nAll MimeTypes tests passed!\n" << std::endl;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file test_precompress.cpp
+ * @brief Unit tests for precompressed static file variants
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-14
+ * @version 1.0
+ */
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Precompress.hpp"
+
+static void writeFile(const std::string& path, const std::string& content) {
+  std::ofstream file(path, std::ios::binary);
+  file << content;
+}
+
+static std::string readFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+}
+
+/// @brief Stand-in for gzip: keeps every other byte
+static bool halve(std::string_view input, std::string& output) {
+  output.clear();
+  for (size_t i = 0; i < input.size(); i += 2) {
+    output += input[i];
+  }
+  return true;
+}
+
+/// @brief Stand-in for a coding that doesn't help
+static bool expand(std::string_view input, std::string& output) {
+  output = std::string(input) + "!";
+  return true;
+}
+
+static std::string makeSite(const std::string& dir) {
+  std::string site = dir + "/site";
+  std::filesystem::create_directories(site + "/css");
+  std::filesystem::create_directories(site + "/.git");
+  writeFile(site + "/index.html", std::string(1000, 'h'));
+  writeFile(site + "/css/style.css", std::string(4000, 'c'));
+  writeFile(site + "/logo.png", std::string(1000, 'p'));
+  writeFile(site + "/tiny.js", "x");
+  writeFile(site + "/.env", std::string(1000, 's'));
+  writeFile(site + "/.git/config", std::string(1000, 's'));
+  for (int i = 0; i < 20; i++) {
+    writeFile(site + "/page" + std::to_string(i) + ".txt",
+              std::string(512 + 2 * i, 't'));
+  }
+  return site;
+}
+
+static void test_variants(const std::string& site) {
+  std::cout << "Testing precompressed variants..." << std::flush;
+
+  std::vector<Precompress::Encoding> encodings = {{".half", halve},
+                                                  {".big", expand}};
+  Precompress::Stats stats = Precompress::run(site, encodings, 4);
+  assert(stats.files == 22);  // html, css, 20 pages
+  assert(stats.written == 22 && stats.not_smaller == 22);
+  assert(stats.up_to_date == 0 && stats.failed == 0);
+  assert(stats.bytes_out * 2 == stats.bytes_in);
+
+  assert(readFile(site + "/css/style.css.half") == std::string(2000, 'c'));
+  assert(std::filesystem::exists(site + "/page19.txt.half"));
+  assert(!std::filesystem::exists(site + "/index.html.big"));
+  assert(!std::filesystem::exists(site + "/logo.png.half"));
+  assert(!std::filesystem::exists(site + "/tiny.js.half"));
+  assert(!std::filesystem::exists(site + "/.env.half"));
+  assert(!std::filesystem::exists(site + "/.git/config.half"));
+
+  struct stat source, variant;
+  assert(stat((site + "/index.html").c_str(), &source) == 0);
+  assert(stat((site + "/index.html.half").c_str(), &variant) == 0);
+  assert(source.st_mtim.tv_sec == variant.st_mtim.tv_sec &&
+         source.st_mtim.tv_nsec == variant.st_mtim.tv_nsec);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_up_to_date(const std::string& site) {
+  std::cout << "Testing up to date variants..." << std::flush;
+
+  std::vector<Precompress::Encoding> encodings = {{".half", halve}};
+  Precompress::Stats stats = Precompress::run(site, encodings, 1);
+  assert(stats.files == 22 && stats.up_to_date == 22);
+  assert(stats.written == 0 && stats.failed == 0);
+
+  // a changed source gets a new variant
+  std::filesystem::last_write_time(
+      site + "/index.html",
+      std::filesystem::last_write_time(site + "/index.html") +
+          std::chrono::seconds(10));
+  writeFile(site + "/css/style.css", std::string(3000, 'd'));
+  stats = Precompress::run(site, encodings, 2);
+  assert(stats.written == 2 && stats.up_to_date == 20);
+  assert(readFile(site + "/css/style.css.half") == std::string(1500, 'd'));
+
+  // a source that stopped compressing well loses its variant
+  encodings[0].compress = expand;
+  writeFile(site + "/page0.txt", std::string(600, 'u'));
+  stats = Precompress::run(site, encodings, 2);
+  assert(stats.not_smaller == 1 && stats.up_to_date == 21);
+  assert(!std::filesystem::exists(site + "/page0.txt.half"));
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_is_variant(void) {
+  std::cout << "Testing variant names..." << std::flush;
+
+  std::vector<Precompress::Encoding> encodings = {{".gz", halve},
+                                                  {".br", halve}};
+  assert(Precompress::isVariant("/a/index.html.gz", encodings));
+  assert(Precompress::isVariant("/a/index.html.br", encodings));
+  assert(!Precompress::isVariant("/a/index.html", encodings));
+  assert(!Precompress::isVariant(".gz", encodings));
+
+  std::cout << "\t\t✓ passed" << std::endl;
+}
+
+static void test_missing_root(const std::string& dir) {
+  std::cout << "Testing missing document root..." << std::flush;
+
+  Precompress::Stats stats =
+      Precompress::run(dir + "/missing", {{".gz", halve}}, 2);
+  assert(stats.files == 0 && stats.failed == 1);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+void run_precompress_tests() {
+  std::cout << "=== Running Precompress Tests ===\n" << std::endl;
+
+  std::string dir = std::filesystem::temp_directory_path() /
+                    ("webserv-precompress-test-" + std::to_string(getpid()));
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+
+  std::string site = makeSite(dir);
+  test_variants(site);
+  test_up_to_date(site);
+  test_is_variant();
+  test_missing_root(dir);
+  std::filesystem::remove_all(dir);
+
+  std::cout << "\nAll Precompress tests passed!\n" << std::endl;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file test_profiler.cpp
+ * @brief Unit tests for the CPU and heap profiler
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-17
+ * @version 1.0
+ */
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "Profiler.hpp"
+
+static volatile unsigned long sink = 0;
+
+static void spin(void) {
+  for (int i = 0; i < 100000; i++) {
+    sink = sink + i;
+  }
+}
+
+static void test_cpu_profile(void) {
+  std::cout << "Testing CPU profile..." << std::flush;
+
+  std::string error_msg;
+  assert(!Profiler::start(0, error_msg));
+  assert(!Profiler::start(PROFILER_MAX_SECONDS + 1, error_msg));
+  assert(!Profiler::hasProfile());
+
+  assert(Profiler::start(1, error_msg));
+  assert(Profiler::isRunning() && Profiler::hasProfile());
+  assert(Profiler::getRemainingSeconds() == 1);
+  assert(!Profiler::start(1, error_msg));
+  assert(error_msg == "a profile is already running");
+  assert(Profiler::foldedStacks().empty());
+
+  auto began = std::chrono::steady_clock::now();
+  while (Profiler::isRunning()) {
+    spin();
+  }
+  auto took = std::chrono::steady_clock::now() - began;
+  assert(took >= std::chrono::milliseconds(900));
+  assert(took < std::chrono::seconds(3));
+
+  // "outer;...;inner count" lines, one second of CPU time at most
+  std::string folded = Profiler::foldedStacks();
+  std::istringstream lines(folded);
+  std::string line;
+  size_t samples = 0;
+  bool nested = false;
+  while (std::getline(lines, line)) {
+    size_t space = line.rfind(' ');
+    assert(space != std::string::npos && space > 0);
+    samples += std::stoul(line.substr(space + 1));
+    nested = nested || line.find(';') < space;
+  }
+  assert(samples > PROFILER_HZ / 2 && samples <= 2 * PROFILER_HZ);
+  assert(nested);  // frame pointers were followed
+  assert(Profiler::foldedStacks() == folded);
+  assert(Profiler::getRemainingSeconds() == 0);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void allocateFromOneSite(void) {
+  Profiler::sampleAllocation(PROFILER_HEAP_INTERVAL);
+  for (int i = 0; i < 4; i++) {
+    Profiler::sampleAllocation(PROFILER_HEAP_INTERVAL / 4);
+  }
+  Profiler::sampleAllocation(8 * PROFILER_HEAP_INTERVAL);
+}
+
+static void test_heap_sampling(void) {
+  std::cout << "Testing heap sampling..." << std::flush;
+
+  // the unit tests don't link heap_hook.cpp
+  assert(!Profiler::isHeapHookInstalled());
+  assert(Profiler::heapReport(10).find("# allocation sites: 0") == 0);
+
+  // a sample per interval crossed, large ones weigh their size
+  for (int i = 0; i < 2; i++) {
+    allocateFromOneSite();
+  }
+  std::string report = Profiler::heapReport(10);
+  assert(report.find("# allocation sites: 1,") == 0);
+  std::string total = std::to_string(2 * 10 * PROFILER_HEAP_INTERVAL);
+  assert(report.find(" " + total + "\n") != std::string::npos);
+  assert(Profiler::heapReport(0).find('\n') == report.find('\n'));
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+void run_profiler_tests() {
+  std::cout << "=== Running Profiler Tests ===\n" << std::endl;
+
+  test_cpu_profile();
+  test_heap_sampling();
+
+  std::cout << "\nAll Profiler tests passed!\n" << std::endl;
+}
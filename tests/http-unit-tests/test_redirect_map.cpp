@@ -0,0 +1,84 @@
+/**
+ * @file test_redirect_map.cpp
+ * @brief Unit tests for bulk redirect maps
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-06
+ * @version 1.0
+ */
+
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "RedirectMap.hpp"
+
+static void test_exact_and_prefix() {
+  std::cout << "Testing exact and prefix redirects..." << std::flush;
+
+  RedirectMap redirects;
+  std::string url;
+  int code = 0;
+
+  redirects.load("tests/test-configs/redirects.map", 301);
+  assert(redirects.size() == 5);
+
+  assert(redirects.resolve("/old-page.html", url, code));
+  assert(url == "/index.html" && code == 301);
+  assert(redirects.resolve("/about-us", url, code));
+  assert(url == "/about.html" && code == 308);
+  assert(!redirects.resolve("/about-us/", url, code));
+  assert(!redirects.resolve("/index.html", url, code));
+
+  assert(redirects.resolve("/legacy/2019/post.html", url, code));
+  assert(url == "/archive/2019/post.html" && code == 301);
+  assert(redirects.resolve("/legacy/docs/intro", url, code));
+  assert(url == "/docs/");
+  assert(!redirects.resolve("/legacyfoo/bar", url, code));
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_later_entry_wins() {
+  std::cout << "Testing repeated redirect entries..." << std::flush;
+
+  RedirectMap redirects;
+  std::string url;
+  int code = 0;
+
+  redirects.addExact("/a", "/b", 301);
+  redirects.addExact("/a", "/c", 307);
+  redirects.addPrefix("/", "/root/*", 302);
+  assert(redirects.size() == 2);
+  assert(redirects.resolve("/a", url, code) && url == "/c" && code == 307);
+  assert(redirects.resolve("/x/y", url, code) && url == "/root/x/y");
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_invalid_map() {
+  std::cout << "Testing invalid redirect map..." << std::flush;
+
+  RedirectMap redirects;
+  bool thrown = false;
+  try {
+    redirects.load("tests/test-configs/missing.map", 301);
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  assert(thrown);
+  assert(!RedirectMap::isRedirectCode(200));
+  assert(RedirectMap::isRedirectCode(308));
+
+  std::cout << "\t\t✓ passed" << std::endl;
+}
+
+void run_redirect_map_tests() {
+  std::cout << "=== Running RedirectMap Tests ===\n" << std::endl;
+
+  test_exact_and_prefix();
+  test_later_entry_wins();
+  test_invalid_map();
+
+  std::cout << "\nAll RedirectMap tests passed!\n" << std::endl;
+}
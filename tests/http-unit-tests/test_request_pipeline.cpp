@@ -0,0 +1,251 @@
+/**
+ * @file test_request_pipeline.cpp
+ * @brief Unit tests for per-location phase handlers
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-17
+ * @version 1.0
+ */
+
+#include <unistd.h>
+
+#include <cassert>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "AccessList.hpp"
+#include "HttpMethodHandler.hpp"
+#include "HttpRequest.hpp"
+#include "HttpResponse.hpp"
+#include "RequestPipeline.hpp"
+
+static std::string trace;
+
+static PhaseResult next(RequestContext&) {
+  trace += 'n';
+  return PhaseResult::NEXT;
+}
+
+static PhaseResult done(RequestContext& context) {
+  trace += 'd';
+  context.response.setStatusCode(HttpUtils::HttpStatusCode::OK);
+  return PhaseResult::DONE;
+}
+
+static PhaseResult filter(RequestContext&) {
+  trace += 'f';
+  return PhaseResult::NEXT;
+}
+
+static PhaseResult log(RequestContext&) {
+  trace += 'l';
+  return PhaseResult::NEXT;
+}
+
+static void test_compose(void) {
+  std::cout << "Testing composed phases..." << std::flush;
+
+  ConfigParser::ServerConfig server;
+  ConfigParser::LocationConfig plain(server);
+  auto pipeline = RequestPipeline::compose(plain);
+  assert(pipeline->count(Phase::REWRITE) == 0);
+  assert(pipeline->count(Phase::ACCESS) == 1);   // body size
+  assert(pipeline->count(Phase::CONTENT) == 2);  // file path, methods
+  assert(pipeline->count(Phase::FILTER) == 0);
+  assert(pipeline->count(Phase::LOG) == 0);
+
+  ConfigParser::LocationConfig full(server);
+  full.allowed_methods = {"GET", "POST"};
+  full.cgi_ext = {".py"};
+  full.upload_resumable = true;
+  full.admin_endpoint = true;
+  full.limit_rate = 1024;
+  pipeline = RequestPipeline::compose(full);
+  assert(pipeline->count(Phase::ACCESS) == 2);
+  assert(pipeline->count(Phase::CONTENT) == 5);
+  assert(pipeline->count(Phase::FILTER) == 1);
+
+  // nothing but the redirect can answer
+  full.redirect_url = "/elsewhere";
+  pipeline = RequestPipeline::compose(full);
+  assert(pipeline->count(Phase::REWRITE) == 1);
+  assert(pipeline->count(Phase::ACCESS) == 0);
+  assert(pipeline->count(Phase::CONTENT) == 0);
+  assert(pipeline->count(Phase::FILTER) == 0);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_run_order(void) {
+  std::cout << "Testing phase order..." << std::flush;
+
+  HttpMethodHandler handler;
+  HttpRequest request;
+  ConfigParser::ServerConfig server;
+  ConfigParser::LocationConfig location(server);
+  HttpResponse response;
+  RequestContext context{handler, request, server, location, response, ""};
+
+  // handlers are grouped by phase whatever order they are added in
+  RequestPipeline pipeline;
+  pipeline.add(Phase::LOG, &log);
+  pipeline.add(Phase::CONTENT, &next);
+  pipeline.add(Phase::FILTER, &filter);
+  pipeline.add(Phase::CONTENT, &done);
+  pipeline.add(Phase::CONTENT, &done);
+  pipeline.add(Phase::ACCESS, &next);
+  pipeline.add(Phase::FILTER, &filter);
+  trace.clear();
+  pipeline.run(context);
+  assert(trace == "nndffl");
+
+  // an access response skips content and filters
+  pipeline.add(Phase::ACCESS, &done);
+  trace.clear();
+  pipeline.run(context);
+  assert(trace == "ndl");
+
+  // no content handler answers
+  RequestPipeline declining;
+  declining.add(Phase::CONTENT, &next);
+  declining.add(Phase::FILTER, &filter);
+  trace.clear();
+  declining.run(context);
+  assert(trace == "n");
+  assert(response.getStatusCode() == HttpUtils::HttpStatusCode::NOT_FOUND);
+
+  // rewrite and access only, for requests whose body is on its way
+  trace.clear();
+  assert(declining.admits(context) && trace.empty());
+  trace.clear();
+  assert(!pipeline.admits(context) && trace == "nd");
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_process_method(void) {
+  std::cout << "Testing requests through location phases..." << std::flush;
+
+  ConfigParser::ServerConfig server;
+  server.root = "docs/fusion_web";
+  ConfigParser::LocationConfig root(server);
+  root.path = "/";
+  root.index = "index.html";
+  root.allowed_methods = {"GET"};
+  root.client_max_body_size = 16;
+  root.limit_rate = 4096;
+  ConfigParser::LocationConfig moved(server);
+  moved.path = "/old";
+  moved.redirect_url = "/";
+  moved.redirect_code = 308;
+  server.locations = {root, moved};
+  server.locations[0].pipeline = RequestPipeline::compose(server.locations[0]);
+  // the second location has no pipeline: it is composed per request
+
+  HttpMethodHandler handler;
+  HttpRequest get;
+  get.setMethod("GET");
+  get.setNormalizedTarget("/", std::string::npos, 0);
+  HttpResponse response = handler.processMethod(get, server);
+  assert(response.getStatusCode() == HttpUtils::HttpStatusCode::OK);
+  assert(response.getLimitRate() == 4096);
+
+  HttpRequest remove;
+  remove.setMethod("DELETE");
+  remove.setNormalizedTarget("/index.html", std::string::npos, 0);
+  response = handler.processMethod(remove, server);
+  assert(response.getStatusCode() ==
+         HttpUtils::HttpStatusCode::METHOD_NOT_ALLOWED);
+  assert(response.getLimitRate() == 0);
+
+  HttpRequest large;
+  large.setMethod("GET");
+  large.setNormalizedTarget("/", std::string::npos, 0);
+  large.setBodyLength(64);
+  response = handler.processMethod(large, server);
+  assert(response.getStatusCode() ==
+         HttpUtils::HttpStatusCode::PAYLOAD_TOO_LARGE);
+
+  HttpRequest old;
+  old.setMethod("POST");
+  old.setNormalizedTarget("/old/page", std::string::npos, 0);
+  old.setBodyLength(64);
+  response = handler.processMethod(old, server);
+  assert(static_cast<int>(response.getStatusCode()) == 308);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_splice_decision(const std::string& root) {
+  std::cout << "Testing splice decision from location phases..."
+            << std::flush;
+
+  ConfigParser::ServerConfig server;
+  server.root = root;
+  ConfigParser::LocationConfig uploads(server);
+  uploads.path = "/uploads";
+  uploads.upload_splice = true;
+  uploads.allowed_methods = {"POST"};
+  uploads.client_max_body_size = 1024;
+  server.locations = {uploads};
+
+  HttpMethodHandler handler;
+  HttpRequest post;
+  post.setMethod("POST");
+  post.setNormalizedTarget("/uploads/", std::string::npos, 0);
+  std::string type = "text/plain";
+  post.insertHeader("Content-Type", type);
+  post.setBodyLength(512);
+  std::string directory;
+  assert(handler.findSpliceDirectory(post, server, directory));
+  assert(std::filesystem::equivalent(directory, root + "/uploads"));
+
+  // every refusal of the access phase, before the body arrives
+  ConfigParser::LocationConfig& location = server.locations[0];
+  location.allowed_methods = {"GET"};
+  assert(!handler.findSpliceDirectory(post, server, directory));
+  location.allowed_methods = {"POST"};
+  post.setBodyLength(1024);
+  assert(!handler.findSpliceDirectory(post, server, directory));
+  post.setBodyLength(512);
+  auto nobody = std::make_shared<AccessList>();
+  nobody->addRule(false, "all");
+  location.access = nobody;
+  assert(!handler.findSpliceDirectory(post, server, directory));
+  location.access = nullptr;
+  location.redirect_url = "/elsewhere";
+  location.redirect_code = 307;
+  assert(!handler.findSpliceDirectory(post, server, directory));
+  location.redirect_url.clear();
+
+  // the pipeline stored by the config parser decides the same
+  location.pipeline = RequestPipeline::compose(location);
+  assert(handler.findSpliceDirectory(post, server, directory));
+  location.allowed_methods = {"GET"};
+  assert(!handler.findSpliceDirectory(post, server, directory));
+  location.allowed_methods = {"POST"};
+
+  // no directory to store the file in
+  post.setNormalizedTarget("/uploads/missing/", std::string::npos, 0);
+  assert(!handler.findSpliceDirectory(post, server, directory));
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+void run_request_pipeline_tests() {
+  std::cout << "=== Running RequestPipeline Tests ===\n" << std::endl;
+
+  test_compose();
+  test_run_order();
+  test_process_method();
+
+  std::string root = std::filesystem::temp_directory_path() /
+                     ("webserv-pipeline-test-" + std::to_string(getpid()));
+  std::filesystem::remove_all(root);
+  std::filesystem::create_directories(root + "/uploads");
+  test_splice_decision(root);
+  std::filesystem::remove_all(root);
+
+  std::cout << "\nAll RequestPipeline tests passed!\n" << std::endl;
+}
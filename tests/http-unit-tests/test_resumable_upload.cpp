@@ -0,0 +1,278 @@
+/**
+ * @file test_resumable_upload.cpp
+ * @brief Unit tests for resumable uploads
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-11
+ * @version 1.0
+ */
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "ResumableUpload.hpp"
+#include "UploadStore.hpp"
+
+using HttpUtils::HttpStatusCode;
+
+static constexpr ConfigParser::UploadDurability kNoSync =
+    ConfigParser::UploadDurability::NONE;
+
+static std::string readFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::string((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+}
+
+static size_t countFiles(const std::string& dir) {
+  size_t files = 0;
+  for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+    (void)entry;
+    files++;
+  }
+  return files;
+}
+
+static void test_upload_in_pieces(const std::string& dir) {
+  std::cout << "Testing upload in pieces..." << std::flush;
+
+  std::string content;
+  for (int i = 0; i < 100000; i++) {
+    content += static_cast<char>(i * 7);
+  }
+  std::string id;
+  std::string error_msg;
+  assert(ResumableUpload::create(dir, content.size(), "data.zip", kNoSync, id,
+                                 error_msg) == HttpStatusCode::CREATED);
+  assert(ResumableUpload::isValidId(id));
+
+  ResumableUpload::State state;
+  assert(ResumableUpload::getState(dir, id, state, error_msg) ==
+         HttpStatusCode::OK);
+  assert(state.offset == 0 && state.length == content.size());
+  assert(state.file_name == "data.zip");
+
+  assert(ResumableUpload::append(dir, id, 0, content.substr(0, 40000),
+                                 kNoSync, state, error_msg) ==
+         HttpStatusCode::NO_CONTENT);
+  assert(state.offset == 40000 && !state.complete);
+
+  // a retry of the same piece (response was lost) is rejected
+  assert(ResumableUpload::append(dir, id, 0, content.substr(0, 40000),
+                                 kNoSync, state, error_msg) ==
+         HttpStatusCode::CONFLICT);
+  assert(state.offset == 40000);
+
+  // offset survives without any in-memory state
+  ResumableUpload::State resumed;
+  assert(ResumableUpload::getState(dir, id, resumed, error_msg) ==
+         HttpStatusCode::OK);
+  assert(resumed.offset == 40000);
+
+  assert(ResumableUpload::append(dir, id, 40000, content.substr(40000) + "x",
+                                 kNoSync, state, error_msg) ==
+         HttpStatusCode::PAYLOAD_TOO_LARGE);
+  assert(ResumableUpload::append(dir, id, 40000, content.substr(40000),
+                                 ConfigParser::UploadDurability::FSYNC, state,
+                                 error_msg) == HttpStatusCode::NO_CONTENT);
+  assert(state.complete && state.offset == content.size());
+  assert(state.file_name == "data.zip");
+  assert(readFile(UploadStore::joinPath(dir, "data.zip")) == content);
+  assert(countFiles(dir) == 1);  // no sidecar left
+
+  assert(ResumableUpload::getState(dir, id, state, error_msg) ==
+         HttpStatusCode::NOT_FOUND);
+
+  std::cout << "\t\t✓ passed" << std::endl;
+}
+
+static void test_existing_file_kept(const std::string& dir) {
+  std::cout << "Testing completion keeps existing file..." << std::flush;
+
+  std::string id;
+  std::string error_msg;
+  ResumableUpload::State state;
+  assert(ResumableUpload::create(dir, 3, "data.zip", kNoSync, id,
+                                 error_msg) == HttpStatusCode::CREATED);
+  assert(ResumableUpload::append(dir, id, 0, "new", kNoSync, state,
+                                 error_msg) == HttpStatusCode::NO_CONTENT);
+  assert(state.complete && state.file_name == id + "-data.zip");
+  assert(readFile(UploadStore::joinPath(dir, state.file_name)) == "new");
+  assert(readFile(UploadStore::joinPath(dir, "data.zip")).size() == 100000);
+
+  // empty upload is complete right away
+  assert(ResumableUpload::create(dir, 0, "empty.txt", kNoSync, id,
+                                 error_msg) == HttpStatusCode::CREATED);
+  assert(std::filesystem::exists(UploadStore::joinPath(dir, "empty.txt")));
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_rejected_pieces(const std::string& dir) {
+  std::cout << "Testing rejected pieces keep the offset..." << std::flush;
+
+  std::string id;
+  std::string error_msg;
+  ResumableUpload::State state;
+  assert(ResumableUpload::create(dir, 10, "pieces.txt", kNoSync, id,
+                                 error_msg) == HttpStatusCode::CREATED);
+  assert(ResumableUpload::append(dir, id, 0, "abcd", kNoSync, state,
+                                 error_msg) == HttpStatusCode::NO_CONTENT);
+
+  // ahead of the server (a piece was lost) and behind it (a retry)
+  for (uint64_t offset : {6, 2}) {
+    assert(ResumableUpload::append(dir, id, offset, "xy", kNoSync, state,
+                                   error_msg) == HttpStatusCode::CONFLICT);
+    assert(error_msg == "Upload-Offset " + std::to_string(offset) +
+                            " doesn't match offset 4");
+  }
+  // one byte past Upload-Length, nothing of it is written
+  assert(ResumableUpload::append(dir, id, 4, "efghijk", kNoSync, state,
+                                 error_msg) ==
+         HttpStatusCode::PAYLOAD_TOO_LARGE);
+  assert(ResumableUpload::getState(dir, id, state, error_msg) ==
+         HttpStatusCode::OK);
+  assert(state.offset == 4 && !state.complete);
+
+  assert(ResumableUpload::append(dir, id, 4, "efghij", kNoSync, state,
+                                 error_msg) == HttpStatusCode::NO_CONTENT);
+  assert(state.complete && state.file_name == "pieces.txt");
+  assert(readFile(UploadStore::joinPath(dir, "pieces.txt")) == "abcdefghij");
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_both_names_taken(const std::string& dir) {
+  std::cout << "Testing completion with both names taken..." << std::flush;
+
+  std::string id;
+  std::string error_msg;
+  ResumableUpload::State state;
+  assert(ResumableUpload::create(dir, 3, "taken.txt", kNoSync, id,
+                                 error_msg) == HttpStatusCode::CREATED);
+  assert(UploadStore::writeNewFile(UploadStore::joinPath(dir, "taken.txt"),
+                                   "one", error_msg));
+  assert(UploadStore::writeNewFile(
+      UploadStore::joinPath(dir, id + "-taken.txt"), "two", error_msg));
+
+  // nothing is replaced, the complete upload stays where it is
+  assert(ResumableUpload::append(dir, id, 0, "new", kNoSync, state,
+                                 error_msg) ==
+         HttpStatusCode::INTERNAL_SERVER_ERROR);
+  assert(!state.complete);
+  assert(readFile(UploadStore::joinPath(dir, "taken.txt")) == "one");
+  assert(readFile(UploadStore::joinPath(dir, id + "-taken.txt")) == "two");
+  assert(ResumableUpload::getState(dir, id, state, error_msg) ==
+         HttpStatusCode::OK);
+  assert(state.offset == 3);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_invalid_ids(const std::string& dir) {
+  std::cout << "Testing invalid upload ids..." << std::flush;
+
+  std::string error_msg;
+  ResumableUpload::State state;
+  assert(!ResumableUpload::isValidId("../../etc/passwd"));
+  assert(!ResumableUpload::isValidId("0123456789ABCDEF0123456789abcdef"));
+  assert(ResumableUpload::isValidId("0123456789abcdef0123456789abcdef"));
+  assert(ResumableUpload::getState(dir, "../x", state, error_msg) ==
+         HttpStatusCode::NOT_FOUND);
+  assert(ResumableUpload::append(dir, "0123456789abcdef0123456789abcdef", 0,
+                                 "x", kNoSync, state, error_msg) ==
+         HttpStatusCode::NOT_FOUND);
+
+  std::cout << "\t\t✓ passed" << std::endl;
+}
+
+static void test_metadata_file_name() {
+  std::cout << "Testing Upload-Metadata file name..." << std::flush;
+
+  // "report 2025.pdf", "../x", "a\nb"
+  assert(ResumableUpload::getMetadataFileName(
+             "filename cmVwb3J0IDIwMjUucGRm") == "report-2025.pdf");
+  assert(ResumableUpload::getMetadataFileName(
+             "relativePath bnVsbA==, filename cmVwb3J0IDIwMjUucGRm,"
+             "filetype YXBwbGljYXRpb24vcGRm") == "report-2025.pdf");
+  assert(ResumableUpload::getMetadataFileName("filename Li4veA==").empty());
+  assert(ResumableUpload::getMetadataFileName("filename YQpi").empty());
+  assert(ResumableUpload::getMetadataFileName("filename !!").empty());
+  assert(ResumableUpload::getMetadataFileName("name cmVwb3J0").empty());
+  assert(ResumableUpload::getMetadataFileName("").empty());
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_sweep(const std::string& dir) {
+  std::cout << "Testing expired upload sweep..." << std::flush;
+
+  std::string id;
+  std::string error_msg;
+  assert(ResumableUpload::create(dir, 10, "old.txt", kNoSync, id,
+                                 error_msg) == HttpStatusCode::CREATED);
+  size_t files = countFiles(dir);
+
+  assert(ResumableUpload::sweep(dir, std::chrono::seconds(3600)) == 0);
+  assert(countFiles(dir) == files);
+  assert(ResumableUpload::sweep(dir, std::chrono::seconds(0)) == 1);
+  assert(countFiles(dir) == files - 2);  // data file and sidecar
+  assert(ResumableUpload::sweep(dir + "/missing", std::chrono::seconds(0)) ==
+         0);
+
+  // age is the last write: an upload idle for two hours expires after one
+  assert(ResumableUpload::create(dir, 10, "idle.txt", kNoSync, id,
+                                 error_msg) == HttpStatusCode::CREATED);
+  std::string fresh;
+  assert(ResumableUpload::create(dir, 10, "fresh.txt", kNoSync, fresh,
+                                 error_msg) == HttpStatusCode::CREATED);
+  struct timespec two_hours_ago[2] = {{time(nullptr) - 7200, 0},
+                                      {time(nullptr) - 7200, 0}};
+  std::string data = UploadStore::joinPath(dir, ".resumable-" + id + ".part");
+  assert(utimensat(AT_FDCWD, data.c_str(), two_hours_ago, 0) == 0);
+  // leftover of an interrupted create: a data file without sidecar
+  std::string orphan = UploadStore::joinPath(
+      dir, ".resumable-" + std::string(32, 'a') + ".part");
+  assert(UploadStore::writeNewFile(orphan, "", error_msg));
+  assert(utimensat(AT_FDCWD, orphan.c_str(), two_hours_ago, 0) == 0);
+
+  files = countFiles(dir);
+  assert(ResumableUpload::sweep(dir, std::chrono::seconds(3600)) == 1);
+  assert(countFiles(dir) == files - 3);
+  assert(!std::filesystem::exists(orphan));
+  ResumableUpload::State state;
+  assert(ResumableUpload::getState(dir, id, state, error_msg) ==
+         HttpStatusCode::NOT_FOUND);
+  assert(ResumableUpload::getState(dir, fresh, state, error_msg) ==
+         HttpStatusCode::OK);
+
+  std::cout << "\t\t✓ passed" << std::endl;
+}
+
+void run_resumable_upload_tests() {
+  std::cout << "=== Running ResumableUpload Tests ===\n" << std::endl;
+
+  std::string dir = std::filesystem::temp_directory_path() /
+                    ("webserv-resumable-test-" + std::to_string(getpid()));
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  std::filesystem::create_directories(dir + "-sweep");
+
+  test_upload_in_pieces(dir);
+  test_existing_file_kept(dir);
+  test_rejected_pieces(dir);
+  test_both_names_taken(dir);
+  test_invalid_ids(dir);
+  test_metadata_file_name();
+  test_sweep(dir + "-sweep");
+  std::filesystem::remove_all(dir + "-sweep");
+  std::filesystem::remove_all(dir);
+
+  std::cout << "\nAll ResumableUpload tests passed!\n" << std::endl;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file test_shared_zone.cpp
+ * @brief Unit tests for shared memory zones
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-17
+ * @version 1.0
+ */
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "SharedZone.hpp"
+#include "VhostQuota.hpp"
+
+static void test_slab_allocator(void) {
+  std::cout << "Testing zone slab allocator..." << std::flush;
+
+  SharedZone zone("test", 64 * SHARED_ZONE_PAGE_SIZE);
+  assert(zone.getPageCount() == 64);
+  size_t metadata_pages = zone.getUsedPages();
+  assert(metadata_pages == 1);
+
+  // chunks of one class share a page
+  std::vector<char*> chunks;
+  for (int i = 0; i < 256; i++) {
+    char* chunk = static_cast<char*>(zone.allocate(10));
+    assert(chunk != nullptr);
+    assert(reinterpret_cast<uintptr_t>(chunk) % 16 == 0);
+    std::memset(chunk, 'x', 10);
+    chunks.push_back(chunk);
+  }
+  assert(zone.getUsedPages() == metadata_pages + 1);
+  assert(zone.allocate(SHARED_ZONE_PAGE_SIZE / 2) != nullptr);
+  assert(zone.getUsedPages() == metadata_pages + 2);
+
+  // freed chunks are reused, zeroed
+  zone.deallocate(chunks[7]);
+  char* again = static_cast<char*>(zone.allocate(16));
+  assert(again == chunks[7] && again[0] == '\0');
+
+  // large blocks take page runs that come back on free
+  void* large = zone.allocate(3 * SHARED_ZONE_PAGE_SIZE);
+  assert(large != nullptr);
+  assert(zone.getUsedPages() == metadata_pages + 5);
+  zone.deallocate(large);
+  assert(zone.getUsedPages() == metadata_pages + 2);
+  assert(zone.allocate(64 * SHARED_ZONE_PAGE_SIZE) == nullptr);
+  assert(zone.allocate(62 * SHARED_ZONE_PAGE_SIZE) == nullptr);
+  void* rest = zone.allocate(61 * SHARED_ZONE_PAGE_SIZE);
+  assert(rest != nullptr);
+  assert(zone.getUsedPages() == zone.getPageCount());
+  assert(zone.allocate(3000) == nullptr);  // no page for a new slab
+
+  bool thrown = false;
+  try {
+    SharedZone tiny("tiny", 1);
+  } catch (const std::invalid_argument&) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_named_objects(void) {
+  std::cout << "Testing zone named objects..." << std::flush;
+
+  SharedZone zone("objects", 16 * SHARED_ZONE_PAGE_SIZE);
+  uint64_t* first = static_cast<uint64_t*>(zone.lookup("a", sizeof(uint64_t)));
+  assert(first != nullptr && *first == 0);
+  *first = 42;
+  assert(zone.lookup("a", sizeof(uint64_t)) == first);
+  assert(zone.lookup("b", sizeof(uint64_t)) != first);
+
+  // more keys than buckets
+  std::vector<void*> objects;
+  for (int i = 0; i < 1000; i++) {
+    objects.push_back(zone.lookup("key" + std::to_string(i), 8));
+    assert(objects.back() != nullptr);
+  }
+  for (int i = 0; i < 1000; i++) {
+    assert(zone.lookup("key" + std::to_string(i), 8) == objects[i]);
+  }
+  assert(*static_cast<uint64_t*>(zone.lookup("a", 8)) == 42);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_shared_between_processes(void) {
+  std::cout << "Testing zone shared with a child..." << std::flush;
+
+  const int increments = 100000;
+  SharedZone zone("fork", 8 * SHARED_ZONE_PAGE_SIZE);
+  VhostUsage* usage = new (zone.lookup("vhost/0", sizeof(VhostUsage)))
+      VhostUsage();
+  ConfigParser::ServerConfig server;
+  server.usage = usage;
+
+  pid_t pid = fork();
+  assert(pid != -1);
+  if (pid == 0) {
+    // the child reaches the same counters by name
+    server.usage =
+        static_cast<VhostUsage*>(zone.lookup("vhost/0", sizeof(VhostUsage)));
+    for (int i = 0; i < increments; i++) {
+      VhostQuota::countRequest(server);
+    }
+    _exit(server.usage == usage ? 0 : 1);
+  }
+  for (int i = 0; i < increments; i++) {
+    VhostQuota::countRequest(server);
+  }
+  int status = 0;
+  assert(waitpid(pid, &status, 0) == pid);
+  assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  assert(usage->requests == 2 * increments);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+void run_shared_zone_tests() {
+  std::cout << "=== Running SharedZone Tests ===\n" << std::endl;
+
+  test_slab_allocator();
+  test_named_objects();
+  test_shared_between_processes();
+
+  std::cout << "\nAll SharedZone tests passed!\n" << std::endl;
+}
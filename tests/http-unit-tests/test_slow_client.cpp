@@ -0,0 +1,210 @@
+/**
+ * @file test_slow_client.cpp
+ * @brief Unit tests for clients that stop reading their response
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-17
+ * @version 1.0
+ *
+ * The event loop runs in a child process with a generated config; the
+ * tests talk to it over TCP like any client.
+ */
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "AssetBundle.hpp"
+#include "Webserver.hpp"
+
+#define SLOW_CLIENT_PORT 18181
+#define SLOW_CLIENT_FILE_SIZE (16 << 20)
+#define SLOW_CLIENT_WAIT_MS 3000
+
+/// @brief Connects to the test server, retrying while it starts up
+static int connectClient(int receive_buffer) {
+  for (int attempt = 0; attempt < 100; attempt++) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    assert(fd >= 0);
+    if (receive_buffer > 0) {
+      setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receive_buffer,
+                 sizeof(receive_buffer));
+    }
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(SLOW_CLIENT_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr),
+                sizeof(addr)) == 0) {
+      return fd;
+    }
+    close(fd);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  return -1;
+}
+
+/// @brief Reads until the server closes or nothing came for a while
+static std::string receiveAll(int fd) {
+  std::string data;
+  char chunk[65536];
+  struct pollfd pfd = {fd, POLLIN, 0};
+  while (poll(&pfd, 1, SLOW_CLIENT_WAIT_MS) == 1) {
+    ssize_t bytes = recv(fd, chunk, sizeof(chunk), 0);
+    if (bytes <= 0) {
+      break;
+    }
+    data.append(chunk, static_cast<size_t>(bytes));
+  }
+  close(fd);
+  return data;
+}
+
+/**
+ * @brief Sends a `Connection: close` request and reads the response
+ * @param receive_buffer SO_RCVBUF of the client, 0 for the default
+ * @param stalled [out] If set, the client is left unread: its descriptor
+ *        is stored here and nothing is returned
+ * @return What was received
+ */
+static std::string request(const std::string& target, int receive_buffer,
+                           int* stalled = nullptr) {
+  int fd = connectClient(receive_buffer);
+  assert(fd >= 0);
+  std::string data = "GET " + target +
+                     " HTTP/1.1\r\nHost: localhost\r\n"
+                     "Connection: close\r\n\r\n";
+  assert(send(fd, data.data(), data.size(), 0) ==
+         static_cast<ssize_t>(data.size()));
+  if (stalled != nullptr) {
+    *stalled = fd;
+    return "";
+  }
+  return receiveAll(fd);
+}
+
+static bool noGzip(std::string_view input, std::string& output) {
+  (void)input;
+  (void)output;
+  return false;
+}
+
+static pid_t startServer(const std::string& dir) {
+  std::filesystem::create_directories(dir + "/tree");
+  std::ofstream(dir + "/index.html") << "<h1>served</h1>";
+  std::ofstream(dir + "/tree/big.bin").close();
+  std::filesystem::resize_file(dir + "/tree/big.bin", SLOW_CLIENT_FILE_SIZE);
+  std::filesystem::create_directories(dir + "/site/assets");
+  std::ofstream(dir + "/site/assets/big.txt")
+      << std::string(SLOW_CLIENT_FILE_SIZE, '.') << "bundled";
+  size_t assets = 0;
+  std::string error_msg;
+  assert(AssetBundle::build(dir + "/site", dir + "/site.bundle", noGzip,
+                            assets, error_msg));
+  std::ofstream(dir + "/slow.conf")
+      << "server {\n    listen " << SLOW_CLIENT_PORT
+      << ";\n    host 127.0.0.1;\n    root " << dir
+      << "/;\n    index index.html;\n\n    location / {\n"
+      << "        allow_methods GET;\n        bundle " << dir
+      << "/site.bundle;\n    }\n\n    location /tree {\n"
+      << "        allow_methods GET;\n        autoindex on;\n    }\n}\n";
+
+  pid_t pid = fork();
+  assert(pid >= 0);
+  if (pid == 0) {
+    int null_fd = open("/dev/null", O_WRONLY);
+    dup2(null_fd, STDOUT_FILENO);
+    dup2(null_fd, STDERR_FILENO);
+    try {
+      Webserv webserv(dir + "/slow.conf");
+      webserv.run();
+    } catch (...) {
+      _exit(1);
+    }
+    _exit(0);
+  }
+  return pid;
+}
+
+/**
+ * @brief Leaves a download unread, then checks that another client is
+ *        served and that the download completes once it is read
+ * @param target Download, its file ranges go out with sendfile()
+ * @param name Expected in the body
+ */
+static void checkStalledDownload(const std::string& target,
+                                 const std::string& name) {
+  int stalled = -1;
+  request(target, 4096, &stalled);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  std::string response = request("/index.html", 0);
+  assert(response.compare(0, 15, "HTTP/1.1 200 OK") == 0);
+  assert(response.find("<h1>served</h1>") != std::string::npos);
+
+  response = receiveAll(stalled);
+  assert(response.compare(0, 15, "HTTP/1.1 200 OK") == 0);
+  size_t head = response.find("\r\n\r\n");
+  assert(head != std::string::npos);
+  assert(response.size() - head - 4 >= SLOW_CLIENT_FILE_SIZE);
+  assert(response.find(name, head) != std::string::npos);
+}
+
+static void test_archive_not_read(void) {
+  std::cout << "Testing archive to a client that doesn't read..."
+            << std::flush;
+
+  checkStalledDownload("/tree/?archive=tar", "big.bin");
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_bundle_asset_not_read(void) {
+  std::cout << "Testing bundle asset to a client that doesn't read..."
+            << std::flush;
+
+  // above BUNDLE_INLINE_MAX, sent from the bundle file
+  checkStalledDownload("/assets/big.txt", "bundled");
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+void run_slow_client_tests() {
+  std::cout << "=== Running Slow Client Tests ===\n" << std::endl;
+
+  std::string dir = std::filesystem::temp_directory_path() /
+                    ("webserv-slow-client-test-" + std::to_string(getpid()));
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  pid_t server = startServer(dir);
+
+  // a failed assert must not leave the server running
+  pid_t tests = fork();
+  assert(tests >= 0);
+  if (tests == 0) {
+    test_archive_not_read();
+    test_bundle_asset_not_read();
+    _exit(0);
+  }
+  int status = 0;
+  waitpid(tests, &status, 0);
+  kill(server, SIGKILL);
+  waitpid(server, nullptr, 0);
+  std::filesystem::remove_all(dir);
+  assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  std::cout << "\nAll Slow Client tests passed!\n" << std::endl;
+}
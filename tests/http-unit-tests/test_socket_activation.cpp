@@ -0,0 +1,131 @@
+/**
+ * @file test_socket_activation.cpp
+ * @brief Unit tests for inherited listening sockets
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-16
+ * @version 1.0
+ */
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "SocketActivation.hpp"
+
+static void test_environment_fds(void) {
+  std::cout << "Testing LISTEN_FDS and LISTEN_PID..." << std::flush;
+
+  std::string pid = std::to_string(getpid());
+  setenv("LISTEN_PID", pid.c_str(), 1);
+  setenv("LISTEN_FDS", "2", 1);
+  setenv("LISTEN_FDNAMES", "http:admin", 1);
+  std::vector<int> fds = SocketActivation::takeEnvironmentFds();
+  assert(fds.size() == 2);
+  assert(fds[0] == LISTEN_FDS_START && fds[1] == LISTEN_FDS_START + 1);
+  assert(std::getenv("LISTEN_PID") == nullptr);
+  assert(std::getenv("LISTEN_FDS") == nullptr);
+  assert(std::getenv("LISTEN_FDNAMES") == nullptr);
+
+  // meant for another process (e.g. inherited from the parent)
+  setenv("LISTEN_PID", "1", 1);
+  setenv("LISTEN_FDS", "2", 1);
+  assert(SocketActivation::takeEnvironmentFds().empty());
+  assert(std::getenv("LISTEN_FDS") == nullptr);
+
+  setenv("LISTEN_PID", pid.c_str(), 1);
+  setenv("LISTEN_FDS", "two", 1);
+  assert(SocketActivation::takeEnvironmentFds().empty());
+  assert(SocketActivation::takeEnvironmentFds().empty());
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_describe_tcp(void) {
+  std::cout << "Testing inherited TCP sockets..." << std::flush;
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  assert(bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) ==
+         0);
+  socklen_t length = sizeof(address);
+  getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+
+  SocketActivation::Listener listener;
+  std::string error_msg;
+  assert(!SocketActivation::describe(fd, listener, error_msg));  // bound only
+  assert(error_msg == "not a listening stream socket");
+
+  assert(listen(fd, 8) == 0);
+  assert(SocketActivation::describe(fd, listener, error_msg));
+  assert(listener.fd == fd && listener.port == ntohs(address.sin_port));
+  assert(listener.unix_path.empty());
+  close(fd);
+
+  int udp = socket(AF_INET, SOCK_DGRAM, 0);
+  assert(!SocketActivation::describe(udp, listener, error_msg));
+  close(udp);
+  int pipe_fds[2];
+  assert(pipe(pipe_fds) == 0);
+  assert(!SocketActivation::describe(pipe_fds[0], listener, error_msg));
+  assert(error_msg.rfind("not a socket", 0) == 0);
+  close(pipe_fds[0]);
+  close(pipe_fds[1]);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_describe_unix(void) {
+  std::cout << "Testing inherited unix sockets..." << std::flush;
+
+  std::string path = "/tmp/webserv-activation-" + std::to_string(getpid()) +
+                     ".sock";
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  struct sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+  unlink(path.c_str());
+  assert(bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) ==
+         0);
+  assert(listen(fd, 8) == 0);
+
+  SocketActivation::Listener listener;
+  std::string error_msg;
+  assert(SocketActivation::describe(fd, listener, error_msg));
+  assert(listener.port == -1 && listener.unix_path == path);
+  close(fd);
+  unlink(path.c_str());
+
+  // abstract sockets have no path a `listen` directive could name
+  fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  address = sockaddr_un{};
+  address.sun_family = AF_UNIX;
+  std::memcpy(address.sun_path + 1, "webserv", 7);
+  assert(bind(fd, reinterpret_cast<sockaddr*>(&address),
+              offsetof(sockaddr_un, sun_path) + 8) == 0);
+  assert(listen(fd, 8) == 0);
+  assert(!SocketActivation::describe(fd, listener, error_msg));
+  close(fd);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+void run_socket_activation_tests() {
+  std::cout << "=== Running SocketActivation Tests ===\n" << std::endl;
+
+  test_environment_fds();
+  test_describe_tcp();
+  test_describe_unix();
+
+  std::cout << "\nAll SocketActivation tests passed!\n" << std::endl;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file test_spliced_body.cpp
+ * @brief Unit tests for upload bodies spliced from a socket to a file
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-17
+ * @version 1.0
+ */
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "SplicedBody.hpp"
+#include "UploadStore.hpp"
+
+static size_t countFiles(const std::string& dir) {
+  size_t count = 0;
+  for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+    (void)entry;
+    count++;
+  }
+  return count;
+}
+
+static void test_splice_from_socket(const std::string& dir) {
+  std::cout << "Testing body splice from socket..." << std::flush;
+
+  int fds[2];
+  assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+  fcntl(fds[0], F_SETFL, O_NONBLOCK);
+
+  // large enough to be written behind, the head brought the first bytes
+  std::string body(UPLOAD_WRITE_BEHIND_MIN + 12345, '\0');
+  for (size_t i = 0; i < body.size(); i++) {
+    body[i] = static_cast<char>(i * 131 + i / 4096);
+  }
+  std::string error_msg;
+  SplicedBody spliced;
+  assert(spliced.open(dir, body.size(), error_msg));
+  assert(spliced.write(body.substr(0, 1000), error_msg));
+  assert(countFiles(dir) == 1 && spliced.getReceived() == 1000);
+
+  assert(spliced.receive(fds[0], error_msg) == -1);
+  assert(errno == EAGAIN && error_msg.empty());
+
+  size_t sent = 1000;
+  while (!spliced.isComplete()) {
+    if (sent < body.size()) {
+      std::string piece = body.substr(sent, 65536);
+      if (sent + piece.size() == body.size()) {
+        piece += "GET / HTTP/1.1\r\n";  // pipelined request
+      }
+      ssize_t bytes = ::write(fds[1], piece.data(), piece.size());
+      assert(bytes > 0);
+      sent += static_cast<size_t>(bytes);
+    }
+    ssize_t moved = spliced.receive(fds[0], error_msg);
+    assert(moved > 0 || (moved == -1 && errno == EAGAIN));
+  }
+  assert(spliced.getReceived() == body.size());
+
+  // nothing past the body was taken from the socket
+  char next[64];
+  assert(recv(fds[0], next, sizeof(next), 0) == 16);
+  assert(std::string(next, 16) == "GET / HTTP/1.1\r\n");
+
+  std::string path = UploadStore::joinPath(dir, "artifact.bin");
+  assert(spliced.publish(path, ConfigParser::UploadDurability::FDATASYNC,
+                         error_msg));
+  assert(countFiles(dir) == 1);
+  std::ifstream file(path, std::ios::binary);
+  std::string content((std::istreambuf_iterator<char>(file)),
+                      std::istreambuf_iterator<char>());
+  assert(content == body);
+
+  close(fds[0]);
+  close(fds[1]);
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_unpublished_body(const std::string& dir) {
+  std::cout << "Testing unpublished body removal..." << std::flush;
+
+  std::string error_msg;
+  std::string path = UploadStore::joinPath(dir, "taken.txt");
+  assert(UploadStore::writeNewFile(path, "first", error_msg));
+  {
+    SplicedBody incomplete;  // client went away
+    assert(incomplete.open(dir, 10, error_msg));
+    assert(incomplete.write("12345", error_msg));
+    assert(countFiles(dir) == 2);
+    assert(!incomplete.publish(path, ConfigParser::UploadDurability::NONE,
+                               error_msg));
+  }
+  assert(countFiles(dir) == 1);
+
+  SplicedBody existing;  // the name is taken, nothing is replaced
+  assert(existing.open(dir, 6, error_msg));
+  assert(existing.write("second", error_msg) && existing.isComplete());
+  assert(!existing.publish(path, ConfigParser::UploadDurability::NONE,
+                           error_msg));
+  assert(error_msg == "File already exists");
+  assert(countFiles(dir) == 1);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+void run_spliced_body_tests() {
+  std::cout << "=== Running SplicedBody Tests ===\n" << std::endl;
+
+  std::string dir = std::filesystem::temp_directory_path() /
+                    ("webserv-splice-test-" + std::to_string(getpid()));
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir + "/stream");
+  std::filesystem::create_directories(dir + "/partial");
+  test_splice_from_socket(dir + "/stream");
+  test_unpublished_body(dir + "/partial");
+  std::filesystem::remove_all(dir);
+
+  std::cout << "\nAll SplicedBody tests passed!\n" << std::endl;
+}
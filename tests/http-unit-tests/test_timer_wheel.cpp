@@ -0,0 +1,65 @@
+/**
+ * @file test_timer_wheel.cpp
+ * @brief Unit tests for the timer wheel of the event loop
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-04
+ * @version 1.0
+ */
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "TimerWheel.hpp"
+
+static void test_expiration_order() {
+  std::cout << "Testing timer expiration..." << std::flush;
+
+  TimerWheel wheel;
+  TimerWheel::Clock::time_point now = TimerWheel::Clock::now();
+  std::vector<int> expired;
+
+  wheel.schedule(4, now + std::chrono::milliseconds(50));
+  wheel.schedule(5, now - std::chrono::milliseconds(5));
+  assert(wheel.size() == 2);
+
+  wheel.collectExpired(now, expired);
+  assert(expired.size() == 1 && expired[0] == 5);
+
+  expired.clear();
+  wheel.collectExpired(now + std::chrono::milliseconds(20), expired);
+  assert(expired.empty());
+
+  wheel.collectExpired(now + std::chrono::milliseconds(60), expired);
+  assert(expired.size() == 1 && expired[0] == 4);
+  assert(wheel.size() == 0);
+
+  std::cout << "\t\t✓ passed" << std::endl;
+}
+
+static void test_timer_after_full_turn() {
+  std::cout << "Testing timer beyond one wheel turn..." << std::flush;
+
+  TimerWheel wheel;
+  TimerWheel::Clock::time_point now = TimerWheel::Clock::now();
+  std::chrono::milliseconds turn(TIMER_WHEEL_TICK_MS * TIMER_WHEEL_SLOTS);
+  std::vector<int> expired;
+
+  wheel.schedule(7, now + turn + std::chrono::milliseconds(100));
+  wheel.collectExpired(now + turn, expired);
+  assert(expired.empty());
+  wheel.collectExpired(now + turn + std::chrono::milliseconds(200), expired);
+  assert(expired.size() == 1 && expired[0] == 7);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+void run_timer_wheel_tests() {
+  std::cout << "=== Running TimerWheel Tests ===\n" << std::endl;
+
+  test_expiration_order();
+  test_timer_after_full_turn();
+
+  std::cout << "\nAll TimerWheel tests passed!\n" << std::endl;
+}
@@ -0,0 +1,180 @@
+/**
+ * @file test_upload_store.cpp
+ * @brief Unit tests for SHA-256 and content-addressed upload storage
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-10
+ * @version 1.0
+ */
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "Sha256.hpp"
+#include "UploadStore.hpp"
+
+static void test_sha256_vectors() {
+  std::cout << "Testing SHA-256 test vectors..." << std::flush;
+
+  for (bool hardware : {false, true}) {
+    Sha256 empty(hardware);
+    assert(empty.finishHex() ==
+           "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+
+    Sha256 abc(hardware);
+    abc.update("abc");
+    assert(abc.finishHex() ==
+           "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+    Sha256 two_blocks(hardware);
+    two_blocks.update(
+        "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq");
+    assert(two_blocks.finishHex() ==
+           "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+    Sha256 million(hardware);
+    std::string thousand(1000, 'a');
+    for (int i = 0; i < 1000; i++) {
+      million.update(thousand);
+    }
+    assert(million.finishHex() ==
+           "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+  }
+
+  std::cout << "\t✓ passed" << (Sha256::hasHardwareSupport() ? " (SHA-NI)" : "")
+            << std::endl;
+}
+
+static void test_sha256_incremental() {
+  std::cout << "Testing SHA-256 incremental updates..." << std::flush;
+
+  std::string data;
+  for (size_t i = 0; i < 1000; i++) {
+    data += static_cast<char>(i * 31 + 7);
+  }
+  // every split point, both code paths agree with the one-shot digest
+  std::string expected = Sha256::hashHex(data);
+  for (size_t split = 0; split <= 200; split++) {
+    Sha256 portable(false);
+    portable.update(std::string_view(data).substr(0, split));
+    portable.update(std::string_view(data).substr(split));
+    assert(portable.finishHex() == expected);
+
+    Sha256 accelerated(true);
+    accelerated.update(std::string_view(data).substr(0, split));
+    accelerated.update(std::string_view(data).substr(split));
+    assert(accelerated.finishHex() == expected);
+  }
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_write_new_file(const std::string& dir) {
+  std::cout << "Testing exclusive file creation..." << std::flush;
+
+  std::string error_msg;
+  std::string path = UploadStore::joinPath(dir, "note.txt");
+  assert(UploadStore::writeNewFile(path, "first", error_msg));
+  assert(!UploadStore::writeNewFile(path, "second", error_msg));
+  assert(error_msg == "File already exists");
+
+  std::ifstream file(path);
+  std::string content((std::istreambuf_iterator<char>(file)),
+                      std::istreambuf_iterator<char>());
+  assert(content == "first");
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_store_by_digest(const std::string& dir) {
+  std::cout << "Testing content-addressed storage..." << std::flush;
+
+  std::string content(3 * UPLOAD_WRITE_CHUNK + 17, 'x');
+  std::string error_msg;
+  UploadStore::StoredObject first;
+  assert(UploadStore::storeByDigest(dir + "/", "zip", content, first,
+                                    error_msg));
+  assert(first.created);
+  assert(first.digest == Sha256::hashHex(content));
+  assert(first.file_name == first.digest + ".zip");
+
+  // same content again: nothing new on disk, same digest
+  UploadStore::StoredObject second;
+  assert(UploadStore::storeByDigest(dir, "zip", content, second, error_msg));
+  assert(!second.created);
+  assert(second.file_name == first.file_name);
+
+  size_t files = 0;
+  for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+    (void)entry;
+    files++;
+  }
+  assert(files == 1);  // no temporary files left behind
+
+  struct stat info;
+  std::string path = UploadStore::joinPath(dir, first.file_name);
+  assert(stat(path.c_str(), &info) == 0);
+  assert(static_cast<size_t>(info.st_size) == content.size());
+  assert(info.st_nlink == 1);
+  assert((info.st_mode & 0777) == 0644);
+
+  UploadStore::StoredObject other;
+  assert(UploadStore::storeByDigest(dir, "", "other", other, error_msg));
+  assert(other.created && other.file_name == other.digest);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_durable_write_behind(const std::string& dir) {
+  std::cout << "Testing durable large file write..." << std::flush;
+
+  std::string content;
+  for (size_t i = 0; i < UPLOAD_WRITE_BEHIND_MIN + 12345; i++) {
+    content += static_cast<char>(i % 251);
+  }
+  std::string error_msg;
+  std::string path = UploadStore::joinPath(dir, "large.bin");
+  assert(UploadStore::writeNewFile(path, content, error_msg,
+                                   ConfigParser::UploadDurability::FSYNC));
+  assert(!UploadStore::writeNewFile(path, "x", error_msg,
+                                    ConfigParser::UploadDurability::FDATASYNC));
+
+  std::ifstream file(path, std::ios::binary);
+  std::string stored((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+  assert(stored == content);
+
+  size_t files = 0;
+  for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+    (void)entry;
+    files++;
+  }
+  assert(files == 1);  // temporary files are gone
+
+  std::cout << "	✓ passed" << std::endl;
+}
+
+void run_upload_store_tests() {
+  std::cout << "=== Running UploadStore Tests ===\n" << std::endl;
+
+  test_sha256_vectors();
+  test_sha256_incremental();
+
+  std::string dir = std::filesystem::temp_directory_path() /
+                    ("webserv-upload-test-" + std::to_string(getpid()));
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir + "/plain");
+  std::filesystem::create_directories(dir + "/digest");
+  std::filesystem::create_directories(dir + "/durable");
+  test_write_new_file(dir + "/plain");
+  test_store_by_digest(dir + "/digest");
+  test_durable_write_behind(dir + "/durable");
+  std::filesystem::remove_all(dir);
+
+  std::cout << "\nAll UploadStore tests passed!\n" << std::endl;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file test_vhost_quota.cpp
+ * @brief Unit tests for per virtual host quotas
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-02
+ * @version 1.0
+ */
+
+#include <cassert>
+#include <iostream>
+#include <string>
+
+#include "Config.hpp"
+#include "VhostQuota.hpp"
+
+static void test_unlimited_without_usage() {
+  std::cout << "Testing vhost without counters..." << std::flush;
+
+  ConfigParser::ServerConfig server;
+  server.max_connections = 1;
+  size_t charged = 0;
+
+  assert(VhostQuota::acquireConnection(server));
+  assert(VhostQuota::acquireConnection(server));
+  assert(VhostQuota::acquireCgiProcess(server));
+  assert(VhostQuota::chargeBodyMemory(server, charged, 1000000));
+  assert(VhostQuota::hasBandwidth(server));
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_connection_and_cgi_limits() {
+  std::cout << "Testing connection and CGI limits..." << std::flush;
+
+  ConfigParser::ServerConfig server;
+  VhostUsage usage;
+  server.usage = &usage;
+  server.max_connections = 2;
+  server.max_cgi_processes = 1;
+
+  assert(VhostQuota::acquireConnection(server));
+  assert(VhostQuota::acquireConnection(server));
+  assert(!VhostQuota::acquireConnection(server));
+  VhostQuota::releaseConnection(server);
+  assert(usage.connections == 1);
+  assert(VhostQuota::acquireConnection(server));
+
+  assert(VhostQuota::acquireCgiProcess(server));
+  assert(!VhostQuota::acquireCgiProcess(server));
+  VhostQuota::releaseCgiProcess(server);
+  assert(usage.cgi_processes == 0);
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+static void test_body_memory_limit() {
+  std::cout << "Testing body memory limit..." << std::flush;
+
+  ConfigParser::ServerConfig server;
+  VhostUsage usage;
+  server.usage = &usage;
+  server.max_body_memory = 100;
+  size_t first = 0;
+  size_t second = 0;
+
+  assert(VhostQuota::chargeBodyMemory(server, first, 40));
+  assert(VhostQuota::chargeBodyMemory(server, first, 60));
+  assert(usage.body_memory == 60);
+  assert(VhostQuota::chargeBodyMemory(server, second, 40));
+  assert(!VhostQuota::chargeBodyMemory(server, second, 41));
+  assert(second == 40);
+  VhostQuota::releaseBodyMemory(server, first);
+  assert(first == 0);
+  assert(usage.body_memory == 40);
+  assert(VhostQuota::chargeBodyMemory(server, second, 100));
+
+  std::cout << "\t\t✓ passed" << std::endl;
+}
+
+static void test_bandwidth_bucket() {
+  std::cout << "Testing bandwidth token bucket..." << std::flush;
+
+  ConfigParser::ServerConfig server;
+  VhostUsage usage;
+  server.usage = &usage;
+  server.max_bandwidth = 1000000;
+
+  usage.bandwidth_tokens = 1;
+  assert(VhostQuota::hasBandwidth(server));
+  VhostQuota::consumeBandwidth(server, 5000000);
+  assert(usage.bytes_sent == 5000000);
+  assert(!VhostQuota::hasBandwidth(server));
+
+  std::cout << "\t✓ passed" << std::endl;
+}
+
+void run_vhost_quota_tests() {
+  std::cout << "=== Running VhostQuota Tests ===\n" << std::endl;
+
+  test_unlimited_without_usage();
+  test_connection_and_cgi_limits();
+  test_body_memory_limit();
+  test_bandwidth_bucket();
+
+  std::cout << "\nAll VhostQuota tests passed!\n" << std::endl;
+}
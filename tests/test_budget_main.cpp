@@ -0,0 +1,350 @@
+/**
+ * @file test_budget_main.cpp
+ * @brief Heap allocation and syscall budgets of canonical requests
+ * @author Julia Persidskaia (ipersids)
+ * @date 2025-09-09
+ * @version 1.0
+ *
+ * Every scenario sends one request through a Connection the way the event
+ * loop does (recv into the buffer chain, processRequest(), send) and counts
+ * what that costs:
+ * - heap allocations: global operator new of this binary is interposed;
+ * - syscalls: the main thread runs under a seccomp filter that reports
+ *   every syscall to a supervisor thread (SECCOMP_RET_USER_NOTIF), which
+ *   counts it and lets it continue. This also sees syscalls libc makes
+ *   internally (fopen, stream flushes), unlike an LD_PRELOAD shim.
+ *
+ * A scenario runs twice on the same keep-alive connection and the second
+ * run is measured, so one-time work (pools, lazily built tables) is left
+ * out. The logger is disabled, so the counts are those of the request path
+ * alone, not of building and writing log lines. A failure means a change
+ * made the request path more expensive. Lower a budget after a change that
+ * makes it cheaper.
+ */
+
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+#include <sys/ioctl.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+
+#include "AssetBundle.hpp"
+#include "Connection.hpp"
+#include "HttpMethodHandler.hpp"
+#include "Logger.hpp"
+#include "Webserver.hpp"
+
+#define BUDGET_CONFIG "tests/test-configs/budget.conf"
+#define BUDGET_SITE "docs/fusion_web"
+#define BUDGET_BUNDLE "budget.bundle"
+#define BUDGET_DIR_TEMPLATE "/tmp/webserv-budget-XXXXXX"
+#define BUDGET_PORT 18180
+#define BUDGET_MAX_TRACE 64
+
+volatile std::sig_atomic_t shutdown_requested = 0;
+
+static std::atomic<bool> g_counting(false);
+static std::atomic<size_t> g_allocations(0);
+static std::atomic<size_t> g_syscalls(0);
+static std::atomic<int> g_notify_fd(-1);
+// numbers of the syscalls counted, printed when a budget is exceeded
+static std::atomic<int> g_trace[BUDGET_MAX_TRACE];
+
+// Allocation counter
+
+static void* countedAlloc(size_t size) {
+  if (g_counting.load(std::memory_order_relaxed)) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+  }
+  void* ptr = std::malloc(size ? size : 1);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+// Syscall counter
+
+/**
+ * @brief Answers seccomp notifications of the main thread, counting them
+ *        while g_counting is set
+ */
+static void superviseSyscalls(void) {
+  while (g_notify_fd.load() < 0) {
+    std::this_thread::yield();
+  }
+  int fd = g_notify_fd.load();
+  struct seccomp_notif request;
+  struct seccomp_notif_resp response;
+
+  while (true) {
+    std::memset(&request, 0, sizeof(request));
+    if (ioctl(fd, SECCOMP_IOCTL_NOTIF_RECV, &request) == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    if (g_counting.load()) {
+      size_t index = g_syscalls.fetch_add(1);
+      if (index < BUDGET_MAX_TRACE) {
+        g_trace[index].store(request.data.nr);
+      }
+    }
+    std::memset(&response, 0, sizeof(response));
+    response.id = request.id;
+    response.flags = SECCOMP_USER_NOTIF_FLAG_CONTINUE;
+    ioctl(fd, SECCOMP_IOCTL_NOTIF_SEND, &response);
+  }
+}
+
+/**
+ * @brief Puts the calling thread under a filter reporting every syscall
+ * @return false if the kernel or sandbox doesn't allow it
+ */
+static bool startSyscallCounter(void) {
+  // the supervisor must exist before the filter, threads inherit filters
+  std::thread(superviseSyscalls).detach();
+
+  struct sock_filter filter[] = {
+      BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_USER_NOTIF),
+  };
+  struct sock_fprog program = {1, filter};
+  if (prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) == -1) {
+    return false;
+  }
+  int fd = static_cast<int>(syscall(SYS_seccomp, SECCOMP_SET_MODE_FILTER,
+                                    SECCOMP_FILTER_FLAG_NEW_LISTENER,
+                                    &program));
+  if (fd < 0) {
+    return false;
+  }
+  g_notify_fd.store(fd);
+  return true;
+}
+
+// Scenarios
+
+struct Scenario {
+  const char* name;
+  const char* request;
+  const char* expected_status;
+  size_t max_allocations;
+  size_t max_syscalls;
+};
+
+/*
+ * Budgets are the request path's measured costs with no headroom: both
+ * counts are deterministic for a build, so every increase fails. The window
+ * starts at the recv() of the event loop and ends after the send() of the
+ * response. Expected syscalls:
+ * - cached GET (bundle asset, answered from memory): recvfrom, sendto;
+ * - static GET: recvfrom; newfstatat, getcwd and one readlink per path
+ *   component to canonicalize the file (5) and the root (4); faccessat2,
+ *   3 newfstatat, openat, 2 read, close; sendto;
+ * - 404: recvfrom; 3 newfstatat of the missing file; canonicalization as
+ *   above, 4 readlinks each; the error page read like a static file; sendto;
+ * - redirect and 400: recvfrom, sendto.
+ * The cached GET is not allocation free: the parser stores the header in a
+ * map and checks the version with a regex, and the response is built as
+ * strings (header map, body copy, Date, serialized message).
+ */
+static const Scenario kScenarios[] = {
+    {"cached keep-alive static GET",
+     "GET /style.css HTTP/1.1\r\nHost: localhost\r\n\r\n", "HTTP/1.1 200",
+     24, 2},
+    {"keep-alive static GET",
+     "GET /index.html HTTP/1.1\r\nHost: localhost\r\n\r\n", "HTTP/1.1 200",
+     58, 23},
+    {"GET of missing file (404 page)",
+     "GET /missing.html HTTP/1.1\r\nHost: localhost\r\n\r\n", "HTTP/1.1 404",
+     73, 25},
+    {"location redirect", "GET /old HTTP/1.1\r\nHost: localhost\r\n\r\n",
+     "HTTP/1.1 301", 25, 2},
+    {"malformed request (400)", "GET /index.html HTTP/1.1\r\n\r\n",
+     "HTTP/1.1 400", 18, 2},
+};
+
+/// @brief Bundles without gzip variants, the requests don't accept them
+static bool noGzip(std::string_view input, std::string& output) {
+  (void)input;
+  (void)output;
+  return false;
+}
+
+/**
+ * @brief Sends one request through a connection like Webserv does
+ * @return Response as received by the client
+ */
+static std::string exchange(Connection& connection, int server_fd,
+                            int client_fd,
+                            const std::string& request, size_t& allocations,
+                            size_t& syscalls) {
+  if (send(client_fd, request.data(), request.size(), 0) !=
+      static_cast<ssize_t>(request.size())) {
+    throw std::runtime_error("send() to connection failed");
+  }
+
+  g_allocations = 0;
+  g_syscalls = 0;
+  g_counting = true;
+  BufferChain& buffer = connection.getReceiveBuffer();
+  size_t available = 0;
+  char* tail = buffer.prepare(available);
+  ssize_t bytes = recv(server_fd, tail, available, 0);
+  if (bytes > 0) {
+    buffer.commit(bytes);
+    connection.processRequest();
+  }
+  g_counting = false;
+  allocations = g_allocations;
+  syscalls = g_syscalls;
+
+  std::string response;
+  char chunk[65536];
+  while ((bytes = recv(client_fd, chunk, sizeof(chunk), MSG_DONTWAIT)) > 0) {
+    response.append(chunk, bytes);
+  }
+  return response;
+}
+
+static bool runScenario(Webserv& webserv, HttpMethodHandler& handler,
+                        const Scenario& scenario, bool count_syscalls) {
+  std::cout << "Testing " << scenario.name << "..." << std::flush;
+
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1) {
+    throw std::runtime_error("socketpair() failed");
+  }
+  bool passed = true;
+  {
+    Connection connection(fds[0], webserv.getServerSocketByPort(BUDGET_PORT),
+                          webserv, handler);
+    size_t allocations = 0;
+    size_t syscalls = 0;
+    for (int run = 0; run < 2; run++) {  // first run warms up
+      std::string response = exchange(connection, fds[0], fds[1], scenario.request,
+                                      allocations, syscalls);
+      if (response.compare(0, std::strlen(scenario.expected_status),
+                           scenario.expected_status) != 0) {
+        std::cout << "\t✗ unexpected response: "
+                  << response.substr(0, response.find("\r\n")) << std::endl;
+        passed = false;
+        break;
+      }
+    }
+    if (passed) {
+      passed = allocations <= scenario.max_allocations &&
+               (!count_syscalls || syscalls <= scenario.max_syscalls);
+      std::cout << "\t" << (passed ? "✓ passed" : "✗ over budget")
+                << " (allocations " << allocations << "/"
+                << scenario.max_allocations << ", syscalls ";
+      if (count_syscalls) {
+        std::cout << syscalls << "/" << scenario.max_syscalls << ")";
+      } else {
+        std::cout << "not counted)";
+      }
+      std::cout << std::endl;
+      if (!passed && count_syscalls) {
+        std::cout << "\tsyscall numbers:";
+        for (size_t i = 0; i < syscalls && i < BUDGET_MAX_TRACE; i++) {
+          std::cout << " " << g_trace[i].load();
+        }
+        std::cout << std::endl;
+      }
+    }
+  }
+  close(fds[1]);
+  return passed;
+}
+
+/**
+ * @brief Copies the site to a new directory, makes it the working
+ *        directory and packs the bundle the config serves
+ *
+ * Serving a file canonicalizes its path, one readlink() and a few
+ * allocations per path component: the directory has a fixed depth and
+ * name length, so the counts don't depend on where the tree is checked
+ * out.
+ *
+ * @param dir [in,out] BUDGET_DIR_TEMPLATE, completed by mkdtemp()
+ * @return Absolute path of the config
+ */
+static std::string prepareSite(char* dir) {
+  std::string config = std::filesystem::absolute(BUDGET_CONFIG);
+  std::string site = std::filesystem::absolute(BUDGET_SITE);
+  if (mkdtemp(dir) == nullptr) {
+    throw std::runtime_error("mkdtemp() failed: " +
+                             std::string(std::strerror(errno)));
+  }
+  std::filesystem::create_directories(std::string(dir) + "/" + BUDGET_SITE);
+  std::filesystem::copy(site, std::string(dir) + "/" + BUDGET_SITE,
+                        std::filesystem::copy_options::recursive);
+  if (chdir(dir) == -1) {
+    throw std::runtime_error("chdir() failed: " +
+                             std::string(std::strerror(errno)));
+  }
+  size_t assets = 0;
+  std::string error_msg;
+  if (!AssetBundle::build(BUDGET_SITE, BUDGET_BUNDLE, noGzip, assets,
+                          error_msg)) {
+    throw std::runtime_error("Bundle build failed: " + error_msg);
+  }
+  return config;
+}
+
+int main() {
+  char dir[] = BUDGET_DIR_TEMPLATE;
+  int result = 1;
+  try {
+    // counted requests must not build or write log lines
+    Logger::disable();
+    Webserv webserv(prepareSite(dir));
+    HttpMethodHandler handler;
+
+    std::cout << "=== Running Budget Tests ===\n" << std::endl;
+    bool count_syscalls = startSyscallCounter();
+    if (!count_syscalls) {
+      std::cout << "seccomp user notification unavailable ("
+                << std::strerror(errno) << "), syscalls are not counted\n"
+                << std::endl;
+    }
+
+    size_t failed = 0;
+    for (const Scenario& scenario : kScenarios) {
+      failed += runScenario(webserv, handler, scenario, count_syscalls) ? 0 : 1;
+    }
+    if (failed != 0) {
+      std::cout << "\n" << failed << " budget test(s) failed!" << std::endl;
+    } else {
+      std::cout << "\nAll budget tests passed!\n" << std::endl;
+      result = 0;
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Test failed with exception: " << e.what() << std::endl;
+  }
+  if (std::strcmp(dir, BUDGET_DIR_TEMPLATE) != 0) {
+    std::filesystem::remove_all(dir);
+  }
+  return result;
+}
@@ -1,14 +1,58 @@
+#include <csignal>
 #include <iostream>
 
+// the slow client tests run the event loop
+volatile std::sig_atomic_t shutdown_requested = 0;
+
 void run_http_request_tests();
 void run_http_request_parser_tests();
 void run_http_method_handler_tests();
+void run_vhost_quota_tests();
+void run_timer_wheel_tests();
+void run_mime_types_tests();
+void run_redirect_map_tests();
+void run_location_matcher_tests();
+void run_buffer_chain_tests();
+void run_upload_store_tests();
+void run_resumable_upload_tests();
+void run_directory_archive_tests();
+void run_asset_bundle_tests();
+void run_precompress_tests();
+void run_cache_policy_tests();
+void run_socket_activation_tests();
+void run_request_pipeline_tests();
+void run_shared_zone_tests();
+void run_access_list_tests();
+void run_profiler_tests();
+void run_connection_filter_tests();
+void run_spliced_body_tests();
+void run_slow_client_tests();
 
 int main() {
   try {
     run_http_request_tests();
     run_http_request_parser_tests();
     run_http_method_handler_tests();
+    run_vhost_quota_tests();
+    run_timer_wheel_tests();
+    run_mime_types_tests();
+    run_redirect_map_tests();
+    run_location_matcher_tests();
+    run_buffer_chain_tests();
+    run_upload_store_tests();
+    run_resumable_upload_tests();
+    run_directory_archive_tests();
+    run_asset_bundle_tests();
+    run_precompress_tests();
+    run_cache_policy_tests();
+    run_socket_activation_tests();
+    run_request_pipeline_tests();
+    run_shared_zone_tests();
+    run_access_list_tests();
+    run_profiler_tests();
+    run_connection_filter_tests();
+    run_spliced_body_tests();
+    run_slow_client_tests();
     return 0;
   } catch (const std::exception& e) {
     std::cerr << "Test failed with exception: " << e.what() << std::endl;